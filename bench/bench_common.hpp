@@ -0,0 +1,86 @@
+#pragma once
+
+/**
+ * @file bench_common.hpp
+ * @brief Минимальная обвязка для бенчмарков
+ *
+ * Бенчмарки — обычные исполняемые файлы без внешних зависимостей.
+ * Первый аргумент командной строки (если задан) масштабирует объем работы,
+ * чтобы в CI их можно было прогнать быстро, а локально — на больших данных.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Множитель объема работы из argv[1] (по умолчанию 1.0)
+ */
+inline double scaleFromArgs(int argc, char** argv) {
+    if (argc > 1) {
+        double scale = std::atof(argv[1]);
+        if (scale > 0) {
+            return scale;
+        }
+    }
+    return 1.0;
+}
+
+inline std::size_t scaled(std::size_t base, double scale) {
+    return std::max<std::size_t>(1, static_cast<std::size_t>(base * scale));
+}
+
+/**
+ * @brief Время выполнения f() в секундах
+ */
+template <typename F>
+double measureSeconds(F&& f) {
+    auto start = Clock::now();
+    f();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Запустить fn(thread_index) в thread_count потоках
+ * @return Время от старта первого до завершения последнего потока, секунды
+ */
+template <typename F>
+double runThreads(unsigned thread_count, F&& fn) {
+    return measureSeconds([&] {
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count);
+        for (unsigned t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&fn, t] { fn(t); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    });
+}
+
+/**
+ * @brief Набор числа потоков 1, 2, 4 ... до max(hardware_concurrency, 4)
+ */
+inline std::vector<unsigned> threadCounts() {
+    unsigned limit = std::max(4u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned n = 1; n <= limit; n *= 2) {
+        counts.push_back(n);
+    }
+    return counts;
+}
+
+inline void printTitle(const std::string& title) {
+    std::printf("\n== %s ==\n", title.c_str());
+}
+
+} // namespace bench
@@ -0,0 +1,96 @@
+/**
+ * @file bulk_load_bench.cpp
+ * @brief Теплый старт: массовая загрузка в зависимости от числа потоков
+ *
+ * Готовые пользователи и заказы (пользователей в 10 раз меньше) с их ID
+ * загружаются в InMemoryDatabase:
+ * - insert: по записи через insertUser/insertOrder (базовая линия);
+ * - bulkLoad: параллельное построение и атомарная установка;
+ * - checkpoint: loadCheckpoint из файла тем же построением.
+ * Для bulkLoad и checkpoint выводится скорость в записях в секунду
+ * при 1, 2, 4 ... потоках.
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include <cstdio>
+#include <filesystem>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+constexpr std::size_t kDistinctProducts = 2000;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const std::size_t order_count = bench::scaled(2000000, scale);
+    const std::size_t user_count = std::max<std::size_t>(1, order_count / 10);
+    const std::string checkpoint_path =
+        (std::filesystem::temp_directory_path() / "bulk_load_bench.ckpt").string();
+
+    std::vector<User> users;
+    users.reserve(user_count);
+    for (std::size_t i = 0; i < user_count; ++i) {
+        const std::string name = "Customer " + std::to_string(i);
+        users.push_back(User{static_cast<int>(i + 1), name, name + "@example.com", true});
+    }
+    std::vector<Order> orders;
+    orders.reserve(order_count);
+    for (std::size_t i = 0; i < order_count; ++i) {
+        orders.push_back(Order{static_cast<int>(i + 1), static_cast<int>(i % user_count + 1),
+                               "Catalog product #" + std::to_string(i % kDistinctProducts),
+                               static_cast<double>(i % 1000) + 0.99,
+                               static_cast<OrderStatus>(i % 5)});
+    }
+    const double records = static_cast<double>(user_count + order_count);
+
+    bench::printTitle("InMemoryDatabase bulk load (" + std::to_string(order_count) +
+                      " orders, " + std::to_string(user_count) + " users)");
+    double insert = 0;
+    {
+        InMemoryDatabase database;
+        insert = bench::measureSeconds([&] {
+            for (const auto& user : users) {
+                database.insertUser(user);
+            }
+            for (const auto& order : orders) {
+                database.insertOrder(order);
+            }
+        });
+        database.saveCheckpoint(checkpoint_path);
+    }
+    std::printf("insert, 1 thread: %.1f ms, %.0f rec/s\n\n", insert * 1e3, records / insert);
+
+    std::printf("%8s %12s %14s %10s %14s %14s\n", "threads", "bulk ms", "bulk rec/s",
+                "speedup", "ckpt ms", "ckpt rec/s");
+    double single = 0;
+    for (unsigned threads : bench::threadCounts()) {
+        double bulk = 0;
+        {
+            InMemoryDatabase database;
+            bulk = bench::measureSeconds([&] { database.bulkLoad(users, orders, threads); });
+            if (database.findAllOrders().size() != order_count) {
+                std::printf("bulk load lost records\n");
+                return 1;
+            }
+        }
+        double checkpoint = 0;
+        {
+            InMemoryDatabase database;
+            checkpoint = bench::measureSeconds(
+                [&] { database.loadCheckpoint(checkpoint_path, threads); });
+        }
+        if (threads == 1) {
+            single = bulk;
+        }
+        std::printf("%8u %12.1f %14.0f %9.2fx %14.1f %14.0f\n", threads, bulk * 1e3,
+                    records / bulk, single / bulk, checkpoint * 1e3, records / checkpoint);
+    }
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    std::remove(checkpoint_path.c_str());
+    return 0;
+}
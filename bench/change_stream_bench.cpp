@@ -0,0 +1,146 @@
+/**
+ * @file change_stream_bench.cpp
+ * @brief Поток изменений: цена для писателя и для потребителя
+ *
+ * Первая таблица — среднее время updateOrder без потока, с потоком без
+ * читателей и с 1..N читателями, которые непрерывно догоняют писателя.
+ * Вторая — цена одного обнаружения изменений потребителем: чтение новых
+ * событий из потока против опроса findAllOrders со сравнением с
+ * предыдущим снимком (как потребитель без потока ищет изменения).
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+constexpr int kOrdersPerUser = 10;
+
+struct Fixture {
+    InMemoryDatabase database;
+    std::vector<Order> orders;
+};
+
+void fill(Fixture& fixture, int orders) {
+    const int users = std::max(1, orders / kOrdersPerUser);
+    for (int i = 0; i < users; ++i) {
+        fixture.database.saveUser(User{0, "User " + std::to_string(i), "user@example.com", true});
+    }
+    fixture.orders.reserve(orders);
+    for (int i = 0; i < orders; ++i) {
+        Order order{0, i % users + 1, "Catalog product #" + std::to_string(i % 2000),
+                    static_cast<double>(i % 1000) + 0.99, OrderStatus::PENDING};
+        order.id = fixture.database.saveOrder(order);
+        fixture.orders.push_back(order);
+    }
+}
+
+// Среднее время updateOrder при readers читателях потока (-1 — без потока)
+double updateNanos(int orders, int updates, int readers) {
+    Fixture fixture;
+    fill(fixture, orders);
+    auto stream = std::make_shared<ChangeStream>();
+    if (readers >= 0) {
+        fixture.database.attachChangeStream(stream);
+    }
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&stream, &done] {
+            std::uint64_t next = stream->nextSequence();
+            std::int64_t total = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                const bool ok = stream->poll(next, [&total](const ChangeEvent& event) {
+                    total += event.amount.minorUnits();
+                });
+                if (!ok) {
+                    next = stream->oldestSequence();
+                }
+                std::this_thread::yield();
+            }
+            if (total == 0) {
+                std::printf("nothing read\n");
+            }
+        });
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(0, orders - 1);
+    const double seconds = bench::measureSeconds([&] {
+        for (int i = 0; i < updates; ++i) {
+            Order order = fixture.orders[pick(rng)];
+            order.status = i % 2 == 0 ? OrderStatus::CONFIRMED : OrderStatus::SHIPPED;
+            fixture.database.updateOrder(order);
+        }
+    });
+    done = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return seconds * 1e9 / updates;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const int orders = static_cast<int>(bench::scaled(100000, scale));
+    const int updates = static_cast<int>(bench::scaled(500000, scale));
+
+    bench::printTitle("updateOrder with a change stream attached");
+    std::printf("orders: %d, updates: %d, hardware threads: %u\n", orders, updates,
+                std::thread::hardware_concurrency());
+    std::printf("%-20s %14s\n", "readers", "ns/update");
+    std::printf("%-20s %14.0f\n", "no stream", updateNanos(orders, updates, -1));
+    for (int readers : {0, 1, 2, 4}) {
+        std::printf("%-20d %14.0f\n", readers, updateNanos(orders, updates, readers));
+    }
+
+    // Потребитель обнаруживает batch изменений между двумя опросами
+    Fixture fixture;
+    fill(fixture, orders);
+    auto stream = std::make_shared<ChangeStream>();
+    fixture.database.attachChangeStream(stream);
+    std::unordered_map<int, OrderStatus> seen;
+    for (const auto& order : fixture.database.findAllOrders()) {
+        seen[order.id] = order.status;
+    }
+    std::uint64_t next = stream->nextSequence();
+
+    bench::printTitle("Consumer: detect changes since the last poll");
+    std::printf("%-10s %18s %22s\n", "changes", "stream poll us", "findAllOrders diff us");
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pick(0, orders - 1);
+    for (int batch : {1, 100, 10000}) {
+        for (int i = 0; i < batch; ++i) {
+            Order& order = fixture.orders[pick(rng)];
+            order.status = OrderStatus::DELIVERED;
+            fixture.database.updateOrder(order);
+        }
+        std::size_t streamed = 0;
+        const double stream_seconds = bench::measureSeconds([&] {
+            stream->poll(next, [&streamed](const ChangeEvent&) { ++streamed; });
+        });
+        std::size_t diffed = 0;
+        const double scan_seconds = bench::measureSeconds([&] {
+            for (const auto& order : fixture.database.findAllOrders()) {
+                auto& status = seen[order.id];
+                diffed += status != order.status ? 1 : 0;
+                status = order.status;
+            }
+        });
+        std::printf("%-10d %18.1f %22.1f\n", batch, stream_seconds * 1e6, scan_seconds * 1e6);
+        if (streamed != static_cast<std::size_t>(batch) || diffed > streamed) {
+            std::printf("mismatch: streamed %zu, diffed %zu\n", streamed, diffed);
+        }
+    }
+    return 0;
+}
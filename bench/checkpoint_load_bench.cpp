@@ -0,0 +1,90 @@
+/**
+ * @file checkpoint_load_bench.cpp
+ * @brief Время запуска: контрольная точка против повтора журнала
+ *
+ * Для нескольких объемов данных (пользователей в 10 раз меньше, чем
+ * заказов) сравнивается восстановление InMemoryDatabase:
+ * - replay: повтор WriteAheadLog, то есть вызовов API, по записи;
+ * - checkpoint: loadCheckpoint (mmap, проверка CRC, построение таблиц).
+ * Также выводятся время записи контрольной точки и размер файлов.
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include "services/write_ahead_log.hpp"
+#include <cstdio>
+#include <filesystem>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+constexpr std::size_t kDistinctProducts = 2000;
+
+double megabytes(const std::string& path) {
+    return static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const auto dir = std::filesystem::temp_directory_path();
+    const std::string log_path = (dir / "checkpoint_load_bench.log").string();
+    const std::string checkpoint_path = (dir / "checkpoint_load_bench.ckpt").string();
+
+    bench::printTitle("InMemoryDatabase warm start");
+    std::printf("%10s %10s %12s %12s %12s %14s %10s %10s\n", "orders", "users", "replay ms",
+                "save ms", "load ms", "load rec/s", "log MB", "ckpt MB");
+
+    for (std::size_t base : {100000, 1000000, 4000000}) {
+        const std::size_t orders = bench::scaled(base, scale);
+        const std::size_t users = std::max<std::size_t>(1, orders / 10);
+        std::remove(log_path.c_str());
+
+        InMemoryDatabase source;
+        source.attachLog(WriteAheadLog::open(log_path, {Durability::Buffered}));
+        std::vector<int> user_ids;
+        user_ids.reserve(users);
+        for (std::size_t i = 0; i < users; ++i) {
+            const std::string name = "Customer " + std::to_string(i);
+            user_ids.push_back(source.saveUser(User{0, name, name + "@example.com", true}));
+        }
+        for (std::size_t i = 0; i < orders; ++i) {
+            source.saveOrder(Order{0, user_ids[i % users],
+                                   "Catalog product #" + std::to_string(i % kDistinctProducts),
+                                   static_cast<double>(i % 1000) + 0.99,
+                                   static_cast<OrderStatus>(i % 5)});
+        }
+        source.attachLog(nullptr);  // Сбрасывает буфер журнала в файл
+
+        const double save = bench::measureSeconds([&] { source.saveCheckpoint(checkpoint_path); });
+
+        double replay = 0;
+        {
+            InMemoryDatabase target;
+            replay = bench::measureSeconds([&] {
+                WriteAheadLog::replay(log_path, [&](const LogRecord& record) {
+                    target.applyLogRecord(record);
+                });
+            });
+        }
+        double load = 0;
+        {
+            InMemoryDatabase target;
+            load = bench::measureSeconds([&] { target.loadCheckpoint(checkpoint_path); });
+            if (target.findAllOrders().size() != orders) {
+                std::printf("checkpoint lost records\n");
+                return 1;
+            }
+        }
+
+        std::printf("%10zu %10zu %12.1f %12.1f %12.1f %14.0f %10.1f %10.1f\n", orders, users,
+                    replay * 1e3, save * 1e3, load * 1e3, (orders + users) / load,
+                    megabytes(log_path), megabytes(checkpoint_path));
+    }
+    std::remove(log_path.c_str());
+    std::remove(checkpoint_path.c_str());
+    return 0;
+}
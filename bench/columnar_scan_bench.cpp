@@ -0,0 +1,88 @@
+/**
+ * @file columnar_scan_bench.cpp
+ * @brief Агрегирующий обход заказов: колонки против массива структур
+ *
+ * Запрос — сумма заказов в статусе PENDING. Сравниваются:
+ * - findAllOrders InMemoryDatabase с последующим суммированием (как
+ *   клиенту приходится делать через IDatabase);
+ * - обход std::vector<Order>: массив структур со строкой внутри,
+ *   то есть нижняя граница для построчного хранения;
+ * - ColumnarDatabase::sumAmountByStatus, читающий только amount и status.
+ */
+
+#include "bench_common.hpp"
+#include "services/columnar_database.hpp"
+#include "services/database.hpp"
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+OrderStatus statusFor(std::size_t i) {
+    return static_cast<OrderStatus>(i % 5);
+}
+
+Order makeOrder(int user_id, std::size_t i) {
+    return Order{0, user_id, "Product name #" + std::to_string(i % 1000),
+                 static_cast<double>(i % 100) + 0.5, statusFor(i)};
+}
+
+void report(const char* label, double seconds, std::size_t rows, std::size_t repeats,
+            Money checksum) {
+    std::printf("%-32s %12.2f ms/scan %10.2f ns/row  (sum %.2f)\n", label,
+                seconds * 1e3 / repeats, seconds * 1e9 / (rows * repeats),
+                checksum.toDouble());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const std::size_t rows = bench::scaled(1000000, scale);
+    const std::size_t repeats = 20;
+
+    InMemoryDatabase row_db;
+    ColumnarDatabase column_db;
+    std::vector<Order> aos;
+    aos.reserve(rows);
+    const int row_user = row_db.saveUser(User{0, "User", "user@test.com", true});
+    const int column_user = column_db.saveUser(User{0, "User", "user@test.com", true});
+    for (std::size_t i = 0; i < rows; ++i) {
+        row_db.saveOrder(makeOrder(row_user, i));
+        column_db.saveOrder(makeOrder(column_user, i));
+        aos.push_back(makeOrder(row_user, i));
+    }
+
+    bench::printTitle("sum(amount) where status == PENDING");
+    std::printf("%zu orders, %zu scans\n", rows, repeats);
+
+    Money sum;
+    double seconds = bench::measureSeconds([&] {
+        for (std::size_t r = 0; r < repeats; ++r) {
+            sum = Money{};
+            for (const auto& order : row_db.findAllOrders()) {
+                sum += order.status == OrderStatus::PENDING ? order.amount : Money{};
+            }
+        }
+    });
+    report("InMemoryDatabase findAllOrders", seconds, rows, repeats, sum);
+
+    seconds = bench::measureSeconds([&] {
+        for (std::size_t r = 0; r < repeats; ++r) {
+            sum = Money{};
+            for (const auto& order : aos) {
+                sum += order.status == OrderStatus::PENDING ? order.amount : Money{};
+            }
+        }
+    });
+    report("vector<Order> scan", seconds, rows, repeats, sum);
+
+    seconds = bench::measureSeconds([&] {
+        for (std::size_t r = 0; r < repeats; ++r) {
+            sum = column_db.sumAmountByStatus(OrderStatus::PENDING);
+        }
+    });
+    report("ColumnarDatabase", seconds, rows, repeats, sum);
+    return 0;
+}
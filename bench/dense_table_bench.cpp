@@ -0,0 +1,150 @@
+/**
+ * @file dense_table_bench.cpp
+ * @brief Индекс по ID: DenseIdArray против std::unordered_map
+ *
+ * Сравнивает прежний способ адресации записей (узловая хеш-таблица
+ * int -> указатель) с DenseIdArray, на котором теперь построена
+ * VersionedTable. Измеряется задержка случайного поиска и накладные
+ * расходы индекса в байтах на запись (без самих записей). Помимо плотных
+ * ID проверяется разреженный случай: IdAllocator выдает потокам блоки,
+ * поэтому в одной базе могут оставаться пропуски.
+ */
+
+#include "bench_common.hpp"
+#include "services/dense_id_array.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <unordered_map>
+
+using namespace services;
+
+namespace {
+
+std::size_t g_allocated = 0;
+
+/**
+ * @brief Аллокатор, считающий байты, выделенные контейнером
+ */
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        g_allocated += n * sizeof(T);
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, std::size_t n) {
+        g_allocated -= n * sizeof(T);
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const { return false; }
+};
+
+struct Record {
+    long value = 0;
+};
+
+struct Slot {
+    std::atomic<const Record*> head{nullptr};
+};
+
+using HashIndex = std::unordered_map<int, const Record*, std::hash<int>, std::equal_to<int>,
+                                     CountingAllocator<std::pair<const int, const Record*>>>;
+
+struct Result {
+    double ns_per_lookup;
+    double bytes_per_record;
+};
+
+std::vector<int> lookupOrder(std::size_t records, int stride, std::size_t lookups) {
+    std::vector<int> ids(lookups);
+    std::uint64_t state = 88172645463325252ull;
+    for (auto& id : ids) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        id = static_cast<int>(state % records) * stride + 1;
+    }
+    return ids;
+}
+
+Result runHash(const Record& record, std::size_t records, int stride,
+               const std::vector<int>& ids) {
+    g_allocated = 0;
+    HashIndex index;
+    for (std::size_t i = 0; i < records; ++i) {
+        index.emplace(static_cast<int>(i) * stride + 1, &record);
+    }
+    const double bytes = static_cast<double>(g_allocated + sizeof(index)) / records;
+
+    long sum = 0;
+    double seconds = bench::measureSeconds([&] {
+        for (int id : ids) {
+            auto it = index.find(id);
+            sum += it != index.end() ? it->second->value : 0;
+        }
+    });
+    if (sum == 0) {
+        std::printf("unexpected checksum\n");
+    }
+    return Result{seconds * 1e9 / ids.size(), bytes};
+}
+
+Result runDense(const Record& record, std::size_t records, int stride,
+                const std::vector<int>& ids) {
+    auto index = std::make_unique<DenseIdArray<Slot>>();
+    for (std::size_t i = 0; i < records; ++i) {
+        index->ensure(static_cast<int>(i) * stride + 1).head.store(&record,
+                                                                  std::memory_order_relaxed);
+    }
+    const double bytes = static_cast<double>(index->memoryBytes()) / records;
+
+    long sum = 0;
+    double seconds = bench::measureSeconds([&] {
+        for (int id : ids) {
+            const Slot* slot = index->find(id);
+            const Record* found = slot != nullptr
+                                      ? slot->head.load(std::memory_order_relaxed)
+                                      : nullptr;
+            sum += found != nullptr ? found->value : 0;
+        }
+    });
+    if (sum == 0) {
+        std::printf("unexpected checksum\n");
+    }
+    return Result{seconds * 1e9 / ids.size(), bytes};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const std::size_t records = bench::scaled(1000000, scale);
+    const std::size_t lookups = bench::scaled(5000000, scale);
+    const Record record{1};
+
+    bench::printTitle("id index: random lookup latency and bytes per record");
+    std::printf("%zu records, %zu lookups\n", records, lookups);
+    std::printf("%-10s %-16s %14s %16s\n", "ids", "index", "ns/lookup", "bytes/record");
+    for (int stride : {1, 4, 64}) {
+        const auto ids = lookupOrder(records, stride, lookups);
+        const std::string label = stride == 1 ? "dense" : "stride " + std::to_string(stride);
+        Result hash = runHash(record, records, stride, ids);
+        Result dense = runDense(record, records, stride, ids);
+        std::printf("%-10s %-16s %14.1f %16.1f\n", label.c_str(), "unordered_map",
+                    hash.ns_per_lookup, hash.bytes_per_record);
+        std::printf("%-10s %-16s %14.1f %16.1f\n", label.c_str(), "DenseIdArray",
+                    dense.ns_per_lookup, dense.bytes_per_record);
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file id_allocator_bench.cpp
+ * @brief Выдача ID: счетчик под мьютексом, общий атомарный счетчик
+ *        и IdAllocator с арендой блоков
+ */
+
+#include "bench_common.hpp"
+#include "services/id_allocator.hpp"
+#include <atomic>
+#include <mutex>
+
+using namespace services;
+
+namespace {
+
+template <typename Allocate>
+double idsPerSecond(unsigned threads, std::size_t ids_per_thread, Allocate&& allocate) {
+    std::atomic<long long> sink{0};
+    double seconds = bench::runThreads(threads, [&](unsigned) {
+        long long local = 0;
+        for (std::size_t i = 0; i < ids_per_thread; ++i) {
+            local += allocate();
+        }
+        sink.fetch_add(local);
+    });
+    return threads * ids_per_thread / seconds;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const std::size_t ids = bench::scaled(2000000, scale);
+
+    bench::printTitle("ID allocation, ids/s");
+    std::printf("%8s %16s %16s %16s\n", "threads", "mutex", "atomic", "leased(64)");
+    for (unsigned threads : bench::threadCounts()) {
+        std::mutex mutex;
+        int counter = 1;
+        double locked = idsPerSecond(threads, ids, [&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            return counter++;
+        });
+
+        IdAllocator shared(1);
+        double atomic = idsPerSecond(threads, ids, [&] { return shared.allocate(); });
+
+        IdAllocator leased(64);
+        double blocks = idsPerSecond(threads, ids, [&] { return leased.allocate(); });
+
+        std::printf("%8u %16.0f %16.0f %16.0f\n", threads, locked, atomic, blocks);
+    }
+    return 0;
+}
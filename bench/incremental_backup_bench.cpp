@@ -0,0 +1,87 @@
+/**
+ * @file incremental_backup_bench.cpp
+ * @brief Резервная копия InMemoryDatabase: дельта против полной
+ *        контрольной точки в зависимости от доли измененных записей
+ *
+ * База заполняется заказами, записывается база копии. Затем для каждой
+ * доли изменений статус меняется у случайных заказов, и выводятся:
+ * - время и объем дельты (IncrementalBackup::backup);
+ * - время и объем полной контрольной точки того же состояния;
+ * - время свертки базы и дельт в новую базу (merge).
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include "services/incremental_backup.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+constexpr int kUsers = 10000;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const auto root = std::filesystem::temp_directory_path() / "incremental_backup_bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "backup");
+    const std::string full_path = (root / "full.ckpt").string();
+
+    const int order_count = static_cast<int>(bench::scaled(1000000, scale));
+    std::vector<User> users;
+    for (int id = 1; id <= kUsers; ++id) {
+        users.push_back(User{id, "User " + std::to_string(id),
+                             "user" + std::to_string(id) + "@example.com", true});
+    }
+    std::vector<Order> orders;
+    for (int id = 1; id <= order_count; ++id) {
+        orders.push_back(Order{id, id % kUsers + 1,
+                               "Catalog product #" + std::to_string(id % 2000),
+                               static_cast<double>(id % 1000) + 0.99, OrderStatus::PENDING});
+    }
+    InMemoryDatabase database;
+    database.bulkLoad(users, orders);
+
+    IncrementalBackup backup((root / "backup").string());
+    const double base_seconds = bench::measureSeconds([&] { backup.backup(database); });
+
+    bench::printTitle("Incremental backup vs full checkpoint");
+    std::printf("orders: %d, base: %.1f MB in %.1f ms\n", order_count,
+                static_cast<double>(backup.stats().base_bytes) / 1e6, base_seconds * 1e3);
+    std::printf("%8s %9s %10s %10s %10s %10s %8s %10s\n", "changed", "updates", "delta ms",
+                "delta MB", "full ms", "full MB", "speedup", "merge ms");
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(1, order_count);
+    for (double rate : {0.001, 0.01, 0.1, 0.5}) {
+        const int changes = std::max(1, static_cast<int>(order_count * rate));
+        for (int i = 0; i < changes; ++i) {
+            auto order = database.findOrderById(pick(rng));
+            order->status = order->status == OrderStatus::PENDING ? OrderStatus::CONFIRMED
+                                                                  : OrderStatus::SHIPPED;
+            database.updateOrder(*order);
+        }
+
+        const double delta_seconds = bench::measureSeconds([&] { backup.backup(database); });
+        const auto stats = backup.stats();
+        // Состояние не менялось, поэтому отсчет изменений от полной точки
+        // совпадает с отсчетом от только что записанной дельты
+        const double full_seconds =
+            bench::measureSeconds([&] { database.saveCheckpoint(full_path); });
+        const auto full_bytes = std::filesystem::file_size(full_path);
+        const double merge_seconds = bench::measureSeconds([&] { backup.merge(); });
+
+        std::printf("%7.1f%% %9d %10.2f %10.2f %10.2f %10.2f %7.1fx %10.1f\n", rate * 100.0,
+                    changes, delta_seconds * 1e3, static_cast<double>(stats.delta_bytes) / 1e6,
+                    full_seconds * 1e3, static_cast<double>(full_bytes) / 1e6,
+                    full_seconds / delta_seconds, merge_seconds * 1e3);
+    }
+    std::filesystem::remove_all(root);
+    return 0;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file lock_hold_bench.cpp
+ * @brief Задержка точечного чтения, пока писатели держат блокировку
+ *
+ * Читатели вызывают findOrderById и замеряют время каждого вызова;
+ * разделяемая блокировка ждет, пока писатель держит эксклюзивную, поэтому
+ * хвост распределения (p99, p99.9, max) отражает длину критических секций
+ * писателей. Нагрузки писателей:
+ * - churn: saveOrder с новыми названиями, updateOrder, deleteOrder,
+ *   saveUser/updateUser — выделение и освобождение на каждой операции;
+ * - clear: заполнение таблицы и clear() — освобождение всех записей разом.
+ * Использует только IDatabase, поэтому собирается и с прежними версиями.
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include <atomic>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+constexpr int kBaseOrders = 10000;
+constexpr unsigned kReaders = 2;
+
+struct Latency {
+    std::vector<double> ns;
+
+    double percentile(double p) const {
+        if (ns.empty()) {
+            return 0;
+        }
+        return ns[std::min(ns.size() - 1, static_cast<std::size_t>(p * ns.size()))];
+    }
+};
+
+std::string productName(std::size_t i) {
+    return "Product with a reasonably long catalog name #" + std::to_string(i);
+}
+
+void fill(IDatabase& db, int user_id, int orders, std::size_t salt) {
+    for (int i = 0; i < orders; ++i) {
+        db.saveOrder(Order{0, user_id, productName(salt + i), 10.0, OrderStatus::PENDING});
+    }
+}
+
+template <typename Writer>
+Latency measure(InMemoryDatabase& db, std::size_t reads_per_reader, Writer&& writer) {
+    std::atomic<bool> done{false};
+    std::vector<std::vector<double>> samples(kReaders);
+    std::thread writer_thread([&] { writer(done); });
+    bench::runThreads(kReaders, [&](unsigned t) {
+        auto& out = samples[t];
+        out.reserve(reads_per_reader);
+        unsigned state = t * 2654435761u + 1;
+        for (std::size_t i = 0; i < reads_per_reader; ++i) {
+            state = state * 1664525u + 1013904223u;
+            const int id = static_cast<int>(state % kBaseOrders) + 1;
+            const auto start = bench::Clock::now();
+            db.findOrderById(id);
+            out.push_back(std::chrono::duration<double, std::nano>(bench::Clock::now() - start)
+                              .count());
+        }
+    });
+    done.store(true);
+    writer_thread.join();
+
+    Latency latency;
+    for (auto& part : samples) {
+        latency.ns.insert(latency.ns.end(), part.begin(), part.end());
+    }
+    std::sort(latency.ns.begin(), latency.ns.end());
+    return latency;
+}
+
+void report(const char* label, const Latency& latency, std::size_t writes) {
+    std::printf("%-8s %10.0f %10.0f %10.0f %12.0f %12zu\n", label, latency.percentile(0.5),
+                latency.percentile(0.99), latency.percentile(0.999), latency.ns.back(), writes);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const std::size_t reads = bench::scaled(2000000, scale);
+    const int clear_batch = static_cast<int>(bench::scaled(50000, scale));
+
+    bench::printTitle("findOrderById latency under concurrent writes, ns");
+    std::printf("%u readers, %zu reads each\n", kReaders, reads);
+    std::printf("%-8s %10s %10s %10s %12s %12s\n", "writer", "p50", "p99", "p99.9", "max",
+                "writes");
+
+    {
+        InMemoryDatabase db;
+        const int user_id = db.saveUser(User{0, "User", "user@test.com", true});
+        fill(db, user_id, kBaseOrders, 0);
+        std::size_t writes = 0;
+        auto latency = measure(db, reads, [&](std::atomic<bool>& done) {
+            std::size_t i = kBaseOrders;
+            while (!done.load(std::memory_order_relaxed)) {
+                const int id = db.saveOrder(
+                    Order{0, user_id, productName(i++), 10.0, OrderStatus::PENDING});
+                db.updateOrder(Order{id, user_id + 1, productName(i++), 20.0,
+                                     OrderStatus::CONFIRMED});
+                db.deleteOrder(id);
+                const int other = db.saveUser(
+                    User{0, "Customer " + std::to_string(i), "customer@test.com", true});
+                db.updateUser(User{other, "Renamed " + std::to_string(i), "customer@test.com",
+                                   false});
+                db.deleteUser(other);
+                writes += 6;
+            }
+        });
+        report("churn", latency, writes);
+    }
+    {
+        // После clear() ID заказов выдаются заново с 1, поэтому читатели
+        // попадают и в заполненные, и в еще пустые слоты
+        InMemoryDatabase db;
+        const int user_id = db.saveUser(User{0, "User", "user@test.com", true});
+        std::size_t writes = 0;
+        auto latency = measure(db, reads, [&](std::atomic<bool>& done) {
+            std::size_t salt = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                fill(db, user_id, clear_batch, salt);
+                salt += clear_batch;
+                db.clear();
+                writes += clear_batch + 1;
+            }
+        });
+        report("clear", latency, writes);
+    }
+    return 0;
+}
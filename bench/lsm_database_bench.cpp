@@ -0,0 +1,118 @@
+/**
+ * @file lsm_database_bench.cpp
+ * @brief Поток записи и точечное чтение: LsmDatabase против MappedDatabase
+ *        и InMemoryDatabase
+ *
+ * Для нескольких объемов выводятся:
+ * - скорость приема заказов (saveOrder, затем updateOrder каждого
+ *   четвертого) в каждой базе;
+ * - для LsmDatabase — усиление записи (байт на диск на байт изменений),
+ *   число сбросов и слияний и оставшихся прогонов;
+ * - среднее время findOrderById по случайным существующим ID и доля
+ *   прогонов, отсеянных фильтром Блума.
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include "services/lsm_database.hpp"
+#include "services/mapped_database.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+constexpr std::size_t kUsers = 10000;
+constexpr std::size_t kLookups = 500000;
+
+Order makeOrder(std::size_t i) {
+    return Order{0, static_cast<int>(i % kUsers + 1),
+                 "Catalog product #" + std::to_string(i % 2000),
+                 static_cast<double>(i % 1000) + 0.99, OrderStatus::PENDING};
+}
+
+// Принять заказы и обновить каждый четвертый; возвращает операций в секунду.
+// Владельцы заказов создаются до замера: MappedDatabase принимает заказы
+// только выданных пользователей
+double ingest(IDatabase& database, std::size_t orders) {
+    for (std::size_t i = 0; i < kUsers; ++i) {
+        database.saveUser(User{0, "Customer", "customer@example.com", true});
+    }
+    const double seconds = bench::measureSeconds([&] {
+        for (std::size_t i = 0; i < orders; ++i) {
+            database.saveOrder(makeOrder(i));
+        }
+        for (std::size_t i = 0; i < orders; i += 4) {
+            Order order = makeOrder(i);
+            order.id = static_cast<int>(i + 1);
+            order.status = OrderStatus::SHIPPED;
+            database.updateOrder(order);
+        }
+    });
+    return static_cast<double>(orders + orders / 4) / seconds;
+}
+
+double lookupNanos(const IDatabase& database, const std::vector<int>& ids) {
+    std::size_t found = 0;
+    const double seconds = bench::measureSeconds([&] {
+        for (int id : ids) {
+            found += database.findOrderById(id).has_value() ? 1 : 0;
+        }
+    });
+    if (found != ids.size()) {
+        std::printf("lookup missed records\n");
+    }
+    return seconds * 1e9 / static_cast<double>(ids.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const auto root = std::filesystem::temp_directory_path() / "lsm_database_bench";
+
+    bench::printTitle("LsmDatabase ingest and point lookups");
+    std::printf("%9s %11s %11s %11s %6s %6s %6s %5s %9s %9s %9s %7s\n", "orders", "lsm op/s",
+                "mapped op/s", "memory op/s", "w-amp", "flush", "merge", "runs", "lsm ns",
+                "mapped ns", "memory ns", "skip %");
+
+    for (std::size_t base : {200000, 1000000, 4000000}) {
+        const std::size_t orders = bench::scaled(base, scale);
+        std::filesystem::remove_all(root);
+        std::filesystem::create_directories(root / "lsm");
+        std::filesystem::create_directories(root / "mapped");
+
+        auto lsm = LsmDatabase::open((root / "lsm").string());
+        auto mapped = MappedDatabase::open((root / "mapped").string());
+        InMemoryDatabase memory;
+
+        const double lsm_rate = ingest(*lsm, orders);
+        const double mapped_rate = ingest(*mapped, orders);
+        const double memory_rate = ingest(memory, orders);
+        lsm->flush();
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> pick(1, static_cast<int>(orders));
+        std::vector<int> ids(kLookups);
+        for (int& id : ids) {
+            id = pick(rng);
+        }
+        const auto before = lsm->stats();
+        const double lsm_get = lookupNanos(*lsm, ids);
+        const auto after = lsm->stats();
+        const double probes = static_cast<double>(after.run_probes - before.run_probes);
+        const double skips = static_cast<double>(after.bloom_skips - before.bloom_skips);
+
+        std::printf("%9zu %11.0f %11.0f %11.0f %6.2f %6llu %6llu %5zu %9.1f %9.1f %9.1f %7.1f\n",
+                    orders, lsm_rate, mapped_rate, memory_rate, after.writeAmplification(),
+                    static_cast<unsigned long long>(after.flushes),
+                    static_cast<unsigned long long>(after.compactions), after.runs, lsm_get,
+                    lookupNanos(*mapped, ids), lookupNanos(memory, ids),
+                    probes + skips > 0 ? 100.0 * skips / (probes + skips) : 0.0);
+    }
+    std::filesystem::remove_all(root);
+    return 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file mapped_database_bench.cpp
+ * @brief Запуск и точечное чтение: MappedDatabase против InMemoryDatabase
+ *
+ * Для нескольких объемов данных (пользователей в 10 раз меньше, чем
+ * заказов) выводятся:
+ * - время открытия MappedDatabase с заполненными файлами и время
+ *   загрузки той же базы в InMemoryDatabase из контрольной точки;
+ * - среднее время findOrderById по случайным ID в обеих базах.
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include "services/mapped_database.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+constexpr std::size_t kDistinctProducts = 2000;
+constexpr std::size_t kLookups = 1000000;
+
+double lookupNanos(const IDatabase& database, const std::vector<int>& ids) {
+    std::size_t found = 0;
+    const double seconds = bench::measureSeconds([&] {
+        for (int id : ids) {
+            found += database.findOrderById(id).has_value() ? 1 : 0;
+        }
+    });
+    if (found != ids.size()) {
+        std::printf("lookup missed records\n");
+    }
+    return seconds * 1e9 / static_cast<double>(ids.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const auto directory = std::filesystem::temp_directory_path() / "mapped_database_bench";
+    const std::string checkpoint_path = (directory / "bench.ckpt").string();
+
+    bench::printTitle("MappedDatabase vs InMemoryDatabase");
+    std::printf("%10s %10s %12s %12s %14s %14s\n", "orders", "users", "open ms",
+                "ckpt load ms", "mapped get ns", "memory get ns");
+
+    for (std::size_t base : {100000, 1000000, 4000000}) {
+        const std::size_t orders = bench::scaled(base, scale);
+        const std::size_t users = std::max<std::size_t>(1, orders / 10);
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+
+        {
+            auto mapped = MappedDatabase::open(directory.string());
+            InMemoryDatabase memory;
+            for (std::size_t i = 0; i < users; ++i) {
+                const std::string name = "Customer " + std::to_string(i);
+                const User user{0, name, name + "@example.com", true};
+                mapped->saveUser(user);
+                memory.saveUser(user);
+            }
+            for (std::size_t i = 0; i < orders; ++i) {
+                const Order order{0, static_cast<int>(i % users + 1),
+                                  "Catalog product #" + std::to_string(i % kDistinctProducts),
+                                  static_cast<double>(i % 1000) + 0.99,
+                                  static_cast<OrderStatus>(i % 5)};
+                mapped->saveOrder(order);
+                memory.saveOrder(order);
+            }
+            memory.saveCheckpoint(checkpoint_path);
+        }
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> pick(1, static_cast<int>(orders));
+        std::vector<int> ids(kLookups);
+        for (int& id : ids) {
+            id = pick(rng);
+        }
+
+        std::shared_ptr<MappedDatabase> mapped;
+        const double open = bench::measureSeconds(
+            [&] { mapped = MappedDatabase::open(directory.string()); });
+        InMemoryDatabase memory;
+        const double load = bench::measureSeconds([&] { memory.loadCheckpoint(checkpoint_path); });
+
+        std::printf("%10zu %10zu %12.3f %12.1f %14.1f %14.1f\n", orders, users, open * 1e3,
+                    load * 1e3, lookupNanos(*mapped, ids), lookupNanos(memory, ids));
+    }
+    std::filesystem::remove_all(directory);
+    return 0;
+}
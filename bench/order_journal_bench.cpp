@@ -0,0 +1,95 @@
+/**
+ * @file order_journal_bench.cpp
+ * @brief Жизненный цикл заказов: журнал событий против полных записей
+ *
+ * Каждый заказ создается и проходит переходы
+ * PENDING → CONFIRMED → SHIPPED → DELIVERED. Сравниваются:
+ * - OrderJournal: заказ целиком при создании, затем короткие события
+ *   статуса, фоновая свертка сегментов;
+ * - WriteAheadLog с полной записью PutOrder на каждое изменение.
+ *
+ * Выводятся скорость дозаписи, байт на изменение, итоговый объем
+ * на диске и усиление записи журнала.
+ */
+
+#include "bench_common.hpp"
+#include "services/order_journal.hpp"
+#include <cstdio>
+#include <filesystem>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+constexpr OrderStatus kTransitions[] = {OrderStatus::CONFIRMED, OrderStatus::SHIPPED,
+                                        OrderStatus::DELIVERED};
+
+Order makeOrder(int id) {
+    return Order{id, id % 10000 + 1, "Catalog product #" + std::to_string(id % 2000),
+                 static_cast<double>(id % 1000) + 0.99, OrderStatus::PENDING};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const auto root = std::filesystem::temp_directory_path() / "order_journal_bench";
+
+    bench::printTitle("Order lifecycle: event journal vs full records");
+    std::printf("%9s %12s %12s %9s %9s %12s %12s %7s %6s\n", "orders", "journal op/s",
+                "full op/s", "journal B", "full B", "journal MB", "full MB", "w-amp",
+                "merges");
+
+    for (std::size_t base : {100000, 500000, 2000000}) {
+        const int orders = static_cast<int>(bench::scaled(base, scale));
+        const std::size_t changes = static_cast<std::size_t>(orders) * 4;
+        std::filesystem::remove_all(root);
+        std::filesystem::create_directories(root / "journal");
+
+        auto journal = OrderJournal::open((root / "journal").string());
+        const double journal_seconds = bench::measureSeconds([&] {
+            for (int id = 1; id <= orders; ++id) {
+                journal->recordOrder(makeOrder(id));
+            }
+            for (OrderStatus status : kTransitions) {
+                for (int id = 1; id <= orders; ++id) {
+                    journal->recordStatus(id, status);
+                }
+            }
+        });
+        journal->compact();
+        const auto stats = journal->stats();
+
+        const std::string full_path = (root / "full.log").string();
+        std::uint64_t full_bytes = 0;
+        const double full_seconds = bench::measureSeconds([&] {
+            auto log = WriteAheadLog::open(full_path, {Durability::Buffered});
+            for (int id = 1; id <= orders; ++id) {
+                const std::string frame = WriteAheadLog::encode(LogRecord::putOrder(makeOrder(id)));
+                full_bytes += frame.size();
+                log->commit(log->append(frame));
+            }
+            for (OrderStatus status : kTransitions) {
+                for (int id = 1; id <= orders; ++id) {
+                    Order order = makeOrder(id);
+                    order.status = status;
+                    const std::string frame = WriteAheadLog::encode(LogRecord::putOrder(order));
+                    full_bytes += frame.size();
+                    log->commit(log->append(frame));
+                }
+            }
+        });
+
+        std::printf("%9d %12.0f %12.0f %9.1f %9.1f %12.1f %12.1f %7.2f %6llu\n", orders,
+                    static_cast<double>(changes) / journal_seconds,
+                    static_cast<double>(changes) / full_seconds,
+                    static_cast<double>(stats.appended_bytes) / static_cast<double>(changes),
+                    static_cast<double>(full_bytes) / static_cast<double>(changes),
+                    static_cast<double>(stats.disk_bytes) / 1e6,
+                    static_cast<double>(full_bytes) / 1e6, stats.writeAmplification(),
+                    static_cast<unsigned long long>(stats.compactions));
+    }
+    std::filesystem::remove_all(root);
+    return 0;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file order_total_bench.cpp
+ * @brief Сумма заказов пользователя: копирование против агрегата в хранилище
+ *
+ * Три пользователя с 1, 1K и 1M заказами, каждый пятый отменен. Для
+ * каждого сравниваются прежний способ getTotal (findOrdersByUserId
+ * и суммирование неотмененных) и OrderService::getTotal поверх
+ * aggregateOrders: время и число выделений памяти на вызов.
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include "services/order_service.hpp"
+#include "services/user_service.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+std::size_t g_allocations = 0;
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    ++g_allocations;
+    void* block = std::malloc(size);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+// Время в микросекундах и выделения на вызов run() за rounds повторов
+template <typename F>
+Money report(const char* label, int orders, int rounds, F&& run) {
+    Money total;
+    const std::size_t allocations = g_allocations;
+    const double seconds = bench::measureSeconds([&] {
+        for (int i = 0; i < rounds; ++i) {
+            total = run();
+        }
+    });
+    std::printf("%-10d %-34s %14.2f %14.1f\n", orders, label, seconds * 1e6 / rounds,
+                static_cast<double>(g_allocations - allocations) / rounds);
+    return total;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const std::size_t sizes[] = {1, 1000, bench::scaled(1000000, scale)};
+
+    auto database = std::make_shared<InMemoryDatabase>();
+    auto users = std::make_shared<UserService>(database);
+    OrderService service(database, users);
+    std::vector<int> user_ids;
+    for (std::size_t orders : sizes) {
+        const int user_id = users->createUser("Customer", "customer@example.com");
+        for (std::size_t i = 0; i < orders; ++i) {
+            database->saveOrder(Order{0, user_id, "Catalog product #" + std::to_string(i % 2000),
+                                      1.0 + i % 1000,
+                                      i % 5 == 4 ? OrderStatus::CANCELLED : OrderStatus::PENDING});
+        }
+        user_ids.push_back(user_id);
+    }
+
+    bench::printTitle("Per-user order total: copies vs aggregate pushdown");
+    std::printf("%-10s %-34s %14s %14s\n", "orders", "method", "us/call", "allocs/call");
+    for (std::size_t i = 0; i < user_ids.size(); ++i) {
+        const int user_id = user_ids[i];
+        const int orders = static_cast<int>(sizes[i]);
+        const int rounds = static_cast<int>(std::max<std::size_t>(5, 2000000 / sizes[i]));
+        const Money copied = report("findOrdersByUserId + sum", orders, rounds, [&] {
+            Money sum;
+            for (const auto& order : database->findOrdersByUserId(user_id)) {
+                if (order.status != OrderStatus::CANCELLED) {
+                    sum += order.amount;
+                }
+            }
+            return sum;
+        });
+        const Money aggregated = report("getTotal (aggregateOrders)", orders, rounds,
+                                        [&] { return service.getTotal(user_id); });
+        if (copied != aggregated) {
+            std::printf("totals differ\n");
+            return 1;
+        }
+    }
+    return 0;
+}
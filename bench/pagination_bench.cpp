@@ -0,0 +1,89 @@
+/**
+ * @file pagination_bench.cpp
+ * @brief Страница по курсору против полной выборки
+ *
+ * У одного пользователя 500K заказов, в базе 2M пользователей, половина
+ * активна. Для истории заказов сравниваются findOrdersByUserId целиком
+ * и страница из 100 заказов в начале, середине и конце истории; для
+ * активных пользователей — getActiveUsers целиком и страница из 100.
+ * Время страницы не должно зависеть от позиции курсора.
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include "services/order_service.hpp"
+#include "services/user_service.hpp"
+#include <cstdio>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+constexpr std::size_t kPageSize = 100;
+
+// Среднее время run() в микросекундах за rounds повторов
+template <typename F>
+void report(const char* label, int rounds, F&& run) {
+    std::size_t result = 0;
+    const double seconds = bench::measureSeconds([&] {
+        for (int i = 0; i < rounds; ++i) {
+            result += run();
+        }
+    });
+    std::printf("%-40s %14.1f %12zu\n", label, seconds * 1e6 / rounds, result / rounds);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const int orders = static_cast<int>(bench::scaled(500000, scale));
+    const int users = static_cast<int>(bench::scaled(2000000, scale));
+
+    auto database = std::make_shared<InMemoryDatabase>();
+    for (int i = 0; i < users; ++i) {
+        database->saveUser(User{0, "User " + std::to_string(i),
+                                "u" + std::to_string(i) + "@x.io", i % 2 == 0});
+    }
+    const int user_id = 1;
+    std::vector<int> ids;
+    ids.reserve(orders);
+    for (int i = 0; i < orders; ++i) {
+        ids.push_back(database->saveOrder(Order{0, user_id, "Product " + std::to_string(i % 500),
+                                                1.0 + i % 100, OrderStatus::DELIVERED}));
+    }
+    UserService users_service(database);
+    OrderService orders_service(database, std::make_shared<UserService>(database));
+
+    bench::printTitle("Keyset pagination vs full result");
+    std::printf("orders of one user: %d, users: %d (half active), page: %zu\n", orders, users,
+                kPageSize);
+    std::printf("%-40s %14s %12s\n", "method", "us per call", "rows");
+
+    report("getUserOrders: full history", 5,
+           [&] { return orders_service.getUserOrders(user_id).size(); });
+    const std::pair<const char*, int> cursors[] = {
+        {"getUserOrders: page at start", 0},
+        {"getUserOrders: page in the middle", ids[ids.size() / 2]},
+        {"getUserOrders: page at the end", ids[ids.size() - kPageSize - 1]},
+    };
+    for (const auto& [label, after_id] : cursors) {
+        report(label, 10000, [&, after_id = after_id] {
+            return orders_service.getUserOrders(user_id, PageRequest{after_id, kPageSize}).size();
+        });
+    }
+
+    report("getActiveUsers: all", 3, [&] { return users_service.getActiveUsers().size(); });
+    const std::pair<const char*, int> user_cursors[] = {
+        {"getActiveUsers: page at start", 0},
+        {"getActiveUsers: page in the middle", users / 2},
+        {"getActiveUsers: page at the end", users - 2 * static_cast<int>(kPageSize) - 1},
+    };
+    for (const auto& [label, after_id] : user_cursors) {
+        report(label, 10000, [&, after_id = after_id] {
+            return users_service.getActiveUsers(PageRequest{after_id, kPageSize}).size();
+        });
+    }
+    return 0;
+}
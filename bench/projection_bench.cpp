@@ -0,0 +1,126 @@
+/**
+ * @file projection_bench.cpp
+ * @brief Проекции без строк против полных записей
+ *
+ * 100K пользователей по 10 заказов. Для каждого способа выводятся время
+ * и число выделений памяти (вызовов operator new) и байт на вызов:
+ * - заказы пользователя: findOrdersByUserId против findOrderSummaries;
+ * - проверка пользователя: findUserById против findUserActive;
+ * - проверка в createOrder: getUser (прежняя) против isActive;
+ * - createOrder целиком.
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include "services/order_service.hpp"
+#include "services/user_service.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+std::size_t g_allocations = 0;
+std::size_t g_bytes = 0;
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    ++g_allocations;
+    g_bytes += size;
+    void* block = std::malloc(size);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+constexpr int kOrdersPerUser = 10;
+
+// Время, выделения и байты на вызов run(id) по calls случайным ID из [1, ids]
+template <typename F>
+void report(const char* label, int ids, int calls, F&& run) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pick(1, ids);
+    std::vector<int> order(calls);
+    for (auto& id : order) {
+        id = pick(rng);
+    }
+    std::size_t found = 0;
+    const std::size_t allocations = g_allocations;
+    const std::size_t bytes = g_bytes;
+    const double seconds = bench::measureSeconds([&] {
+        for (int id : order) {
+            found += run(id);
+        }
+    });
+    std::printf("%-40s %10.0f %14.2f %14.1f\n", label, seconds * 1e9 / calls,
+                static_cast<double>(g_allocations - allocations) / calls,
+                static_cast<double>(g_bytes - bytes) / calls);
+    if (found == 0) {
+        std::printf("nothing found\n");
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const int users = static_cast<int>(bench::scaled(100000, scale));
+    const int calls = static_cast<int>(bench::scaled(200000, scale));
+
+    auto database = std::make_shared<InMemoryDatabase>();
+    for (int i = 0; i < users; ++i) {
+        database->saveUser(User{0, "Customer with a long name " + std::to_string(i),
+                                "customer" + std::to_string(i) + "@example.com", true});
+    }
+    for (int i = 0; i < users * kOrdersPerUser; ++i) {
+        database->saveOrder(Order{0, i % users + 1, "Catalog product #" + std::to_string(i % 2000),
+                                  1.0 + i % 1000, static_cast<OrderStatus>(i % 5)});
+    }
+    auto user_service = std::make_shared<UserService>(database);
+
+    bench::printTitle("Projections vs full records");
+    std::printf("users: %d, orders per user: %d\n", users, kOrdersPerUser);
+    std::printf("%-40s %10s %14s %14s\n", "method", "ns/call", "allocs/call", "bytes/call");
+
+    report("user orders: findOrdersByUserId", users, calls,
+           [&](int id) { return database->findOrdersByUserId(id).size(); });
+    report("user orders: findOrderSummaries", users, calls, [&](int id) {
+        OrderQuery query;
+        query.user_id = id;
+        return database->findOrderSummaries(query).size();
+    });
+    report("user probe: findUserById", users, calls, [&](int id) {
+        const auto user = database->findUserById(id);
+        return static_cast<std::size_t>(user && user->is_active);
+    });
+    report("user probe: findUserActive", users, calls,
+           [&](int id) { return static_cast<std::size_t>(database->findUserActive(id).value()); });
+    report("createOrder check: getUser", users, calls, [&](int id) {
+        const auto user = user_service->getUser(id);
+        return static_cast<std::size_t>(user && user->is_active);
+    });
+    report("createOrder check: isActive", users, calls,
+           [&](int id) { return static_cast<std::size_t>(user_service->isActive(id)); });
+    OrderService order_service(database, user_service);
+    const std::string product = "Catalog product #1";
+    report("createOrder", users, calls, [&](int id) {
+        return static_cast<std::size_t>(order_service.createOrder(id, product, 9.99) > 0);
+    });
+    return 0;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file query_pushdown_bench.cpp
+ * @brief Фильтр в хранилище (findOrders, findUsers) против фильтра
+ *        после копирования
+ *
+ * 1M пользователей (четверть активна) и 2M заказов равномерно по пяти
+ * статусам; у одного пользователя 100K заказов. Для каждого способа
+ * выводятся время и число байт, выделенных за вызов: глобальный
+ * operator new их подсчитывает.
+ * - активные пользователи: findAllUsers и copy_if против findUsers;
+ * - сумма пользователя без отмененных: findOrdersByUserId против findOrders;
+ * - доставленные заказы дороже 900: findAllOrders против findOrders.
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+std::size_t g_allocated = 0;
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    g_allocated += size;
+    void* block = std::malloc(size);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+// Среднее время run() и выделенные за вызов байты
+template <typename F>
+void report(const char* label, int rounds, F&& run) {
+    std::size_t result = 0;
+    const std::size_t before = g_allocated;
+    const double seconds = bench::measureSeconds([&] {
+        for (int i = 0; i < rounds; ++i) {
+            result = run();
+        }
+    });
+    std::printf("%-42s %10.2f %14.1f %10zu\n", label, seconds * 1e3 / rounds,
+                static_cast<double>(g_allocated - before) / rounds / (1 << 20), result);
+}
+
+template <typename Record, typename Pred>
+std::vector<Record> filtered(std::vector<Record> all, Pred pred) {
+    std::vector<Record> result;
+    std::copy_if(all.begin(), all.end(), std::back_inserter(result), pred);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const int users = static_cast<int>(bench::scaled(1000000, scale));
+    const int orders = static_cast<int>(bench::scaled(2000000, scale));
+    const int heavy_orders = static_cast<int>(bench::scaled(100000, scale));
+
+    InMemoryDatabase database;
+    for (int i = 0; i < users; ++i) {
+        database.saveUser(User{0, "User " + std::to_string(i),
+                               "u" + std::to_string(i) + "@x.io", i % 4 == 0});
+    }
+    const int heavy_user = 1;
+    for (int i = 0; i < orders; ++i) {
+        const int user_id = i < heavy_orders ? heavy_user : 2 + i % (users - 1);
+        database.saveOrder(Order{0, user_id, "Catalog product #" + std::to_string(i % 2000),
+                                 1.0 + i % 1000, static_cast<OrderStatus>(i % 5)});
+    }
+
+    bench::printTitle("Predicate pushdown vs filtering copies");
+    std::printf("users: %d, orders: %d, orders of one user: %d\n", users, orders, heavy_orders);
+    std::printf("%-42s %10s %14s %10s\n", "method", "ms", "MiB allocated", "rows");
+
+    report("active users: findAllUsers + copy_if", 3, [&] {
+        return filtered(database.findAllUsers(),
+                        [](const User& user) { return user.is_active; })
+            .size();
+    });
+    UserQuery active;
+    active.is_active = true;
+    report("active users: findUsers", 3, [&] { return database.findUsers(active).size(); });
+
+    const auto not_cancelled = [](const Order& order) {
+        return order.status != OrderStatus::CANCELLED;
+    };
+    report("user total: findOrdersByUserId + filter", 20, [&] {
+        return filtered(database.findOrdersByUserId(heavy_user), not_cancelled).size();
+    });
+    OrderQuery total;
+    total.user_id = heavy_user;
+    total.statuses = StatusSet::allExcept({OrderStatus::CANCELLED});
+    report("user total: findOrders", 20, [&] { return database.findOrders(total).size(); });
+
+    report("delivered > 900: findAllOrders + filter", 3, [&] {
+        return filtered(database.findAllOrders(), [](const Order& order) {
+                   return order.status == OrderStatus::DELIVERED && order.amount > Money(900.0);
+               })
+            .size();
+    });
+    OrderQuery expensive;
+    expensive.statuses = StatusSet::of({OrderStatus::DELIVERED});
+    expensive.min_amount = Money::fromMinorUnits(90001);
+    report("delivered > 900: findOrders", 3, [&] { return database.findOrders(expensive).size(); });
+    return 0;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file read_contention_bench.cpp
+ * @brief Конкурентное чтение: разделяемая блокировка против эксклюзивной
+ *
+ * ExclusiveLockDatabase воспроизводит прежнее поведение InMemoryDatabase,
+ * где любое обращение (в том числе чтение) брало единственный std::mutex.
+ * Нагрузка — 95% чтений (findUserById / findOrderById), 5% updateOrder.
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include <mutex>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+class ExclusiveLockDatabase : public IDatabase {
+public:
+    int saveUser(const User& user) override { Guard g(mutex_); return db_.saveUser(user); }
+    std::optional<User> findUserById(int id) const override { Guard g(mutex_); return db_.findUserById(id); }
+    std::vector<User> findAllUsers() const override { Guard g(mutex_); return db_.findAllUsers(); }
+    bool updateUser(const User& user) override { Guard g(mutex_); return db_.updateUser(user); }
+    bool deleteUser(int id) override { Guard g(mutex_); return db_.deleteUser(id); }
+    int saveOrder(const Order& order) override { Guard g(mutex_); return db_.saveOrder(order); }
+    std::optional<Order> findOrderById(int id) const override { Guard g(mutex_); return db_.findOrderById(id); }
+    std::vector<Order> findOrdersByUserId(int user_id) const override { Guard g(mutex_); return db_.findOrdersByUserId(user_id); }
+    std::vector<Order> findAllOrders() const override { Guard g(mutex_); return db_.findAllOrders(); }
+    bool updateOrder(const Order& order) override { Guard g(mutex_); return db_.updateOrder(order); }
+    bool deleteOrder(int id) override { Guard g(mutex_); return db_.deleteOrder(id); }
+    void clear() override { Guard g(mutex_); db_.clear(); }
+
+private:
+    using Guard = std::lock_guard<std::mutex>;
+    mutable std::mutex mutex_;
+    InMemoryDatabase db_;
+};
+
+constexpr int kRecords = 10000;
+
+double opsPerSecond(IDatabase& db, unsigned threads, std::size_t ops_per_thread) {
+    db.clear();
+    for (int i = 0; i < kRecords; ++i) {
+        int user_id = db.saveUser(User{0, "User", "user@test.com", true});
+        db.saveOrder(Order{0, user_id, "Product", 10.0, OrderStatus::PENDING});
+    }
+    double seconds = bench::runThreads(threads, [&](unsigned t) {
+        unsigned state = t * 2654435761u + 1;
+        for (std::size_t i = 0; i < ops_per_thread; ++i) {
+            state = state * 1664525u + 1013904223u;
+            int id = static_cast<int>(state % kRecords) + 1;
+            if (i % 20 == 0) {
+                db.updateOrder(Order{id, id, "Product", 10.0, OrderStatus::CONFIRMED});
+            } else if (i % 2 == 0) {
+                db.findUserById(id);
+            } else {
+                db.findOrderById(id);
+            }
+        }
+    });
+    return threads * ops_per_thread / seconds;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const std::size_t ops = bench::scaled(200000, scale);
+
+    bench::printTitle("95% reads / 5% writes, ops/s");
+    std::printf("%8s %16s %16s %10s\n", "threads", "std::mutex", "shared_mutex", "speedup");
+    for (unsigned threads : bench::threadCounts()) {
+        ExclusiveLockDatabase exclusive;
+        InMemoryDatabase shared;
+        double a = opsPerSecond(exclusive, threads, ops);
+        double b = opsPerSecond(shared, threads, ops);
+        std::printf("%8u %16.0f %16.0f %9.2fx\n", threads, a, b, b / a);
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file scan_visitor_bench.cpp
+ * @brief Обход через scanUsers против копии таблицы findAllUsers
+ *
+ * База из 10M пользователей, половина активна. Для каждого способа
+ * выводятся время и пик живой памяти кучи сверх уже занятой базой:
+ * глобальные operator new/delete считают живые байты и их максимум.
+ * - getActiveUsers прежним способом: findAllUsers и copy_if;
+ * - UserService::getActiveUsers поверх scanUsers;
+ * - подсчет активных без результата;
+ * - первые 100 активных (досрочное завершение обхода).
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include "services/user_service.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+std::size_t g_bytes = 0;
+std::size_t g_peak = 0;
+
+// Размер блока хранится перед ним, чтобы delete мог вычесть его
+constexpr std::size_t kHeader = alignof(std::max_align_t);
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    g_bytes += size;
+    g_peak = std::max(g_peak, g_bytes);
+    auto* block = static_cast<unsigned char*>(std::malloc(size + kHeader));
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<std::size_t*>(block) = size;
+    return block + kHeader;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto* block = static_cast<unsigned char*>(ptr) - kHeader;
+    g_bytes -= *reinterpret_cast<std::size_t*>(block);
+    std::free(block);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+namespace {
+
+// Время run() и пик памяти сверх живой до вызова, МиБ
+template <typename F>
+void report(const char* label, F&& run) {
+    const std::size_t before = g_bytes;
+    g_peak = g_bytes;
+    std::size_t result = 0;
+    const double seconds = bench::measureSeconds([&] { result = run(); });
+    std::printf("%-36s %12.1f %14.1f %12zu\n", label, seconds * 1e3,
+                static_cast<double>(g_peak - before) / (1 << 20), result);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const int users = static_cast<int>(bench::scaled(10000000, scale));
+
+    auto database = std::make_shared<InMemoryDatabase>();
+    for (int i = 0; i < users; ++i) {
+        database->saveUser(User{0, "User " + std::to_string(i),
+                                "u" + std::to_string(i) + "@x.io", i % 2 == 0});
+    }
+    UserService service(database);
+
+    bench::printTitle("Streaming scans vs full-table copies");
+    std::printf("users: %d (half active), database heap: %.1f MiB\n", users,
+                static_cast<double>(g_bytes) / (1 << 20));
+    std::printf("%-36s %12s %14s %12s\n", "method", "ms", "peak extra MiB", "result");
+
+    report("findAllUsers + copy_if", [&] {
+        const auto all = database->findAllUsers();
+        std::vector<User> active;
+        std::copy_if(all.begin(), all.end(), std::back_inserter(active),
+                     [](const User& user) { return user.is_active; });
+        return active.size();
+    });
+    report("getActiveUsers (scanUsers)", [&] { return service.getActiveUsers().size(); });
+    report("count active: findAllUsers", [&] {
+        const auto all = database->findAllUsers();
+        return static_cast<std::size_t>(std::count_if(
+            all.begin(), all.end(), [](const User& user) { return user.is_active; }));
+    });
+    report("count active: scanUsers", [&] {
+        std::size_t count = 0;
+        database->scanUsers([&count](const User& user) {
+            count += user.is_active ? 1 : 0;
+            return true;
+        });
+        return count;
+    });
+    report("first 100 active: findAllUsers", [&] {
+        const auto all = database->findAllUsers();
+        std::vector<User> first;
+        for (const auto& user : all) {
+            if (user.is_active && first.size() < 100) {
+                first.push_back(user);
+            }
+        }
+        return first.size();
+    });
+    report("first 100 active: scanUsers", [&] {
+        std::vector<User> first;
+        database->scanUsers([&first](const User& user) {
+            if (user.is_active) {
+                first.push_back(user);
+            }
+            return first.size() < 100;
+        });
+        return first.size();
+    });
+    return 0;
+}
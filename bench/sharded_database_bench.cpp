@@ -0,0 +1,56 @@
+/**
+ * @file sharded_database_bench.cpp
+ * @brief Пропускная способность InMemoryDatabase и ShardedDatabase
+ *        в зависимости от числа потоков
+ *
+ * Нагрузка повторяет OrderService::createOrder + getOrder:
+ * findUserById -> saveOrder -> findOrderById.
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include "services/sharded_database.hpp"
+#include <memory>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+constexpr int kUsers = 1000;
+
+double opsPerSecond(IDatabase& db, unsigned threads, std::size_t ops_per_thread) {
+    db.clear();
+    for (int i = 0; i < kUsers; ++i) {
+        db.saveUser(User{0, "User", "user@test.com", true});
+    }
+    double seconds = bench::runThreads(threads, [&](unsigned t) {
+        for (std::size_t i = 0; i < ops_per_thread; ++i) {
+            int user_id = static_cast<int>((i * 7 + t) % kUsers) + 1;
+            if (!db.findUserById(user_id)) {
+                continue;
+            }
+            int id = db.saveOrder(Order{0, user_id, "Product", 10.0, OrderStatus::PENDING});
+            db.findOrderById(id);
+        }
+    });
+    return threads * ops_per_thread / seconds;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const std::size_t ops = bench::scaled(100000, scale);
+
+    bench::printTitle("createOrder-like workload, ops/s");
+    std::printf("%8s %16s %16s %10s\n", "threads", "InMemory", "Sharded(16)", "speedup");
+    for (unsigned threads : bench::threadCounts()) {
+        InMemoryDatabase single;
+        ShardedDatabase sharded(16);
+        double a = opsPerSecond(single, threads, ops);
+        double b = opsPerSecond(sharded, threads, ops);
+        std::printf("%8u %16.0f %16.0f %9.2fx\n", threads, a, b, b / a);
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file snapshot_scan_bench.cpp
+ * @brief Влияние полного обхода (findAllOrders) на писателей
+ *
+ * Писатели выполняют saveOrder, параллельно один поток непрерывно
+ * вызывает findAllOrders на большой таблице. Обход читает снимок
+ * без блокировки, поэтому скорость записи почти не должна падать.
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include <atomic>
+#include <thread>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+struct Result {
+    double writes_per_second;
+    long scans;
+};
+
+Result run(std::size_t preload, std::size_t writes, bool with_scanner) {
+    InMemoryDatabase db;
+    int user_id = db.saveUser(User{0, "User", "user@test.com", true});
+    for (std::size_t i = 0; i < preload; ++i) {
+        db.saveOrder(Order{0, user_id, "Product", 10.0, OrderStatus::PENDING});
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<long> scans{0};
+    std::thread scanner;
+    if (with_scanner) {
+        scanner = std::thread([&] {
+            while (!done.load(std::memory_order_relaxed)) {
+                db.findAllOrders();
+                scans.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    double seconds = bench::measureSeconds([&] {
+        for (std::size_t i = 0; i < writes; ++i) {
+            db.saveOrder(Order{0, user_id, "Product", 10.0, OrderStatus::PENDING});
+        }
+    });
+    done.store(true);
+    if (scanner.joinable()) {
+        scanner.join();
+    }
+    return Result{writes / seconds, scans.load()};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const std::size_t preload = bench::scaled(500000, scale);
+    const std::size_t writes = bench::scaled(200000, scale);
+
+    bench::printTitle("saveOrder throughput with a concurrent full scan");
+    std::printf("table size: %zu orders, %zu writes\n", preload, writes);
+    Result idle = run(preload, writes, false);
+    Result busy = run(preload, writes, true);
+    std::printf("%-24s %16.0f writes/s\n", "no scanner", idle.writes_per_second);
+    std::printf("%-24s %16.0f writes/s (%ld scans)\n", "with findAllOrders loop",
+                busy.writes_per_second, busy.scans);
+    return 0;
+}
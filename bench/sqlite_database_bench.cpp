@@ -0,0 +1,152 @@
+/**
+ * @file sqlite_database_bench.cpp
+ * @brief Каждый метод IDatabase: SqliteDatabase против InMemoryDatabase
+ *
+ * SqliteDatabase измеряется дважды: с пакетными транзакциями (Buffered)
+ * и с фиксацией каждого изменения (Written), чтобы был виден вклад
+ * пакетов. Для каждого метода выводится среднее время вызова.
+ * findAll* и clear вызываются по одному разу на всю базу.
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include "services/sqlite_database.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <random>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+constexpr int kOrdersPerUser = 10;
+
+struct Workload {
+    int users = 0;
+    int orders = 0;
+    std::vector<int> lookups;   // Случайные ID заказов
+};
+
+// Время вызова методов по порядку строк таблицы, наносекунды
+std::vector<double> measure(IDatabase& database, const Workload& work) {
+    std::vector<double> nanos;
+    const auto timed = [&nanos](std::size_t calls, const std::function<void()>& run) {
+        nanos.push_back(bench::measureSeconds(run) * 1e9 / static_cast<double>(calls));
+    };
+    std::vector<int> user_ids(work.users);
+    std::vector<int> order_ids(work.orders);
+    std::size_t found = 0;
+
+    timed(work.users, [&] {
+        for (int i = 0; i < work.users; ++i) {
+            user_ids[i] = database.saveUser(User{0, "User " + std::to_string(i),
+                                                 "user" + std::to_string(i) + "@example.com",
+                                                 true});
+        }
+    });
+    timed(work.lookups.size(), [&] {
+        for (int id : work.lookups) {
+            found += database.findUserById(user_ids[id % work.users]).has_value() ? 1 : 0;
+        }
+    });
+    timed(1, [&] { found += database.findAllUsers().size(); });
+    timed(work.users, [&] {
+        for (int i = 0; i < work.users; ++i) {
+            database.updateUser(User{user_ids[i], "User " + std::to_string(i),
+                                     "user" + std::to_string(i) + "@example.com", false});
+        }
+    });
+    timed(work.orders, [&] {
+        for (int i = 0; i < work.orders; ++i) {
+            order_ids[i] = database.saveOrder(
+                Order{0, user_ids[i % work.users], "Catalog product #" + std::to_string(i % 2000),
+                      static_cast<double>(i % 1000) + 0.99, OrderStatus::PENDING});
+        }
+    });
+    timed(work.lookups.size(), [&] {
+        for (int id : work.lookups) {
+            found += database.findOrderById(order_ids[id]).has_value() ? 1 : 0;
+        }
+    });
+    timed(work.lookups.size(), [&] {
+        for (int id : work.lookups) {
+            found += database.findOrdersByUserId(user_ids[id % work.users]).size();
+        }
+    });
+    timed(1, [&] { found += database.findAllOrders().size(); });
+    timed(work.orders, [&] {
+        for (int i = 0; i < work.orders; ++i) {
+            database.updateOrder(Order{order_ids[i], user_ids[i % work.users],
+                                       "Catalog product #" + std::to_string(i % 2000),
+                                       static_cast<double>(i % 1000) + 0.99,
+                                       OrderStatus::SHIPPED});
+        }
+    });
+    timed(work.orders / 2, [&] {
+        for (int i = 0; i < work.orders; i += 2) {
+            database.deleteOrder(order_ids[i]);
+        }
+    });
+    timed(work.users / 2, [&] {
+        for (int i = 0; i < work.users; i += 2) {
+            database.deleteUser(user_ids[i]);
+        }
+    });
+    timed(1, [&] { database.clear(); });
+    if (found == 0) {
+        std::printf("nothing found\n");
+    }
+    return nanos;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const auto root = std::filesystem::temp_directory_path() / "sqlite_database_bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    Workload work;
+    work.orders = static_cast<int>(bench::scaled(100000, scale));
+    work.users = std::max(1, work.orders / kOrdersPerUser);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(0, work.orders - 1);
+    work.lookups.resize(bench::scaled(50000, scale));
+    for (int& id : work.lookups) {
+        id = pick(rng);
+    }
+
+    InMemoryDatabase memory;
+    const auto memory_nanos = measure(memory, work);
+    std::vector<double> sqlite_nanos;
+    {
+        auto sqlite = SqliteDatabase::open((root / "batched.sqlite").string());
+        sqlite_nanos = measure(*sqlite, work);
+    }
+    std::vector<double> written_nanos;
+    {
+        SqliteDatabase::Options options;
+        options.durability = Durability::Written;
+        auto sqlite = SqliteDatabase::open((root / "written.sqlite").string(), options);
+        written_nanos = measure(*sqlite, work);
+    }
+
+    bench::printTitle("IDatabase methods: SqliteDatabase vs InMemoryDatabase");
+    std::printf("users: %d, orders: %d, lookups: %zu\n", work.users, work.orders,
+                work.lookups.size());
+    std::printf("%-20s %14s %14s %14s\n", "method", "memory ns", "sqlite ns", "sqlite 1/tx ns");
+    const char* methods[] = {"saveUser",      "findUserById",  "findAllUsers",
+                             "updateUser",    "saveOrder",     "findOrderById",
+                             "findOrdersByUserId",             "findAllOrders",
+                             "updateOrder",   "deleteOrder",   "deleteUser",
+                             "clear"};
+    for (std::size_t i = 0; i < memory_nanos.size(); ++i) {
+        std::printf("%-20s %14.0f %14.0f %14.0f\n", methods[i], memory_nanos[i], sqlite_nanos[i],
+                    written_nanos[i]);
+    }
+    std::filesystem::remove_all(root);
+    return 0;
+}
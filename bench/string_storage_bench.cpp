@@ -0,0 +1,138 @@
+/**
+ * @file string_storage_bench.cpp
+ * @brief Память и выделения на запись: интернирование и арена строк
+ *
+ * Сравнивает прежнее хранение (VersionedTable<User/Order>, каждая строка
+ * записи — отдельный std::string) с InMemoryDatabase, где названия
+ * продуктов интернированы, а имя и email лежат в арене. Глобальные
+ * operator new/delete подсчитывают живые байты и блоки кучи, поэтому
+ * временные строки в результат не попадают.
+ * Названия продуктов берутся из небольшого набора, как в реальных данных.
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include "services/versioned_table.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+std::size_t g_bytes = 0;
+std::size_t g_blocks = 0;
+
+// Размер блока хранится перед ним, чтобы delete мог вычесть его
+constexpr std::size_t kHeader = alignof(std::max_align_t);
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    g_bytes += size;
+    ++g_blocks;
+    auto* block = static_cast<unsigned char*>(std::malloc(size + kHeader));
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<std::size_t*>(block) = size;
+    return block + kHeader;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto* block = static_cast<unsigned char*>(ptr) - kHeader;
+    g_bytes -= *reinterpret_cast<std::size_t*>(block);
+    --g_blocks;
+    std::free(block);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+namespace {
+
+constexpr std::size_t kDistinctProducts = 2000;
+
+std::string productName(std::size_t i) {
+    return "Catalog product name #" + std::to_string(i % kDistinctProducts);
+}
+
+User makeUser(std::size_t i) {
+    return User{0, "Customer number " + std::to_string(i),
+                "customer." + std::to_string(i) + "@example.com", true};
+}
+
+struct Usage {
+    double bytes_per_record;
+    double blocks_per_record;
+};
+
+template <typename F>
+Usage measure(std::size_t records, F&& fill) {
+    const std::size_t bytes = g_bytes;
+    const std::size_t blocks = g_blocks;
+    fill();
+    return Usage{static_cast<double>(g_bytes - bytes) / records,
+                 static_cast<double>(g_blocks - blocks) / records};
+}
+
+void report(const char* label, const Usage& usage) {
+    std::printf("%-36s %14.1f %14.2f\n", label, usage.bytes_per_record,
+                usage.blocks_per_record);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const std::size_t users = bench::scaled(100000, scale);
+    const std::size_t orders = bench::scaled(1000000, scale);
+
+    bench::printTitle("heap usage per record");
+    std::printf("%zu users, %zu orders, %zu distinct product names\n", users, orders,
+                kDistinctProducts);
+    std::printf("%-36s %14s %14s\n", "storage", "bytes/record", "blocks/record");
+
+    {
+        VersionedTable<User> table;
+        report("users: VersionedTable<User>", measure(users, [&] {
+            for (std::size_t i = 0; i < users; ++i) {
+                User user = makeUser(i);
+                user.id = static_cast<int>(i) + 1;
+                table.insert(user.id, std::move(user));
+            }
+        }));
+    }
+    {
+        VersionedTable<Order> table;
+        report("orders: VersionedTable<Order>", measure(orders, [&] {
+            for (std::size_t i = 0; i < orders; ++i) {
+                const int id = static_cast<int>(i) + 1;
+                table.insert(id, Order{id, 1, productName(i), 10.0, OrderStatus::PENDING});
+            }
+        }));
+    }
+
+    InMemoryDatabase db;
+    report("users: InMemoryDatabase", measure(users, [&] {
+        for (std::size_t i = 0; i < users; ++i) {
+            db.saveUser(makeUser(i));
+        }
+    }));
+    report("orders: InMemoryDatabase", measure(orders, [&] {
+        for (std::size_t i = 0; i < orders; ++i) {
+            db.saveOrder(Order{0, 1, productName(i), 10.0, OrderStatus::PENDING});
+        }
+    }));
+
+    const auto text = db.textMemory();
+    std::printf("user text arena: %zu bytes, product pool: %zu names in %zu bytes\n",
+                text.user_text_bytes, text.product_names, text.product_name_bytes);
+    return 0;
+}
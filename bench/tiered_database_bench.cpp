@@ -0,0 +1,136 @@
+/**
+ * @file tiered_database_bench.cpp
+ * @brief Память и задержки TieredDatabase против InMemoryDatabase
+ *
+ * Заказы создаются в статусе PENDING, затем большая часть переводится
+ * в DELIVERED или CANCELLED — как накапливается история магазина. Каждая
+ * конфигурация строится в отдельном процессе, чтобы пиковый объем
+ * резидентной памяти (ru_maxrss) относился только к ней. Выводятся
+ * прирост памяти на заказ и среднее время findOrderById для активных
+ * и завершенных заказов и findOrdersByUserId.
+ */
+
+#include "bench_common.hpp"
+#include "services/database.hpp"
+#include "services/tiered_database.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace services;
+using namespace contracts;
+
+namespace {
+
+constexpr int kOrdersPerUser = 20;
+constexpr int kTerminalPercent = 90;
+
+long peakResidentKb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+void run(IDatabase& database, const char* engine, int orders, int lookups) {
+    const long baseline = peakResidentKb();
+    const int users = std::max(1, orders / kOrdersPerUser);
+    for (int i = 0; i < users; ++i) {
+        database.saveUser(User{0, "User " + std::to_string(i), "user@example.com", true});
+    }
+    std::vector<int> active;
+    std::vector<int> terminal;
+    for (int i = 0; i < orders; ++i) {
+        Order order{0, i % users + 1, "Catalog product #" + std::to_string(i % 2000),
+                    static_cast<double>(i % 1000) + 0.99, OrderStatus::PENDING};
+        order.id = database.saveOrder(order);
+        if (i % 100 < kTerminalPercent) {
+            order.status = i % 10 == 0 ? OrderStatus::CANCELLED : OrderStatus::DELIVERED;
+            database.updateOrder(order);
+            terminal.push_back(order.id);
+        } else {
+            active.push_back(order.id);
+        }
+    }
+    const long grown = peakResidentKb() - baseline;
+
+    std::mt19937 rng(42);
+    std::size_t found = 0;
+    const auto lookup = [&](const std::vector<int>& ids) {
+        std::uniform_int_distribution<std::size_t> pick(0, ids.size() - 1);
+        return bench::measureSeconds([&] {
+                   for (int i = 0; i < lookups; ++i) {
+                       found += database.findOrderById(ids[pick(rng)]).has_value() ? 1 : 0;
+                   }
+               }) * 1e9 / lookups;
+    };
+    const double active_ns = lookup(active);
+    const double terminal_ns = lookup(terminal);
+    std::uniform_int_distribution<int> pick_user(1, users);
+    const int user_lookups = std::max(1, lookups / kOrdersPerUser);
+    const double user_ns = bench::measureSeconds([&] {
+                               for (int i = 0; i < user_lookups; ++i) {
+                                   found += database.findOrdersByUserId(pick_user(rng)).size();
+                               }
+                           }) * 1e9 / user_lookups;
+
+    std::printf("%-10d %-10s %12.1f %12.0f %14.0f %16.0f %16.0f\n", orders, engine,
+                grown / 1024.0, grown * 1024.0 / orders, active_ns, terminal_ns, user_ns);
+    if (found == 0) {
+        std::printf("nothing found\n");
+    }
+}
+
+// Выполнить body в дочернем процессе и дождаться его
+template <typename Body>
+void isolated(Body&& body) {
+    std::fflush(stdout);
+    const pid_t pid = fork();
+    if (pid == 0) {
+        body();
+        std::fflush(stdout);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double scale = bench::scaleFromArgs(argc, argv);
+    const int lookups = static_cast<int>(bench::scaled(100000, scale));
+    const auto root = std::filesystem::temp_directory_path() / "tiered_database_bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    bench::printTitle("TieredDatabase vs InMemoryDatabase: memory and lookups");
+    std::printf("%d%% of orders DELIVERED or CANCELLED, %d orders per user\n",
+                kTerminalPercent, kOrdersPerUser);
+    std::printf("%-10s %-10s %12s %12s %14s %16s %16s\n", "orders", "engine", "peak RSS MB",
+                "bytes/order", "active find ns", "terminal find ns", "by user ns");
+    for (std::size_t base : {100000, 1000000}) {
+        const int orders = static_cast<int>(bench::scaled(base, scale));
+        isolated([&] {
+            InMemoryDatabase database;
+            run(database, "memory", orders, lookups);
+        });
+        isolated([&] {
+            auto database = TieredDatabase::open(root.string());
+            run(*database, "tiered", orders, lookups);
+            const auto stats = database->stats();
+            std::printf("%-10s cold orders: %zu, cold index: %.1f MB, on disk: %.1f MB\n", "",
+                        stats.cold_orders, stats.cold_index_bytes / 1048576.0,
+                        stats.cold_disk_bytes / 1048576.0);
+        });
+    }
+    std::filesystem::remove_all(root);
+    return 0;
+}
@@ -2,6 +2,10 @@
 
 #include "user_contract.hpp"
 #include "order_contract.hpp"
+#include "query.hpp"
+#include <algorithm>
+#include <functional>
+#include <iterator>
 #include <optional>
 #include <vector>
 
@@ -15,6 +19,10 @@ namespace contracts {
  */
 class IDatabase {
 public:
+    // Обработчик обхода: false прекращает обход
+    using UserVisitor = std::function<bool(const User&)>;
+    using OrderVisitor = std::function<bool(const Order&)>;
+
     virtual ~IDatabase() = default;
 
     // Операции с пользователями
@@ -27,11 +35,163 @@ public:
     // Операции с заказами
     virtual int saveOrder(const Order& order) = 0;
     virtual std::optional<Order> findOrderById(int id) const = 0;
+    // Заказы пользователя в порядке возрастания ID. ID выдаются потокам
+    // блоками, поэтому порядок ID не обязан совпадать с порядком создания
     virtual std::vector<Order> findOrdersByUserId(int user_id) const = 0;
     virtual std::vector<Order> findAllOrders() const = 0;
     virtual bool updateOrder(const Order& order) = 0;
     virtual bool deleteOrder(int id) = 0;
 
+    /**
+     * @brief Обойти записи без копии всей таблицы
+     *
+     * visit получает записи в том же порядке, что и findAll*; запись
+     * действительна только во время вызова. Реализация по умолчанию
+     * обходит результат findAll*, хранилища переопределяют ее, чтобы
+     * выдавать записи по одной.
+     */
+    virtual void scanUsers(const UserVisitor& visit) const {
+        for (const auto& user : findAllUsers()) {
+            if (!visit(user)) {
+                return;
+            }
+        }
+    }
+
+    virtual void scanOrders(const OrderVisitor& visit) const {
+        for (const auto& order : findAllOrders()) {
+            if (!visit(order)) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Страница заказов пользователя (см. PageRequest)
+     *
+     * Реализация по умолчанию копирует все заказы пользователя;
+     * хранилища с упорядоченным индексом отдают страницу за O(limit).
+     * Заказ, созданный во время обхода, может получить ID меньше курсора
+     * и не попасть ни на одну страницу (см. PageRequest).
+     */
+    virtual std::vector<Order> findOrdersByUserIdPage(int user_id,
+                                                      const PageRequest& page) const {
+        auto orders = findOrdersByUserId(user_id);
+        auto first = std::upper_bound(orders.begin(), orders.end(), page.after_id,
+                                      [](int id, const Order& order) { return id < order.id; });
+        const auto count = std::min<std::size_t>(page.limit, orders.end() - first);
+        return std::vector<Order>(std::make_move_iterator(first),
+                                  std::make_move_iterator(first + count));
+    }
+
+    /**
+     * @brief Страница активных пользователей (см. PageRequest)
+     *
+     * Реализация по умолчанию обходит всю таблицу (findAll* не обязан
+     * быть упорядочен по ID); хранилища переопределяют ее, чтобы начинать
+     * обход с курсора.
+     */
+    virtual std::vector<User> findActiveUsersPage(const PageRequest& page) const {
+        std::vector<User> users;
+        scanUsers([&users, &page](const User& user) {
+            if (user.is_active && user.id > page.after_id) {
+                users.push_back(user);
+            }
+            return true;
+        });
+        const auto count = std::min(page.limit, users.size());
+        const auto byId = [](const User& a, const User& b) { return a.id < b.id; };
+        std::partial_sort(users.begin(), users.begin() + count, users.end(), byId);
+        users.resize(count);
+        return users;
+    }
+
+    /**
+     * @brief Заказы, удовлетворяющие запросу
+     *
+     * Порядок — как у findOrdersByUserId, если задан query.user_id, иначе
+     * как у findAllOrders. Реализация по умолчанию фильтрует их результат;
+     * хранилища переопределяют ее, чтобы проверять условия по месту
+     * хранения под одной блокировкой или снимком и копировать только
+     * подходящие записи. Переопределяют InMemoryDatabase и TieredDatabase;
+     * у SqliteDatabase, ColumnarDatabase, MappedDatabase, LsmDatabase
+     * и ShardedDatabase работает реализация по умолчанию: условия
+     * проверяются по уже скопированным записям. То же у findOrderSummaries.
+     */
+    virtual std::vector<Order> findOrders(const OrderQuery& query) const {
+        std::vector<Order> orders;
+        if (query.user_id) {
+            orders = findOrdersByUserId(*query.user_id);
+            orders.erase(std::remove_if(orders.begin(), orders.end(),
+                                        [&query](const Order& order) {
+                                            return !query.matches(order);
+                                        }),
+                         orders.end());
+            return orders;
+        }
+        scanOrders([&orders, &query](const Order& order) {
+            if (query.matches(order)) {
+                orders.push_back(order);
+            }
+            return true;
+        });
+        return orders;
+    }
+
+    /**
+     * @brief Проекция findOrders без названий продуктов
+     *
+     * Реализация по умолчанию сокращает результат findOrders; хранилища
+     * переопределяют ее, чтобы не копировать строки вовсе.
+     */
+    virtual std::vector<OrderSummary> findOrderSummaries(const OrderQuery& query) const {
+        std::vector<OrderSummary> summaries;
+        for (const auto& order : findOrders(query)) {
+            summaries.push_back(OrderSummary{order.id, order.user_id, order.amount, order.status});
+        }
+        return summaries;
+    }
+
+    /**
+     * @brief Число, сумма, минимум и максимум сумм заказов под запросом
+     *
+     * Реализация по умолчанию обходит findOrderSummaries; хранилища
+     * переопределяют ее, чтобы считать по месту хранения без копий записей:
+     * InMemoryDatabase и TieredDatabase, ShardedDatabase (сливает агрегаты
+     * шардов), ColumnarDatabase (по колонкам) и SqliteDatabase (запросом
+     * SQL). MappedDatabase и LsmDatabase пользуются реализацией по умолчанию.
+     */
+    virtual OrderAggregate aggregateOrders(const OrderQuery& query) const {
+        OrderAggregate aggregate;
+        for (const auto& order : findOrderSummaries(query)) {
+            aggregate.add(order.amount);
+        }
+        return aggregate;
+    }
+
+    /**
+     * @brief Флаг is_active пользователя без копии имени и email
+     * @return nullopt, если пользователя нет
+     */
+    virtual std::optional<bool> findUserActive(int id) const {
+        const auto user = findUserById(id);
+        return user ? std::optional<bool>(user->is_active) : std::nullopt;
+    }
+
+    /**
+     * @brief Пользователи, удовлетворяющие запросу, в порядке findAllUsers
+     */
+    virtual std::vector<User> findUsers(const UserQuery& query) const {
+        std::vector<User> users;
+        scanUsers([&users, &query](const User& user) {
+            if (query.matches(user)) {
+                users.push_back(user);
+            }
+            return true;
+        });
+        return users;
+    }
+
     // Служебные методы
     virtual void clear() = 0;
 };
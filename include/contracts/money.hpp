@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <ostream>
+
+namespace contracts {
+
+/**
+ * @brief Денежная сумма с фиксированной точкой - часть контракта
+ *
+ * Хранится целым числом минимальных единиц (копеек), поэтому сложение
+ * точное и не накапливает ошибку округления, а суммирование колонок
+ * сводится к целочисленной редукции.
+ *
+ * Совместимость со старым кодом на double: неявное преобразование
+ * из double (округление до ближайшей копейки) и toDouble().
+ * Нечисловые (NaN, ±inf) и не помещающиеся в int64 копеек суммы дают
+ * недействительное значение (isValid() == false), оно меньше любой
+ * действительной суммы; fromDouble() сообщает о них через nullopt.
+ * Сложение и вычитание с переполнением int64 или с недействительным
+ * операндом тоже дают недействительную сумму, а не переносятся по модулю.
+ */
+class Money {
+public:
+    static constexpr std::int64_t kMinorPerUnit = 100;
+
+    constexpr Money() = default;
+
+    /**
+     * @brief Сумма из double с округлением до ближайшей копейки
+     *
+     * Для недопустимого amount (см. fromDouble) - недействительная сумма.
+     */
+    Money(double amount)
+        : minor_(fromDouble(amount).value_or(invalid()).minor_) {}
+
+    /**
+     * @brief Сумма из double или nullopt, если amount не конечно
+     *        или не помещается в int64 копеек
+     */
+    static std::optional<Money> fromDouble(double amount) {
+        const double minor = amount * kMinorPerUnit;
+        // 2^63 точно представимо в double; левая граница строгая, чтобы
+        // INT64_MIN оставался признаком недействительной суммы
+        if (!std::isfinite(minor) || !(minor > -kMinorLimit && minor < kMinorLimit)) {
+            return std::nullopt;
+        }
+        return fromMinorUnits(std::llround(minor));
+    }
+
+    static constexpr Money fromMinorUnits(std::int64_t minor) {
+        Money money;
+        money.minor_ = minor;
+        return money;
+    }
+
+    constexpr std::int64_t minorUnits() const { return minor_; }
+
+    constexpr bool isValid() const { return minor_ != kInvalidMinor; }
+
+    double toDouble() const {
+        return static_cast<double>(minor_) / kMinorPerUnit;
+    }
+
+    constexpr Money& operator+=(Money other) {
+        if (!isValid() || !other.isValid() ||
+            __builtin_add_overflow(minor_, other.minor_, &minor_)) {
+            minor_ = kInvalidMinor;
+        }
+        return *this;
+    }
+
+    constexpr Money& operator-=(Money other) {
+        if (!isValid() || !other.isValid() ||
+            __builtin_sub_overflow(minor_, other.minor_, &minor_)) {
+            minor_ = kInvalidMinor;
+        }
+        return *this;
+    }
+
+    friend constexpr Money operator+(Money a, Money b) { return a += b; }
+    friend constexpr Money operator-(Money a, Money b) { return a -= b; }
+
+    friend constexpr bool operator==(Money a, Money b) { return a.minor_ == b.minor_; }
+    friend constexpr bool operator!=(Money a, Money b) { return a.minor_ != b.minor_; }
+    friend constexpr bool operator<(Money a, Money b) { return a.minor_ < b.minor_; }
+    friend constexpr bool operator<=(Money a, Money b) { return a.minor_ <= b.minor_; }
+    friend constexpr bool operator>(Money a, Money b) { return a.minor_ > b.minor_; }
+    friend constexpr bool operator>=(Money a, Money b) { return a.minor_ >= b.minor_; }
+
+    /**
+     * @brief Недействительная сумма (isValid() == false)
+     */
+    static constexpr Money invalid() { return fromMinorUnits(kInvalidMinor); }
+
+    friend std::ostream& operator<<(std::ostream& out, Money money) {
+        const std::int64_t units = money.minor_ / kMinorPerUnit;
+        const std::int64_t minor = std::llabs(money.minor_ % kMinorPerUnit);
+        if (money.minor_ < 0 && units == 0) {
+            out << '-';
+        }
+        out << units << '.' << (minor < 10 ? "0" : "") << minor;
+        return out;
+    }
+
+private:
+    static constexpr std::int64_t kInvalidMinor = std::numeric_limits<std::int64_t>::min();
+    static constexpr double kMinorLimit = 9223372036854775808.0;  // 2^63
+
+    std::int64_t minor_ = 0;
+};
+
+} // namespace contracts
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "money.hpp"
+#include "page.hpp"
 #include <string>
 #include <optional>
 #include <vector>
@@ -25,7 +27,7 @@ struct Order {
     int id;
     int user_id;
     std::string product_name;
-    double amount;
+    Money amount;
     OrderStatus status;
 
     bool operator==(const Order& other) const {
@@ -37,6 +39,23 @@ struct Order {
     }
 };
 
+/**
+ * @brief Краткая запись заказа без названия продукта - часть контракта
+ *
+ * Проекция Order для списков и сумм: копируется без выделения памяти.
+ */
+struct OrderSummary {
+    int id;
+    int user_id;
+    Money amount;
+    OrderStatus status;
+
+    bool operator==(const OrderSummary& other) const {
+        return id == other.id && user_id == other.user_id && amount == other.amount &&
+               status == other.status;
+    }
+};
+
 /**
  * @brief Интерфейс (контракт) сервиса заказов
  * 
@@ -45,16 +64,25 @@ struct Order {
  */
 class IOrderService {
 public:
+    /**
+     * @brief Наибольшая сумма одного заказа (10^11 в основных единицах)
+     *
+     * Ограничивает рост суммы getTotal: переполнение int64 копеек требует
+     * больше 900 тысяч заказов на предельную сумму.
+     */
+    static constexpr Money kMaxAmount = Money::fromMinorUnits(10'000'000'000'000);
+
     virtual ~IOrderService() = default;
 
     /**
      * @brief Создать новый заказ
      * @param user_id ID пользователя (должен существовать и быть активным)
      * @param product_name Название продукта (не должно быть пустым)
-     * @param amount Сумма заказа (должна быть > 0)
+     * @param amount Сумма заказа (должна быть > 0 и не больше kMaxAmount);
+     *        double преобразуется с округлением до копейки
      * @return ID созданного заказа или -1 при ошибке
      */
-    virtual int createOrder(int user_id, const std::string& product_name, double amount) = 0;
+    virtual int createOrder(int user_id, const std::string& product_name, Money amount) = 0;
 
     /**
      * @brief Получить заказ по ID
@@ -70,6 +98,21 @@ public:
      */
     virtual std::vector<Order> getUserOrders(int user_id) const = 0;
 
+    /**
+     * @brief Страница заказов пользователя
+     * @param user_id ID пользователя
+     * @param page Курсор (ID последнего заказа прошлой страницы) и размер
+     * @return Не больше page.limit заказов с ID > page.after_id по возрастанию ID
+     */
+    virtual std::vector<Order> getUserOrders(int user_id, const PageRequest& page) const = 0;
+
+    /**
+     * @brief Заказы пользователя без названий продуктов
+     * @param user_id ID пользователя
+     * @return Краткие записи в том же порядке, что и getUserOrders(user_id)
+     */
+    virtual std::vector<OrderSummary> getUserOrderSummaries(int user_id) const = 0;
+
     /**
      * @brief Обновить статус заказа
      * @param id ID заказа
@@ -86,9 +129,18 @@ public:
     virtual bool cancelOrder(int id) = 0;
 
     /**
-     * @brief Получить общую сумму заказов пользователя
+     * @brief Получить общую сумму заказов пользователя (точно)
      * @param user_id ID пользователя
-     * @return Сумма всех заказов пользователя
+     * @return Сумма всех неотмененных заказов пользователя; недействительная
+     *         сумма, если она не помещается в int64 копеек
+     */
+    virtual Money getTotal(int user_id) const = 0;
+
+    /**
+     * @brief Общая сумма заказов пользователя в double
+     *
+     * Для совместимости с кодом на double, равна getTotal(user_id).toDouble(),
+     * а при переполнении суммы — NaN.
      */
     virtual double getTotalAmount(int user_id) const = 0;
 };
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+namespace contracts {
+
+/**
+ * @brief Запрос страницы по ключу (курсору) - часть контракта
+ *
+ * Страница — записи с ID больше after_id по возрастанию ID, не больше
+ * limit. Курсор следующей страницы — ID последней записи текущей; пустая
+ * страница означает конец. Порядок по ID стабилен: изменения между
+ * запросами не сдвигают страницы, запись не повторяется и не
+ * пропускается, если ее ID больше курсора.
+ *
+ * Записи, созданные во время обхода, могут быть пропущены: ID выдаются
+ * потокам блоками (IdAllocator), и новая запись получает ID из ранее
+ * арендованного блока, меньший уже пройденного курсора. Полный снимок
+ * дает только обход без параллельных вставок.
+ */
+struct PageRequest {
+    static constexpr std::size_t kDefaultLimit = 100;
+
+    int after_id = 0;
+    std::size_t limit = kDefaultLimit;
+};
+
+} // namespace contracts
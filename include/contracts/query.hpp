@@ -0,0 +1,125 @@
+#pragma once
+
+#include "order_contract.hpp"
+#include "user_contract.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+
+namespace contracts {
+
+/**
+ * @brief Набор статусов заказа - часть контракта
+ *
+ * Битовая маска по значению OrderStatus; по умолчанию содержит все статусы.
+ */
+class StatusSet {
+public:
+    constexpr StatusSet() = default;
+
+    static constexpr StatusSet none() { return StatusSet(0); }
+
+    static constexpr StatusSet of(std::initializer_list<OrderStatus> statuses) {
+        StatusSet set = none();
+        for (OrderStatus status : statuses) {
+            set.bits_ |= bit(status);
+        }
+        return set;
+    }
+
+    static constexpr StatusSet allExcept(std::initializer_list<OrderStatus> statuses) {
+        StatusSet set;
+        for (OrderStatus status : statuses) {
+            set.bits_ &= ~bit(status);
+        }
+        return set;
+    }
+
+    constexpr bool contains(OrderStatus status) const { return (bits_ & bit(status)) != 0; }
+
+    friend constexpr bool operator==(StatusSet a, StatusSet b) { return a.bits_ == b.bits_; }
+    friend constexpr bool operator!=(StatusSet a, StatusSet b) { return a.bits_ != b.bits_; }
+
+private:
+    // CANCELLED — последний статус
+    static constexpr std::uint8_t kAll =
+        (1u << (static_cast<int>(OrderStatus::CANCELLED) + 1)) - 1;
+
+    explicit constexpr StatusSet(std::uint8_t bits) : bits_(bits) {}
+
+    static constexpr std::uint8_t bit(OrderStatus status) {
+        return static_cast<std::uint8_t>(1u << static_cast<int>(status));
+    }
+
+    std::uint8_t bits_ = kAll;
+};
+
+/**
+ * @brief Фильтр заказов для IDatabase::findOrders - часть контракта
+ *
+ * Незаданное условие не ограничивает выборку; границы суммы включительны.
+ * Условия проверяются по полям без строк, поэтому хранилище может
+ * отбросить запись до копирования названия продукта.
+ */
+struct OrderQuery {
+    std::optional<int> user_id;
+    StatusSet statuses;
+    std::optional<Money> min_amount;
+    std::optional<Money> max_amount;
+
+    bool matches(int order_user_id, Money amount, OrderStatus status) const {
+        return (!user_id || *user_id == order_user_id) && statuses.contains(status) &&
+               (!min_amount || *min_amount <= amount) && (!max_amount || amount <= *max_amount);
+    }
+
+    bool matches(const Order& order) const {
+        return matches(order.user_id, order.amount, order.status);
+    }
+};
+
+/**
+ * @brief Агрегат сумм заказов для IDatabase::aggregateOrders - часть контракта
+ *
+ * min и max имеют смысл только при count > 0. Если сумма не поместилась
+ * в int64 копеек, overflow == true и sum недействительна (см. Money).
+ */
+struct OrderAggregate {
+    std::size_t count = 0;
+    Money sum;
+    Money min;
+    Money max;
+    bool overflow = false;
+
+    void add(Money amount) {
+        min = count == 0 || amount < min ? amount : min;
+        max = count == 0 || max < amount ? amount : max;
+        sum += amount;
+        overflow = overflow || !sum.isValid();
+        ++count;
+    }
+
+    void merge(const OrderAggregate& other) {
+        if (other.count == 0) {
+            return;
+        }
+        min = count == 0 || other.min < min ? other.min : min;
+        max = count == 0 || max < other.max ? other.max : max;
+        sum += other.sum;
+        overflow = overflow || other.overflow || !sum.isValid();
+        count += other.count;
+    }
+};
+
+/**
+ * @brief Фильтр пользователей для IDatabase::findUsers - часть контракта
+ */
+struct UserQuery {
+    std::optional<bool> is_active;
+
+    bool matches(bool active) const { return !is_active || *is_active == active; }
+
+    bool matches(const User& user) const { return matches(user.is_active); }
+};
+
+} // namespace contracts
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "page.hpp"
 #include <string>
 #include <optional>
 #include <vector>
@@ -54,6 +55,14 @@ public:
      */
     virtual std::vector<User> getActiveUsers() const = 0;
 
+    /**
+     * @brief Страница активных пользователей
+     * @param page Курсор (ID последнего пользователя прошлой страницы) и размер
+     * @return Не больше page.limit активных пользователей с ID > page.after_id
+     *         по возрастанию ID
+     */
+    virtual std::vector<User> getActiveUsers(const PageRequest& page) const = 0;
+
     /**
      * @brief Деактивировать пользователя
      * @param id ID пользователя
@@ -67,6 +76,13 @@ public:
      * @return true если пользователь существует
      */
     virtual bool userExists(int id) const = 0;
+
+    /**
+     * @brief Проверить, что пользователь существует и активен
+     * @param id ID пользователя
+     * @return true если пользователь найден и is_active
+     */
+    virtual bool isActive(int id) const = 0;
 };
 
 } // namespace contracts
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace services {
+
+/**
+ * @brief Фильтр Блума по 64-битным ключам
+ *
+ * Отвечает «точно нет» или «возможно есть»: при 10 битах на ключ
+ * ложноположительных ответов около 1%. Позиции битов — двойное
+ * хеширование одного 64-битного хеша. Биты лежат подряд, поэтому
+ * проверять можно и сохраненный фильтр прямо в отображенном файле
+ * (статический mayContain).
+ */
+class BloomFilter {
+public:
+    /**
+     * @param keys Ожидаемое число ключей
+     * @param bits_per_key Размер фильтра на ключ; больше — меньше ложных ответов
+     */
+    BloomFilter(std::size_t keys, unsigned bits_per_key)
+        : bytes_(std::max<std::size_t>(8, (keys * bits_per_key + 7) / 8)),
+          // Оптимум k = bits_per_key * ln 2
+          hashes_(std::clamp((bits_per_key * 69 + 50) / 100, 1u, 30u)) {}
+
+    void add(std::uint64_t key) {
+        const std::size_t bits = bytes_.size() * 8;
+        std::uint64_t hash = mix(key);
+        const std::uint64_t delta = (hash >> 33) | (hash << 31);
+        for (unsigned i = 0; i < hashes_; ++i) {
+            const std::size_t bit = hash % bits;
+            bytes_[bit / 8] |= static_cast<std::uint8_t>(1u << (bit % 8));
+            hash += delta;
+        }
+    }
+
+    bool mayContain(std::uint64_t key) const {
+        return mayContain(bytes_.data(), bytes_.size(), hashes_, key);
+    }
+
+    /**
+     * @brief Проверить ключ по битам фильтра, построенного с hashes хешами
+     */
+    static bool mayContain(const std::uint8_t* bytes, std::size_t size, unsigned hashes,
+                           std::uint64_t key) {
+        const std::size_t bits = size * 8;
+        std::uint64_t hash = mix(key);
+        const std::uint64_t delta = (hash >> 33) | (hash << 31);
+        for (unsigned i = 0; i < hashes; ++i) {
+            const std::size_t bit = hash % bits;
+            if ((bytes[bit / 8] & (1u << (bit % 8))) == 0) {
+                return false;
+            }
+            hash += delta;
+        }
+        return true;
+    }
+
+    const std::vector<std::uint8_t>& bytes() const { return bytes_; }
+    unsigned hashes() const { return hashes_; }
+
+private:
+    // Финализатор splitmix64: близкие ключи дают независимые хеши
+    static std::uint64_t mix(std::uint64_t key) {
+        key ^= key >> 30;
+        key *= 0xBF58476D1CE4E5B9ull;
+        key ^= key >> 27;
+        key *= 0x94D049BB133111EBull;
+        key ^= key >> 31;
+        return key;
+    }
+
+    std::vector<std::uint8_t> bytes_;
+    unsigned hashes_;
+};
+
+} // namespace services
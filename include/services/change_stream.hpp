@@ -0,0 +1,190 @@
+#pragma once
+
+#include "contracts/money.hpp"
+#include "contracts/order_contract.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace services {
+
+/**
+ * @brief Изменение в потоке ChangeStream
+ *
+ * Строки указывают в копию кадра у читателя и действительны только внутри
+ * вызова обработчика poll().
+ */
+struct ChangeEvent {
+    enum class Type : std::uint8_t {
+        PutUser,       // Пользователь создан или изменен
+        DeleteUser,
+        PutOrder,      // Заказ создан или изменен
+        DeleteOrder,
+        Clear,         // База очищена
+        Reload,        // Содержимое заменено целиком (bulkLoad, loadCheckpoint)
+    };
+
+    std::uint64_t sequence = 0;
+    Type type = Type::Clear;
+    int id = 0;
+    // PutUser
+    std::string_view name;
+    std::string_view email;
+    bool is_active = false;
+    // PutOrder
+    int user_id = 0;
+    std::string_view product_name;
+    contracts::Money amount;
+    contracts::OrderStatus status = contracts::OrderStatus::PENDING;
+    // Строки не поместились в кольцо и опущены: запись нужно перечитать
+    bool truncated = false;
+};
+
+/**
+ * @brief Ограниченный поток изменений с чтением без блокировок
+ *
+ * Изменения получают номера подряд с 1 и записываются кадрами (заголовок
+ * и строки записи) в кольцевой буфер фиксированного размера. Отдельный
+ * индекс хранит позицию кадра по номеру, поэтому читатель продолжает
+ * с любого номера, который еще в кольце.
+ *
+ * Писатель один (публикации сериализует владелец, например mutex_
+ * InMemoryDatabase) и никогда не ждет читателей: новый кадр затирает
+ * самые старые. Читателей сколько угодно, каждый хранит только свой
+ * следующий номер и ничего не пишет в общую память. Чтение устроено как
+ * seqlock: кольцо состоит из атомарных слов, читатель копирует кадр
+ * пословно (relaxed) в свой буфер, затем проверяет, что писатель его
+ * не затер, и только потом разбирает копию. Отставший больше чем
+ * на емкость кольца читатель получает отказ и восстанавливается сам
+ * (например, полным обходом базы и чтением с oldestSequence()).
+ */
+class ChangeStream {
+public:
+    /**
+     * @brief Поток с кольцом из capacity_bytes байт (не меньше 4 КиБ)
+     */
+    explicit ChangeStream(std::size_t capacity_bytes = 4 << 20);
+
+    ChangeStream(const ChangeStream&) = delete;
+    ChangeStream& operator=(const ChangeStream&) = delete;
+
+    // --- Писатель (сериализуется владельцем, память не выделяет) ---
+
+    void publishUser(int id, std::string_view name, std::string_view email, bool is_active);
+    void publishOrder(int id, int user_id, std::string_view product_name,
+                      contracts::Money amount, contracts::OrderStatus status);
+    void publishDelete(ChangeEvent::Type type, int id);
+    void publishReset(ChangeEvent::Type type);
+
+    // --- Читатели (любое число потоков) ---
+
+    /**
+     * @brief Номер, который получит следующее изменение
+     */
+    std::uint64_t nextSequence() const { return published_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Номер самого старого изменения, еще доступного для чтения
+     */
+    std::uint64_t oldestSequence() const { return oldest_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Передать visit(const ChangeEvent&) изменения, начиная с next
+     *
+     * next продвигается за каждым прочитанным изменением; чтение
+     * останавливается на последнем опубликованном или после max изменений.
+     * Продолжение после перезапуска — тот же вызов с сохраненным номером.
+     * @return false, если изменение next уже затерто (next не меняется).
+     *         visit получает только проверенные, целиком прочитанные изменения
+     */
+    template <typename Visitor>
+    bool poll(std::uint64_t& next, Visitor&& visit,
+              std::size_t max = std::numeric_limits<std::size_t>::max()) const {
+        const std::uint64_t end = published_.load(std::memory_order_acquire);
+        std::vector<std::uint64_t> text;
+        for (std::size_t count = 0; count < max && next < end; ++count) {
+            if (next < oldest_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            const std::uint64_t position =
+                positions_[next & position_mask_].load(std::memory_order_relaxed);
+            const std::size_t word = position % capacity_ / kWordSize;
+            Header header;
+            loadWords(word, &header, kHeaderWords);
+            if (!intact(next) || header.sequence != next) {
+                return false;
+            }
+            // Заголовок проверен, размеры строк в нем настоящие
+            text.resize(wordsFor(std::size_t{header.first_size} + header.second_size));
+            loadWords(word + kHeaderWords, text.data(), text.size());
+            if (!intact(next)) {
+                return false;
+            }
+            const ChangeEvent event =
+                decode(header, reinterpret_cast<const char*>(text.data()));
+            visit(event);
+            ++next;
+        }
+        return true;
+    }
+
+    std::size_t capacityBytes() const { return capacity_; }
+
+private:
+    // Заголовок кадра, за ним строки первая и вторая
+    struct Header {
+        std::uint64_t sequence;
+        std::int64_t amount;
+        std::int32_t id;
+        std::int32_t user_id;
+        std::uint32_t first_size;
+        std::uint32_t second_size;
+        std::uint8_t type;
+        std::uint8_t status;
+        std::uint8_t is_active;
+        std::uint8_t truncated;
+        std::uint8_t padding[4];
+    };
+
+    static_assert(sizeof(Header) == 40, "layout of change frame header");
+
+    static constexpr std::size_t kWordSize = sizeof(std::uint64_t);
+    static constexpr std::size_t kHeaderWords = sizeof(Header) / kWordSize;
+
+    static std::size_t wordsFor(std::size_t bytes) { return (bytes + kWordSize - 1) / kWordSize; }
+
+    // Скопировать count слов кольца, начиная со слова first, в out
+    void loadWords(std::size_t first, void* out, std::size_t count) const;
+
+    // Кадр sequence не затерт с момента чтения (после чтения данных)
+    bool intact(std::uint64_t sequence) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return oldest_.load(std::memory_order_relaxed) <= sequence;
+    }
+
+    static ChangeEvent decode(const Header& header, const char* text);
+
+    void publish(Header header, std::string_view first, std::string_view second);
+
+    const std::size_t capacity_;
+    // Кольцо из capacity_ / kWordSize слов; кадры выровнены по слову.
+    // Атомарные слова делают одновременные чтение и запись кадра
+    // законными: читатель отбрасывает копию, если кадр затерт
+    std::unique_ptr<std::atomic<std::uint64_t>[]> words_;
+    // Позиции кадров по номеру; кадров в кольце не больше, чем ячеек
+    std::unique_ptr<std::atomic<std::uint64_t>[]> positions_;
+    std::uint64_t position_mask_ = 0;
+
+    // Только писатель
+    std::uint64_t write_position_ = 0;   // Конец последнего кадра (растет)
+
+    std::atomic<std::uint64_t> published_{1};   // Следующий номер
+    std::atomic<std::uint64_t> oldest_{1};      // Самый старый незатертый
+};
+
+} // namespace services
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "contracts/money.hpp"
+#include "contracts/order_contract.hpp"
+#include "services/string_storage.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace services {
+
+/**
+ * @brief Формат файла контрольной точки (снимок пользователей и заказов)
+ *
+ * Файл — заголовок и секции записей фиксированного размера, которые
+ * читаются прямо из отображенной памяти:
+ *
+ *   Header | UserEntry[users] | ProductEntry[products] |
+ *   OrderEntry[orders] | строки
+ *
+ * Названия продуктов хранятся один раз в таблице продуктов, заказ
+ * ссылается на нее номером. Имя и email пользователя лежат подряд
+ * в секции строк. Числа — в порядке байт записавшей машины, он отмечен
+ * в заголовке; файл с другим порядком не загружается. CRC32 заголовка
+ * покрывает все секции.
+ */
+namespace checkpoint_format {
+
+constexpr char kMagic[8] = {'I', 'M', 'D', 'B', 'C', 'K', 'P', 'T'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kByteOrderMark = 0x01020304;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t users;
+    std::uint64_t products;
+    std::uint64_t orders;
+    std::uint64_t text_bytes;
+    std::uint32_t crc;           // CRC32 всех секций после заголовка
+    std::uint32_t reserved;
+};
+
+struct UserEntry {
+    std::int32_t id;
+    std::uint32_t name_size;
+    std::uint32_t email_size;    // email следует сразу за именем
+    std::uint8_t is_active;
+    std::uint8_t padding[3];
+    std::uint64_t text_offset;
+};
+
+struct ProductEntry {
+    std::uint64_t text_offset;
+    std::uint32_t size;
+    std::uint32_t padding;
+};
+
+struct OrderEntry {
+    std::int32_t id;
+    std::int32_t user_id;
+    std::int64_t amount;         // Money::minorUnits
+    std::uint32_t product;       // Номер в таблице продуктов
+    std::uint8_t status;
+    std::uint8_t padding[3];
+};
+
+static_assert(sizeof(Header) == 56, "layout of checkpoint header");
+static_assert(sizeof(UserEntry) == 24, "layout of checkpoint user entry");
+static_assert(sizeof(ProductEntry) == 16, "layout of checkpoint product entry");
+static_assert(sizeof(OrderEntry) == 24, "layout of checkpoint order entry");
+
+} // namespace checkpoint_format
+
+/**
+ * @brief Накопить записи и записать контрольную точку одним файлом
+ *
+ * Файл пишется во временный рядом, сбрасывается на диск и атомарно
+ * переименовывается: прежняя контрольная точка остается целой, пока
+ * новая не готова. Строки копируются при добавлении.
+ */
+class CheckpointWriter {
+public:
+    void addUser(int id, std::string_view name, std::string_view email, bool is_active);
+
+    /**
+     * @param product Одинаковые названия сохраняются один раз
+     */
+    void addOrder(int id, int user_id, std::string_view product, contracts::Money amount,
+                  contracts::OrderStatus status);
+
+    /**
+     * @return false, если файл не удалось записать
+     */
+    bool write(const std::string& path) const;
+
+    std::size_t userCount() const { return users_.size(); }
+    std::size_t orderCount() const { return orders_.size(); }
+
+private:
+    std::uint64_t storeText(std::string_view text);
+
+    std::vector<checkpoint_format::UserEntry> users_;
+    std::vector<checkpoint_format::ProductEntry> products_;
+    std::vector<checkpoint_format::OrderEntry> orders_;
+    std::string text_;
+    // Ключи — копии названий в арене: text_ перевыделяется при росте
+    StringArena product_keys_;
+    std::unordered_map<std::string_view, std::uint32_t> product_ids_;
+};
+
+/**
+ * @brief Контрольная точка, отображенная в память
+ *
+ * open() проверяет заголовок, размеры секций, CRC32 и ссылки записей
+ * на строки, после чего доступ к записям не требует проверок.
+ * Представления строк действительны, пока жив объект.
+ */
+class CheckpointReader {
+public:
+    struct User {
+        int id;
+        std::string_view name;
+        std::string_view email;
+        bool is_active;
+    };
+
+    struct Order {
+        int id;
+        int user_id;
+        std::uint32_t product;   // См. product()
+        contracts::Money amount;
+        contracts::OrderStatus status;
+    };
+
+    /**
+     * @return nullopt, если файла нет, он не является контрольной точкой
+     *         или поврежден
+     */
+    static std::optional<CheckpointReader> open(const std::string& path);
+
+    CheckpointReader(CheckpointReader&& other) noexcept;
+    CheckpointReader(const CheckpointReader&) = delete;
+    CheckpointReader& operator=(const CheckpointReader&) = delete;
+    CheckpointReader& operator=(CheckpointReader&&) = delete;
+    ~CheckpointReader();
+
+    std::size_t userCount() const { return header_.users; }
+    std::size_t productCount() const { return header_.products; }
+    std::size_t orderCount() const { return header_.orders; }
+
+    User user(std::size_t index) const;
+    std::string_view product(std::size_t index) const;
+    Order order(std::size_t index) const;
+
+private:
+    CheckpointReader(const char* data, std::size_t size);
+
+    // Проверить файл и найти секции
+    bool validate();
+
+    const char* data_;
+    std::size_t size_;
+    checkpoint_format::Header header_{};
+    const char* users_ = nullptr;
+    const char* products_ = nullptr;
+    const char* orders_ = nullptr;
+    const char* text_ = nullptr;
+};
+
+} // namespace services
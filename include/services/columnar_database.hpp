@@ -0,0 +1,127 @@
+#pragma once
+
+#include "contracts/database_contract.hpp"
+#include "services/dense_id_array.hpp"
+#include "services/id_allocator.hpp"
+#include "services/versioned_table.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace services {
+
+/**
+ * @brief In-memory база данных с колоночным хранением заказов
+ *
+ * Заказы хранятся не массивом структур, а отдельными непрерывными
+ * колонками (id, user_id, amount в копейках, status), а названия продуктов — в общей
+ * строковой куче, на которую ссылаются смещение (64 бита, куча может
+ * превысить 4 ГиБ) и длина. Название длиннее 4 ГиБ не принимается:
+ * saveOrder/updateOrder отказывают. Агрегирующие
+ * обходы (суммы, фильтры по статусу) читают только нужные колонки
+ * и не тащат через кэш строки. Удаленный заказ замещается последней
+ * строкой, поэтому колонки остаются плотными, а findAllOrders не
+ * гарантирует порядок по ID.
+ *
+ * Пользователи хранятся так же, как в InMemoryDatabase (VersionedTable).
+ * Операции над заказами, включая обходы, берут mutex_ (разделяемо для
+ * чтения, эксклюзивно для изменений).
+ */
+class ColumnarDatabase : public contracts::IDatabase {
+public:
+    ColumnarDatabase();
+
+    // Операции с пользователями
+    int saveUser(const contracts::User& user) override;
+    std::optional<contracts::User> findUserById(int id) const override;
+    std::vector<contracts::User> findAllUsers() const override;
+    bool updateUser(const contracts::User& user) override;
+    bool deleteUser(int id) override;
+
+    // Операции с заказами
+    int saveOrder(const contracts::Order& order) override;
+    std::optional<contracts::Order> findOrderById(int id) const override;
+    std::vector<contracts::Order> findOrdersByUserId(int user_id) const override;
+    std::vector<contracts::Order> findAllOrders() const override;
+    bool updateOrder(const contracts::Order& order) override;
+    bool deleteOrder(int id) override;
+
+    // Служебные методы
+    void clear() override;
+
+    // Колоночные запросы: читают только user_id, amount и status
+
+    /**
+     * @brief Агрегат по колонкам, без сборки заказов и чтения названий
+     *
+     * С query.user_id обходит строки заказов пользователя по индексу,
+     * без него — все строки подряд.
+     */
+    contracts::OrderAggregate aggregateOrders(const contracts::OrderQuery& query) const override;
+
+    /**
+     * @brief Количество заказов в данном статусе
+     */
+    std::size_t countOrdersByStatus(contracts::OrderStatus status) const;
+
+    /**
+     * @brief Сумма заказов в данном статусе
+     */
+    contracts::Money sumAmountByStatus(contracts::OrderStatus status) const;
+
+    /**
+     * @brief Сумма неотмененных заказов пользователя
+     *
+     * То же, что OrderService::getTotal, но без копирования заказов;
+     * при переполнении — недействительная сумма.
+     */
+    contracts::Money totalAmountByUser(int user_id) const;
+
+    /**
+     * @brief Байты строковой кучи, занятые удаленными и замененными названиями
+     */
+    std::size_t productHeapGarbage() const;
+
+private:
+    // Номер строки + 1, 0 — заказа нет
+    struct RowRef {
+        std::size_t row_plus_one = 0;
+    };
+
+    const RowRef* rowOf(int id) const;
+    contracts::Order rowToOrder(std::size_t row) const;
+    void setProductName(std::size_t row, const std::string& name);
+    void compactIfWasteful();
+    void compactProductHeap();
+
+    // Поддержка вторичного индекса user_id -> ID заказов (под эксклюзивной mutex_)
+    void indexOrder(int user_id, int order_id);
+    void unindexOrder(int user_id, int order_id);
+
+    mutable std::shared_mutex mutex_;
+    VersionedTable<contracts::User> users_;
+
+    // Колонки заказов, одна строка — один заказ
+    std::vector<int> order_id_;
+    std::vector<int> user_id_;
+    std::vector<std::int64_t> amount_;  // Money::minorUnits()
+    std::vector<std::uint8_t> status_;
+    std::vector<std::uint64_t> product_offset_;
+    std::vector<std::uint32_t> product_length_;
+
+    // Названия продуктов подряд, без разделителей
+    std::string product_heap_;
+    std::size_t product_garbage_ = 0;
+
+    std::unique_ptr<DenseIdArray<RowRef>> rows_;
+    // ID заказов каждого пользователя, отсортированы по возрастанию
+    std::unordered_map<int, std::vector<int>> user_orders_;
+    std::shared_ptr<IdAllocator> user_ids_;
+    std::shared_ptr<IdAllocator> order_ids_;
+};
+
+} // namespace services
@@ -1,8 +1,21 @@
 #pragma once
 
 #include "contracts/database_contract.hpp"
+#include "services/change_stream.hpp"
+#include "services/checkpoint.hpp"
+#include "services/dense_id_array.hpp"
+#include "services/id_allocator.hpp"
+#include "services/string_storage.hpp"
+#include "services/versioned_table.hpp"
+#include "services/write_ahead_log.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string_view>
 #include <unordered_map>
 #include <mutex>
+#include <shared_mutex>
+#include <vector>
 
 namespace services {
 
@@ -11,10 +24,55 @@ namespace services {
  * 
  * Простая реализация для демонстрации. В реальном проекте
  * здесь была бы работа с настоящей БД.
+ *
+ * Точечное чтение (find*ById, findOrdersByUserId) берет разделяемую
+ * блокировку и не блокирует другие чтения; изменения берут эксклюзивную
+ * блокировку. Полный обход (findAll*) читает согласованный снимок
+ * VersionedTable и блокировку не берет вовсе, поэтому не тормозит писателей.
+ *
+ * Строки записей не выделяются по отдельности: названия продуктов
+ * интернируются (различных названий мало, заказов много), имя и email
+ * пользователя копируются в общую арену. Записи таблиц хранят
+ * string_view на них. Когда замененные и удаленные имена и email
+ * занимают больше половины арены, актуальные копируются в новую
+ * (compactUserText), а прежняя освобождается вместе с последним
+ * открытым на нее снимком.
+ *
+ * Под эксклюзивной блокировкой память не выделяется и не освобождается:
+ * узлы версий и индекса, слоты таблиц и копии строк готовятся до нее,
+ * а замененные версии и прежние таблицы после clear() удаляются после
+ * ее снятия. Исключения — амортизированный рост индекса заказов
+ * пользователей (вектор ID и таблица бакетов) и сжатие имен и email.
+ *
+ * С подключенным журналом (attachLog) каждое изменение кодируется до
+ * блокировки, добавляется в журнал под ней (порядок в журнале совпадает
+ * с порядком применения), а подтверждения журнала поток ждет после ее
+ * снятия — вместе с другими писателями одной группы.
+ *
+ * Теплый старт (bulkLoad, loadCheckpoint) строит таблицы, строки
+ * и индекс заказов в нескольких потоках без блокировок и устанавливает
+ * их целиком под одной короткой эксклюзивной блокировкой.
+ *
+ * После saveCheckpoint база отслеживает ID измененных записей, и
+ * saveDelta записывает только их (см. IncrementalBackup). Пока отсчета
+ * нет, писатели не делают ничего сверх чтения одного флага.
+ *
+ * С подключенным потоком изменений (attachChangeStream) каждое изменение
+ * публикуется под эксклюзивной блокировкой, поэтому номера в потоке
+ * идут в порядке применения; публикация только копирует запись в кольцо.
  */
 class InMemoryDatabase : public contracts::IDatabase {
 public:
-    InMemoryDatabase() = default;
+    InMemoryDatabase();
+
+    /**
+     * @brief Создать базу с общими аллокаторами ID
+     *
+     * Позволяет нескольким хранилищам выдавать ID из одного пространства.
+     * clear() сбрасывает переданные аллокаторы.
+     */
+    InMemoryDatabase(std::shared_ptr<IdAllocator> user_ids,
+                     std::shared_ptr<IdAllocator> order_ids);
 
     // Операции с пользователями
     int saveUser(const contracts::User& user) override;
@@ -31,15 +89,332 @@ public:
     bool updateOrder(const contracts::Order& order) override;
     bool deleteOrder(int id) override;
 
+    /**
+     * @brief Обход снимка MVCC, как findAll*, без блокировки и без копии
+     *        таблицы
+     *
+     * Запись для visit одна на весь обход: строки копируются в ее буферы,
+     * поэтому память выделяется только под самые длинные из них.
+     */
+    void scanUsers(const UserVisitor& visit) const override;
+    void scanOrders(const OrderVisitor& visit) const override;
+
+    /**
+     * @brief Страница из индекса заказов пользователя: двоичный поиск
+     *        курсора и limit записей под разделяемой блокировкой
+     */
+    std::vector<contracts::Order> findOrdersByUserIdPage(
+        int user_id, const contracts::PageRequest& page) const override;
+
+    /**
+     * @brief Обход снимка MVCC с курсора до limit активных пользователей;
+     *        неактивные между ними тоже просматриваются
+     */
+    std::vector<contracts::User> findActiveUsersPage(
+        const contracts::PageRequest& page) const override;
+
+    /**
+     * @brief Фильтр проверяется по хранимым записям, строки копируются
+     *        только у подходящих
+     *
+     * С user_id — индекс заказов пользователя под разделяемой блокировкой,
+     * иначе — один снимок MVCC без блокировки, как findAll*.
+     */
+    std::vector<contracts::Order> findOrders(const contracts::OrderQuery& query) const override;
+    std::vector<contracts::User> findUsers(const contracts::UserQuery& query) const override;
+
+    /**
+     * @brief Проекции без строк: запись копируется из таблицы по полям
+     */
+    std::vector<contracts::OrderSummary> findOrderSummaries(
+        const contracts::OrderQuery& query) const override;
+    std::optional<bool> findUserActive(int id) const override;
+
+    /**
+     * @brief Агрегат по хранимым записям, без копий и без выделения памяти
+     */
+    contracts::OrderAggregate aggregateOrders(const contracts::OrderQuery& query) const override;
+
     // Служебные методы
     void clear() override;
 
+    /**
+     * @brief Вставить пользователя с уже назначенным ID
+     *
+     * В отличие от saveUser не выдает новый ID, а сохраняет user.id как есть.
+     * Используется составными хранилищами (шардирование), которые сами
+     * распределяют идентификаторы. См. IdAllocator::advancePast о вставке
+     * ID, выданных не аллокатором этой базы.
+     * @return true если вставлен, false если ID <= 0 или уже занят
+     */
+    bool insertUser(const contracts::User& user);
+
+    /**
+     * @brief Вставить заказ с уже назначенным ID
+     * @return true если вставлен, false если ID <= 0 или уже занят
+     */
+    bool insertOrder(const contracts::Order& order);
+
+    /**
+     * @brief Память под строки пользователей и заказов
+     */
+    struct TextMemory {
+        std::size_t user_text_bytes = 0;      // Выделено ареной имен и email
+        std::size_t product_names = 0;        // Различных названий продуктов
+        std::size_t product_name_bytes = 0;   // Пул названий вместе с хеш-таблицей
+    };
+
+    TextMemory textMemory() const;
+
+    /**
+     * @brief Записать контрольную точку — согласованный снимок обеих таблиц
+     *
+     * Читает снимки MVCC и не блокирует писателей. Файл заменяется
+     * атомарно (см. CheckpointWriter). Начинает отсчет изменений для
+     * saveDelta.
+     * @return false, если файл не удалось записать
+     */
+    bool saveCheckpoint(const std::string& path) const;
+
+    /**
+     * @brief Записать дельту — записи, измененные после предыдущей
+     *        saveCheckpoint или saveDelta
+     *
+     * Дельта — файл кадров WriteAheadLog: PutUser/PutOrder с состоянием
+     * записи в согласованном снимке и DeleteUser/DeleteOrder для записей,
+     * которых в снимке нет. Применение через applyLogRecord поверх
+     * контрольной точки и предыдущих дельт дает состояние на момент
+     * снимка. Изменение, которое еще не вернулось из вызова, может
+     * попасть и в следующую дельту — записи идемпотентны. Файл заменяется
+     * атомарно.
+     * @return false, если отсчета нет (контрольная точка не записывалась
+     *         либо после нее были clear, bulkLoad или loadCheckpoint) или
+     *         файл не удалось записать; изменения тогда не теряются
+     */
+    bool saveDelta(const std::string& path);
+
+    /**
+     * @brief Заменить содержимое базы контрольной точкой
+     *
+     * Предназначена для запуска: строит содержимое как bulkLoad, без
+     * журнала. Последующее применение журнала поверх контрольной точки
+     * безопасно — его записи идемпотентны.
+     * @param threads Потоков построения; 0 — по числу ядер
+     * @return false, если файла нет или он поврежден (база не меняется)
+     */
+    bool loadCheckpoint(const std::string& path, unsigned threads = 0);
+
+    /**
+     * @brief Заменить содержимое базы готовыми записями с их ID
+     *
+     * Предназначена для запуска (теплый старт из внешнего источника),
+     * в журнал не пишется. Записи делятся между потоками по диапазонам
+     * ID; каждый поток строит свою часть таблиц, копирует строки в свою
+     * арену и собирает свою часть индекса заказов пользователей. Готовое
+     * содержимое заменяет прежнее атомарно: читатели видят либо прежнюю
+     * базу, либо новую целиком. Аллокаторы ID продолжают после
+     * наибольших загруженных ID.
+     * @param threads Потоков построения; 0 — по числу ядер
+     * @return false, если есть ID <= 0 или повторяющиеся ID (база не меняется)
+     */
+    bool bulkLoad(const std::vector<contracts::User>& users,
+                  const std::vector<contracts::Order>& orders, unsigned threads = 0);
+
+    /**
+     * @brief Записывать все последующие изменения в журнал
+     *
+     * Вызывается до начала работы с базой, обычно после восстановления
+     * через applyLogRecord. Изменение, которое не удалось сохранить
+     * в журнал, возвращает ошибку (-1 у save*, false у остальных); после
+     * сбоя журнала база перестает принимать изменения.
+     *
+     * Кадр добавляется в буфер журнала до применения изменения, поэтому
+     * журнал в состоянии failed() изменение не применяет. Если же сбой
+     * произошел при записи группы (commit), изменения этой группы уже
+     * видны в памяти: состояние в памяти опережает журнал, а после
+     * перезапуска восстанавливается только сохраненное.
+     */
+    void attachLog(std::shared_ptr<WriteAheadLog> log);
+
+    /**
+     * @brief Журнал подключен и перешел в состояние failed()
+     *
+     * Единственный способ узнать о сбое для clear(), который не
+     * возвращает результат.
+     */
+    bool logFailed() const { return log_ && log_->failed(); }
+
+    /**
+     * @brief Публиковать все последующие изменения в поток
+     *
+     * Put* несут запись целиком, Delete* — ID; clear() публикует Clear,
+     * bulkLoad и loadCheckpoint — Reload (читателю нужен полный обход).
+     * nullptr отключает поток.
+     */
+    void attachChangeStream(std::shared_ptr<ChangeStream> stream);
+
+    /**
+     * @brief Применить запись журнала (восстановление до attachLog)
+     *
+     * Put* вставляют запись с ее ID или заменяют существующую.
+     */
+    void applyLogRecord(const LogRecord& record);
+
 private:
-    mutable std::mutex mutex_;
-    std::unordered_map<int, contracts::User> users_;
-    std::unordered_map<int, contracts::Order> orders_;
-    int next_user_id_ = 1;
-    int next_order_id_ = 1;
+    struct StoredUser {
+        int id = 0;
+        std::string_view name;
+        std::string_view email;
+        bool is_active = false;
+    };
+
+    struct StoredOrder {
+        int id = 0;
+        int user_id = 0;
+        std::string_view product_name;
+        contracts::Money amount;
+        contracts::OrderStatus status = contracts::OrderStatus::PENDING;
+    };
+
+    // Строки, на которые ссылаются записи; заменяется целиком при clear()
+    // и при сжатии имен и email (пул названий тогда переходит в новое)
+    struct TextStore {
+        StringArena user_text;
+        std::shared_ptr<StringInterner> product_names = std::make_shared<StringInterner>();
+        // Имена и email из массовой загрузки: по арене на поток построения
+        std::vector<std::unique_ptr<StringArena>> bulk_text;
+        // Байты имен и email, на которые не ссылается ни одна актуальная
+        // запись (замененные, удаленные); меняется под эксклюзивной mutex_
+        std::size_t dead_user_bytes = 0;
+
+        std::size_t userTextBytes() const;
+        // Сжатие линейно по живым пользователям, поэтому запускается, лишь
+        // когда мусор составляет больше половины: амортизированно O(1)
+        bool userTextWasteful() const;
+    };
+
+    using UserTable = VersionedTable<StoredUser>;
+    using OrderTable = VersionedTable<StoredOrder>;
+    // ID заказов каждого пользователя, отсортированы по возрастанию
+    using OrderIndex = std::unordered_map<int, std::vector<int>>;
+
+    static contracts::User toUser(const StoredUser& user);
+    static contracts::Order toOrder(const StoredOrder& order);
+
+    // visit(StoredOrder) для заказов, подходящих под query: с user_id —
+    // по индексу под разделяемой mutex_, иначе по снимку MVCC. reserve(n)
+    // получает число заказов, если под фильтр заведомо подходят все n
+    template <typename Visitor, typename Reserve>
+    void visitOrders(const contracts::OrderQuery& query, Visitor&& visit,
+                     Reserve&& reserve) const;
+    // Результат visitOrders, по записи convert(StoredOrder) на заказ
+    template <typename Record, typename Convert>
+    std::vector<Record> collectOrders(const contracts::OrderQuery& query, Convert convert) const;
+
+    // Копируют строки в текущее хранилище под text_mutex_ и возвращают его.
+    // Вызываются до взятия mutex_; под mutex_ результат сверяется с text_,
+    // так как clear() мог успеть заменить хранилище
+    std::shared_ptr<TextStore> storeUserText(const contracts::User& user, bool name,
+                                             bool email, StoredUser& stored);
+    std::shared_ptr<TextStore> storeProductName(const std::string& name,
+                                                StoredOrder& stored);
+
+    // Скопировать актуальные имена и email в новое хранилище строк
+    // и заменить им прежнее, если в нем все еще больше половины мусора.
+    // Берет mutex_ эксклюзивно: вызывается после снятия блокировки
+    void compactUserText();
+
+    // Узел {user_id: [order_id]} для indexOrder, выделенный до взятия mutex_.
+    // Неиспользованный узел остается потоку до следующего изменения
+    static OrderIndex::node_type& spareIndexNode(int user_id, int order_id);
+
+    // Содержимое базы целиком, построенное до взятия mutex_. swapContents
+    // оставляет в нем прежние строки, индекс и таблицы (old_*), чтобы
+    // освободить их после снятия блокировки
+    struct Contents {
+        std::shared_ptr<TextStore> text = std::make_shared<TextStore>();
+        UserTable::Bulk users;
+        OrderTable::Bulk orders;
+        std::size_t user_count = 0;
+        std::size_t order_count = 0;
+        OrderIndex index;
+        int max_user_id = 0;
+        int max_order_id = 0;
+        UserTable::Garbage old_users;
+        OrderTable::Garbage old_orders;
+    };
+
+    // Под mutex_ и text_mutex_: обменять содержимое с other
+    // и сбросить аллокаторы ID
+    void swapContents(Contents& other);
+
+    // Построить contents из записей user_at(i) и order_at(i) в threads
+    // потоках без блокировок. user_at возвращает строки источника (они
+    // копируются), order_at — название продукта уже из contents.text.
+    // false — ID <= 0 или повторяются
+    template <typename UserAt, typename OrderAt>
+    static bool buildContents(Contents& contents, std::size_t user_count, UserAt user_at,
+                              std::size_t order_count, OrderAt order_at, unsigned threads);
+
+    // Установить построенное содержимое и продолжить ID после загруженных
+    void publish(Contents& contents);
+
+    // Под эксклюзивной mutex_: опубликовать текущее состояние записи
+    // (Put или Delete, если ее нет) в поток изменений
+    void publishUserChange(int id);
+    void publishOrderChange(int id);
+
+    // Под эксклюзивной mutex_ до применения изменения: добавить кадр;
+    // nullopt — журнал не принял запись, изменение не применяется
+    std::optional<std::uint64_t> appendLog(const std::string& frame);
+    // После снятия mutex_: дождаться сохранения добавленного кадра
+    bool commitLog(std::uint64_t lsn);
+
+    // Поддержка вторичного индекса user_id -> ID заказов (под эксклюзивной mutex_).
+    // Новый ключ вставляется узлом spare, опустевший извлекается в removed,
+    // чтобы освободить его после снятия блокировки
+    void indexOrder(int user_id, int order_id, OrderIndex::node_type& spare);
+    void unindexOrder(int user_id, int order_id, OrderIndex::node_type& removed);
+
+    // ID записей, измененных с последней контрольной точки или дельты.
+    // Писатели отмечают ID после снятия mutex_: изменение, уже попавшее
+    // в снимок, может быть отмечено и для следующей дельты, но не
+    // потеряно. Набор забирается под разделяемой mutex_ вместе со
+    // снимками таблиц, а сбрасывается (clear, publish) под эксклюзивной
+    struct ChangedIds {
+        std::mutex mutex;
+        // Отсчет идет от записанной контрольной точки; читается
+        // писателями без mutex
+        std::atomic<bool> tracking{false};
+        // Номер набора, в котором ID отмечен последним, — без повторов
+        std::uint32_t generation = 1;
+        DenseIdArray<std::uint32_t> user_marks;
+        DenseIdArray<std::uint32_t> order_marks;
+        std::vector<int> users;
+        std::vector<int> orders;
+    };
+
+    void markUserChanged(int id) const;
+    void markOrderChanged(int id) const;
+    // Под mutex_: начать отсчет заново (tracking) или прекратить его
+    void restartChanges(bool tracking) const;
+
+    mutable std::shared_mutex mutex_;
+    UserTable users_;
+    OrderTable orders_;
+    // Заменяется под mutex_ и text_mutex_; содержимое *text_ меняется
+    // под text_mutex_
+    std::shared_ptr<TextStore> text_;
+    mutable std::mutex text_mutex_;
+    OrderIndex user_orders_;
+    std::shared_ptr<WriteAheadLog> log_;
+    std::shared_ptr<ChangeStream> stream_;
+    // ID выдаются до взятия блокировки
+    std::shared_ptr<IdAllocator> user_ids_;
+    std::shared_ptr<IdAllocator> order_ids_;
+    mutable ChangedIds changes_;
+    // Контрольные точки и дельты записываются по одной
+    mutable std::mutex backup_mutex_;
 };
 
 } // namespace services
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace services {
+
+/**
+ * @brief Массив слотов, индексируемый непосредственно ID
+ *
+ * ID выдаются базой плотно и последовательно, поэтому вместо хеш-таблицы
+ * с отдельным узлом на запись используется трехуровневое разреженное
+ * дерево фиксированной формы (2048 x 1024 x 1024 слотов = весь диапазон
+ * неотрицательных int). Листья по 1024 слота выделяются лениво и не
+ * перемещаются, поиск — два обращения к каталогу и одно к листу, без
+ * хеширования и сравнений ключей.
+ *
+ * Узлы публикуются через CAS, поэтому ensure() безопасен при
+ * конкурентных вызовах, а find()/forEach() можно выполнять без
+ * блокировок параллельно с ними. Сами слоты синхронизирует пользователь.
+ */
+template <typename Slot>
+class DenseIdArray {
+    static constexpr int kLeafBits = 10;
+    static constexpr int kMidBits = 10;
+    static constexpr int kTopBits = 11;
+    static constexpr std::size_t kLeafSize = std::size_t{1} << kLeafBits;
+    static constexpr std::size_t kMidSize = std::size_t{1} << kMidBits;
+    static constexpr std::size_t kTopSize = std::size_t{1} << kTopBits;
+
+    struct Leaf {
+        std::array<Slot, kLeafSize> slots{};
+    };
+
+    struct Mid {
+        std::array<std::atomic<Leaf*>, kMidSize> leaves{};
+    };
+
+public:
+    DenseIdArray() = default;
+    DenseIdArray(const DenseIdArray&) = delete;
+    DenseIdArray& operator=(const DenseIdArray&) = delete;
+
+    ~DenseIdArray() {
+        for (auto& top : top_) {
+            Mid* mid = top.load(std::memory_order_relaxed);
+            if (mid == nullptr) {
+                continue;
+            }
+            for (auto& leaf : mid->leaves) {
+                delete leaf.load(std::memory_order_relaxed);
+            }
+            delete mid;
+        }
+    }
+
+    /**
+     * @brief Слот для id или nullptr, если id < 0 или лист не выделен
+     */
+    Slot* find(int id) const {
+        if (id < 0) {
+            return nullptr;
+        }
+        const auto key = static_cast<std::size_t>(id);
+        Mid* mid = top_[key >> (kLeafBits + kMidBits)].load(std::memory_order_acquire);
+        if (mid == nullptr) {
+            return nullptr;
+        }
+        Leaf* leaf = mid->leaves[(key >> kLeafBits) & (kMidSize - 1)].load(
+            std::memory_order_acquire);
+        if (leaf == nullptr) {
+            return nullptr;
+        }
+        return &leaf->slots[key & (kLeafSize - 1)];
+    }
+
+    /**
+     * @brief Слот для id, при необходимости выделяет лист (id >= 0)
+     */
+    Slot& ensure(int id) {
+        const auto key = static_cast<std::size_t>(id);
+        Mid* mid = install(top_[key >> (kLeafBits + kMidBits)]);
+        Leaf* leaf = install(mid->leaves[(key >> kLeafBits) & (kMidSize - 1)]);
+        return leaf->slots[key & (kLeafSize - 1)];
+    }
+
+    /**
+     * @brief Вызвать visit(id, slot) для всех слотов выделенных листьев
+     *        в порядке возрастания id
+     */
+    template <typename Visitor>
+    void forEach(Visitor&& visit) const {
+        forEachWhile([&visit](int id, Slot& slot) {
+            visit(id, slot);
+            return true;
+        });
+    }
+
+    /**
+     * @brief Как forEach, но начиная с id first; visit(id, slot) возвращает
+     *        bool: false прекращает обход
+     * @return false, если обход прекращен
+     */
+    template <typename Visitor>
+    bool forEachWhile(Visitor&& visit, int first = 0) const {
+        const auto start = static_cast<std::size_t>(std::max(first, 0));
+        const std::size_t first_top = start >> (kLeafBits + kMidBits);
+        const std::size_t first_mid = (start >> kLeafBits) & (kMidSize - 1);
+        for (std::size_t t = first_top; t < kTopSize; ++t) {
+            Mid* mid = top_[t].load(std::memory_order_acquire);
+            if (mid == nullptr) {
+                continue;
+            }
+            for (std::size_t m = t == first_top ? first_mid : 0; m < kMidSize; ++m) {
+                Leaf* leaf = mid->leaves[m].load(std::memory_order_acquire);
+                if (leaf == nullptr) {
+                    continue;
+                }
+                const std::size_t base = (t << (kLeafBits + kMidBits)) | (m << kLeafBits);
+                const bool first_leaf = t == first_top && m == first_mid;
+                for (std::size_t i = first_leaf ? start & (kLeafSize - 1) : 0; i < kLeafSize;
+                     ++i) {
+                    if (!visit(static_cast<int>(base | i), leaf->slots[i])) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Объем памяти каталога и листьев в байтах
+     */
+    std::size_t memoryBytes() const {
+        std::size_t bytes = sizeof(*this);
+        for (const auto& top : top_) {
+            Mid* mid = top.load(std::memory_order_acquire);
+            if (mid == nullptr) {
+                continue;
+            }
+            bytes += sizeof(Mid);
+            for (const auto& leaf : mid->leaves) {
+                if (leaf.load(std::memory_order_acquire) != nullptr) {
+                    bytes += sizeof(Leaf);
+                }
+            }
+        }
+        return bytes;
+    }
+
+private:
+    template <typename Node>
+    static Node* install(std::atomic<Node*>& link) {
+        Node* node = link.load(std::memory_order_acquire);
+        if (node != nullptr) {
+            return node;
+        }
+        Node* fresh = new Node();
+        if (link.compare_exchange_strong(node, fresh, std::memory_order_acq_rel,
+                                         std::memory_order_acquire)) {
+            return fresh;
+        }
+        delete fresh;  // Узел успел установить другой поток
+        return node;
+    }
+
+    std::array<std::atomic<Mid*>, kTopSize> top_{};
+};
+
+} // namespace services
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace services {
+
+/**
+ * @brief CRC-32 (IEEE 802.3) для проверки целостности файлов
+ *
+ * Можно считать по частям: crc32(b, crc32(a)) == crc32(a + b).
+ */
+std::uint32_t crc32(const char* data, std::size_t size, std::uint32_t crc = 0);
+
+/**
+ * @brief Записать size байт целиком, повторяя write после частичной записи
+ */
+bool writeFully(int fd, const char* data, std::size_t size);
+
+/**
+ * @brief Сбросить данные файла на накопитель (fdatasync, F_FULLFSYNC на macOS)
+ */
+bool syncToDisk(int fd);
+
+/**
+ * @brief Номер из имени файла вида <prefix><число><suffix>
+ * @return false, если имя другого вида или в числе больше 18 цифр
+ */
+bool parseNumber(const std::string& name, const std::string& prefix, const std::string& suffix,
+                 std::uint64_t& number);
+
+/**
+ * @brief Файл, отображенный в память для чтения и записи (MAP_SHARED)
+ *
+ * Изменения попадают в страничный кэш сразу и переживают падение
+ * процесса; на накопитель их гарантированно сбрасывает sync().
+ * resize() переотображает файл: прежние указатели на его данные
+ * становятся недействительными, синхронизирует их владелец.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Открыть или создать файл; пустой файл не отображается
+     * @return nullopt, если файл не удалось открыть или отобразить
+     */
+    static std::optional<MappedFile> open(const std::string& path);
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+    ~MappedFile();
+
+    char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    /**
+     * @brief Изменить длину файла; добавленные байты нулевые
+     * @return false, если длину или отображение изменить не удалось;
+     *         тогда прежнее отображение остается действительным
+     */
+    bool resize(std::size_t size);
+
+    /**
+     * @brief Сбросить измененные страницы и длину файла на накопитель
+     */
+    bool sync() const;
+
+private:
+    MappedFile(int fd, char* data, std::size_t size) : fd_(fd), data_(data), size_(size) {}
+
+    int fd_;
+    char* data_;
+    std::size_t size_;
+};
+
+} // namespace services
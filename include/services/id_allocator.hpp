@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace services {
+
+/**
+ * @brief Аллокатор уникальных положительных ID
+ *
+ * Поток арендует у общего атомарного счетчика блок из block_size ID
+ * и дальше выдает их из своего кэша без обращения к разделяемой памяти.
+ * Поэтому выдача ID не сериализует потоки, а один общий аллокатор
+ * можно разделять между несколькими хранилищами (например, шардами).
+ *
+ * Гарантии:
+ * - ID уникальны и положительны;
+ * - после выдачи INT_MAX ID исчерпаны: allocate() возвращает -1;
+ * - в пределах одного потока ID строго возрастают;
+ * - между потоками порядок не гарантирован, возможны пропуски
+ *   (неизрасходованный остаток блока).
+ */
+class IdAllocator {
+public:
+    static constexpr int kDefaultBlockSize = 64;
+
+    /**
+     * @param block_size Размер арендуемого блока (1 — без аренды,
+     *                   каждый ID берется из общего счетчика)
+     */
+    explicit IdAllocator(int block_size = kDefaultBlockSize);
+
+    IdAllocator(const IdAllocator&) = delete;
+    IdAllocator& operator=(const IdAllocator&) = delete;
+
+    /**
+     * @brief Выдать следующий ID
+     * @return ID или -1, если положительные int исчерпаны
+     */
+    int allocate();
+
+    /**
+     * @brief Сдвинуть водяной знак выше id, чтобы этот ID не был выдан
+     *
+     * Нужен при вставке записей с заранее известными ID (загрузка данных).
+     * ID ниже текущего водяного знака может лежать в блоке, уже
+     * арендованном потоком, и из аренды не изымается: allocate() еще
+     * выдаст его. Хранилище, принимающее чужие ID, должно пропускать
+     * занятые ID при выдаче (см. InMemoryDatabase::saveUser).
+     */
+    void advancePast(int id);
+
+    /**
+     * @brief Начать выдачу заново с 1 и аннулировать арендованные блоки
+     */
+    void reset();
+
+    /**
+     * @brief Первый ID, еще не отданный ни в один блок
+     */
+    std::int64_t watermark() const { return next_block_.load(std::memory_order_relaxed); }
+
+    int blockSize() const { return block_size_; }
+
+private:
+    const int block_size_;
+    // Уникален за все время жизни процесса, в отличие от адреса объекта
+    const std::uint64_t uid_;
+    // Шире int: водяной знак после INT_MAX не переполняется
+    std::atomic<std::int64_t> next_block_{1};
+    // Увеличивается при reset(), устаревшие блоки потоков перестают действовать
+    std::atomic<std::uint64_t> generation_{0};
+};
+
+} // namespace services
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "services/database.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace services {
+
+/**
+ * @brief Резервные копии InMemoryDatabase: база и инкрементальные дельты
+ *
+ * Каталог содержит базу base-<n>.ckpt (контрольная точка) и дельты
+ * delta-<n>.log (InMemoryDatabase::saveDelta) — только записи,
+ * измененные с предыдущей копии. Номера файлов растут; база base-<n>
+ * покрывает все дельты с меньшим номером, поэтому восстанавливается
+ * база с наибольшим номером и дельты после нее по порядку.
+ *
+ * merge() сворачивает базу и дельты в новую базу: восстанавливает их
+ * во временную InMemoryDatabase и записывает ее контрольную точку, после
+ * чего прежние файлы удаляются. Файлы появляются атомарным
+ * переименованием, поэтому прерванная копия или свертка не портит
+ * предыдущие.
+ *
+ * Каталог принадлежит одной базе данных: дельта отсчитывается от ее
+ * последней контрольной точки или дельты, поэтому в обход backup() они
+ * не записываются. Методы не вызываются одновременно.
+ */
+class IncrementalBackup {
+public:
+    struct Stats {
+        std::uint64_t base_bytes = 0;
+        std::uint64_t delta_bytes = 0;   // Все дельты после базы
+        std::size_t deltas = 0;
+    };
+
+    /**
+     * @brief Копии в существующем каталоге directory
+     */
+    explicit IncrementalBackup(std::string directory);
+
+    /**
+     * @brief Записать дельту, а если ее не от чего отсчитать — новую базу
+     *
+     * Новая база нужна для первой копии и после clear, bulkLoad или
+     * loadCheckpoint (в том числе после restore); прежние файлы тогда
+     * удаляются.
+     * @return false, если файл не удалось записать
+     */
+    bool backup(InMemoryDatabase& database);
+
+    /**
+     * @brief Свернуть базу и дельты в новую базу
+     * @param threads Потоков загрузки базы; 0 — по числу ядер
+     * @return false, если базы нет, база или дельта повреждена или файлы
+     *         не удалось записать; прежние файлы тогда остаются
+     */
+    bool merge(unsigned threads = 0);
+
+    /**
+     * @brief Заменить содержимое базы данных последней копией
+     *
+     * Файлы копии не изменяются. Дельта с оборванным или поврежденным
+     * кадром — ошибка: пропустить ее значило бы молча потерять изменения.
+     * @param threads Потоков загрузки базы; 0 — по числу ядер
+     * @return false, если базы нет или база или дельта повреждены
+     *         (database тогда не изменяется)
+     */
+    bool restore(InMemoryDatabase& database, unsigned threads = 0) const;
+
+    Stats stats() const;
+
+private:
+    // Номер последней базы (0 — базы нет) и дельт после нее по возрастанию
+    struct Files {
+        std::uint64_t base = 0;
+        std::vector<std::uint64_t> deltas;
+        std::uint64_t last = 0;   // Наибольший номер среди всех файлов
+    };
+
+    Files scan() const;
+    // Удалить базы и дельты с номерами меньше number
+    void removeBefore(std::uint64_t number) const;
+
+    std::string basePath(std::uint64_t number) const;
+    std::string deltaPath(std::uint64_t number) const;
+
+    const std::string directory_;
+};
+
+} // namespace services
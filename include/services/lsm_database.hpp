@@ -0,0 +1,283 @@
+#pragma once
+
+#include "contracts/database_contract.hpp"
+#include "services/dense_id_array.hpp"
+#include "services/id_allocator.hpp"
+#include "services/write_ahead_log.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace services {
+
+/**
+ * @brief Формат отсортированного прогона (run) LSM-дерева
+ *
+ *   Header | Entry[entries] | строки | биты фильтра Блума
+ *
+ * Записи отсортированы по ключу: старшие 32 бита — вид записи
+ * (kUserKind, kOrderKind), младшие — ID. Удаление хранится записью
+ * с флагом kDeleted. Строки записи (имя и email пользователя, название
+ * продукта) лежат подряд в секции строк. Числа — в порядке байт
+ * записавшей машины, он отмечен в заголовке. CRC32 покрывает все
+ * секции после заголовка.
+ */
+namespace lsm_format {
+
+constexpr char kMagic[8] = {'I', 'M', 'D', 'B', 'L', 'S', 'M', 'R'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kByteOrderMark = 0x01020304;
+
+constexpr std::uint32_t kUserKind = 0;
+constexpr std::uint32_t kOrderKind = 1;
+
+constexpr std::uint8_t kDeleted = 1;
+constexpr std::uint8_t kActive = 2;      // User::is_active
+
+inline std::uint64_t makeKey(std::uint32_t kind, int id) {
+    return (std::uint64_t{kind} << 32) | static_cast<std::uint32_t>(id);
+}
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t entries;
+    std::uint64_t text_bytes;
+    std::uint64_t bloom_bytes;
+    std::uint32_t bloom_hashes;
+    std::uint32_t crc;
+};
+
+struct Entry {
+    std::uint64_t key;
+    std::int64_t amount;             // Money::minorUnits заказа
+    std::uint64_t text_offset;
+    std::uint32_t first_size;        // Имя или название продукта
+    std::uint32_t second_size;       // Email
+    std::int32_t user_id;            // Владелец заказа
+    std::uint8_t flags;
+    std::uint8_t status;
+    std::uint8_t padding[2];
+};
+
+static_assert(sizeof(Header) == 48, "layout of run header");
+static_assert(sizeof(Entry) == 40, "layout of run entry");
+
+} // namespace lsm_format
+
+class LsmRun;
+
+/**
+ * @brief Хранилище на LSM-дереве для интенсивной записи
+ *
+ * Изменение — это последовательная дозапись: кадр в журнал
+ * (WriteAheadLog) и вставка в memtable — упорядоченную таблицу
+ * в памяти. Заполненная memtable замораживается и фоновым потоком
+ * пишется одним проходом в неизменяемый отсортированный прогон; новые
+ * изменения идут в новую memtable и новый журнал. Фоновое слияние
+ * объединяет прогоны одного яруса (fanout прогонов близкого размера)
+ * в один, удаления отбрасываются при слиянии с самым старым прогоном.
+ *
+ * Чтение по ID проверяет memtable, замороженную memtable и прогоны
+ * от новых к старым. Прогон отображен в память; фильтр Блума отсеивает
+ * прогоны без ключа, в остальных — бинарный поиск. Ключи (ID живых
+ * записей и владельцы заказов) и индекс заказов пользователей хранятся
+ * в памяти и восстанавливаются при open() из прогонов и журналов,
+ * поэтому поиск отсутствующей записи не читает прогоны, а update*
+ * и delete* не читают прежнюю запись.
+ *
+ * Набор прогонов и номер действующего журнала записаны в MANIFEST,
+ * который заменяется атомарно; файлы, не попавшие в него (прерванные
+ * сброс или слияние), удаляются при открытии. Прогон собирается
+ * в памяти и пишется целиком.
+ *
+ * Изменения берут эксклюзивную mutex_, чтение — разделяемую. Если
+ * memtable заполнилась, а предыдущая еще не сброшена, писатель ждет.
+ */
+class LsmDatabase : public contracts::IDatabase {
+public:
+    struct Options {
+        Durability durability = Durability::Buffered;
+        // Объем memtable, при котором она замораживается и сбрасывается
+        std::size_t memtable_bytes = 4 << 20;
+        unsigned bloom_bits_per_key = 10;
+        // Сколько прогонов одного яруса сливаются в один
+        unsigned fanout = 4;
+    };
+
+    struct Stats {
+        std::uint64_t logical_bytes = 0;     // Принято изменений (кадры журнала)
+        std::uint64_t flushed_bytes = 0;     // Записано сбросами memtable
+        std::uint64_t compacted_bytes = 0;   // Записано слияниями
+        std::uint64_t flushes = 0;
+        std::uint64_t compactions = 0;
+        std::size_t runs = 0;
+        std::uint64_t run_probes = 0;        // Бинарных поисков в прогонах
+        std::uint64_t bloom_skips = 0;       // Прогонов, отсеянных фильтром
+
+        /**
+         * @brief Байт, записанных на диск, на байт принятых изменений
+         *
+         * Журнал пишет каждое изменение один раз, к этому добавляются
+         * сбросы и слияния.
+         */
+        double writeAmplification() const {
+            return logical_bytes == 0
+                       ? 0.0
+                       : 1.0 + static_cast<double>(flushed_bytes + compacted_bytes) /
+                                   static_cast<double>(logical_bytes);
+        }
+    };
+
+    /**
+     * @brief Открыть базу в существующем каталоге и восстановить состояние
+     * @return nullptr, если файлы не удалось открыть или они повреждены
+     */
+    static std::shared_ptr<LsmDatabase> open(const std::string& directory, Options options);
+    static std::shared_ptr<LsmDatabase> open(const std::string& directory) {
+        return open(directory, Options{});
+    }
+
+    LsmDatabase(const LsmDatabase&) = delete;
+    LsmDatabase& operator=(const LsmDatabase&) = delete;
+
+    /**
+     * @brief Останавливает фоновый поток; memtable остается в журнале
+     */
+    ~LsmDatabase() override;
+
+    // Операции с пользователями
+    int saveUser(const contracts::User& user) override;
+    std::optional<contracts::User> findUserById(int id) const override;
+    std::vector<contracts::User> findAllUsers() const override;
+    bool updateUser(const contracts::User& user) override;
+    bool deleteUser(int id) override;
+
+    // Операции с заказами
+    int saveOrder(const contracts::Order& order) override;
+    std::optional<contracts::Order> findOrderById(int id) const override;
+    std::vector<contracts::Order> findOrdersByUserId(int user_id) const override;
+    std::vector<contracts::Order> findAllOrders() const override;
+    bool updateOrder(const contracts::Order& order) override;
+    bool deleteOrder(int id) override;
+
+    // Служебные методы
+    void clear() override;
+
+    /**
+     * @brief Сбросить memtable в прогон и дождаться фоновых слияний
+     * @return false, если сброс или журнал завершились ошибкой
+     */
+    bool flush();
+
+    Stats stats() const;
+
+private:
+    // Изменения одной memtable по ключу (lsm_format::makeKey)
+    using Records = std::map<std::uint64_t, LogRecord>;
+
+    struct Memtable {
+        Records records;
+        std::size_t bytes = 0;
+    };
+
+    // Живая запись и владелец заказа
+    struct KeySlot {
+        int user_id = 0;
+        bool live = false;
+    };
+
+    using OrderIndex = std::unordered_map<int, std::vector<int>>;
+
+    LsmDatabase(std::string directory, Options options);
+
+    // Прочитать MANIFEST, открыть прогоны, восстановить ключи и memtable
+    bool recover();
+
+    // Узел memtable с записью; выделяется до взятия mutex_
+    static Records::node_type makeNode(const LogRecord& record);
+
+    // Под эксклюзивной mutex_: применить изменение к memtable и ключам.
+    // Замененная запись остается в node и освобождается вместе с ним
+    void apply(Records::node_type& node);
+    void applyKey(std::uint32_t kind, int id, bool deleted, int user_id);
+    // Под эксклюзивной mutex_: добавить кадр в журнал, применить изменение
+    // и при необходимости заморозить memtable. log — журнал для commit()
+    // после снятия блокировки; 0 — изменение не принято
+    std::uint64_t write(std::unique_lock<std::shared_mutex>& lock, const std::string& frame,
+                        Records::node_type& node, std::shared_ptr<WriteAheadLog>& log);
+    bool freezeMemtable();
+
+    // Под разделяемой mutex_: последняя версия ключа (Delete* — удалена)
+    std::optional<LogRecord> lookup(std::uint64_t key) const;
+    // Под разделяемой mutex_: visit(const LogRecord&) для живых записей
+    // вида kind по возрастанию ID
+    template <typename Visitor>
+    void scan(std::uint32_t kind, Visitor&& visit) const;
+
+    // Фоновый поток: сброс замороженной memtable и слияния. Вызываются
+    // под mutex_ и отпускают ее на время ввода-вывода
+    void backgroundLoop();
+    bool flushFrozen(std::unique_lock<std::shared_mutex>& lock);
+    bool compactTier(std::unique_lock<std::shared_mutex>& lock);
+    // Прогоны [first, last) одного яруса к слиянию или {0, 0}
+    std::pair<std::size_t, std::size_t> pickCompaction() const;
+
+    // Содержимое MANIFEST для текущего набора прогонов (под mutex_)
+    std::string manifest() const;
+    bool writeManifest(const std::string& content) const;
+
+    // Поддержка индекса user_id -> ID заказов (под эксклюзивной mutex_)
+    void indexOrder(int user_id, int order_id);
+    void unindexOrder(int user_id, int order_id);
+
+    std::string runPath(std::uint64_t number) const;
+    std::string logPath(std::uint64_t generation) const;
+
+    const std::string directory_;
+    const Options options_;
+
+    // Запись MANIFEST; берется до mutex_
+    std::mutex manifest_mutex_;
+    mutable std::shared_mutex mutex_;
+    std::condition_variable_any work_cv_;   // Для фонового потока
+    std::condition_variable_any idle_cv_;   // Сброс или слияние завершены
+    std::shared_ptr<Memtable> memtable_;
+    std::shared_ptr<const Memtable> frozen_;
+    // Прогоны от старых к новым
+    std::vector<std::shared_ptr<const LsmRun>> runs_;
+    std::unique_ptr<DenseIdArray<KeySlot>> users_;
+    std::unique_ptr<DenseIdArray<KeySlot>> orders_;
+    // ID заказов каждого пользователя, отсортированы по возрастанию
+    OrderIndex user_orders_;
+    std::shared_ptr<WriteAheadLog> log_;
+    std::shared_ptr<WriteAheadLog> frozen_log_;
+    std::uint64_t log_generation_ = 0;
+    // Старейший журнал с изменениями, которых еще нет в прогонах
+    std::uint64_t first_log_ = 1;
+    std::uint64_t next_run_ = 1;
+    // Меняется в clear(): результат фоновой работы над прежним
+    // содержимым отбрасывается
+    std::uint64_t epoch_ = 0;
+    bool compacting_ = false;
+    bool stop_ = false;
+    bool failed_ = false;
+    Stats stats_;
+    mutable std::atomic<std::uint64_t> run_probes_{0};
+    mutable std::atomic<std::uint64_t> bloom_skips_{0};
+    std::shared_ptr<IdAllocator> user_ids_;
+    std::shared_ptr<IdAllocator> order_ids_;
+    std::thread worker_;
+};
+
+} // namespace services
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "contracts/database_contract.hpp"
+#include "services/file_io.hpp"
+#include "services/id_allocator.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace services {
+
+/**
+ * @brief Формат файлов MappedDatabase
+ *
+ * База — каталог из четырех файлов, каждый начинается с Header:
+ *
+ *   users.dat        Header | UserSlot[ID]
+ *   orders.dat       Header | OrderSlot[ID]
+ *   user_orders.dat  Header | UserOrdersSlot[user_id]
+ *   strings.dat      Header | строки подряд
+ *
+ * Слот записи адресуется прямо ее ID (у пользователей и заказов слот 0
+ * не используется), пустой слот — нулевой. Строки записей лежат в куче
+ * strings.dat и задаются смещением от конца заголовка и длиной. Заказы каждого пользователя
+ * связаны двусвязным списком по возрастанию ID: голова и хвост —
+ * в user_orders.dat, ссылки — в слотах заказов. Числа — в порядке байт
+ * записавшей машины, он отмечен в заголовке.
+ */
+namespace mapped_format {
+
+constexpr char kUsersMagic[8] = {'I', 'M', 'D', 'B', 'U', 'S', 'E', 'R'};
+constexpr char kOrdersMagic[8] = {'I', 'M', 'D', 'B', 'O', 'R', 'D', 'R'};
+constexpr char kUserOrdersMagic[8] = {'I', 'M', 'D', 'B', 'U', 'I', 'D', 'X'};
+constexpr char kStringsMagic[8] = {'I', 'M', 'D', 'B', 'T', 'E', 'X', 'T'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kByteOrderMark = 0x01020304;
+
+// Флаг слота: запись существует. Ставится последним при записи
+constexpr std::uint8_t kLive = 1;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t record_size;   // Размер слота, 1 у кучи строк
+    std::uint32_t reserved;
+    std::uint64_t used;          // Слоты: наибольший выданный ID; куча: занято байт
+};
+
+struct UserSlot {
+    std::uint64_t text_offset;   // Имя, за ним сразу email
+    std::uint32_t name_size;
+    std::uint32_t email_size;
+    std::uint8_t flags;
+    std::uint8_t is_active;
+    std::uint8_t padding[6];
+};
+
+struct OrderSlot {
+    std::uint64_t product_offset;
+    std::int64_t amount;         // Money::minorUnits
+    std::int32_t user_id;
+    std::uint32_t product_size;
+    std::int32_t prev;           // Соседние заказы пользователя, 0 — нет
+    std::int32_t next;
+    std::uint8_t flags;
+    std::uint8_t status;
+    std::uint8_t padding[6];
+};
+
+struct UserOrdersSlot {
+    std::int32_t first;
+    std::int32_t last;
+};
+
+static_assert(sizeof(Header) == 32, "layout of mapped file header");
+static_assert(sizeof(UserSlot) == 24, "layout of mapped user slot");
+static_assert(sizeof(OrderSlot) == 40, "layout of mapped order slot");
+static_assert(sizeof(UserOrdersSlot) == 8, "layout of mapped user orders slot");
+
+} // namespace mapped_format
+
+/**
+ * @brief Хранилище в файлах, отображенных в память
+ *
+ * Записи лежат в слотах фиксированного размера, адресуемых ID, поэтому
+ * findUserById/findOrderById — чтение из страничного кэша без
+ * промежуточных структур, а запуск не требует фазы загрузки: open()
+ * отображает файлы и проверяет заголовки, аллокаторы ID продолжают
+ * после наибольшего сохраненного ID.
+ *
+ * Изменения пишутся прямо в отображение и переживают падение процесса;
+ * слот помечается существующим после записи его строк и полей. На
+ * накопитель изменения гарантированно попадают после sync().
+ *
+ * open() один раз последовательно проходит слоты и отвергает файлы,
+ * чьи живые записи ссылаются за пределы кучи строк, имеют статус вне
+ * OrderStatus или user_id за файлом списков: дальше чтения доверяют
+ * слотам без проверок. Списки заказов, которые выходят за выданные ID,
+ * зациклены или расходятся с живыми слотами (падение посреди изменения
+ * списка), open() не отвергает, а строит заново из живых слотов.
+ *
+ * Строки не освобождаются до clear(): замененные имена и названия
+ * остаются в куче. Одинаковые названия продуктов, записанные за время
+ * работы процесса, хранятся один раз. Заказы принимаются только
+ * с 0 <= user_id <= наибольшего выданного ID пользователя: user_id
+ * адресует слот списка заказов, и произвольный ID растил бы
+ * user_orders.dat до гигабайт.
+ *
+ * Все операции берут mutex_ (разделяемо для чтения, эксклюзивно для
+ * изменений): рост файла переотображает его.
+ */
+class MappedDatabase : public contracts::IDatabase {
+public:
+    /**
+     * @brief Открыть базу в существующем каталоге, создав недостающие файлы
+     * @return nullptr, если файлы не удалось открыть или они не являются
+     *         файлами этой базы
+     */
+    static std::shared_ptr<MappedDatabase> open(const std::string& directory);
+
+    // Операции с пользователями
+    int saveUser(const contracts::User& user) override;
+    std::optional<contracts::User> findUserById(int id) const override;
+    std::vector<contracts::User> findAllUsers() const override;
+    bool updateUser(const contracts::User& user) override;
+    bool deleteUser(int id) override;
+
+    // Операции с заказами
+    int saveOrder(const contracts::Order& order) override;
+    std::optional<contracts::Order> findOrderById(int id) const override;
+    std::vector<contracts::Order> findOrdersByUserId(int user_id) const override;
+    std::vector<contracts::Order> findAllOrders() const override;
+    bool updateOrder(const contracts::Order& order) override;
+    bool deleteOrder(int id) override;
+
+    // Служебные методы
+    void clear() override;
+
+    /**
+     * @brief Сбросить все файлы на накопитель
+     */
+    bool sync() const;
+
+private:
+    MappedDatabase(MappedFile users, MappedFile orders, MappedFile user_orders,
+                   MappedFile strings);
+
+    // Подготовить пустой файл (записать заголовок) или проверить существующий
+    static bool initialize(MappedFile& file, const char (&magic)[8],
+                           std::uint32_t record_size);
+
+    // Проверить живые слоты: строки в куче, статус, user_id в файле списков
+    bool validate() const;
+
+    // Списки заказов согласованы со слотами (см. описание класса)
+    bool listsConsistent() const;
+
+    // Построить списки заново из живых слотов (при открытии, до выдачи базы)
+    void rebuildLists();
+
+    std::size_t chainCount() const;
+
+    static mapped_format::Header& header(const MappedFile& file);
+
+    template <typename Slot>
+    static Slot* slots(const MappedFile& file);
+
+    // Слот id или nullptr, если id < 0 или слот за концом файла
+    template <typename Slot>
+    static Slot* slotAt(const MappedFile& file, int id);
+
+    // Вырастить файл, чтобы в нем был слот id (под эксклюзивной mutex_)
+    template <typename Slot>
+    static bool ensureSlot(MappedFile& file, int id);
+
+    // user_id может владеть заказами: не больше наибольшего выданного ID
+    bool acceptsUserId(int user_id) const;
+
+    const mapped_format::UserSlot* liveUser(int id) const;
+    const mapped_format::OrderSlot* liveOrder(int id) const;
+    contracts::User toUser(int id, const mapped_format::UserSlot& slot) const;
+    contracts::Order toOrder(int id, const mapped_format::OrderSlot& slot) const;
+    std::string_view text(std::uint64_t offset, std::size_t size) const;
+
+    // Дописать строки подряд в кучу; false — файл не удалось вырастить
+    bool appendText(std::string_view first, std::string_view second,
+                    std::uint64_t& offset);
+    bool storeProductName(const std::string& name, std::uint64_t& offset);
+
+    // Список заказов пользователя (под эксклюзивной mutex_, слоты выделены)
+    void linkOrder(int user_id, int order_id);
+    void unlinkOrder(int user_id, int order_id);
+
+    mutable std::shared_mutex mutex_;
+    MappedFile users_;
+    MappedFile orders_;
+    MappedFile user_orders_;
+    MappedFile strings_;
+    // Смещения названий, записанных за время работы процесса
+    std::unordered_map<std::string, std::uint64_t> product_offsets_;
+    std::shared_ptr<IdAllocator> user_ids_;
+    std::shared_ptr<IdAllocator> order_ids_;
+};
+
+} // namespace services
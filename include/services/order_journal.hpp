@@ -0,0 +1,154 @@
+#pragma once
+
+#include "contracts/order_contract.hpp"
+#include "services/write_ahead_log.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace services {
+
+/**
+ * @brief Сегментированный журнал событий заказов
+ *
+ * Заказ сохраняется один раз целиком (PutOrder при создании), а смены
+ * статуса — короткими событиями SetOrderStatus (14 байт вместо полной
+ * записи с названием продукта). События дописываются в активный сегмент
+ * segment-<n>.log (формат кадров WriteAheadLog, та же групповая
+ * фиксация); заполненный сегмент закрывается и начинается следующий.
+ *
+ * Фоновый поток сворачивает закрытые сегменты вместе с прежней базой
+ * в новую базу base-<n>.log: по одной записи PutOrder с последним
+ * состоянием на каждый живой заказ, удаленные заказы отбрасываются.
+ * База base-<n> покрывает все сегменты с номером меньше n и появляется
+ * атомарным переименованием, поэтому при открытии берется база
+ * с наибольшим номером, а старые файлы удаляются. Свертка читает
+ * только закрытые файлы: дозапись берет mutex_ лишь на копирование
+ * кадра в буфер и на смену сегмента, а свертка — на замену списка
+ * файлов.
+ *
+ * Свертка запускается, когда закрытые сегменты занимают не меньше
+ * compaction_ratio от размера базы (но хотя бы один сегмент): так на
+ * диске живет ограниченное число устаревших событий, а переписывание
+ * базы остается амортизированно O(1) на событие.
+ */
+class OrderJournal {
+public:
+    struct Options {
+        Durability durability = Durability::Buffered;
+        // Размер, при котором сегмент закрывается
+        std::size_t segment_bytes = 4 << 20;
+        // Закрытых сегментов относительно базы, при котором идет свертка
+        double compaction_ratio = 1.0;
+    };
+
+    struct Stats {
+        std::uint64_t appended_bytes = 0;    // Кадры событий
+        std::uint64_t compacted_bytes = 0;   // Записано свертками в базы
+        std::uint64_t disk_bytes = 0;        // База и сегменты сейчас
+        std::uint64_t events = 0;
+        std::uint64_t compactions = 0;
+        std::size_t segments = 0;            // Закрытые и активный
+
+        /**
+         * @brief Байт, записанных на диск, на байт событий
+         */
+        double writeAmplification() const {
+            return appended_bytes == 0
+                       ? 0.0
+                       : static_cast<double>(appended_bytes + compacted_bytes) /
+                             static_cast<double>(appended_bytes);
+        }
+    };
+
+    /**
+     * @brief Открыть журнал в существующем каталоге
+     * @return nullptr, если файлы не удалось открыть или каталога нет
+     */
+    static std::shared_ptr<OrderJournal> open(const std::string& directory, Options options);
+    static std::shared_ptr<OrderJournal> open(const std::string& directory) {
+        return open(directory, Options{});
+    }
+
+    OrderJournal(const OrderJournal&) = delete;
+    OrderJournal& operator=(const OrderJournal&) = delete;
+
+    /**
+     * @brief Останавливает свертку и записывает буфер активного сегмента
+     */
+    ~OrderJournal();
+
+    /**
+     * @brief Сохранить заказ целиком (создание или замена)
+     * @return false, если журнал не принял или не сохранил запись
+     */
+    bool recordOrder(const contracts::Order& order);
+    bool recordStatus(int id, contracts::OrderStatus status);
+    bool recordDeleted(int id);
+
+    /**
+     * @brief Последнее состояние живых заказов по возрастанию ID
+     *
+     * Читает базу и все сегменты; для восстановления при запуске
+     * (например, InMemoryDatabase::bulkLoad).
+     */
+    std::vector<contracts::Order> load() const;
+
+    /**
+     * @brief Закрыть активный сегмент и дождаться свертки
+     * @return false, если свертка завершилась ошибкой
+     */
+    bool compact();
+
+    Stats stats() const;
+
+private:
+    // Закрытый сегмент: журнал держится, пока из буфера не записаны
+    // кадры, фиксируемые после смены сегмента
+    struct Segment {
+        std::uint64_t number = 0;
+        std::uint64_t bytes = 0;
+        std::shared_ptr<WriteAheadLog> log;
+    };
+
+    OrderJournal(std::string directory, Options options);
+
+    bool recover();
+    bool append(const LogRecord& record);
+    // Под mutex_: закрыть активный сегмент и открыть следующий
+    bool rollSegment();
+    bool compactionDue() const;
+
+    void compactionLoop();
+    // Под mutex_, отпускает ее на время свертки
+    bool compactSealed(std::unique_lock<std::mutex>& lock);
+
+    std::string segmentPath(std::uint64_t number) const;
+    std::string basePath(std::uint64_t number) const;
+
+    const std::string directory_;
+    const Options options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;   // Для потока свертки
+    std::condition_variable idle_cv_;   // Свертка завершена
+    std::shared_ptr<WriteAheadLog> active_;
+    std::uint64_t active_number_ = 1;
+    std::uint64_t active_bytes_ = 0;
+    std::vector<Segment> sealed_;
+    std::uint64_t base_number_ = 0;     // 0 — базы нет
+    std::uint64_t base_bytes_ = 0;
+    bool compacting_ = false;
+    bool requested_ = false;            // compact(): свернуть без учета порога
+    bool stop_ = false;
+    bool failed_ = false;
+    Stats stats_;
+    std::thread worker_;
+};
+
+} // namespace services
@@ -3,7 +3,11 @@
 #include "contracts/order_contract.hpp"
 #include "contracts/user_contract.hpp"
 #include "contracts/database_contract.hpp"
+#include "services/order_journal.hpp"
+#include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
 
 namespace services {
 
@@ -12,26 +16,57 @@ namespace services {
  * 
  * Реализует контракт IOrderService. Зависит от IUserService
  * для проверки существования пользователя при создании заказа.
+ *
+ * Если передан журнал, созданный заказ сохраняется в него целиком,
+ * а смены статуса — короткими событиями. Изменение заказа в базе и его
+ * событие идут под одной блокировкой из набора по ID заказа, поэтому
+ * события одного заказа лежат в журнале в порядке изменений. Смена
+ * статуса может опередить запись о создании (заказ уже виден в базе),
+ * поэтому createOrder записывает текущее состояние заказа, а не исходное.
+ *
+ * Изменение, уже сохраненное в базе, считается выполненным, даже если
+ * журнал его не принял (иначе повтор createOrder создал бы дубликат):
+ * о сбое сообщает journalFailed(), журнал с этого момента отстает.
  */
 class OrderService : public contracts::IOrderService {
 public:
     OrderService(std::shared_ptr<contracts::IDatabase> database,
-                 std::shared_ptr<contracts::IUserService> userService);
+                 std::shared_ptr<contracts::IUserService> userService,
+                 std::shared_ptr<OrderJournal> journal = nullptr);
 
-    int createOrder(int user_id, const std::string& product_name, double amount) override;
+    int createOrder(int user_id, const std::string& product_name, contracts::Money amount) override;
     std::optional<contracts::Order> getOrder(int id) const override;
     std::vector<contracts::Order> getUserOrders(int user_id) const override;
+    std::vector<contracts::Order> getUserOrders(
+        int user_id, const contracts::PageRequest& page) const override;
+    std::vector<contracts::OrderSummary> getUserOrderSummaries(int user_id) const override;
     bool updateOrderStatus(int id, contracts::OrderStatus status) override;
     bool cancelOrder(int id) override;
+    contracts::Money getTotal(int user_id) const override;
     double getTotalAmount(int user_id) const override;
 
+    /**
+     * @brief Журнал не сохранил хотя бы одно событие
+     */
+    bool journalFailed() const { return journal_failed_.load(); }
+
 private:
+    static constexpr std::size_t kOrderLocks = 64;
+
     std::shared_ptr<contracts::IDatabase> database_;
     std::shared_ptr<contracts::IUserService> userService_;
+    std::shared_ptr<OrderJournal> journal_;
+    std::array<std::mutex, kOrderLocks> order_locks_;
+    std::atomic<bool> journal_failed_{false};
+
+    // Блокировка заказа id на время изменения и записи события;
+    // без журнала — пустая
+    std::unique_lock<std::mutex> lockForJournal(int id);
+    void journaled(bool recorded);
 
     // Валидация согласно контракту
     bool isValidProductName(const std::string& name) const;
-    bool isValidAmount(double amount) const;
+    bool isValidAmount(contracts::Money amount) const;
     bool canCancel(contracts::OrderStatus status) const;
 };
 
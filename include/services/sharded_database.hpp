@@ -0,0 +1,77 @@
+#pragma once
+
+#include "contracts/database_contract.hpp"
+#include "services/database.hpp"
+#include "services/id_allocator.hpp"
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+namespace services {
+
+/**
+ * @brief Шардированная in-memory база данных
+ *
+ * Пользователи и заказы распределяются по независимым шардам
+ * (shard = id % shard_count), у каждого шарда своя блокировка.
+ * Операции над разными шардами не конкурируют между собой, поэтому
+ * пропускная способность растет с числом ядер.
+ *
+ * Каждый шард — обычный InMemoryDatabase, а ID выдаются общими
+ * для всех шардов аллокаторами IdAllocator, поэтому они уникальны
+ * во всей базе. clear() очищает шарды под эксклюзивной clear_mutex_,
+ * которую save* берут на чтение, поэтому выдача ID не пересекается
+ * со сбросом аллокаторов.
+ */
+class ShardedDatabase : public contracts::IDatabase {
+public:
+    static constexpr std::size_t kDefaultShardCount = 16;
+
+    /**
+     * @param shard_count Количество шардов (0 трактуется как 1)
+     */
+    explicit ShardedDatabase(std::size_t shard_count = kDefaultShardCount);
+
+    // Операции с пользователями
+    int saveUser(const contracts::User& user) override;
+    std::optional<contracts::User> findUserById(int id) const override;
+    std::vector<contracts::User> findAllUsers() const override;
+    bool updateUser(const contracts::User& user) override;
+    bool deleteUser(int id) override;
+
+    // Операции с заказами
+    int saveOrder(const contracts::Order& order) override;
+    std::optional<contracts::Order> findOrderById(int id) const override;
+    std::vector<contracts::Order> findOrdersByUserId(int user_id) const override;
+    std::vector<contracts::Order> findAllOrders() const override;
+    bool updateOrder(const contracts::Order& order) override;
+    bool deleteOrder(int id) override;
+
+    /**
+     * @brief Агрегаты шардов, объединенные без копий записей
+     */
+    contracts::OrderAggregate aggregateOrders(const contracts::OrderQuery& query) const override;
+
+    // Служебные методы
+    void clear() override;
+
+    std::size_t shardCount() const { return shards_.size(); }
+
+    /**
+     * @brief Индекс шарда, в котором хранится запись с данным ID
+     */
+    std::size_t shardIndex(int id) const;
+
+private:
+    InMemoryDatabase& shardFor(int id);
+    const InMemoryDatabase& shardFor(int id) const;
+
+    std::vector<std::unique_ptr<InMemoryDatabase>> shards_;
+    std::shared_ptr<IdAllocator> user_ids_;
+    std::shared_ptr<IdAllocator> order_ids_;
+    // Выделение ID и вставка (на чтение) против clear() (эксклюзивно)
+    std::shared_mutex clear_mutex_;
+};
+
+} // namespace services
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "contracts/database_contract.hpp"
+#include "services/id_allocator.hpp"
+#include "services/write_ahead_log.hpp"
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace services {
+
+/**
+ * @brief Хранилище во встроенной базе SQLite
+ *
+ * Таблицы users и orders с первичным ключом id, индекс заказов по
+ * (user_id, id) для findOrdersByUserId; сумма хранится в копейках
+ * (Money::minorUnits). aggregateOrders считается запросом SQL (COUNT,
+ * SUM, MIN, MAX с условиями запроса в WHERE) без чтения строк заказов.
+ * ID выдаются IdAllocator до взятия блокировки и продолжаются после
+ * наибольших сохраненных при открытии.
+ *
+ * Все запросы подготавливаются один раз при открытии и переиспользуются
+ * (sqlite3_reset), SQL не разбирается на каждом вызове. Журнал SQLite —
+ * в режиме WAL: фиксация дописывает страницы в файл -wal вместо
+ * копирования прежних в журнал отката.
+ *
+ * Изменения идут пакетами: первое открывает транзакцию, она фиксируется
+ * после batch_size изменений, при flush() и при закрытии базы. Чтения
+ * идут в том же соединении и видят незафиксированные изменения пакета.
+ * Durability задает, когда изменение переживает сбой:
+ * - Buffered — после фиксации пакета, synchronous=OFF;
+ * - Written — каждое изменение фиксируется сразу, synchronous=OFF
+ *   (переживает падение процесса, но не ОС);
+ * - Synced — каждое изменение фиксируется сразу, synchronous=FULL.
+ *
+ * Соединение одно, операции сериализуются mutex_. Если фиксация пакета
+ * не удалась, база перестает принимать изменения (-1 у save*, false
+ * у остальных).
+ */
+class SqliteDatabase : public contracts::IDatabase {
+public:
+    struct Options {
+        Durability durability = Durability::Buffered;
+        // Изменений в одной транзакции (Buffered)
+        std::size_t batch_size = 256;
+    };
+
+    /**
+     * @brief Открыть или создать базу в файле path
+     * @return nullptr, если файл не открылся или схема не создалась
+     */
+    static std::shared_ptr<SqliteDatabase> open(const std::string& path, Options options);
+    static std::shared_ptr<SqliteDatabase> open(const std::string& path) {
+        return open(path, Options{});
+    }
+
+    SqliteDatabase(const SqliteDatabase&) = delete;
+    SqliteDatabase& operator=(const SqliteDatabase&) = delete;
+
+    /**
+     * @brief Фиксирует открытый пакет и закрывает соединение
+     */
+    ~SqliteDatabase() override;
+
+    // Операции с пользователями
+    int saveUser(const contracts::User& user) override;
+    std::optional<contracts::User> findUserById(int id) const override;
+    std::vector<contracts::User> findAllUsers() const override;
+    bool updateUser(const contracts::User& user) override;
+    bool deleteUser(int id) override;
+
+    // Операции с заказами
+    int saveOrder(const contracts::Order& order) override;
+    std::optional<contracts::Order> findOrderById(int id) const override;
+    std::vector<contracts::Order> findOrdersByUserId(int user_id) const override;
+    std::vector<contracts::Order> findAllOrders() const override;
+    bool updateOrder(const contracts::Order& order) override;
+    bool deleteOrder(int id) override;
+
+    // Запросы с условиями
+    contracts::OrderAggregate aggregateOrders(const contracts::OrderQuery& query) const override;
+
+    // Служебные методы
+    void clear() override;
+
+    /**
+     * @brief Зафиксировать открытый пакет изменений
+     * @return false, если фиксация не удалась
+     */
+    bool flush();
+
+private:
+    // Подготовленные запросы; порядок совпадает с текстами в kStatementSql
+    enum Statement {
+        kBegin,
+        kCommit,
+        kInsertUser,
+        kSelectUser,
+        kSelectAllUsers,
+        kUpdateUser,
+        kDeleteUser,
+        kInsertOrder,
+        kSelectOrder,
+        kSelectUserOrders,
+        kSelectAllOrders,
+        kUpdateOrder,
+        kDeleteOrder,
+        kClearUsers,
+        kClearOrders,
+        kMaxUserId,
+        kMaxOrderId,
+        kAggregateOrders,
+        kAggregateUserOrders,
+        kStatementCount,
+    };
+
+    SqliteDatabase(sqlite3* connection, Options options);
+
+    bool prepareStatements();
+    // Подготовленный запрос; выполняется под mutex_ и сбрасывается после него
+    sqlite3_stmt* statement(Statement which) const;
+
+    // Под mutex_: выполнить изменение в пакете. false — запрос не
+    // выполнился или не затронул строк
+    template <typename Bind>
+    bool write(Statement which, Bind&& bind);
+    // Под mutex_: открыть транзакцию пакета, если она еще не открыта
+    bool beginBatch();
+    // Под mutex_: зафиксировать пакет; при ошибке база перестает
+    // принимать изменения
+    bool commitBatch();
+
+    sqlite3* connection_;
+    const Options options_;
+    std::array<sqlite3_stmt*, kStatementCount> statements_{};
+
+    mutable std::mutex mutex_;
+    std::size_t pending_ = 0;       // Изменений в открытом пакете
+    bool in_batch_ = false;
+    bool failed_ = false;
+    // ID выдаются до взятия блокировки
+    std::shared_ptr<IdAllocator> user_ids_;
+    std::shared_ptr<IdAllocator> order_ids_;
+};
+
+} // namespace services
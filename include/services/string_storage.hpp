@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace services {
+
+/**
+ * @brief Куча строк, выделяемых блоками
+ *
+ * Строки копируются подряд в крупные блоки вместо отдельного выделения
+ * на каждую. Сохраненная строка не перемещается и не освобождается
+ * до уничтожения арены, поэтому string_view на нее можно читать
+ * без синхронизации. Отдельные строки не освобождаются.
+ *
+ * Не потокобезопасна: store() синхронизирует владелец.
+ */
+class StringArena {
+public:
+    static constexpr std::size_t kBlockSize = 16 * 1024;
+
+    StringArena() = default;
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    /**
+     * @brief Скопировать text в арену
+     * @return Представление копии (пустое для пустой строки)
+     */
+    std::string_view store(std::string_view text);
+
+    /**
+     * @brief Байты, занятые сохраненными строками
+     */
+    std::size_t bytesUsed() const { return used_; }
+
+    /**
+     * @brief Байты, выделенные под блоки
+     */
+    std::size_t bytesReserved() const { return reserved_; }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* cursor_ = nullptr;
+    std::size_t left_ = 0;
+    std::size_t used_ = 0;
+    std::size_t reserved_ = 0;
+};
+
+/**
+ * @brief Пул уникальных строк (интернирование)
+ *
+ * Каждая различная строка хранится один раз, intern() возвращает
+ * одно и то же представление для равных строк. Подходит для значений
+ * с небольшим числом различных вариантов (названия продуктов).
+ * Строки живут до уничтожения пула.
+ *
+ * Не потокобезопасен: intern() синхронизирует владелец.
+ */
+class StringInterner {
+public:
+    StringInterner() = default;
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    std::string_view intern(std::string_view text);
+
+    /**
+     * @brief Найти уже интернированную строку, не меняя пул
+     *
+     * Как и другие const-методы, безопасен из нескольких потоков,
+     * пока никто не вызывает intern().
+     * @return Представление из пула или nullopt
+     */
+    std::optional<std::string_view> find(std::string_view text) const;
+
+    /**
+     * @brief Количество различных строк
+     */
+    std::size_t size() const { return strings_.size(); }
+
+    /**
+     * @brief Приблизительный объем памяти: арена и хеш-таблица
+     */
+    std::size_t memoryBytes() const;
+
+private:
+    StringArena arena_;
+    std::unordered_set<std::string_view> strings_;
+};
+
+} // namespace services
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "contracts/database_contract.hpp"
+#include "services/database.hpp"
+#include "services/dense_id_array.hpp"
+#include "services/id_allocator.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace services {
+
+/**
+ * @brief Формат записи холодного сегмента
+ *
+ *   Record | название продукта
+ *
+ * Числа — в порядке байт записавшей машины: сегменты живут только пока
+ * открыта база.
+ */
+namespace cold_format {
+
+struct Record {
+    std::int64_t amount;         // Money::minorUnits
+    std::int32_t id;
+    std::int32_t user_id;
+    std::uint32_t name_size;
+    std::uint8_t status;
+    std::uint8_t padding[3];
+};
+
+static_assert(sizeof(Record) == 24, "layout of cold record");
+
+} // namespace cold_format
+
+/**
+ * @brief Хранилище с горячим и холодным ярусами заказов
+ *
+ * Пользователи и активные заказы (PENDING, CONFIRMED, SHIPPED) живут
+ * в горячем ярусе — обычном InMemoryDatabase. Заказ в конечном статусе
+ * (DELIVERED, CANCELLED) при сохранении или обновлении переносится
+ * в холодный ярус: запись дописывается в сегмент cold-<n>.seg, а в памяти
+ * остаются только ее место (12 байт на заказ в DenseIdArray) и ID в списке
+ * холодных заказов пользователя. Смена статуса на активный возвращает
+ * заказ в горячий ярус.
+ *
+ * find* обслуживают оба яруса прозрачно: findOrderById читает холодную
+ * запись одним pread, findOrdersByUserId и findAllOrders объединяют ярусы
+ * по возрастанию ID. Записи дописываются в буфер активного сегмента
+ * и пишутся в файл блоками; заполненный сегмент закрывается для записи.
+ *
+ * Холодный ярус — продолжение памяти, а не долговременное хранилище:
+ * сегменты удаляются при открытии и закрытии базы. Когда замененные
+ * и удаленные холодные записи занимают больше половины живых (и не меньше
+ * compact_min_dead_bytes), живые записи переписываются в новые сегменты
+ * под эксклюзивной mutex_, а прежние удаляются.
+ *
+ * ID выдаются общими с горячим ярусом аллокаторами. Изменения заказов
+ * внутри горячего яруса и чтение берут mutex_ на чтение, перенос между
+ * ярусами и изменения холодных записей — эксклюзивно, поэтому читатель
+ * никогда не видит заказ в обоих ярусах или ни в одном.
+ */
+class TieredDatabase : public contracts::IDatabase {
+public:
+    struct Options {
+        // Размер, при котором сегмент закрывается
+        std::size_t segment_bytes = 64 << 20;
+        // Буфер активного сегмента; записи из него читаются из памяти
+        std::size_t write_buffer_bytes = 64 << 10;
+        // Мертвые байты, меньше которых сегменты не сжимаются
+        std::uint64_t compact_min_dead_bytes = 16 << 20;
+    };
+
+    struct Stats {
+        std::size_t cold_orders = 0;
+        std::size_t cold_index_bytes = 0;     // Память индекса холодного яруса
+        std::uint64_t cold_disk_bytes = 0;    // Сегменты вместе с буфером
+        std::uint64_t cold_dead_bytes = 0;    // Замененные и удаленные записи
+        std::uint64_t migrations = 0;         // Переносов в холодный ярус
+        std::uint64_t compactions = 0;        // Сжатий сегментов
+        std::size_t segments = 0;
+    };
+
+    /**
+     * @brief Открыть базу с сегментами в существующем каталоге
+     *
+     * Сегменты, оставшиеся от прежнего запуска, удаляются.
+     * @return nullptr, если каталога нет или сегмент не создался
+     */
+    static std::shared_ptr<TieredDatabase> open(const std::string& directory, Options options);
+    static std::shared_ptr<TieredDatabase> open(const std::string& directory) {
+        return open(directory, Options{});
+    }
+
+    TieredDatabase(const TieredDatabase&) = delete;
+    TieredDatabase& operator=(const TieredDatabase&) = delete;
+
+    /**
+     * @brief Закрывает и удаляет сегменты
+     */
+    ~TieredDatabase() override;
+
+    // Операции с пользователями
+    int saveUser(const contracts::User& user) override;
+    std::optional<contracts::User> findUserById(int id) const override;
+    std::vector<contracts::User> findAllUsers() const override;
+    bool updateUser(const contracts::User& user) override;
+    bool deleteUser(int id) override;
+
+    // Операции с заказами
+    int saveOrder(const contracts::Order& order) override;
+    std::optional<contracts::Order> findOrderById(int id) const override;
+    std::vector<contracts::Order> findOrdersByUserId(int user_id) const override;
+    std::vector<contracts::Order> findAllOrders() const override;
+    bool updateOrder(const contracts::Order& order) override;
+    bool deleteOrder(int id) override;
+
+    void scanUsers(const UserVisitor& visit) const override;
+    std::vector<contracts::User> findActiveUsersPage(
+        const contracts::PageRequest& page) const override;
+    std::vector<contracts::User> findUsers(const contracts::UserQuery& query) const override;
+    std::vector<contracts::Order> findOrders(const contracts::OrderQuery& query) const override;
+    std::vector<contracts::OrderSummary> findOrderSummaries(
+        const contracts::OrderQuery& query) const override;
+    std::optional<bool> findUserActive(int id) const override;
+    // Холодные записи читаются с диска: агрегат по ним копирует их
+    contracts::OrderAggregate aggregateOrders(const contracts::OrderQuery& query) const override;
+
+    // Служебные методы
+    void clear() override;
+
+    /**
+     * @brief Статус, с которым заказ хранится в холодном ярусе
+     */
+    static bool isCold(contracts::OrderStatus status) {
+        return status == contracts::OrderStatus::DELIVERED ||
+               status == contracts::OrderStatus::CANCELLED;
+    }
+
+    Stats stats() const;
+
+private:
+    // Место холодной записи; segment == 0 — заказа в холодном ярусе нет
+    struct ColdSlot {
+        std::uint32_t segment = 0;
+        std::uint32_t offset = 0;
+        std::uint32_t size = 0;
+    };
+
+    struct Segment {
+        int fd = -1;
+        std::uint64_t file_bytes = 0;   // Записано в файл; дальше — буфер
+    };
+
+    TieredDatabase(std::string directory, Options options);
+
+    static std::string encode(const contracts::Order& order);
+
+    // Под mutex_: место заказа в холодном ярусе или nullptr
+    const ColdSlot* coldSlot(int id) const;
+    // Под mutex_: прочитать холодную запись
+    std::optional<contracts::Order> readCold(const ColdSlot& slot) const;
+    // Под mutex_: дописать в result холодные заказы пользователя
+    void appendColdOrdersOf(int user_id, std::vector<contracts::Order>& result) const;
+    // Под mutex_: холодные заказы, подходящие под query, в любом порядке
+    std::vector<contracts::Order> findColdOrders(const contracts::OrderQuery& query) const;
+    // Под mutex_: все живые холодные заказы в порядке сегментов
+    std::vector<contracts::Order> scanCold() const;
+
+    // Под эксклюзивной mutex_: дописать запись и указать на нее индекс
+    bool appendCold(int id, int user_id, const std::string& record);
+    // Под эксклюзивной mutex_: убрать заказ из холодного индекса
+    void forgetCold(int id);
+    // Под эксклюзивной mutex_: убрать ID из списка владельца; если он
+    // неизвестен (nullopt) — из всех списков
+    void unlinkColdOwner(int id, std::optional<int> user_id);
+    // Под эксклюзивной mutex_: сжать сегменты, если мертвых записей много
+    void compactIfWasteful();
+    // Под эксклюзивной mutex_: переписать живые записи в новые сегменты
+    bool compactCold();
+    bool flushBuffer();
+    bool openSegment();
+    void closeSegments();
+
+    std::string segmentPath(std::uint32_t number) const;
+    // Сегмент, который сжатие переименует в cold-<n>.seg
+    std::string compactPath(std::uint32_t number) const;
+
+    const std::string directory_;
+    const Options options_;
+    std::shared_ptr<IdAllocator> user_ids_;
+    std::shared_ptr<IdAllocator> order_ids_;
+    InMemoryDatabase hot_;
+
+    mutable std::shared_mutex mutex_;
+    std::unique_ptr<DenseIdArray<ColdSlot>> cold_;
+    // Холодные заказы пользователя в порядке переноса
+    std::unordered_map<int, std::vector<int>> cold_by_user_;
+    // segments_[n - 1] — сегмент cold-<n>.seg; последний — активный
+    std::vector<Segment> segments_;
+    std::string buffer_;            // Хвост активного сегмента
+    std::size_t cold_orders_ = 0;
+    std::uint64_t dead_bytes_ = 0;
+    std::uint64_t migrations_ = 0;
+    std::uint64_t compactions_ = 0;
+    bool failed_ = false;           // Буфер не удалось записать
+};
+
+} // namespace services
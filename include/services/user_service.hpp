@@ -19,8 +19,11 @@ public:
     int createUser(const std::string& name, const std::string& email) override;
     std::optional<contracts::User> getUser(int id) const override;
     std::vector<contracts::User> getActiveUsers() const override;
+    std::vector<contracts::User> getActiveUsers(
+        const contracts::PageRequest& page) const override;
     bool deactivateUser(int id) override;
     bool userExists(int id) const override;
+    bool isActive(int id) const override;
 
 private:
     std::shared_ptr<contracts::IDatabase> database_;
@@ -0,0 +1,601 @@
+#pragma once
+
+#include "services/dense_id_array.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace services {
+
+/**
+ * @brief Таблица записей с версиями (MVCC) и снимками для полного обхода
+ *
+ * Каждое изменение записи создает новую неизменяемую версию с меткой
+ * времени фиксации, старая версия остается в цепочке. Снимок (Snapshot)
+ * фиксирует метку времени и обходит таблицу без блокировки владельца:
+ * писатели продолжают работать, а снимок видит согласованное состояние
+ * на момент своего создания.
+ *
+ * Записи лежат в DenseIdArray: слот с цепочкой версий адресуется прямо
+ * по ID, снимок обходит слоты в порядке возрастания ID.
+ *
+ * Модель синхронизации (блокировку держит владелец таблицы):
+ * - insert/update/erase/clear/install/takeGarbage — под эксклюзивной блокировкой;
+ * - find/size — под разделяемой блокировкой;
+ * - prepare/reserve, snapshot()/scan() — без блокировки.
+ *
+ * Критическая секция владельца может обходиться без malloc/free: узел
+ * версии выделяется заранее (prepare), слот — reserve(), а освобожденные
+ * версии копятся в таблице и забираются takeGarbage(), чтобы удалить их
+ * после снятия блокировки. Перегрузки insert/update/erase с Record
+ * делают все это сами под блокировкой.
+ *
+ * Освобождение памяти: замененная версия удаляется, когда не осталось
+ * снимков старше момента ее замены; удаленная запись (надгробие в слоте)
+ * отцепляется от слота и освобождается, когда завершатся все снимки,
+ * которые могли ее видеть. Сам слот остается и переиспользуется при
+ * повторной вставке того же ID.
+ * clear() и install() подменяют все состояние целиком, старое живет,
+ * пока его держат открытые снимки.
+ */
+template <typename Record>
+class VersionedTable {
+    struct Version {
+        Record data;
+        std::uint64_t begin;  // Метка фиксации, с которой версия видна
+        bool deleted;
+        std::atomic<Version*> prev{nullptr};
+
+        Version(Record record, std::uint64_t ts, bool is_deleted, Version* older)
+            : data(std::move(record)), begin(ts), deleted(is_deleted), prev(older) {}
+    };
+
+    struct Slot {
+        std::atomic<Version*> head{nullptr};
+    };
+
+    struct Superseded {
+        Version* newer;
+        Version* older;  // Перестает быть видимой с newer->begin
+    };
+
+    struct Tombstone {
+        Slot* slot;
+        Version* version;
+        std::uint64_t begin;  // Копия: version мог быть уже освобожден
+    };
+
+    struct Unlinked {
+        Version* version;
+        std::uint64_t ticket;  // Снимки с меньшим номером могли прочитать указатель
+    };
+
+    // Очередь на кольцевом буфере: растет до пикового размера и больше
+    // не выделяет память, в отличие от std::deque
+    template <typename T>
+    class RingQueue {
+    public:
+        bool empty() const { return count_ == 0; }
+        std::size_t size() const { return count_; }
+        const T& front() const { return buffer_[head_]; }
+
+        void push_back(const T& value) {
+            if (count_ == buffer_.size()) {
+                grow();
+            }
+            buffer_[(head_ + count_) % buffer_.size()] = value;
+            ++count_;
+        }
+
+        void pop_front() {
+            head_ = (head_ + 1) % buffer_.size();
+            --count_;
+        }
+
+        template <typename F>
+        void forEach(F&& f) const {
+            for (std::size_t i = 0; i < count_; ++i) {
+                f(buffer_[(head_ + i) % buffer_.size()]);
+            }
+        }
+
+    private:
+        void grow() {
+            std::vector<T> bigger(std::max<std::size_t>(16, buffer_.size() * 2));
+            for (std::size_t i = 0; i < count_; ++i) {
+                bigger[i] = buffer_[(head_ + i) % buffer_.size()];
+            }
+            buffer_ = std::move(bigger);
+            head_ = 0;
+        }
+
+        std::vector<T> buffer_;
+        std::size_t head_ = 0;
+        std::size_t count_ = 0;
+    };
+
+    struct State {
+        DenseIdArray<Slot> slots;
+        std::atomic<std::uint64_t> commit_ts{0};
+        std::size_t live = 0;
+
+        // Списки на освобождение (только писатели)
+        RingQueue<Superseded> superseded;
+        RingQueue<Tombstone> tombstones;
+        RingQueue<Unlinked> unlinked;
+        // Версии, которые больше никто не видит, связаны через prev;
+        // удаляются владельцем вне блокировки (takeGarbage)
+        Version* garbage = nullptr;
+
+        // Реестр открытых снимков: номер -> метка времени
+        std::mutex snapshots_mutex;
+        std::map<std::uint64_t, std::uint64_t> active;
+        std::uint64_t next_ticket = 1;
+
+        // Внешние данные, на которые ссылаются записи (см. clear)
+        std::shared_ptr<const void> retained;
+
+        ~State() {
+            slots.forEach([](int, Slot& slot) {
+                freeChain(slot.head.load(std::memory_order_relaxed));
+            });
+            unlinked.forEach([](const Unlinked& entry) { delete entry.version; });
+            freeChain(garbage);
+        }
+    };
+
+    static void freeChain(Version* version) {
+        while (version != nullptr) {
+            Version* prev = version->prev.load(std::memory_order_relaxed);
+            delete version;
+            version = prev;
+        }
+    }
+
+public:
+    /**
+     * @brief Согласованный снимок таблицы на момент создания
+     *
+     * Пока снимок открыт, версии, видимые в нем, не освобождаются.
+     */
+    class Snapshot {
+    public:
+        Snapshot(Snapshot&& other) noexcept
+            : state_(std::move(other.state_)), ts_(other.ts_), ticket_(other.ticket_) {}
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        Snapshot& operator=(Snapshot&&) = delete;
+
+        ~Snapshot() {
+            if (state_) {
+                std::lock_guard<std::mutex> lock(state_->snapshots_mutex);
+                state_->active.erase(ticket_);
+            }
+        }
+
+        /**
+         * @brief Вызвать visit(const Record&) для каждой видимой записи
+         */
+        template <typename Visitor>
+        void forEach(Visitor&& visit) const {
+            forEachWhile([&visit](const Record& record) {
+                visit(record);
+                return true;
+            });
+        }
+
+        /**
+         * @brief Как forEach, но начиная с id first; false из visit
+         *        прекращает обход
+         * @return false, если обход прекращен
+         */
+        template <typename Visitor>
+        bool forEachWhile(Visitor&& visit, int first = 0) const {
+            const std::uint64_t ts = ts_;
+            const auto visible = [ts, &visit](int, const Slot& slot) {
+                const Version* version = slot.head.load(std::memory_order_acquire);
+                while (version != nullptr && version->begin > ts) {
+                    version = version->prev.load(std::memory_order_acquire);
+                }
+                return version == nullptr || version->deleted || visit(version->data);
+            };
+            return state_->slots.forEachWhile(visible, first);
+        }
+
+        /**
+         * @brief Запись id, видимая в снимке, или nullptr
+         */
+        const Record* find(int id) const {
+            const Slot* slot = state_->slots.find(id);
+            if (slot == nullptr) {
+                return nullptr;
+            }
+            const Version* version = slot->head.load(std::memory_order_acquire);
+            while (version != nullptr && version->begin > ts_) {
+                version = version->prev.load(std::memory_order_acquire);
+            }
+            return version != nullptr && !version->deleted ? &version->data : nullptr;
+        }
+
+        std::uint64_t timestamp() const { return ts_; }
+
+    private:
+        friend class VersionedTable;
+
+        explicit Snapshot(std::shared_ptr<State> state) : state_(std::move(state)) {
+            std::lock_guard<std::mutex> lock(state_->snapshots_mutex);
+            ticket_ = state_->next_ticket++;
+            ts_ = state_->commit_ts.load(std::memory_order_acquire);
+            state_->active.emplace(ticket_, ts_);
+        }
+
+        std::shared_ptr<State> state_;
+        std::uint64_t ts_ = 0;
+        std::uint64_t ticket_ = 0;
+    };
+
+    /**
+     * @brief Узел версии, выделенный до взятия блокировки владельца
+     *
+     * Передается в insert/update/erase; при успехе таблица забирает узел,
+     * иначе он освобождается вместе с объектом.
+     */
+    class Prepared {
+    public:
+        Prepared() = default;
+
+        bool empty() const { return !version_; }
+
+        /**
+         * @brief Запись внутри узла, ее можно изменить до вставки
+         */
+        Record& record() { return version_->data; }
+
+    private:
+        friend class VersionedTable;
+
+        explicit Prepared(std::unique_ptr<Version> version) : version_(std::move(version)) {}
+
+        std::unique_ptr<Version> version_;
+    };
+
+    /**
+     * @brief Освобожденные таблицей версии и состояния
+     *
+     * Удаляет их в деструкторе — после снятия блокировки владельца,
+     * если объект объявлен раньше блокировки.
+     */
+    class Garbage {
+    public:
+        Garbage() = default;
+        Garbage(Garbage&& other) noexcept
+            : versions_(std::exchange(other.versions_, nullptr)),
+              state_(std::move(other.state_)) {}
+        Garbage(const Garbage&) = delete;
+        Garbage& operator=(const Garbage&) = delete;
+
+        Garbage& operator=(Garbage&& other) noexcept {
+            if (this != &other) {
+                freeChain(versions_);
+                versions_ = std::exchange(other.versions_, nullptr);
+                state_ = std::move(other.state_);
+            }
+            return *this;
+        }
+
+        ~Garbage() { freeChain(versions_); }
+
+    private:
+        friend class VersionedTable;
+
+        Version* versions_ = nullptr;
+        std::shared_ptr<State> state_;  // Прежнее состояние после clear
+    };
+
+    /**
+     * @brief Содержимое таблицы, построенное отдельно от нее
+     *
+     * Для массовой загрузки: add() с разными ID безопасен из разных
+     * потоков без синхронизации, готовое содержимое подменяет таблицу
+     * целиком через install(). Записи видны всем последующим снимкам.
+     */
+    class Bulk {
+    public:
+        Bulk() : state_(std::make_shared<State>()) {}
+
+        /**
+         * @return false если ID < 0 или запись с таким ID уже добавлена
+         */
+        bool add(int id, Record record) {
+            if (id < 0) {
+                return false;
+            }
+            Slot& slot = state_->slots.ensure(id);
+            auto version = std::make_unique<Version>(std::move(record), 0, false, nullptr);
+            Version* expected = nullptr;
+            if (!slot.head.compare_exchange_strong(expected, version.get(),
+                                                   std::memory_order_relaxed)) {
+                return false;
+            }
+            version.release();
+            return true;
+        }
+
+    private:
+        friend class VersionedTable;
+
+        std::shared_ptr<State> state_;
+    };
+
+    VersionedTable() : state_(std::make_shared<State>()) {}
+
+    VersionedTable(const VersionedTable&) = delete;
+    VersionedTable& operator=(const VersionedTable&) = delete;
+
+    // --- Под разделяемой блокировкой владельца ---
+
+    /**
+     * @brief Актуальная версия записи или nullptr
+     */
+    const Record* find(int id) const {
+        const Version* version = liveHead(*state_, id);
+        return version != nullptr ? &version->data : nullptr;
+    }
+
+    std::size_t size() const { return state_->live; }
+
+    /**
+     * @brief Количество версий, ожидающих освобождения
+     */
+    std::size_t pendingReclaim() const {
+        return state_->superseded.size() + state_->tombstones.size() +
+               state_->unlinked.size();
+    }
+
+    // --- Без блокировки владельца ---
+
+    /**
+     * @brief Выделить узел версии для insert/update (для erase — Record{})
+     */
+    static Prepared prepare(Record record) {
+        return Prepared(std::make_unique<Version>(std::move(record), 0, false, nullptr));
+    }
+
+    /**
+     * @brief Заранее выделить слот для id, чтобы insert не выделял память
+     *
+     * Безопасно параллельно с любыми операциями таблицы.
+     */
+    void reserve(int id) {
+        if (id >= 0) {
+            std::atomic_load(&state_)->slots.ensure(id);
+        }
+    }
+
+    // --- Под эксклюзивной блокировкой владельца ---
+
+    /**
+     * @return false если запись с таким ID уже есть
+     */
+    bool insert(int id, Prepared& prepared) {
+        State& state = *state_;
+        if (id < 0 || liveHead(state, id) != nullptr) {
+            return false;
+        }
+        Slot& slot = state.slots.ensure(id);
+        const std::uint64_t ts = state.commit_ts.load(std::memory_order_relaxed) + 1;
+        // В слоте может остаться надгробие предыдущей записи с этим ID
+        Version* older = slot.head.load(std::memory_order_relaxed);
+        Version* newer = publish(prepared, ts, false, older);
+        slot.head.store(newer, std::memory_order_release);
+        if (older != nullptr) {
+            state.superseded.push_back(Superseded{newer, older});
+        }
+        ++state.live;
+        commit(state, ts);
+        return true;
+    }
+
+    /**
+     * @return false если записи с таким ID нет
+     */
+    bool update(int id, Prepared& prepared) {
+        return replace(id, prepared, false);
+    }
+
+    /**
+     * @param tombstone Узел prepare(Record{}) под отметку об удалении
+     * @return false если записи с таким ID нет
+     */
+    bool erase(int id, Prepared& tombstone) {
+        return replace(id, tombstone, true);
+    }
+
+    /**
+     * @param retained Данные, на которые ссылаются прежние записи
+     *        (например, их строки); живут, пока прежнее состояние держат снимки
+     * @return Прежнее состояние: если снимков нет, оно освободится вместе
+     *         с результатом
+     */
+    Garbage clear(std::shared_ptr<const void> retained = nullptr) {
+        return install(Bulk(), 0, std::move(retained));
+    }
+
+    /**
+     * @brief Заменить все содержимое таблицы построенным в bulk
+     *
+     * Потоки, заполнявшие bulk, должны быть завершены (join).
+     * @param records Количество записей, добавленных в bulk
+     * @param retained См. clear()
+     * @return Прежнее состояние, как у clear()
+     */
+    Garbage install(Bulk bulk, std::size_t records,
+                    std::shared_ptr<const void> retained = nullptr) {
+        bulk.state_->live = records;
+        Garbage garbage = takeGarbage();
+        state_->retained = std::move(retained);
+        garbage.state_ = std::atomic_exchange(&state_, std::move(bulk.state_));
+        return garbage;
+    }
+
+    /**
+     * @brief Забрать версии, освобожденные предыдущими изменениями
+     */
+    Garbage takeGarbage() {
+        Garbage garbage;
+        garbage.versions_ = std::exchange(state_->garbage, nullptr);
+        return garbage;
+    }
+
+    // Перегрузки, выделяющие и освобождающие память под блокировкой
+
+    bool insert(int id, Record record) {
+        Prepared prepared = prepare(std::move(record));
+        const bool inserted = insert(id, prepared);
+        takeGarbage();
+        return inserted;
+    }
+
+    bool update(int id, Record record) {
+        Prepared prepared = prepare(std::move(record));
+        const bool updated = update(id, prepared);
+        takeGarbage();
+        return updated;
+    }
+
+    bool erase(int id) {
+        Prepared tombstone = prepare(Record{});
+        const bool erased = erase(id, tombstone);
+        takeGarbage();
+        return erased;
+    }
+
+    // --- Без блокировки владельца ---
+
+    Snapshot snapshot() const {
+        return Snapshot(std::atomic_load(&state_));
+    }
+
+    template <typename Visitor>
+    void scan(Visitor&& visit) const {
+        snapshot().forEach(std::forward<Visitor>(visit));
+    }
+
+    template <typename Visitor>
+    bool scanWhile(Visitor&& visit, int first = 0) const {
+        return snapshot().forEachWhile(std::forward<Visitor>(visit), first);
+    }
+
+private:
+    static Version* liveHead(const State& state, int id) {
+        const Slot* slot = state.slots.find(id);
+        if (slot == nullptr) {
+            return nullptr;
+        }
+        Version* version = slot->head.load(std::memory_order_relaxed);
+        return version != nullptr && !version->deleted ? version : nullptr;
+    }
+
+    static Version* publish(Prepared& prepared, std::uint64_t ts, bool deleted, Version* older) {
+        Version* version = prepared.version_.release();
+        version->begin = ts;
+        version->deleted = deleted;
+        version->prev.store(older, std::memory_order_relaxed);
+        return version;
+    }
+
+    bool replace(int id, Prepared& prepared, bool deleted) {
+        State& state = *state_;
+        Version* older = liveHead(state, id);
+        if (older == nullptr) {
+            return false;
+        }
+        Slot* slot = state.slots.find(id);
+        const std::uint64_t ts = state.commit_ts.load(std::memory_order_relaxed) + 1;
+        Version* newer = publish(prepared, ts, deleted, older);
+        slot->head.store(newer, std::memory_order_release);
+        state.superseded.push_back(Superseded{newer, older});
+        if (deleted) {
+            state.tombstones.push_back(Tombstone{slot, newer, ts});
+            --state.live;
+        }
+        commit(state, ts);
+        return true;
+    }
+
+    static void commit(State& state, std::uint64_t ts) {
+        state.commit_ts.store(ts, std::memory_order_release);
+        collect(state);
+    }
+
+    static void collect(State& state) {
+        if (state.superseded.empty() && state.tombstones.empty() && state.unlinked.empty()) {
+            return;
+        }
+        std::uint64_t min_ts;
+        std::uint64_t min_ticket;
+        {
+            std::lock_guard<std::mutex> lock(state.snapshots_mutex);
+            if (state.active.empty()) {
+                min_ts = state.commit_ts.load(std::memory_order_relaxed);
+                min_ticket = state.next_ticket;
+            } else {
+                // Номера и метки выдаются под одной блокировкой и монотонны
+                min_ticket = state.active.begin()->first;
+                min_ts = state.active.begin()->second;
+            }
+        }
+
+        // Удаленную запись не видит ни один снимок, но указатель на нее
+        // мог быть прочитан из слота: освобождаем после отцепления, когда
+        // завершатся все снимки, открытые до него. Если поверх надгробия
+        // уже вставлена новая запись, оно освободится как замененная версия.
+        // Надгробия обрабатываются раньше замененных версий, чтобы не
+        // сравнивать слот с уже освобожденным указателем.
+        std::uint64_t unlink_ticket = 0;
+        while (!state.tombstones.empty() && state.tombstones.front().begin <= min_ts) {
+            const Tombstone entry = state.tombstones.front();
+            state.tombstones.pop_front();
+            if (entry.slot->head.load(std::memory_order_relaxed) != entry.version) {
+                continue;
+            }
+            entry.slot->head.store(nullptr, std::memory_order_release);
+            if (unlink_ticket == 0) {
+                std::lock_guard<std::mutex> lock(state.snapshots_mutex);
+                unlink_ticket = state.next_ticket;
+            }
+            state.unlinked.push_back(Unlinked{entry.version, unlink_ticket});
+        }
+
+        // Снимок с ts >= newer->begin останавливается на newer и до older
+        // не доходит, поэтому older можно отцепить и удалить сразу
+        while (!state.superseded.empty() && state.superseded.front().newer->begin <= min_ts) {
+            const Superseded entry = state.superseded.front();
+            state.superseded.pop_front();
+            entry.newer->prev.store(nullptr, std::memory_order_release);
+            toGarbage(state, entry.older);
+        }
+
+        while (!state.unlinked.empty() && state.unlinked.front().ticket <= min_ticket) {
+            toGarbage(state, state.unlinked.front().version);
+            state.unlinked.pop_front();
+        }
+    }
+
+    // К этому моменту prev версии уже обнулен (ее собственная замена
+    // обработана раньше), поэтому prev свободен под связь списка
+    static void toGarbage(State& state, Version* version) {
+        version->prev.store(state.garbage, std::memory_order_relaxed);
+        state.garbage = version;
+    }
+
+    std::shared_ptr<State> state_;
+};
+
+} // namespace services
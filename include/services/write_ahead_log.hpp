@@ -0,0 +1,179 @@
+#pragma once
+
+#include "contracts/order_contract.hpp"
+#include "contracts/user_contract.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace services {
+
+/**
+ * @brief Изменение базы в журнале
+ *
+ * Put* хранят запись целиком (вставка или замена), поэтому повторное
+ * применение журнала дает то же состояние.
+ */
+struct LogRecord {
+    enum class Type : std::uint8_t {
+        PutUser = 1,
+        DeleteUser = 2,
+        PutOrder = 3,
+        DeleteOrder = 4,
+        Clear = 5,
+        SetOrderStatus = 6,
+    };
+
+    Type type = Type::Clear;
+    int id = 0;               // ID удаляемой записи или заказа для SetOrderStatus
+    contracts::User user{};   // Для PutUser
+    contracts::Order order{}; // Для PutOrder; у SetOrderStatus — только status
+
+    static LogRecord putUser(const contracts::User& user);
+    static LogRecord deleteUser(int id);
+    static LogRecord putOrder(const contracts::Order& order);
+    static LogRecord deleteOrder(int id);
+    static LogRecord setOrderStatus(int id, contracts::OrderStatus status);
+    static LogRecord clear();
+};
+
+/**
+ * @brief Когда commit() считает изменение сохраненным
+ */
+enum class Durability {
+    // Запись остается в буфере процесса до его заполнения или flush():
+    // теряется при падении процесса
+    Buffered,
+    // Группа записывается в файл (write) до возврата из commit():
+    // переживает падение процесса, но не ОС
+    Written,
+    // После write группа сбрасывается на диск (fdatasync):
+    // переживает отключение питания
+    Synced,
+};
+
+/**
+ * @brief Журнал упреждающей записи с групповой фиксацией
+ *
+ * Владелец добавляет закодированную запись под своей блокировкой
+ * (append — только копирование в буфер), чтобы порядок в журнале совпал
+ * с порядком применения, а после снятия блокировки ждет commit().
+ * Первый ожидающий поток становится лидером: забирает все накопленные
+ * записи, пишет их одним write и одним fdatasync; остальные ждут его.
+ * Пока лидер ждет диск, следующие записи копятся в новую группу,
+ * поэтому под нагрузкой один fdatasync покрывает много операций.
+ *
+ * Формат файла — последовательность кадров
+ * [длина u32][CRC32 u32][данные], числа little-endian. Оборванный или
+ * поврежденный хвост (падение посреди write) отбрасывается при replay.
+ *
+ * После ошибки записи журнал переходит в состояние failed(): новые
+ * записи не принимаются, commit() возвращает false.
+ */
+class WriteAheadLog {
+public:
+    struct Options {
+        Durability durability = Durability::Synced;
+        // Для Buffered: объем, при котором буфер пишется в файл
+        std::size_t buffer_bytes = 1 << 20;
+    };
+
+    struct Stats {
+        std::uint64_t records = 0;   // Добавлено записей
+        std::uint64_t writes = 0;    // Групп, записанных в файл
+        std::uint64_t syncs = 0;     // Вызовов fdatasync
+        std::uint64_t bytes = 0;     // Записано в файл
+    };
+
+    /**
+     * @brief Открыть журнал для дозаписи (файл создается при отсутствии)
+     * @return nullptr, если файл не открылся
+     */
+    static std::shared_ptr<WriteAheadLog> open(const std::string& path, Options options);
+    static std::shared_ptr<WriteAheadLog> open(const std::string& path) {
+        return open(path, Options{});
+    }
+
+    /**
+     * @brief Применить записи журнала по порядку
+     *
+     * Оборванный хвост обрезается, чтобы дозапись продолжилась
+     * с корректной границы кадра.
+     * @return Число примененных записей (0, если файла нет)
+     */
+    static std::size_t replay(const std::string& path,
+                              const std::function<void(const LogRecord&)>& apply);
+
+    /**
+     * @brief Прочитать все записи законченного файла, не изменяя его
+     *
+     * Для файлов, которые больше не дописываются (например, дельт
+     * резервной копии): оборванный или поврежденный кадр — ошибка.
+     * @return Записи по порядку или nullopt, если файл не прочитан или поврежден
+     */
+    static std::optional<std::vector<LogRecord>> readAll(const std::string& path);
+
+    /**
+     * @brief Закодировать запись в кадр журнала (вне блокировки владельца)
+     */
+    static std::string encode(const LogRecord& record);
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    /**
+     * @brief Записывает накопленный буфер и закрывает файл
+     */
+    ~WriteAheadLog();
+
+    /**
+     * @brief Добавить кадр из encode() в очередь на запись
+     * @return Номер записи для commit() или 0, если журнал в состоянии failed()
+     */
+    std::uint64_t append(const std::string& frame);
+
+    /**
+     * @brief Дождаться сохранения записей до lsn включительно
+     *
+     * Уровень гарантии — Options::durability.
+     * @return false, если запись в файл не удалась
+     */
+    bool commit(std::uint64_t lsn);
+
+    /**
+     * @brief Записать и сбросить на диск все добавленные записи
+     */
+    bool flush();
+
+    bool failed() const;
+    Stats stats() const;
+    Durability durability() const { return options_.durability; }
+
+private:
+    WriteAheadLog(int fd, Options options);
+
+    // Записать группу до target (при sync — и сбросить на диск).
+    // Вызывается с захваченной lock; на время ввода-вывода ее отпускает
+    void writeGroup(std::unique_lock<std::mutex>& lock, std::uint64_t target, bool sync);
+
+    const int fd_;
+    const Options options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable written_cv_;
+    std::string pending_;          // Добавленные, но не записанные кадры
+    std::string batch_;            // Группа, которую пишет лидер
+    std::uint64_t appended_ = 0;   // Номер последней добавленной записи
+    std::uint64_t written_ = 0;    // Записано в файл до этого номера
+    std::uint64_t synced_ = 0;     // Сброшено на диск до этого номера
+    bool writing_ = false;         // Лидер пишет группу
+    bool failed_ = false;
+    Stats stats_;
+};
+
+} // namespace services
@@ -0,0 +1,181 @@
+#include "services/change_stream.hpp"
+#include <algorithm>
+
+namespace services {
+
+namespace {
+
+constexpr std::size_t kMinCapacity = 4096;
+
+std::size_t alignFrame(std::size_t size) {
+    return (size + 7) & ~std::size_t{7};
+}
+
+/**
+ * Пишет байты подряд в атомарные слова кольца; неполное последнее
+ * слово дописывается в flush()
+ */
+class WordWriter {
+public:
+    explicit WordWriter(std::atomic<std::uint64_t>* words) : words_(words) {}
+
+    void put(const void* data, std::size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0) {
+            const std::size_t chunk = std::min(size, sizeof(pending_) - filled_);
+            std::memcpy(reinterpret_cast<char*>(&pending_) + filled_, bytes, chunk);
+            filled_ += chunk;
+            bytes += chunk;
+            size -= chunk;
+            if (filled_ == sizeof(pending_)) {
+                flush();
+            }
+        }
+    }
+
+    void flush() {
+        if (filled_ != 0) {
+            words_++->store(pending_, std::memory_order_relaxed);
+            pending_ = 0;
+            filled_ = 0;
+        }
+    }
+
+private:
+    std::atomic<std::uint64_t>* words_;
+    std::uint64_t pending_ = 0;
+    std::size_t filled_ = 0;
+};
+
+} // namespace
+
+ChangeStream::ChangeStream(std::size_t capacity_bytes)
+    : capacity_(alignFrame(std::max(capacity_bytes, kMinCapacity))),
+      words_(new std::atomic<std::uint64_t>[capacity_ / kWordSize]) {
+    for (std::size_t i = 0; i < capacity_ / kWordSize; ++i) {
+        words_[i].store(0, std::memory_order_relaxed);
+    }
+    // Кадр не короче заголовка, поэтому в кольце их не больше
+    // capacity_ / sizeof(Header): ячейка индекса переиспользуется, только
+    // когда ее прежний кадр уже затерт
+    std::size_t slots = 1;
+    while (slots <= capacity_ / sizeof(Header)) {
+        slots <<= 1;
+    }
+    positions_.reset(new std::atomic<std::uint64_t>[slots]);
+    for (std::size_t i = 0; i < slots; ++i) {
+        positions_[i].store(0, std::memory_order_relaxed);
+    }
+    position_mask_ = slots - 1;
+}
+
+void ChangeStream::publishUser(int id, std::string_view name, std::string_view email,
+                               bool is_active) {
+    Header header{};
+    header.type = static_cast<std::uint8_t>(ChangeEvent::Type::PutUser);
+    header.id = id;
+    header.is_active = is_active ? 1 : 0;
+    publish(header, name, email);
+}
+
+void ChangeStream::publishOrder(int id, int user_id, std::string_view product_name,
+                                contracts::Money amount, contracts::OrderStatus status) {
+    Header header{};
+    header.type = static_cast<std::uint8_t>(ChangeEvent::Type::PutOrder);
+    header.id = id;
+    header.user_id = user_id;
+    header.amount = amount.minorUnits();
+    header.status = static_cast<std::uint8_t>(status);
+    publish(header, product_name, {});
+}
+
+void ChangeStream::publishDelete(ChangeEvent::Type type, int id) {
+    Header header{};
+    header.type = static_cast<std::uint8_t>(type);
+    header.id = id;
+    publish(header, {}, {});
+}
+
+void ChangeStream::publishReset(ChangeEvent::Type type) {
+    Header header{};
+    header.type = static_cast<std::uint8_t>(type);
+    publish(header, {}, {});
+}
+
+void ChangeStream::publish(Header header, std::string_view first, std::string_view second) {
+    if (alignFrame(sizeof(Header) + first.size() + second.size()) > capacity_ / 4) {
+        // Один кадр не должен вытеснять почти все кольцо
+        header.truncated = 1;
+        first = {};
+        second = {};
+    }
+    header.first_size = static_cast<std::uint32_t>(first.size());
+    header.second_size = static_cast<std::uint32_t>(second.size());
+    const std::size_t size = alignFrame(sizeof(Header) + first.size() + second.size());
+
+    // Кадр не разрывается концом кольца: остаток до конца пропускается
+    std::uint64_t position = write_position_;
+    const std::size_t offset = position % capacity_;
+    if (offset + size > capacity_) {
+        position += capacity_ - offset;
+    }
+    const std::uint64_t end = position + size;
+
+    // Сначала объявить затираемые кадры недоступными, затем писать:
+    // читатель, проверивший oldest_ после чтения кадра, увидит затирание
+    const std::uint64_t sequence = published_.load(std::memory_order_relaxed);
+    std::uint64_t oldest = oldest_.load(std::memory_order_relaxed);
+    while (oldest < sequence &&
+           positions_[oldest & position_mask_].load(std::memory_order_relaxed) + capacity_ <
+               end) {
+        ++oldest;
+    }
+    oldest_.store(oldest, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    header.sequence = sequence;
+    WordWriter frame(words_.get() + position % capacity_ / kWordSize);
+    frame.put(&header, sizeof(header));
+    // data() пустой строки может быть nullptr, memcpy он не передается
+    if (!first.empty()) {
+        frame.put(first.data(), first.size());
+    }
+    if (!second.empty()) {
+        frame.put(second.data(), second.size());
+    }
+    frame.flush();
+    positions_[sequence & position_mask_].store(position, std::memory_order_relaxed);
+    write_position_ = end;
+    published_.store(sequence + 1, std::memory_order_release);
+}
+
+void ChangeStream::loadWords(std::size_t first, void* out, std::size_t count) const {
+    char* bytes = static_cast<char*>(out);
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::uint64_t word = words_[first + i].load(std::memory_order_relaxed);
+        std::memcpy(bytes + i * kWordSize, &word, kWordSize);
+    }
+}
+
+ChangeEvent ChangeStream::decode(const Header& header, const char* text) {
+    ChangeEvent event;
+    event.sequence = header.sequence;
+    event.type = static_cast<ChangeEvent::Type>(header.type);
+    event.id = header.id;
+    event.truncated = header.truncated != 0;
+    const std::string_view first(text, header.first_size);
+    const std::string_view second(text + header.first_size, header.second_size);
+    if (event.type == ChangeEvent::Type::PutUser) {
+        event.name = first;
+        event.email = second;
+        event.is_active = header.is_active != 0;
+    } else if (event.type == ChangeEvent::Type::PutOrder) {
+        event.user_id = header.user_id;
+        event.product_name = first;
+        event.amount = contracts::Money::fromMinorUnits(header.amount);
+        event.status = static_cast<contracts::OrderStatus>(header.status);
+    }
+    return event;
+}
+
+} // namespace services
@@ -0,0 +1,223 @@
+#include "services/checkpoint.hpp"
+#include "services/file_io.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace services {
+
+using namespace checkpoint_format;
+
+namespace {
+
+template <typename T>
+T readEntry(const char* section, std::size_t index) {
+    T entry;
+    std::memcpy(&entry, section + index * sizeof(T), sizeof(T));
+    return entry;
+}
+
+} // namespace
+
+void CheckpointWriter::addUser(int id, std::string_view name, std::string_view email,
+                               bool is_active) {
+    UserEntry entry{};
+    entry.id = id;
+    entry.name_size = static_cast<std::uint32_t>(name.size());
+    entry.email_size = static_cast<std::uint32_t>(email.size());
+    entry.is_active = is_active ? 1 : 0;
+    entry.text_offset = storeText(name);
+    storeText(email);
+    users_.push_back(entry);
+}
+
+void CheckpointWriter::addOrder(int id, int user_id, std::string_view product,
+                                contracts::Money amount, contracts::OrderStatus status) {
+    auto it = product_ids_.find(product);
+    if (it == product_ids_.end()) {
+        ProductEntry entry{};
+        entry.text_offset = storeText(product);
+        entry.size = static_cast<std::uint32_t>(product.size());
+        products_.push_back(entry);
+        it = product_ids_
+                 .emplace(product_keys_.store(product),
+                          static_cast<std::uint32_t>(products_.size() - 1))
+                 .first;
+    }
+    OrderEntry entry{};
+    entry.id = id;
+    entry.user_id = user_id;
+    entry.amount = amount.minorUnits();
+    entry.product = it->second;
+    entry.status = static_cast<std::uint8_t>(status);
+    orders_.push_back(entry);
+}
+
+std::uint64_t CheckpointWriter::storeText(std::string_view text) {
+    const std::uint64_t offset = text_.size();
+    text_.append(text);
+    return offset;
+}
+
+bool CheckpointWriter::write(const std::string& path) const {
+    const auto* users = reinterpret_cast<const char*>(users_.data());
+    const auto* products = reinterpret_cast<const char*>(products_.data());
+    const auto* orders = reinterpret_cast<const char*>(orders_.data());
+    const std::size_t users_size = users_.size() * sizeof(UserEntry);
+    const std::size_t products_size = products_.size() * sizeof(ProductEntry);
+    const std::size_t orders_size = orders_.size() * sizeof(OrderEntry);
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byte_order = kByteOrderMark;
+    header.users = users_.size();
+    header.products = products_.size();
+    header.orders = orders_.size();
+    header.text_bytes = text_.size();
+    std::uint32_t crc = crc32(users, users_size);
+    crc = crc32(products, products_size, crc);
+    crc = crc32(orders, orders_size, crc);
+    header.crc = crc32(text_.data(), text_.size(), crc);
+
+    const std::string temp = path + ".tmp";
+    const int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = writeFully(fd, reinterpret_cast<const char*>(&header), sizeof(header)) &&
+              writeFully(fd, users, users_size) && writeFully(fd, products, products_size) &&
+              writeFully(fd, orders, orders_size) &&
+              writeFully(fd, text_.data(), text_.size()) && syncToDisk(fd);
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::optional<CheckpointReader> CheckpointReader::open(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(Header)) {
+        ::close(fd);
+        return std::nullopt;
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // Отображение живет и после закрытия дескриптора
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return std::nullopt;
+    }
+    // Файл читается один раз подряд: проверка CRC, затем построение таблиц
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+
+    CheckpointReader reader(static_cast<const char*>(mapped), size);
+    if (!reader.validate()) {
+        return std::nullopt;
+    }
+    return reader;
+}
+
+CheckpointReader::CheckpointReader(const char* data, std::size_t size)
+    : data_(data), size_(size) {
+    std::memcpy(&header_, data_, sizeof(header_));
+}
+
+CheckpointReader::CheckpointReader(CheckpointReader&& other) noexcept
+    : data_(other.data_),
+      size_(other.size_),
+      header_(other.header_),
+      users_(other.users_),
+      products_(other.products_),
+      orders_(other.orders_),
+      text_(other.text_) {
+    other.data_ = nullptr;
+}
+
+CheckpointReader::~CheckpointReader() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+CheckpointReader::User CheckpointReader::user(std::size_t index) const {
+    const auto entry = readEntry<UserEntry>(users_, index);
+    const char* name = text_ + entry.text_offset;
+    return User{entry.id, std::string_view(name, entry.name_size),
+                std::string_view(name + entry.name_size, entry.email_size),
+                entry.is_active != 0};
+}
+
+std::string_view CheckpointReader::product(std::size_t index) const {
+    const auto entry = readEntry<ProductEntry>(products_, index);
+    return std::string_view(text_ + entry.text_offset, entry.size);
+}
+
+CheckpointReader::Order CheckpointReader::order(std::size_t index) const {
+    const auto entry = readEntry<OrderEntry>(orders_, index);
+    return Order{entry.id, entry.user_id, entry.product,
+                 contracts::Money::fromMinorUnits(entry.amount),
+                 static_cast<contracts::OrderStatus>(entry.status)};
+}
+
+bool CheckpointReader::validate() {
+    if (std::memcmp(header_.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header_.version != kVersion || header_.byte_order != kByteOrderMark) {
+        return false;
+    }
+    // Размеры секций из заголовка не должны переполнить вычисление длины
+    const std::uint64_t limit = size_;
+    if (header_.users > limit / sizeof(UserEntry) ||
+        header_.products > limit / sizeof(ProductEntry) ||
+        header_.orders > limit / sizeof(OrderEntry) || header_.text_bytes > limit) {
+        return false;
+    }
+    const std::uint64_t expected = sizeof(Header) + header_.users * sizeof(UserEntry) +
+                                   header_.products * sizeof(ProductEntry) +
+                                   header_.orders * sizeof(OrderEntry) + header_.text_bytes;
+    if (expected != size_) {
+        return false;
+    }
+    users_ = data_ + sizeof(Header);
+    products_ = users_ + header_.users * sizeof(UserEntry);
+    orders_ = products_ + header_.products * sizeof(ProductEntry);
+    text_ = orders_ + header_.orders * sizeof(OrderEntry);
+
+    if (crc32(users_, size_ - sizeof(Header)) != header_.crc) {
+        return false;
+    }
+    const std::uint64_t text_bytes = header_.text_bytes;
+    for (std::size_t i = 0; i < header_.users; ++i) {
+        const auto entry = readEntry<UserEntry>(users_, i);
+        if (entry.id <= 0 || entry.text_offset > text_bytes ||
+            text_bytes - entry.text_offset <
+                std::uint64_t{entry.name_size} + entry.email_size) {
+            return false;
+        }
+    }
+    for (std::size_t i = 0; i < header_.products; ++i) {
+        const auto entry = readEntry<ProductEntry>(products_, i);
+        if (entry.text_offset > text_bytes || text_bytes - entry.text_offset < entry.size) {
+            return false;
+        }
+    }
+    for (std::size_t i = 0; i < header_.orders; ++i) {
+        const auto entry = readEntry<OrderEntry>(orders_, i);
+        if (entry.id <= 0 || entry.product >= header_.products ||
+            entry.status > static_cast<std::uint8_t>(contracts::OrderStatus::CANCELLED)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace services
@@ -0,0 +1,327 @@
+#include "services/columnar_database.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace services {
+
+namespace {
+
+using contracts::OrderStatus;
+
+std::uint8_t statusCode(OrderStatus status) {
+    return static_cast<std::uint8_t>(status);
+}
+
+// Длина названия хранится в 32 битах
+bool productNameFits(const std::string& name) {
+    return name.size() <= std::numeric_limits<std::uint32_t>::max();
+}
+
+// Ядра обхода колонок. Условие превращается в маску без ветвлений,
+// а суммы целочисленные (копейки), поэтому порядок сложения не влияет
+// на результат и компилятор свободно векторизует редукцию.
+std::size_t countEqual(const std::uint8_t* values, std::size_t n, std::uint8_t value) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        count += values[i] == value;
+    }
+    return count;
+}
+
+std::int64_t sumWhereEqual(const std::int64_t* amounts, const std::uint8_t* keys,
+                           std::size_t n, std::uint8_t key) {
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += keys[i] == key ? amounts[i] : 0;
+    }
+    return sum;
+}
+
+} // namespace
+
+ColumnarDatabase::ColumnarDatabase()
+    : rows_(std::make_unique<DenseIdArray<RowRef>>()),
+      user_ids_(std::make_shared<IdAllocator>()),
+      order_ids_(std::make_shared<IdAllocator>()) {}
+
+int ColumnarDatabase::saveUser(const contracts::User& user) {
+    contracts::User new_user = user;
+    const int id = user_ids_->allocate();
+    if (id < 0) {
+        return -1;
+    }
+    new_user.id = id;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    users_.insert(id, std::move(new_user));
+    return id;
+}
+
+std::optional<contracts::User> ColumnarDatabase::findUserById(int id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (const auto* user = users_.find(id)) {
+        return *user;
+    }
+    return std::nullopt;
+}
+
+std::vector<contracts::User> ColumnarDatabase::findAllUsers() const {
+    std::vector<contracts::User> result;
+    users_.scan([&result](const contracts::User& user) { result.push_back(user); });
+    return result;
+}
+
+bool ColumnarDatabase::updateUser(const contracts::User& user) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    return users_.update(user.id, user);
+}
+
+bool ColumnarDatabase::deleteUser(int id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    return users_.erase(id);
+}
+
+int ColumnarDatabase::saveOrder(const contracts::Order& order) {
+    if (!productNameFits(order.product_name)) {
+        return -1;
+    }
+    const int id = order_ids_->allocate();
+    if (id < 0) {
+        return -1;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const std::size_t row = order_id_.size();
+    order_id_.push_back(id);
+    user_id_.push_back(order.user_id);
+    amount_.push_back(order.amount.minorUnits());
+    status_.push_back(statusCode(order.status));
+    product_offset_.push_back(0);
+    product_length_.push_back(0);
+    setProductName(row, order.product_name);
+    rows_->ensure(id).row_plus_one = row + 1;
+    indexOrder(order.user_id, id);
+    return id;
+}
+
+std::optional<contracts::Order> ColumnarDatabase::findOrderById(int id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const RowRef* ref = rowOf(id);
+    if (ref == nullptr) {
+        return std::nullopt;
+    }
+    return rowToOrder(ref->row_plus_one - 1);
+}
+
+std::vector<contracts::Order> ColumnarDatabase::findOrdersByUserId(int user_id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<contracts::Order> result;
+    auto index_it = user_orders_.find(user_id);
+    if (index_it == user_orders_.end()) {
+        return result;
+    }
+    result.reserve(index_it->second.size());
+    for (int order_id : index_it->second) {
+        result.push_back(rowToOrder(rowOf(order_id)->row_plus_one - 1));
+    }
+    return result;
+}
+
+std::vector<contracts::Order> ColumnarDatabase::findAllOrders() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<contracts::Order> result;
+    result.reserve(order_id_.size());
+    for (std::size_t row = 0; row < order_id_.size(); ++row) {
+        result.push_back(rowToOrder(row));
+    }
+    return result;
+}
+
+bool ColumnarDatabase::updateOrder(const contracts::Order& order) {
+    if (!productNameFits(order.product_name)) {
+        return false;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const RowRef* ref = rowOf(order.id);
+    if (ref == nullptr) {
+        return false;
+    }
+    const std::size_t row = ref->row_plus_one - 1;
+    if (user_id_[row] != order.user_id) {
+        unindexOrder(user_id_[row], order.id);
+        indexOrder(order.user_id, order.id);
+    }
+    user_id_[row] = order.user_id;
+    amount_[row] = order.amount.minorUnits();
+    status_[row] = statusCode(order.status);
+    // Смена статуса — частый случай, название при этом не переписываем
+    if (order.product_name.compare(0, std::string::npos, product_heap_, product_offset_[row],
+                                   product_length_[row]) != 0) {
+        product_garbage_ += product_length_[row];
+        setProductName(row, order.product_name);
+        compactIfWasteful();
+    }
+    return true;
+}
+
+bool ColumnarDatabase::deleteOrder(int id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    RowRef* ref = rows_->find(id);
+    if (ref == nullptr || ref->row_plus_one == 0) {
+        return false;
+    }
+    const std::size_t row = ref->row_plus_one - 1;
+    const std::size_t last = order_id_.size() - 1;
+    unindexOrder(user_id_[row], id);
+    product_garbage_ += product_length_[row];
+    ref->row_plus_one = 0;
+
+    // Последняя строка переезжает на место удаленной
+    if (row != last) {
+        order_id_[row] = order_id_[last];
+        user_id_[row] = user_id_[last];
+        amount_[row] = amount_[last];
+        status_[row] = status_[last];
+        product_offset_[row] = product_offset_[last];
+        product_length_[row] = product_length_[last];
+        rows_->find(order_id_[row])->row_plus_one = row + 1;
+    }
+    order_id_.pop_back();
+    user_id_.pop_back();
+    amount_.pop_back();
+    status_.pop_back();
+    product_offset_.pop_back();
+    product_length_.pop_back();
+
+    compactIfWasteful();
+    return true;
+}
+
+void ColumnarDatabase::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    users_.clear();
+    order_id_.clear();
+    user_id_.clear();
+    amount_.clear();
+    status_.clear();
+    product_offset_.clear();
+    product_length_.clear();
+    product_heap_.clear();
+    product_garbage_ = 0;
+    rows_ = std::make_unique<DenseIdArray<RowRef>>();
+    user_orders_.clear();
+    user_ids_->reset();
+    order_ids_->reset();
+}
+
+std::size_t ColumnarDatabase::countOrdersByStatus(contracts::OrderStatus status) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return countEqual(status_.data(), status_.size(), statusCode(status));
+}
+
+contracts::Money ColumnarDatabase::sumAmountByStatus(contracts::OrderStatus status) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return contracts::Money::fromMinorUnits(
+        sumWhereEqual(amount_.data(), status_.data(), status_.size(), statusCode(status)));
+}
+
+contracts::OrderAggregate ColumnarDatabase::aggregateOrders(
+    const contracts::OrderQuery& query) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    contracts::OrderAggregate aggregate;
+    const auto addRow = [this, &query, &aggregate](std::size_t row) {
+        const auto amount = contracts::Money::fromMinorUnits(amount_[row]);
+        if (query.matches(user_id_[row], amount, static_cast<OrderStatus>(status_[row]))) {
+            aggregate.add(amount);
+        }
+    };
+    if (query.user_id) {
+        auto index_it = user_orders_.find(*query.user_id);
+        if (index_it != user_orders_.end()) {
+            for (int order_id : index_it->second) {
+                addRow(rowOf(order_id)->row_plus_one - 1);
+            }
+        }
+        return aggregate;
+    }
+    for (std::size_t row = 0; row < order_id_.size(); ++row) {
+        addRow(row);
+    }
+    return aggregate;
+}
+
+contracts::Money ColumnarDatabase::totalAmountByUser(int user_id) const {
+    contracts::OrderQuery query;
+    query.user_id = user_id;
+    query.statuses = contracts::StatusSet::allExcept({OrderStatus::CANCELLED});
+    return aggregateOrders(query).sum;
+}
+
+std::size_t ColumnarDatabase::productHeapGarbage() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return product_garbage_;
+}
+
+const ColumnarDatabase::RowRef* ColumnarDatabase::rowOf(int id) const {
+    const RowRef* ref = rows_->find(id);
+    return ref != nullptr && ref->row_plus_one != 0 ? ref : nullptr;
+}
+
+contracts::Order ColumnarDatabase::rowToOrder(std::size_t row) const {
+    return contracts::Order{
+        order_id_[row],
+        user_id_[row],
+        product_heap_.substr(product_offset_[row], product_length_[row]),
+        contracts::Money::fromMinorUnits(amount_[row]),
+        static_cast<OrderStatus>(status_[row])};
+}
+
+void ColumnarDatabase::setProductName(std::size_t row, const std::string& name) {
+    product_offset_[row] = product_heap_.size();
+    product_length_[row] = static_cast<std::uint32_t>(name.size());
+    product_heap_.append(name);
+}
+
+void ColumnarDatabase::compactIfWasteful() {
+    // Сжатие линейно по куче, поэтому запускается, лишь когда мусор
+    // составляет больше половины: амортизированно O(1) на изменение
+    if (product_garbage_ > product_heap_.size() / 2) {
+        compactProductHeap();
+    }
+}
+
+void ColumnarDatabase::compactProductHeap() {
+    std::string heap;
+    heap.reserve(product_heap_.size() - product_garbage_);
+    for (std::size_t row = 0; row < product_offset_.size(); ++row) {
+        const std::uint64_t offset = heap.size();
+        heap.append(product_heap_, product_offset_[row], product_length_[row]);
+        product_offset_[row] = offset;
+    }
+    product_heap_ = std::move(heap);
+    product_garbage_ = 0;
+}
+
+void ColumnarDatabase::indexOrder(int user_id, int order_id) {
+    auto& ids = user_orders_[user_id];
+    if (ids.empty() || ids.back() < order_id) {
+        ids.push_back(order_id);
+        return;
+    }
+    ids.insert(std::lower_bound(ids.begin(), ids.end(), order_id), order_id);
+}
+
+void ColumnarDatabase::unindexOrder(int user_id, int order_id) {
+    auto it = user_orders_.find(user_id);
+    if (it == user_orders_.end()) {
+        return;
+    }
+    auto& ids = it->second;
+    auto pos = std::lower_bound(ids.begin(), ids.end(), order_id);
+    if (pos != ids.end() && *pos == order_id) {
+        ids.erase(pos);
+    }
+    if (ids.empty()) {
+        user_orders_.erase(it);
+    }
+}
+
+} // namespace services
@@ -1,110 +1,1109 @@
 #include "services/database.hpp"
+#include "services/file_io.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fcntl.h>
+#include <limits>
+#include <thread>
+#include <unistd.h>
+#include <unordered_set>
 
 namespace services {
 
+namespace {
+
+// Массовая загрузка делит ID на отрезки по 4 листа DenseIdArray и раздает
+// их потокам по кругу: поток заполняет свои листья, а при плотных ID
+// части получаются равными
+constexpr unsigned kBulkIdsPerChunk = 4096;
+
+// Меньше этого мусора в арене имен и email не сжимается: копирование
+// всех пользователей ради нескольких килобайт не окупается
+constexpr std::size_t kMinCompactBytes = 64 * 1024;
+
+unsigned bulkThreads(unsigned threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    return std::max(1u, threads);
+}
+
+unsigned bulkPart(int id, unsigned parts) {
+    return (static_cast<unsigned>(id) / kBulkIdsPerChunk) % parts;
+}
+
+// Отрезок входа [first, second), который обрабатывает поток part
+std::pair<std::size_t, std::size_t> bulkSlice(std::size_t count, unsigned part,
+                                              unsigned parts) {
+    return {count * part / parts, count * (part + 1) / parts};
+}
+
+// Выполнить task(0) ... task(parts - 1) параллельно, task(0) — в этом потоке
+template <typename Task>
+void runParallel(unsigned parts, const Task& task) {
+    std::vector<std::thread> workers;
+    workers.reserve(parts - 1);
+    for (unsigned part = 1; part < parts; ++part) {
+        workers.emplace_back([&task, part] { task(part); });
+    }
+    task(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+} // namespace
+
+InMemoryDatabase::InMemoryDatabase()
+    : InMemoryDatabase(std::make_shared<IdAllocator>(), std::make_shared<IdAllocator>()) {}
+
+InMemoryDatabase::InMemoryDatabase(std::shared_ptr<IdAllocator> user_ids,
+                                   std::shared_ptr<IdAllocator> order_ids)
+    : text_(std::make_shared<TextStore>()),
+      user_ids_(std::move(user_ids)),
+      order_ids_(std::move(order_ids)) {}
+
 int InMemoryDatabase::saveUser(const contracts::User& user) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    contracts::User new_user = user;
-    new_user.id = next_user_id_++;
-    users_[new_user.id] = new_user;
-    return new_user.id;
+    if (logFailed()) {
+        return -1;
+    }
+    // Выданный ID может быть уже занят: insertUser мог вставить ID из блока,
+    // арендованного этим или другим потоком. Тогда берется следующий ID
+    for (;;) {
+        const int id = user_ids_->allocate();
+        if (id < 0) {
+            return -1;
+        }
+        const std::string frame =
+            log_ ? WriteAheadLog::encode(LogRecord::putUser(
+                       contracts::User{id, user.name, user.email, user.is_active}))
+                 : std::string();
+        auto prepared = UserTable::prepare(StoredUser{id, {}, {}, user.is_active});
+        auto text = storeUserText(user, true, true, prepared.record());
+        users_.reserve(id);
+        // Объявлен до блокировки: освобождается после ее снятия
+        UserTable::Garbage garbage;
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (text != text_) {
+            storeUserText(user, true, true, prepared.record());
+        }
+        if (users_.find(id) != nullptr) {
+            text_->dead_user_bytes += user.name.size() + user.email.size();
+            continue;
+        }
+        const auto lsn = appendLog(frame);
+        if (!lsn) {
+            text_->dead_user_bytes += user.name.size() + user.email.size();
+            return -1;
+        }
+        users_.insert(id, prepared);
+        publishUserChange(id);
+        garbage = users_.takeGarbage();
+        lock.unlock();
+        markUserChanged(id);
+        return commitLog(*lsn) ? id : -1;
+    }
 }
 
 std::optional<contracts::User> InMemoryDatabase::findUserById(int id) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = users_.find(id);
-    if (it != users_.end()) {
-        return it->second;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (const auto* user = users_.find(id)) {
+        return toUser(*user);
+    }
+    return std::nullopt;
+}
+
+std::optional<bool> InMemoryDatabase::findUserActive(int id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (const auto* user = users_.find(id)) {
+        return user->is_active;
     }
     return std::nullopt;
 }
 
 std::vector<contracts::User> InMemoryDatabase::findAllUsers() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    // Обход снимка не держит mutex_ и не блокирует писателей
     std::vector<contracts::User> result;
-    result.reserve(users_.size());
-    for (const auto& [id, user] : users_) {
-        result.push_back(user);
+    users_.scan([&result](const StoredUser& user) { result.push_back(toUser(user)); });
+    return result;
+}
+
+void InMemoryDatabase::scanUsers(const UserVisitor& visit) const {
+    contracts::User user{0, {}, {}, false};
+    users_.scanWhile([&user, &visit](const StoredUser& stored) {
+        user.id = stored.id;
+        user.name.assign(stored.name);
+        user.email.assign(stored.email);
+        user.is_active = stored.is_active;
+        return visit(user);
+    });
+}
+
+std::vector<contracts::User> InMemoryDatabase::findActiveUsersPage(
+    const contracts::PageRequest& page) const {
+    std::vector<contracts::User> result;
+    if (page.limit == 0 || page.after_id == std::numeric_limits<int>::max()) {
+        return result;
     }
+    result.reserve(std::min<std::size_t>(page.limit, 4096));
+    users_.scanWhile(
+        [&result, &page](const StoredUser& user) {
+            if (user.is_active) {
+                result.push_back(toUser(user));
+            }
+            return result.size() < page.limit;
+        },
+        page.after_id + 1);
+    return result;
+}
+
+std::vector<contracts::User> InMemoryDatabase::findUsers(const contracts::UserQuery& query) const {
+    std::vector<contracts::User> result;
+    users_.scan([&result, &query](const StoredUser& user) {
+        if (query.matches(user.is_active)) {
+            result.push_back(toUser(user));
+        }
+    });
     return result;
 }
 
 bool InMemoryDatabase::updateUser(const contracts::User& user) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = users_.find(user.id);
-    if (it != users_.end()) {
-        it->second = user;
-        return true;
+    if (logFailed()) {
+        return false;
+    }
+    // Обычно меняется только is_active: строки копируются, только если изменились
+    bool name_changed = false;
+    bool email_changed = false;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const auto* current = users_.find(user.id);
+        if (current == nullptr) {
+            return false;
+        }
+        name_changed = current->name != user.name;
+        email_changed = current->email != user.email;
+    }
+    const std::string frame =
+        log_ ? WriteAheadLog::encode(LogRecord::putUser(user)) : std::string();
+    auto prepared = UserTable::prepare(StoredUser{user.id, {}, {}, user.is_active});
+    auto text = storeUserText(user, name_changed, email_changed, prepared.record());
+
+    UserTable::Garbage garbage;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const auto* current = users_.find(user.id);
+    if (current == nullptr) {
+        return false;
+    }
+    StoredUser& stored = prepared.record();
+    if (text != text_ || (!name_changed && current->name != user.name) ||
+        (!email_changed && current->email != user.email)) {
+        // Между проверкой и блокировкой запись изменил другой писатель или
+        // clear() заменил хранилище строк: копируем под блокировкой
+        name_changed = current->name != user.name;
+        email_changed = current->email != user.email;
+        storeUserText(user, name_changed, email_changed, stored);
     }
-    return false;
+    if (!name_changed) {
+        stored.name = current->name;
+    }
+    if (!email_changed) {
+        stored.email = current->email;
+    }
+    const auto lsn = appendLog(frame);
+    if (!lsn) {
+        text_->dead_user_bytes += (name_changed ? user.name.size() : 0) +
+                                  (email_changed ? user.email.size() : 0);
+        return false;
+    }
+    text_->dead_user_bytes += (name_changed ? current->name.size() : 0) +
+                              (email_changed ? current->email.size() : 0);
+    const bool compact = text_->userTextWasteful();
+    users_.update(user.id, prepared);
+    publishUserChange(user.id);
+    garbage = users_.takeGarbage();
+    lock.unlock();
+    markUserChanged(user.id);
+    if (compact) {
+        compactUserText();
+    }
+    return commitLog(*lsn);
 }
 
 bool InMemoryDatabase::deleteUser(int id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return users_.erase(id) > 0;
+    if (logFailed()) {
+        return false;
+    }
+    const std::string frame =
+        log_ ? WriteAheadLog::encode(LogRecord::deleteUser(id)) : std::string();
+    auto tombstone = UserTable::prepare(StoredUser{});
+    UserTable::Garbage garbage;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const auto* current = users_.find(id);
+    if (current == nullptr) {
+        return false;
+    }
+    const auto lsn = appendLog(frame);
+    if (!lsn) {
+        return false;
+    }
+    text_->dead_user_bytes += current->name.size() + current->email.size();
+    const bool compact = text_->userTextWasteful();
+    users_.erase(id, tombstone);
+    publishUserChange(id);
+    garbage = users_.takeGarbage();
+    lock.unlock();
+    markUserChanged(id);
+    if (compact) {
+        compactUserText();
+    }
+    return commitLog(*lsn);
 }
 
 int InMemoryDatabase::saveOrder(const contracts::Order& order) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    contracts::Order new_order = order;
-    new_order.id = next_order_id_++;
-    orders_[new_order.id] = new_order;
-    return new_order.id;
+    if (logFailed()) {
+        return -1;
+    }
+    // Занятый вставкой insertOrder ID пропускается, как в saveUser
+    for (;;) {
+        const int id = order_ids_->allocate();
+        if (id < 0) {
+            return -1;
+        }
+        const std::string frame =
+            log_ ? WriteAheadLog::encode(LogRecord::putOrder(contracts::Order{
+                       id, order.user_id, order.product_name, order.amount, order.status}))
+                 : std::string();
+        auto prepared = OrderTable::prepare(
+            StoredOrder{id, order.user_id, {}, order.amount, order.status});
+        auto text = storeProductName(order.product_name, prepared.record());
+        auto& spare = spareIndexNode(order.user_id, id);
+        orders_.reserve(id);
+
+        OrderTable::Garbage garbage;
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (text != text_) {
+            storeProductName(order.product_name, prepared.record());
+        }
+        if (orders_.find(id) != nullptr) {
+            continue;
+        }
+        const auto lsn = appendLog(frame);
+        if (!lsn) {
+            return -1;
+        }
+        orders_.insert(id, prepared);
+        indexOrder(order.user_id, id, spare);
+        publishOrderChange(id);
+        garbage = orders_.takeGarbage();
+        lock.unlock();
+        markOrderChanged(id);
+        return commitLog(*lsn) ? id : -1;
+    }
 }
 
 std::optional<contracts::Order> InMemoryDatabase::findOrderById(int id) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = orders_.find(id);
-    if (it != orders_.end()) {
-        return it->second;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (const auto* order = orders_.find(id)) {
+        return toOrder(*order);
     }
     return std::nullopt;
 }
 
 std::vector<contracts::Order> InMemoryDatabase::findOrdersByUserId(int user_id) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     std::vector<contracts::Order> result;
-    for (const auto& [id, order] : orders_) {
-        if (order.user_id == user_id) {
-            result.push_back(order);
-        }
+    auto index_it = user_orders_.find(user_id);
+    if (index_it == user_orders_.end()) {
+        return result;
+    }
+    result.reserve(index_it->second.size());
+    for (int order_id : index_it->second) {
+        result.push_back(toOrder(*orders_.find(order_id)));
+    }
+    return result;
+}
+
+std::vector<contracts::Order> InMemoryDatabase::findOrdersByUserIdPage(
+    int user_id, const contracts::PageRequest& page) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<contracts::Order> result;
+    auto index_it = user_orders_.find(user_id);
+    if (index_it == user_orders_.end()) {
+        return result;
+    }
+    const auto& ids = index_it->second;
+    auto first = std::upper_bound(ids.begin(), ids.end(), page.after_id);
+    const auto count = std::min<std::size_t>(page.limit, ids.end() - first);
+    result.reserve(count);
+    for (auto it = first; it != first + count; ++it) {
+        result.push_back(toOrder(*orders_.find(*it)));
     }
     return result;
 }
 
 std::vector<contracts::Order> InMemoryDatabase::findAllOrders() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     std::vector<contracts::Order> result;
-    result.reserve(orders_.size());
-    for (const auto& [id, order] : orders_) {
-        result.push_back(order);
+    orders_.scan([&result](const StoredOrder& order) { result.push_back(toOrder(order)); });
+    return result;
+}
+
+template <typename Visitor, typename Reserve>
+void InMemoryDatabase::visitOrders(const contracts::OrderQuery& query, Visitor&& visit,
+                                   Reserve&& reserve) const {
+    const auto matches = [&query](const StoredOrder& order) {
+        return query.matches(order.user_id, order.amount, order.status);
+    };
+    if (!query.user_id) {
+        orders_.scan([&matches, &visit](const StoredOrder& order) {
+            if (matches(order)) {
+                visit(order);
+            }
+        });
+        return;
+    }
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto index_it = user_orders_.find(*query.user_id);
+    if (index_it == user_orders_.end()) {
+        return;
+    }
+    const auto& ids = index_it->second;
+    // Число заказов известно точно, только если фильтр их не отбрасывает
+    if (query.statuses == contracts::StatusSet() && !query.min_amount && !query.max_amount) {
+        reserve(ids.size());
     }
+    for (int order_id : ids) {
+        const StoredOrder& order = *orders_.find(order_id);
+        if (matches(order)) {
+            visit(order);
+        }
+    }
+}
+
+template <typename Record, typename Convert>
+std::vector<Record> InMemoryDatabase::collectOrders(const contracts::OrderQuery& query,
+                                                    Convert convert) const {
+    std::vector<Record> result;
+    visitOrders(
+        query, [&result, &convert](const StoredOrder& order) { result.push_back(convert(order)); },
+        [&result](std::size_t count) { result.reserve(count); });
     return result;
 }
 
+contracts::OrderAggregate InMemoryDatabase::aggregateOrders(
+    const contracts::OrderQuery& query) const {
+    contracts::OrderAggregate aggregate;
+    visitOrders(
+        query, [&aggregate](const StoredOrder& order) { aggregate.add(order.amount); },
+        [](std::size_t) {});
+    return aggregate;
+}
+
+std::vector<contracts::Order> InMemoryDatabase::findOrders(
+    const contracts::OrderQuery& query) const {
+    return collectOrders<contracts::Order>(query, toOrder);
+}
+
+std::vector<contracts::OrderSummary> InMemoryDatabase::findOrderSummaries(
+    const contracts::OrderQuery& query) const {
+    return collectOrders<contracts::OrderSummary>(query, [](const StoredOrder& order) {
+        return contracts::OrderSummary{order.id, order.user_id, order.amount, order.status};
+    });
+}
+
+void InMemoryDatabase::scanOrders(const OrderVisitor& visit) const {
+    contracts::Order order{0, 0, {}, contracts::Money(), contracts::OrderStatus::PENDING};
+    orders_.scanWhile([&order, &visit](const StoredOrder& stored) {
+        order.id = stored.id;
+        order.user_id = stored.user_id;
+        order.product_name.assign(stored.product_name);
+        order.amount = stored.amount;
+        order.status = stored.status;
+        return visit(order);
+    });
+}
+
 bool InMemoryDatabase::updateOrder(const contracts::Order& order) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = orders_.find(order.id);
-    if (it != orders_.end()) {
-        it->second = order;
-        return true;
+    if (logFailed()) {
+        return false;
+    }
+    const std::string frame =
+        log_ ? WriteAheadLog::encode(LogRecord::putOrder(order)) : std::string();
+    auto prepared = OrderTable::prepare(
+        StoredOrder{order.id, order.user_id, {}, order.amount, order.status});
+    // Интернирование не растит пул, если название не изменилось
+    auto text = storeProductName(order.product_name, prepared.record());
+    auto& spare = spareIndexNode(order.user_id, order.id);
+
+    OrderTable::Garbage garbage;
+    OrderIndex::node_type removed;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const auto* current = orders_.find(order.id);
+    if (current == nullptr) {
+        return false;
     }
-    return false;
+    if (text != text_) {
+        storeProductName(order.product_name, prepared.record());
+    }
+    const auto lsn = appendLog(frame);
+    if (!lsn) {
+        return false;
+    }
+    if (current->user_id != order.user_id) {
+        unindexOrder(current->user_id, order.id, removed);
+        indexOrder(order.user_id, order.id, spare);
+    }
+    orders_.update(order.id, prepared);
+    publishOrderChange(order.id);
+    garbage = orders_.takeGarbage();
+    lock.unlock();
+    markOrderChanged(order.id);
+    return commitLog(*lsn);
 }
 
 bool InMemoryDatabase::deleteOrder(int id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return orders_.erase(id) > 0;
+    if (logFailed()) {
+        return false;
+    }
+    const std::string frame =
+        log_ ? WriteAheadLog::encode(LogRecord::deleteOrder(id)) : std::string();
+    auto tombstone = OrderTable::prepare(StoredOrder{});
+    OrderTable::Garbage garbage;
+    OrderIndex::node_type removed;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const auto* current = orders_.find(id);
+    if (current == nullptr) {
+        return false;
+    }
+    const auto lsn = appendLog(frame);
+    if (!lsn) {
+        return false;
+    }
+    unindexOrder(current->user_id, id, removed);
+    orders_.erase(id, tombstone);
+    publishOrderChange(id);
+    garbage = orders_.takeGarbage();
+    lock.unlock();
+    markOrderChanged(id);
+    return commitLog(*lsn);
+}
+
+bool InMemoryDatabase::insertUser(const contracts::User& user) {
+    if (user.id <= 0 || logFailed()) {
+        return false;
+    }
+    {
+        // Проверка до копирования: строки отклоненной записи не попадут в арену
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (users_.find(user.id) != nullptr) {
+            return false;
+        }
+    }
+    const std::string frame =
+        log_ ? WriteAheadLog::encode(LogRecord::putUser(user)) : std::string();
+    auto prepared = UserTable::prepare(StoredUser{user.id, {}, {}, user.is_active});
+    auto text = storeUserText(user, true, true, prepared.record());
+    users_.reserve(user.id);
+
+    UserTable::Garbage garbage;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (text != text_) {
+        storeUserText(user, true, true, prepared.record());
+    }
+    const auto lsn = users_.find(user.id) == nullptr ? appendLog(frame) : std::nullopt;
+    if (!lsn) {
+        text_->dead_user_bytes += user.name.size() + user.email.size();
+        return false;
+    }
+    users_.insert(user.id, prepared);
+    publishUserChange(user.id);
+    garbage = users_.takeGarbage();
+    // Собственные ID не должны пересечься со вставленными извне
+    user_ids_->advancePast(user.id);
+    lock.unlock();
+    markUserChanged(user.id);
+    return commitLog(*lsn);
+}
+
+bool InMemoryDatabase::insertOrder(const contracts::Order& order) {
+    if (order.id <= 0 || logFailed()) {
+        return false;
+    }
+    const std::string frame =
+        log_ ? WriteAheadLog::encode(LogRecord::putOrder(order)) : std::string();
+    auto prepared = OrderTable::prepare(
+        StoredOrder{order.id, order.user_id, {}, order.amount, order.status});
+    auto text = storeProductName(order.product_name, prepared.record());
+    auto& spare = spareIndexNode(order.user_id, order.id);
+    orders_.reserve(order.id);
+
+    OrderTable::Garbage garbage;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (text != text_) {
+        storeProductName(order.product_name, prepared.record());
+    }
+    if (orders_.find(order.id) != nullptr) {
+        return false;
+    }
+    const auto lsn = appendLog(frame);
+    if (!lsn) {
+        return false;
+    }
+    orders_.insert(order.id, prepared);
+    indexOrder(order.user_id, order.id, spare);
+    publishOrderChange(order.id);
+    garbage = orders_.takeGarbage();
+    order_ids_->advancePast(order.id);
+    lock.unlock();
+    markOrderChanged(order.id);
+    return commitLog(*lsn);
 }
 
 void InMemoryDatabase::clear() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    users_.clear();
-    orders_.clear();
-    next_user_id_ = 1;
-    next_order_id_ = 1;
+    const std::string frame = log_ ? WriteAheadLog::encode(LogRecord::clear()) : std::string();
+    Contents old;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    // Журнал, не принявший запись, оставляет содержимое нетронутым;
+    // сбой подтверждения виден через logFailed()
+    const auto lsn = appendLog(frame);
+    if (!lsn) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> text_lock(text_mutex_);
+        swapContents(old);
+    }
+    restartChanges(false);
+    if (stream_) {
+        stream_->publishReset(ChangeEvent::Type::Clear);
+    }
+    lock.unlock();
+    commitLog(*lsn);
 }
 
-} // namespace services
+bool InMemoryDatabase::saveCheckpoint(const std::string& path) const {
+    std::lock_guard<std::mutex> backup_lock(backup_mutex_);
+    std::optional<UserTable::Snapshot> users;
+    std::optional<OrderTable::Snapshot> orders;
+    {
+        // Писатели берут эксклюзивную блокировку, поэтому между снимками
+        // двух таблиц изменений нет и контрольная точка согласована
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        users.emplace(users_.snapshot());
+        orders.emplace(orders_.snapshot());
+        restartChanges(true);
+    }
+    CheckpointWriter writer;
+    users->forEach([&writer](const StoredUser& user) {
+        writer.addUser(user.id, user.name, user.email, user.is_active);
+    });
+    orders->forEach([&writer](const StoredOrder& order) {
+        writer.addOrder(order.id, order.user_id, order.product_name, order.amount,
+                        order.status);
+    });
+    if (!writer.write(path)) {
+        // Дельте не от чего отсчитываться
+        restartChanges(false);
+        return false;
+    }
+    return true;
+}
 
+bool InMemoryDatabase::saveDelta(const std::string& path) {
+    std::lock_guard<std::mutex> backup_lock(backup_mutex_);
+    std::optional<UserTable::Snapshot> users;
+    std::optional<OrderTable::Snapshot> orders;
+    std::vector<int> user_ids;
+    std::vector<int> order_ids;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::lock_guard<std::mutex> changes_lock(changes_.mutex);
+        if (!changes_.tracking.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        users.emplace(users_.snapshot());
+        orders.emplace(orders_.snapshot());
+        user_ids.swap(changes_.users);
+        order_ids.swap(changes_.orders);
+        if (++changes_.generation == 0) {
+            changes_.generation = 1;
+        }
+    }
+    std::sort(user_ids.begin(), user_ids.end());
+    std::sort(order_ids.begin(), order_ids.end());
+
+    std::string data;
+    for (int id : user_ids) {
+        const auto* user = users->find(id);
+        data += WriteAheadLog::encode(user != nullptr ? LogRecord::putUser(toUser(*user))
+                                                      : LogRecord::deleteUser(id));
+    }
+    for (int id : order_ids) {
+        const auto* order = orders->find(id);
+        data += WriteAheadLog::encode(order != nullptr ? LogRecord::putOrder(toOrder(*order))
+                                                       : LogRecord::deleteOrder(id));
+    }
+
+    const std::string temp = path + ".tmp";
+    const int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    bool ok = fd >= 0 && writeFully(fd, data.data(), data.size()) && syncToDisk(fd);
+    ok = (fd < 0 || ::close(fd) == 0) && ok;
+    if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        // Вернуть изменения следующей дельте
+        for (int id : user_ids) {
+            markUserChanged(id);
+        }
+        for (int id : order_ids) {
+            markOrderChanged(id);
+        }
+        return false;
+    }
+    return true;
+}
+
+void InMemoryDatabase::markUserChanged(int id) const {
+    if (!changes_.tracking.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(changes_.mutex);
+    std::uint32_t& mark = changes_.user_marks.ensure(id);
+    if (mark != changes_.generation) {
+        mark = changes_.generation;
+        changes_.users.push_back(id);
+    }
+}
+
+void InMemoryDatabase::markOrderChanged(int id) const {
+    if (!changes_.tracking.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(changes_.mutex);
+    std::uint32_t& mark = changes_.order_marks.ensure(id);
+    if (mark != changes_.generation) {
+        mark = changes_.generation;
+        changes_.orders.push_back(id);
+    }
+}
+
+void InMemoryDatabase::restartChanges(bool tracking) const {
+    std::lock_guard<std::mutex> lock(changes_.mutex);
+    changes_.users.clear();
+    changes_.orders.clear();
+    if (++changes_.generation == 0) {
+        changes_.generation = 1;
+    }
+    changes_.tracking.store(tracking, std::memory_order_relaxed);
+}
+
+template <typename UserAt, typename OrderAt>
+bool InMemoryDatabase::buildContents(Contents& contents, std::size_t user_count,
+                                     UserAt user_at, std::size_t order_count,
+                                     OrderAt order_at, unsigned threads) {
+    const unsigned parts = threads;
+    // [поток][часть]: номера записей, которые поток нашел в своем отрезке
+    // входа для каждой части ID
+    using Buckets = std::vector<std::vector<std::vector<std::uint32_t>>>;
+    Buckets user_buckets(parts, std::vector<std::vector<std::uint32_t>>(parts));
+    Buckets order_buckets(parts, std::vector<std::vector<std::uint32_t>>(parts));
+    std::atomic<bool> ok{true};
+    runParallel(parts, [&](unsigned thread) {
+        const auto users = bulkSlice(user_count, thread, parts);
+        for (std::size_t i = users.first; i < users.second; ++i) {
+            const int id = user_at(i).id;
+            if (id <= 0) {
+                ok.store(false, std::memory_order_relaxed);
+                return;
+            }
+            user_buckets[thread][bulkPart(id, parts)].push_back(static_cast<std::uint32_t>(i));
+        }
+        const auto orders = bulkSlice(order_count, thread, parts);
+        for (std::size_t i = orders.first; i < orders.second; ++i) {
+            const int id = order_at(i).id;
+            if (id <= 0) {
+                ok.store(false, std::memory_order_relaxed);
+                return;
+            }
+            order_buckets[thread][bulkPart(id, parts)].push_back(static_cast<std::uint32_t>(i));
+        }
+    });
+    if (!ok.load()) {
+        return false;
+    }
+
+    // Поток part строит записи своей части ID; пары {user_id, order_id}
+    // для индекса раскладывает по частям user_id: [поток][часть]
+    using IndexPairs = std::vector<std::vector<std::vector<std::pair<int, int>>>>;
+    IndexPairs index_pairs(parts, std::vector<std::vector<std::pair<int, int>>>(parts));
+    std::vector<int> max_user_ids(parts, 0);
+    std::vector<int> max_order_ids(parts, 0);
+    for (unsigned part = 0; part < parts; ++part) {
+        contents.text->bulk_text.push_back(std::make_unique<StringArena>());
+    }
+    runParallel(parts, [&](unsigned part) {
+        StringArena& text = *contents.text->bulk_text[part];
+        int max_user_id = 0;
+        for (const auto& bucket : user_buckets) {
+            for (std::uint32_t i : bucket[part]) {
+                StoredUser user = user_at(i);
+                user.name = text.store(user.name);
+                user.email = text.store(user.email);
+                if (!contents.users.add(user.id, user)) {
+                    ok.store(false, std::memory_order_relaxed);
+                    return;
+                }
+                max_user_id = std::max(max_user_id, user.id);
+            }
+        }
+        int max_order_id = 0;
+        auto& pairs = index_pairs[part];
+        for (const auto& bucket : order_buckets) {
+            for (std::uint32_t i : bucket[part]) {
+                const StoredOrder order = order_at(i);
+                if (!contents.orders.add(order.id, order)) {
+                    ok.store(false, std::memory_order_relaxed);
+                    return;
+                }
+                pairs[bulkPart(order.user_id, parts)].emplace_back(order.user_id, order.id);
+                max_order_id = std::max(max_order_id, order.id);
+            }
+        }
+        max_user_ids[part] = max_user_id;
+        max_order_ids[part] = max_order_id;
+    });
+    if (!ok.load()) {
+        return false;
+    }
+
+    // Части индекса не пересекаются по ключам и строятся параллельно,
+    // затем их узлы переносятся в общий индекс без копирования
+    std::vector<OrderIndex> indexes(parts);
+    runParallel(parts, [&](unsigned part) {
+        OrderIndex& index = indexes[part];
+        for (const auto& pairs : index_pairs) {
+            for (const auto& [user_id, order_id] : pairs[part]) {
+                index[user_id].push_back(order_id);
+            }
+        }
+        for (auto& [user_id, ids] : index) {
+            // Вход, упорядоченный по ID, дает уже отсортированные списки
+            if (!std::is_sorted(ids.begin(), ids.end())) {
+                std::sort(ids.begin(), ids.end());
+            }
+        }
+    });
+    std::size_t keys = 0;
+    for (const auto& index : indexes) {
+        keys += index.size();
+    }
+    contents.index.reserve(keys);
+    for (auto& index : indexes) {
+        contents.index.merge(index);
+    }
+
+    contents.user_count = user_count;
+    contents.order_count = order_count;
+    contents.max_user_id = *std::max_element(max_user_ids.begin(), max_user_ids.end());
+    contents.max_order_id = *std::max_element(max_order_ids.begin(), max_order_ids.end());
+    return true;
+}
+
+bool InMemoryDatabase::loadCheckpoint(const std::string& path, unsigned threads) {
+    auto checkpoint = CheckpointReader::open(path);
+    if (!checkpoint) {
+        return false;
+    }
+    // Названия интернируются один раз на продукт, заказы берут их по номеру
+    Contents contents;
+    std::vector<std::string_view> products(checkpoint->productCount());
+    for (std::size_t i = 0; i < products.size(); ++i) {
+        products[i] = contents.text->product_names->intern(checkpoint->product(i));
+    }
+    const CheckpointReader& reader = *checkpoint;
+    const bool built = buildContents(
+        contents, reader.userCount(),
+        [&reader](std::size_t i) {
+            const auto user = reader.user(i);
+            return StoredUser{user.id, user.name, user.email, user.is_active};
+        },
+        reader.orderCount(),
+        [&reader, &products](std::size_t i) {
+            const auto order = reader.order(i);
+            return StoredOrder{order.id, order.user_id, products[order.product],
+                               order.amount, order.status};
+        },
+        bulkThreads(threads));
+    if (!built) {
+        return false;
+    }
+    publish(contents);
+    return true;
+}
+
+bool InMemoryDatabase::bulkLoad(const std::vector<contracts::User>& users,
+                                const std::vector<contracts::Order>& orders,
+                                unsigned threads) {
+    const unsigned parts = bulkThreads(threads);
+    Contents contents;
+    // Различных названий мало: потоки собирают их в своих отрезках, пул
+    // заполняется в одном потоке, а при построении заказы только ищут в нем
+    std::vector<std::unordered_set<std::string_view>> names(parts);
+    runParallel(parts, [&](unsigned thread) {
+        const auto slice = bulkSlice(orders.size(), thread, parts);
+        for (std::size_t i = slice.first; i < slice.second; ++i) {
+            names[thread].insert(orders[i].product_name);
+        }
+    });
+    for (const auto& part : names) {
+        for (std::string_view name : part) {
+            contents.text->product_names->intern(name);
+        }
+    }
+    const StringInterner& products = *contents.text->product_names;
+    const bool built = buildContents(
+        contents, users.size(),
+        [&users](std::size_t i) {
+            const auto& user = users[i];
+            return StoredUser{user.id, user.name, user.email, user.is_active};
+        },
+        orders.size(),
+        [&orders, &products](std::size_t i) {
+            const auto& order = orders[i];
+            return StoredOrder{order.id, order.user_id, *products.find(order.product_name),
+                               order.amount, order.status};
+        },
+        parts);
+    if (!built) {
+        return false;
+    }
+    publish(contents);
+    return true;
+}
+
+void InMemoryDatabase::publish(Contents& contents) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::lock_guard<std::mutex> text_lock(text_mutex_);
+    swapContents(contents);
+    restartChanges(false);
+    if (stream_) {
+        stream_->publishReset(ChangeEvent::Type::Reload);
+    }
+    user_ids_->advancePast(contents.max_user_id);
+    order_ids_->advancePast(contents.max_order_id);
+}
+
+InMemoryDatabase::TextMemory InMemoryDatabase::textMemory() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::lock_guard<std::mutex> text_lock(text_mutex_);
+    TextMemory memory;
+    memory.user_text_bytes = text_->user_text.bytesReserved();
+    for (const auto& arena : text_->bulk_text) {
+        memory.user_text_bytes += arena->bytesReserved();
+    }
+    memory.product_names = text_->product_names->size();
+    memory.product_name_bytes = text_->product_names->memoryBytes();
+    return memory;
+}
+
+void InMemoryDatabase::swapContents(Contents& other) {
+    // Открытые снимки прежних таблиц ссылаются на прежние строки
+    other.old_users = users_.install(std::move(other.users), other.user_count, text_);
+    other.old_orders = orders_.install(std::move(other.orders), other.order_count, text_);
+    text_.swap(other.text);
+    user_orders_.swap(other.index);
+    user_ids_->reset();
+    order_ids_->reset();
+}
+
+void InMemoryDatabase::attachLog(std::shared_ptr<WriteAheadLog> log) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    log_ = std::move(log);
+}
+
+void InMemoryDatabase::attachChangeStream(std::shared_ptr<ChangeStream> stream) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    stream_ = std::move(stream);
+}
+
+void InMemoryDatabase::publishUserChange(int id) {
+    if (!stream_) {
+        return;
+    }
+    if (const auto* user = users_.find(id)) {
+        stream_->publishUser(id, user->name, user->email, user->is_active);
+    } else {
+        stream_->publishDelete(ChangeEvent::Type::DeleteUser, id);
+    }
+}
+
+void InMemoryDatabase::publishOrderChange(int id) {
+    if (!stream_) {
+        return;
+    }
+    if (const auto* order = orders_.find(id)) {
+        stream_->publishOrder(id, order->user_id, order->product_name, order->amount,
+                              order->status);
+    } else {
+        stream_->publishDelete(ChangeEvent::Type::DeleteOrder, id);
+    }
+}
+
+void InMemoryDatabase::applyLogRecord(const LogRecord& record) {
+    switch (record.type) {
+    case LogRecord::Type::PutUser:
+        if (!insertUser(record.user)) {
+            updateUser(record.user);
+        }
+        break;
+    case LogRecord::Type::DeleteUser:
+        deleteUser(record.id);
+        break;
+    case LogRecord::Type::PutOrder:
+        if (!insertOrder(record.order)) {
+            updateOrder(record.order);
+        }
+        break;
+    case LogRecord::Type::DeleteOrder:
+        deleteOrder(record.id);
+        break;
+    case LogRecord::Type::Clear:
+        clear();
+        break;
+    case LogRecord::Type::SetOrderStatus:
+        if (auto order = findOrderById(record.id)) {
+            order->status = record.order.status;
+            updateOrder(*order);
+        }
+        break;
+    }
+}
+
+std::optional<std::uint64_t> InMemoryDatabase::appendLog(const std::string& frame) {
+    if (!log_) {
+        return 0;
+    }
+    // Буфер журнала сохраняет емкость между группами, поэтому копирование
+    // кадра обычно не выделяет память
+    const std::uint64_t lsn = log_->append(frame);
+    return lsn != 0 ? std::optional<std::uint64_t>(lsn) : std::nullopt;
+}
+
+bool InMemoryDatabase::commitLog(std::uint64_t lsn) {
+    return !log_ || log_->commit(lsn);
+}
+
+contracts::User InMemoryDatabase::toUser(const StoredUser& user) {
+    return contracts::User{user.id, std::string(user.name), std::string(user.email),
+                           user.is_active};
+}
+
+contracts::Order InMemoryDatabase::toOrder(const StoredOrder& order) {
+    return contracts::Order{order.id, order.user_id, std::string(order.product_name),
+                            order.amount, order.status};
+}
+
+std::shared_ptr<InMemoryDatabase::TextStore> InMemoryDatabase::storeUserText(
+    const contracts::User& user, bool name, bool email, StoredUser& stored) {
+    std::lock_guard<std::mutex> lock(text_mutex_);
+    if (name) {
+        stored.name = text_->user_text.store(user.name);
+    }
+    if (email) {
+        stored.email = text_->user_text.store(user.email);
+    }
+    return text_;
+}
+
+std::size_t InMemoryDatabase::TextStore::userTextBytes() const {
+    std::size_t bytes = user_text.bytesUsed();
+    for (const auto& arena : bulk_text) {
+        bytes += arena->bytesUsed();
+    }
+    return bytes;
+}
+
+bool InMemoryDatabase::TextStore::userTextWasteful() const {
+    return dead_user_bytes >= kMinCompactBytes && dead_user_bytes > userTextBytes() / 2;
+}
+
+void InMemoryDatabase::compactUserText() {
+    auto text = std::make_shared<TextStore>();
+    UserTable::Bulk users;
+    // Объявлены до блокировки: прежние таблица и строки освобождаются
+    // после ее снятия, если их не держат снимки
+    UserTable::Garbage old_users;
+    std::shared_ptr<TextStore> old_text;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::lock_guard<std::mutex> text_lock(text_mutex_);
+    if (!text_->userTextWasteful()) {
+        // Сжатие уже выполнил другой писатель или clear()
+        return;
+    }
+    text->product_names = text_->product_names;
+    std::size_t count = 0;
+    users_.scan([&](const StoredUser& user) {
+        users.add(user.id, StoredUser{user.id, text->user_text.store(user.name),
+                                      text->user_text.store(user.email), user.is_active});
+        ++count;
+    });
+    // Снимки прежней таблицы читают строки прежнего хранилища
+    old_users = users_.install(std::move(users), count, text_);
+    old_text = std::exchange(text_, std::move(text));
+}
+
+std::shared_ptr<InMemoryDatabase::TextStore> InMemoryDatabase::storeProductName(
+    const std::string& name, StoredOrder& stored) {
+    std::lock_guard<std::mutex> lock(text_mutex_);
+    stored.product_name = text_->product_names->intern(name);
+    return text_;
+}
+
+InMemoryDatabase::OrderIndex::node_type& InMemoryDatabase::spareIndexNode(int user_id,
+                                                                          int order_id) {
+    // Узлы одинаковых unordered_map взаимозаменяемы, поэтому запас общий
+    // для всех баз потока; выделяется заново, только если индекс его забрал
+    thread_local OrderIndex::node_type spare;
+    if (spare.empty()) {
+        OrderIndex scratch;
+        scratch.emplace(user_id, std::vector<int>{order_id});
+        spare = scratch.extract(scratch.begin());
+        return spare;
+    }
+    spare.key() = user_id;
+    spare.mapped().assign(1, order_id);
+    return spare;
+}
+
+void InMemoryDatabase::indexOrder(int user_id, int order_id, OrderIndex::node_type& spare) {
+    auto it = user_orders_.find(user_id);
+    if (it == user_orders_.end()) {
+        // spare уже содержит {user_id: [order_id]}
+        user_orders_.insert(std::move(spare));
+        return;
+    }
+    auto& ids = it->second;
+    // Обычно ID растут, и вставка сводится к push_back
+    if (ids.empty() || ids.back() < order_id) {
+        ids.push_back(order_id);
+        return;
+    }
+    ids.insert(std::lower_bound(ids.begin(), ids.end(), order_id), order_id);
+}
+
+void InMemoryDatabase::unindexOrder(int user_id, int order_id,
+                                    OrderIndex::node_type& removed) {
+    auto it = user_orders_.find(user_id);
+    if (it == user_orders_.end()) {
+        return;
+    }
+    auto& ids = it->second;
+    auto pos = std::lower_bound(ids.begin(), ids.end(), order_id);
+    if (pos != ids.end() && *pos == order_id) {
+        ids.erase(pos);
+    }
+    if (ids.empty()) {
+        removed = user_orders_.extract(it);
+    }
+}
+
+} // namespace services
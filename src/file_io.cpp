@@ -0,0 +1,170 @@
+#include "services/file_io.hpp"
+#include <array>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace services {
+
+namespace {
+
+// Слайсинг по 8 байт: восемь таблиц, по одному обращению на байт входа
+// без цепочки зависимостей между ними
+using CrcTables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+constexpr CrcTables makeCrcTables() {
+    CrcTables tables{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) != 0 ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+        }
+        tables[0][i] = crc;
+    }
+    for (std::size_t t = 1; t < tables.size(); ++t) {
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            const std::uint32_t prev = tables[t - 1][i];
+            tables[t][i] = tables[0][prev & 0xFF] ^ (prev >> 8);
+        }
+    }
+    return tables;
+}
+
+constexpr CrcTables kCrcTables = makeCrcTables();
+
+std::uint32_t loadLittle32(const unsigned char* p) {
+    return static_cast<std::uint32_t>(p[0]) | static_cast<std::uint32_t>(p[1]) << 8 |
+           static_cast<std::uint32_t>(p[2]) << 16 | static_cast<std::uint32_t>(p[3]) << 24;
+}
+
+} // namespace
+
+std::uint32_t crc32(const char* data, std::size_t size, std::uint32_t crc) {
+    const auto* p = reinterpret_cast<const unsigned char*>(data);
+    const auto& t = kCrcTables;
+    crc = ~crc;
+    for (; size >= 8; size -= 8, p += 8) {
+        const std::uint32_t lo = loadLittle32(p) ^ crc;
+        const std::uint32_t hi = loadLittle32(p + 4);
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^
+              t[4][lo >> 24] ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^
+              t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+    for (; size > 0; --size, ++p) {
+        crc = t[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+bool parseNumber(const std::string& name, const std::string& prefix, const std::string& suffix,
+                 std::uint64_t& number) {
+    if (name.size() <= prefix.size() + suffix.size() ||
+        name.compare(0, prefix.size(), prefix) != 0 ||
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return false;
+    }
+    const std::string digits =
+        name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+    if (digits.find_first_not_of("0123456789") != std::string::npos || digits.size() > 18) {
+        return false;
+    }
+    number = std::stoull(digits);
+    return true;
+}
+
+bool writeFully(int fd, const char* data, std::size_t size) {
+    std::size_t done = 0;
+    while (done < size) {
+        const ssize_t written = ::write(fd, data + done, size - done);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        done += static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool syncToDisk(int fd) {
+#if defined(__APPLE__)
+    // fsync на macOS не сбрасывает кэш накопителя
+    return ::fcntl(fd, F_FULLFSYNC) != -1 || ::fsync(fd) == 0;
+#else
+    return ::fdatasync(fd) == 0;
+#endif
+}
+
+std::optional<MappedFile> MappedFile::open(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+    MappedFile file(fd, nullptr, 0);
+    if (!file.resize(static_cast<std::size_t>(info.st_size))) {
+        return std::nullopt;
+    }
+    return file;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : fd_(other.fd_), data_(other.data_), size_(other.size_) {
+    other.fd_ = -1;
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        ::munmap(data_, size_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool MappedFile::resize(std::size_t size) {
+    // Отображение пересоздается целиком (mremap есть только в Linux),
+    // прежнее снимается последним: при любой неудаче оно остается
+    // действительным. Файл растет до отображения и сжимается после
+    if (size > size_ && ::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        return false;
+    }
+    void* mapped = nullptr;
+    if (size != 0) {
+        mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        // Выросший файл не сжимается обратно: добавленные байты нулевые
+        if (mapped == MAP_FAILED) {
+            return false;
+        }
+    }
+    if (size < size_ && ::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        if (mapped != nullptr) {
+            ::munmap(mapped, size);
+        }
+        return false;
+    }
+    if (data_ != nullptr) {
+        ::munmap(data_, size_);
+    }
+    data_ = static_cast<char*>(mapped);
+    size_ = size;
+    return true;
+}
+
+bool MappedFile::sync() const {
+    if (data_ != nullptr && ::msync(data_, size_, MS_SYNC) != 0) {
+        return false;
+    }
+    return syncToDisk(fd_);
+}
+
+} // namespace services
@@ -0,0 +1,84 @@
+#include "services/id_allocator.hpp"
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace services {
+
+namespace {
+
+std::atomic<std::uint64_t> next_allocator_uid{1};
+
+/**
+ * Блок ID, арендованный потоком у конкретного аллокатора.
+ * Кэш потока ограничен: при нехватке слотов вытесняется любой блок,
+ * его остаток просто теряется (ID остаются уникальными).
+ */
+struct Lease {
+    std::uint64_t owner = 0;
+    std::uint64_t generation = 0;
+    // Шире int: блок может заканчиваться на INT_MAX + 1
+    std::int64_t next = 0;
+    std::int64_t end = 0;
+};
+
+constexpr std::int64_t kMaxId = std::numeric_limits<int>::max();
+
+constexpr std::size_t kLeaseSlots = 8;
+
+thread_local std::array<Lease, kLeaseSlots> leases;
+thread_local std::size_t next_victim = 0;
+
+} // namespace
+
+IdAllocator::IdAllocator(int block_size)
+    : block_size_(std::max(block_size, 1)),
+      uid_(next_allocator_uid.fetch_add(1, std::memory_order_relaxed)) {}
+
+int IdAllocator::allocate() {
+    if (block_size_ == 1) {
+        const std::int64_t id = next_block_.fetch_add(1, std::memory_order_relaxed);
+        return id <= kMaxId ? static_cast<int>(id) : -1;
+    }
+
+    const std::uint64_t generation = generation_.load(std::memory_order_acquire);
+    Lease* lease = nullptr;
+    for (auto& candidate : leases) {
+        if (candidate.owner == uid_) {
+            lease = &candidate;
+            break;
+        }
+    }
+    if (lease != nullptr && lease->generation == generation && lease->next < lease->end) {
+        return static_cast<int>(lease->next++);
+    }
+    if (lease == nullptr) {
+        lease = &leases[next_victim++ % kLeaseSlots];
+    }
+
+    const std::int64_t start = next_block_.fetch_add(block_size_, std::memory_order_relaxed);
+    if (start > kMaxId) {
+        return -1;
+    }
+    // Последний блок обрезается по INT_MAX
+    const std::int64_t end = std::min(start + block_size_, kMaxId + 1);
+    *lease = Lease{uid_, generation, start + 1, end};
+    return static_cast<int>(start);
+}
+
+void IdAllocator::advancePast(int id) {
+    std::int64_t current = next_block_.load(std::memory_order_relaxed);
+    // Все арендованные блоки лежат ниже водяного знака, поэтому его
+    // сдвиг вверх не пересекается ни с одним из них
+    while (id >= current &&
+           !next_block_.compare_exchange_weak(current, std::int64_t{id} + 1,
+                                               std::memory_order_relaxed)) {
+    }
+}
+
+void IdAllocator::reset() {
+    next_block_.store(1, std::memory_order_relaxed);
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+} // namespace services
@@ -0,0 +1,137 @@
+#include "services/incremental_backup.hpp"
+#include "services/file_io.hpp"
+#include <algorithm>
+#include <filesystem>
+
+namespace services {
+
+IncrementalBackup::IncrementalBackup(std::string directory) : directory_(std::move(directory)) {}
+
+IncrementalBackup::Files IncrementalBackup::scan() const {
+    namespace fs = std::filesystem;
+    Files files;
+    std::vector<std::uint64_t> deltas;
+    std::error_code error;
+    for (const auto& item : fs::directory_iterator(directory_, error)) {
+        const std::string name = item.path().filename().string();
+        std::uint64_t number = 0;
+        if (parseNumber(name, "base-", ".ckpt", number)) {
+            files.base = std::max(files.base, number);
+        } else if (parseNumber(name, "delta-", ".log", number)) {
+            deltas.push_back(number);
+        } else {
+            continue;
+        }
+        files.last = std::max(files.last, number);
+    }
+    std::sort(deltas.begin(), deltas.end());
+    for (std::uint64_t number : deltas) {
+        if (number > files.base) {
+            files.deltas.push_back(number);
+        }
+    }
+    return files;
+}
+
+bool IncrementalBackup::backup(InMemoryDatabase& database) {
+    const Files files = scan();
+    const std::uint64_t number = files.last + 1;
+    if (files.base != 0 && database.saveDelta(deltaPath(number))) {
+        return true;
+    }
+    if (!database.saveCheckpoint(basePath(number))) {
+        return false;
+    }
+    removeBefore(number);
+    return true;
+}
+
+bool IncrementalBackup::merge(unsigned threads) {
+    const Files files = scan();
+    if (files.base == 0) {
+        return false;
+    }
+    if (files.deltas.empty()) {
+        return true;
+    }
+    InMemoryDatabase merged;
+    if (!restore(merged, threads)) {
+        return false;
+    }
+    // Новая база покрывает все свернутые дельты
+    const std::uint64_t number = files.last + 1;
+    if (!merged.saveCheckpoint(basePath(number))) {
+        return false;
+    }
+    removeBefore(number);
+    return true;
+}
+
+bool IncrementalBackup::restore(InMemoryDatabase& database, unsigned threads) const {
+    const Files files = scan();
+    if (files.base == 0) {
+        return false;
+    }
+    // Дельты читаются до загрузки базы: поврежденная дельта не меняет database
+    std::vector<std::vector<LogRecord>> deltas;
+    for (std::uint64_t number : files.deltas) {
+        auto records = WriteAheadLog::readAll(deltaPath(number));
+        if (!records) {
+            return false;
+        }
+        deltas.push_back(std::move(*records));
+    }
+    if (!database.loadCheckpoint(basePath(files.base), threads)) {
+        return false;
+    }
+    for (const auto& records : deltas) {
+        for (const LogRecord& record : records) {
+            database.applyLogRecord(record);
+        }
+    }
+    return true;
+}
+
+IncrementalBackup::Stats IncrementalBackup::stats() const {
+    namespace fs = std::filesystem;
+    const Files files = scan();
+    std::error_code error;
+    Stats stats;
+    if (files.base != 0) {
+        stats.base_bytes = fs::file_size(basePath(files.base), error);
+    }
+    for (std::uint64_t number : files.deltas) {
+        const auto size = fs::file_size(deltaPath(number), error);
+        stats.delta_bytes += error ? 0 : size;
+    }
+    stats.deltas = files.deltas.size();
+    return stats;
+}
+
+void IncrementalBackup::removeBefore(std::uint64_t number) const {
+    namespace fs = std::filesystem;
+    std::error_code error;
+    std::vector<fs::path> stale;
+    for (const auto& item : fs::directory_iterator(directory_, error)) {
+        const std::string name = item.path().filename().string();
+        std::uint64_t found = 0;
+        if ((parseNumber(name, "base-", ".ckpt", found) ||
+             parseNumber(name, "delta-", ".log", found)) &&
+            found < number) {
+            stale.push_back(item.path());
+        }
+    }
+    for (const auto& path : stale) {
+        fs::remove(path, error);
+    }
+}
+
+std::string IncrementalBackup::basePath(std::uint64_t number) const {
+    return directory_ + "/base-" + std::to_string(number) + ".ckpt";
+}
+
+std::string IncrementalBackup::deltaPath(std::uint64_t number) const {
+    return directory_ + "/delta-" + std::to_string(number) + ".log";
+}
+
+} // namespace services
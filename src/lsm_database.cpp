@@ -0,0 +1,1055 @@
+#include "services/lsm_database.hpp"
+#include "services/bloom_filter.hpp"
+#include "services/file_io.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace services {
+
+using namespace lsm_format;
+
+namespace {
+
+constexpr char kManifestMagic[] = "IMDBLSM";
+constexpr int kManifestVersion = 1;
+
+// Оценка памяти записи memtable: узел дерева и строки
+std::size_t recordBytes(const LogRecord& record) {
+    return sizeof(std::pair<const std::uint64_t, LogRecord>) + 32 + record.user.name.size() +
+           record.user.email.size() + record.order.product_name.size();
+}
+
+std::uint64_t keyOf(const LogRecord& record) {
+    switch (record.type) {
+    case LogRecord::Type::PutUser:
+        return makeKey(kUserKind, record.user.id);
+    case LogRecord::Type::DeleteUser:
+        return makeKey(kUserKind, record.id);
+    case LogRecord::Type::PutOrder:
+        return makeKey(kOrderKind, record.order.id);
+    default:
+        return makeKey(kOrderKind, record.id);
+    }
+}
+
+bool isDelete(const LogRecord& record) {
+    return record.type == LogRecord::Type::DeleteUser ||
+           record.type == LogRecord::Type::DeleteOrder;
+}
+
+} // namespace
+
+/**
+ * @brief Неизменяемый прогон, отображенный в память только для чтения
+ */
+class LsmRun {
+public:
+    /**
+     * @brief Сборка прогона: записи добавляются по возрастанию ключа
+     */
+    class Builder {
+    public:
+        void add(const LogRecord& record) {
+            Entry entry{};
+            entry.key = keyOf(record);
+            entry.text_offset = text_.size();
+            if (isDelete(record)) {
+                entry.flags = kDeleted;
+            } else if (record.type == LogRecord::Type::PutUser) {
+                entry.first_size = static_cast<std::uint32_t>(record.user.name.size());
+                entry.second_size = static_cast<std::uint32_t>(record.user.email.size());
+                entry.flags = record.user.is_active ? kActive : 0;
+                text_.append(record.user.name).append(record.user.email);
+            } else {
+                entry.first_size = static_cast<std::uint32_t>(record.order.product_name.size());
+                entry.amount = record.order.amount.minorUnits();
+                entry.user_id = record.order.user_id;
+                entry.status = static_cast<std::uint8_t>(record.order.status);
+                text_.append(record.order.product_name);
+            }
+            entries_.push_back(entry);
+        }
+
+        // Перенести запись другого прогона (слияние)
+        void add(Entry entry, const char* text) {
+            const char* source = text + entry.text_offset;
+            entry.text_offset = text_.size();
+            text_.append(source, std::size_t{entry.first_size} + entry.second_size);
+            entries_.push_back(entry);
+        }
+
+        bool empty() const { return entries_.empty(); }
+
+        /**
+         * @brief Записать прогон во временный файл, сбросить на диск
+         *        и переименовать в path
+         */
+        bool write(const std::string& path, unsigned bloom_bits_per_key) const {
+            BloomFilter bloom(entries_.size(), bloom_bits_per_key);
+            for (const Entry& entry : entries_) {
+                bloom.add(entry.key);
+            }
+            const auto* entries = reinterpret_cast<const char*>(entries_.data());
+            const std::size_t entries_size = entries_.size() * sizeof(Entry);
+            const auto* bits = reinterpret_cast<const char*>(bloom.bytes().data());
+
+            Header header{};
+            std::memcpy(header.magic, kMagic, sizeof(kMagic));
+            header.version = kVersion;
+            header.byte_order = kByteOrderMark;
+            header.entries = entries_.size();
+            header.text_bytes = text_.size();
+            header.bloom_bytes = bloom.bytes().size();
+            header.bloom_hashes = bloom.hashes();
+            std::uint32_t crc = crc32(entries, entries_size);
+            crc = crc32(text_.data(), text_.size(), crc);
+            header.crc = crc32(bits, bloom.bytes().size(), crc);
+
+            const std::string temp = path + ".tmp";
+            const int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                return false;
+            }
+            bool ok = writeFully(fd, reinterpret_cast<const char*>(&header), sizeof(header)) &&
+                      writeFully(fd, entries, entries_size) &&
+                      writeFully(fd, text_.data(), text_.size()) &&
+                      writeFully(fd, bits, bloom.bytes().size()) && syncToDisk(fd);
+            ok = ::close(fd) == 0 && ok;
+            if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+                std::remove(temp.c_str());
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        std::vector<Entry> entries_;
+        std::string text_;
+    };
+
+    /**
+     * @return nullptr, если файл не открылся или поврежден
+     */
+    static std::shared_ptr<const LsmRun> open(const std::string& path, std::uint64_t number,
+                                              unsigned tier) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(Header)) {
+            ::close(fd);
+            return nullptr;
+        }
+        const auto size = static_cast<std::size_t>(info.st_size);
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            return nullptr;
+        }
+        // Поиск по прогону — бинарный, упреждающее чтение не поможет
+        ::madvise(mapped, size, MADV_RANDOM);
+
+        std::shared_ptr<LsmRun> run(
+            new LsmRun(path, number, tier, static_cast<const char*>(mapped), size));
+        if (!run->validate()) {
+            return nullptr;
+        }
+        return run;
+    }
+
+    LsmRun(const LsmRun&) = delete;
+    LsmRun& operator=(const LsmRun&) = delete;
+
+    ~LsmRun() { ::munmap(const_cast<char*>(data_), size_); }
+
+    const std::string& path() const { return path_; }
+    std::uint64_t number() const { return number_; }
+    unsigned tier() const { return tier_; }
+    std::uint64_t bytes() const { return size_; }
+    std::size_t size() const { return header_.entries; }
+
+    const Entry& entry(std::size_t index) const { return entries_[index]; }
+    std::uint64_t key(std::size_t index) const { return entries_[index].key; }
+    const char* text() const { return text_; }
+
+    bool mayContain(std::uint64_t key) const {
+        return BloomFilter::mayContain(bloom_, header_.bloom_bytes, header_.bloom_hashes, key);
+    }
+
+    // Первая запись с ключом >= key
+    std::size_t lowerBound(std::uint64_t key) const {
+        const Entry* begin = entries_;
+        const Entry* end = entries_ + header_.entries;
+        return std::lower_bound(begin, end, key,
+                                [](const Entry& entry, std::uint64_t value) {
+                                    return entry.key < value;
+                                }) -
+               begin;
+    }
+
+    LogRecord record(std::size_t index) const {
+        const Entry& entry = entries_[index];
+        const int id = static_cast<int>(static_cast<std::uint32_t>(entry.key));
+        const bool user = (entry.key >> 32) == kUserKind;
+        if ((entry.flags & kDeleted) != 0) {
+            return user ? LogRecord::deleteUser(id) : LogRecord::deleteOrder(id);
+        }
+        const char* first = text_ + entry.text_offset;
+        if (user) {
+            return LogRecord::putUser(contracts::User{
+                id, std::string(first, entry.first_size),
+                std::string(first + entry.first_size, entry.second_size),
+                (entry.flags & kActive) != 0});
+        }
+        return LogRecord::putOrder(contracts::Order{
+            id, entry.user_id, std::string(first, entry.first_size),
+            contracts::Money::fromMinorUnits(entry.amount),
+            static_cast<contracts::OrderStatus>(entry.status)});
+    }
+
+private:
+    LsmRun(std::string path, std::uint64_t number, unsigned tier, const char* data,
+           std::size_t size)
+        : path_(std::move(path)), number_(number), tier_(tier), data_(data), size_(size) {
+        std::memcpy(&header_, data_, sizeof(header_));
+    }
+
+    bool validate() {
+        if (std::memcmp(header_.magic, kMagic, sizeof(kMagic)) != 0 ||
+            header_.version != kVersion || header_.byte_order != kByteOrderMark ||
+            header_.bloom_hashes == 0 || header_.bloom_hashes > 30 || header_.bloom_bytes == 0) {
+            return false;
+        }
+        const std::uint64_t limit = size_;
+        if (header_.entries > limit / sizeof(Entry) || header_.text_bytes > limit ||
+            header_.bloom_bytes > limit) {
+            return false;
+        }
+        if (sizeof(Header) + header_.entries * sizeof(Entry) + header_.text_bytes +
+                header_.bloom_bytes !=
+            size_) {
+            return false;
+        }
+        // Заголовок 48 байт от начала страницы: записи выровнены по 8
+        entries_ = reinterpret_cast<const Entry*>(data_ + sizeof(Header));
+        text_ = data_ + sizeof(Header) + header_.entries * sizeof(Entry);
+        bloom_ = reinterpret_cast<const std::uint8_t*>(text_ + header_.text_bytes);
+        if (crc32(data_ + sizeof(Header), size_ - sizeof(Header)) != header_.crc) {
+            return false;
+        }
+        for (std::size_t i = 0; i < header_.entries; ++i) {
+            const Entry& entry = entries_[i];
+            const std::uint64_t kind = entry.key >> 32;
+            if ((kind != kUserKind && kind != kOrderKind) ||
+                (i > 0 && entries_[i - 1].key >= entry.key) ||
+                entry.text_offset > header_.text_bytes ||
+                header_.text_bytes - entry.text_offset <
+                    std::uint64_t{entry.first_size} + entry.second_size ||
+                entry.status > static_cast<std::uint8_t>(contracts::OrderStatus::CANCELLED)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const std::string path_;
+    const std::uint64_t number_;
+    const unsigned tier_;
+    const char* data_;
+    const std::size_t size_;
+    Header header_{};
+    const Entry* entries_ = nullptr;
+    const char* text_ = nullptr;
+    const std::uint8_t* bloom_ = nullptr;
+};
+
+std::shared_ptr<LsmDatabase> LsmDatabase::open(const std::string& directory, Options options) {
+    options.fanout = std::max(options.fanout, 2u);
+    options.memtable_bytes = std::max<std::size_t>(options.memtable_bytes, 1);
+    std::shared_ptr<LsmDatabase> database(new LsmDatabase(directory, options));
+    if (!database->recover()) {
+        return nullptr;
+    }
+    LsmDatabase* raw = database.get();
+    database->worker_ = std::thread([raw] { raw->backgroundLoop(); });
+    return database;
+}
+
+LsmDatabase::LsmDatabase(std::string directory, Options options)
+    : directory_(std::move(directory)),
+      options_(options),
+      memtable_(std::make_shared<Memtable>()),
+      users_(std::make_unique<DenseIdArray<KeySlot>>()),
+      orders_(std::make_unique<DenseIdArray<KeySlot>>()),
+      user_ids_(std::make_shared<IdAllocator>()),
+      order_ids_(std::make_shared<IdAllocator>()) {}
+
+LsmDatabase::~LsmDatabase() {
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    idle_cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool LsmDatabase::recover() {
+    namespace fs = std::filesystem;
+    std::error_code error;
+    if (!fs::is_directory(directory_, error)) {
+        return false;
+    }
+
+    std::uint64_t first_log = 1;
+    std::ifstream manifest_in(directory_ + "/MANIFEST");
+    if (manifest_in) {
+        std::string magic;
+        int version = 0;
+        if (!(manifest_in >> magic >> version) || magic != kManifestMagic ||
+            version != kManifestVersion) {
+            return false;
+        }
+        std::string line;
+        std::getline(manifest_in, line);
+        while (std::getline(manifest_in, line)) {
+            std::istringstream fields(line);
+            std::string tag;
+            fields >> tag;
+            if (tag == "log" && fields >> first_log) {
+                continue;
+            }
+            if (tag == "next" && fields >> next_run_) {
+                continue;
+            }
+            std::uint64_t number = 0;
+            unsigned tier = 0;
+            if (tag != "run" || !(fields >> number >> tier)) {
+                return false;
+            }
+            auto run = LsmRun::open(runPath(number), number, tier);
+            if (run == nullptr) {
+                return false;
+            }
+            runs_.push_back(std::move(run));
+        }
+    }
+
+    // Файлы вне MANIFEST — от прерванных сброса, слияния или clear()
+    std::set<std::uint64_t> live_runs;
+    for (const auto& run : runs_) {
+        live_runs.insert(run->number());
+    }
+    std::vector<std::uint64_t> logs;
+    for (const auto& item : fs::directory_iterator(directory_, error)) {
+        const std::string name = item.path().filename().string();
+        std::uint64_t number = 0;
+        if (parseNumber(name, "wal-", ".log", number)) {
+            if (number >= first_log) {
+                logs.push_back(number);
+            } else {
+                fs::remove(item.path(), error);
+            }
+        } else if ((parseNumber(name, "run-", ".dat", number) && live_runs.count(number) == 0) ||
+                   (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0)) {
+            fs::remove(item.path(), error);
+        }
+    }
+    std::sort(logs.begin(), logs.end());
+
+    int max_user_id = 0;
+    int max_order_id = 0;
+    auto track = [&](std::uint32_t kind, int id) {
+        int& max_id = kind == kUserKind ? max_user_id : max_order_id;
+        max_id = std::max(max_id, id);
+    };
+    for (const auto& run : runs_) {
+        for (std::size_t i = 0; i < run->size(); ++i) {
+            const Entry& entry = run->entry(i);
+            const auto kind = static_cast<std::uint32_t>(entry.key >> 32);
+            const int id = static_cast<int>(static_cast<std::uint32_t>(entry.key));
+            applyKey(kind, id, (entry.flags & kDeleted) != 0, entry.user_id);
+            track(kind, id);
+        }
+        next_run_ = std::max(next_run_, run->number() + 1);
+    }
+    for (std::uint64_t generation : logs) {
+        WriteAheadLog::replay(logPath(generation), [&](const LogRecord& record) {
+            // Журналы LsmDatabase содержат только Put* и Delete*
+            if (record.type == LogRecord::Type::Clear ||
+                record.type == LogRecord::Type::SetOrderStatus) {
+                return;
+            }
+            auto node = makeNode(record);
+            apply(node);
+            const std::uint64_t key = keyOf(record);
+            track(static_cast<std::uint32_t>(key >> 32),
+                  static_cast<int>(static_cast<std::uint32_t>(key)));
+        });
+    }
+    user_ids_->advancePast(max_user_id);
+    order_ids_->advancePast(max_order_id);
+
+    // Восстановленная memtable остается в журналах до первого сброса,
+    // поэтому дозапись продолжается в последний из них
+    first_log_ = logs.empty() ? first_log : logs.front();
+    log_generation_ = logs.empty() ? first_log : logs.back();
+    log_ = WriteAheadLog::open(logPath(log_generation_),
+                               WriteAheadLog::Options{options_.durability});
+    if (log_ == nullptr) {
+        return false;
+    }
+    return manifest_in || writeManifest(manifest());
+}
+
+LsmDatabase::Records::node_type LsmDatabase::makeNode(const LogRecord& record) {
+    Records records;
+    records.emplace(keyOf(record), record);
+    return records.extract(records.begin());
+}
+
+void LsmDatabase::apply(Records::node_type& node) {
+    const std::uint64_t key = node.key();
+    const LogRecord& record = node.mapped();
+    const bool deleted = isDelete(record);
+    applyKey(static_cast<std::uint32_t>(key >> 32),
+             static_cast<int>(static_cast<std::uint32_t>(key)), deleted,
+             record.type == LogRecord::Type::PutOrder ? record.order.user_id : 0);
+    memtable_->bytes += recordBytes(record);
+
+    auto it = memtable_->records.find(key);
+    if (it == memtable_->records.end()) {
+        memtable_->records.insert(std::move(node));
+    } else {
+        std::swap(it->second, node.mapped());
+    }
+}
+
+void LsmDatabase::applyKey(std::uint32_t kind, int id, bool deleted, int user_id) {
+    KeySlot& slot = (kind == kUserKind ? users_ : orders_)->ensure(id);
+    if (kind == kOrderKind) {
+        const bool moved = slot.live && (deleted || slot.user_id != user_id);
+        if (moved) {
+            unindexOrder(slot.user_id, id);
+        }
+        if (!deleted && (!slot.live || moved)) {
+            indexOrder(user_id, id);
+        }
+    }
+    slot.live = !deleted;
+    slot.user_id = deleted ? 0 : user_id;
+}
+
+std::uint64_t LsmDatabase::write(std::unique_lock<std::shared_mutex>& lock,
+                                 const std::string& frame, Records::node_type& node,
+                                 std::shared_ptr<WriteAheadLog>& log) {
+    if (failed_) {
+        return 0;
+    }
+    const std::uint64_t lsn = log_->append(frame);
+    if (lsn == 0) {
+        return 0;
+    }
+    log = log_;
+    stats_.logical_bytes += frame.size();
+    apply(node);
+
+    if (memtable_->bytes >= options_.memtable_bytes) {
+        // Предыдущая memtable еще сбрасывается: писатель ждет, иначе
+        // память под замороженные таблицы росла бы без предела
+        idle_cv_.wait(lock, [this] { return frozen_ == nullptr || failed_ || stop_; });
+        if (frozen_ == nullptr && !failed_ &&
+            memtable_->bytes >= options_.memtable_bytes) {
+            freezeMemtable();
+        }
+    }
+    return lsn;
+}
+
+bool LsmDatabase::freezeMemtable() {
+    auto next = WriteAheadLog::open(logPath(log_generation_ + 1),
+                                    WriteAheadLog::Options{options_.durability});
+    if (next == nullptr) {
+        failed_ = true;
+        return false;
+    }
+    frozen_ = std::move(memtable_);
+    memtable_ = std::make_shared<Memtable>();
+    frozen_log_ = std::move(log_);
+    log_ = std::move(next);
+    ++log_generation_;
+    work_cv_.notify_one();
+    return true;
+}
+
+int LsmDatabase::saveUser(const contracts::User& user) {
+    contracts::User stored = user;
+    stored.id = user_ids_->allocate();
+    if (stored.id < 0) {
+        return -1;
+    }
+    const LogRecord record = LogRecord::putUser(stored);
+    const std::string frame = WriteAheadLog::encode(record);
+    auto node = makeNode(record);
+    std::shared_ptr<WriteAheadLog> log;
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const std::uint64_t lsn = write(lock, frame, node, log);
+    lock.unlock();
+    return lsn != 0 && log->commit(lsn) ? stored.id : -1;
+}
+
+std::optional<contracts::User> LsmDatabase::findUserById(int id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const KeySlot* slot = users_->find(id);
+    if (slot == nullptr || !slot->live) {
+        return std::nullopt;
+    }
+    auto record = lookup(makeKey(kUserKind, id));
+    if (!record || record->type != LogRecord::Type::PutUser) {
+        return std::nullopt;
+    }
+    return std::move(record->user);
+}
+
+std::vector<contracts::User> LsmDatabase::findAllUsers() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<contracts::User> result;
+    scan(kUserKind, [&](const LogRecord& record) { result.push_back(record.user); });
+    return result;
+}
+
+bool LsmDatabase::updateUser(const contracts::User& user) {
+    const LogRecord record = LogRecord::putUser(user);
+    const std::string frame = WriteAheadLog::encode(record);
+    auto node = makeNode(record);
+    std::shared_ptr<WriteAheadLog> log;
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const KeySlot* slot = users_->find(user.id);
+    if (slot == nullptr || !slot->live) {
+        return false;
+    }
+    const std::uint64_t lsn = write(lock, frame, node, log);
+    lock.unlock();
+    return lsn != 0 && log->commit(lsn);
+}
+
+bool LsmDatabase::deleteUser(int id) {
+    const LogRecord record = LogRecord::deleteUser(id);
+    const std::string frame = WriteAheadLog::encode(record);
+    auto node = makeNode(record);
+    std::shared_ptr<WriteAheadLog> log;
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const KeySlot* slot = users_->find(id);
+    if (slot == nullptr || !slot->live) {
+        return false;
+    }
+    const std::uint64_t lsn = write(lock, frame, node, log);
+    lock.unlock();
+    return lsn != 0 && log->commit(lsn);
+}
+
+int LsmDatabase::saveOrder(const contracts::Order& order) {
+    contracts::Order stored = order;
+    stored.id = order_ids_->allocate();
+    if (stored.id < 0) {
+        return -1;
+    }
+    const LogRecord record = LogRecord::putOrder(stored);
+    const std::string frame = WriteAheadLog::encode(record);
+    auto node = makeNode(record);
+    std::shared_ptr<WriteAheadLog> log;
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const std::uint64_t lsn = write(lock, frame, node, log);
+    lock.unlock();
+    return lsn != 0 && log->commit(lsn) ? stored.id : -1;
+}
+
+std::optional<contracts::Order> LsmDatabase::findOrderById(int id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const KeySlot* slot = orders_->find(id);
+    if (slot == nullptr || !slot->live) {
+        return std::nullopt;
+    }
+    auto record = lookup(makeKey(kOrderKind, id));
+    if (!record || record->type != LogRecord::Type::PutOrder) {
+        return std::nullopt;
+    }
+    return std::move(record->order);
+}
+
+std::vector<contracts::Order> LsmDatabase::findOrdersByUserId(int user_id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<contracts::Order> result;
+    auto index_it = user_orders_.find(user_id);
+    if (index_it == user_orders_.end()) {
+        return result;
+    }
+    result.reserve(index_it->second.size());
+    for (int order_id : index_it->second) {
+        auto record = lookup(makeKey(kOrderKind, order_id));
+        if (record && record->type == LogRecord::Type::PutOrder) {
+            result.push_back(std::move(record->order));
+        }
+    }
+    return result;
+}
+
+std::vector<contracts::Order> LsmDatabase::findAllOrders() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<contracts::Order> result;
+    scan(kOrderKind, [&](const LogRecord& record) { result.push_back(record.order); });
+    return result;
+}
+
+bool LsmDatabase::updateOrder(const contracts::Order& order) {
+    const LogRecord record = LogRecord::putOrder(order);
+    const std::string frame = WriteAheadLog::encode(record);
+    auto node = makeNode(record);
+    std::shared_ptr<WriteAheadLog> log;
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const KeySlot* slot = orders_->find(order.id);
+    if (slot == nullptr || !slot->live) {
+        return false;
+    }
+    const std::uint64_t lsn = write(lock, frame, node, log);
+    lock.unlock();
+    return lsn != 0 && log->commit(lsn);
+}
+
+bool LsmDatabase::deleteOrder(int id) {
+    const LogRecord record = LogRecord::deleteOrder(id);
+    const std::string frame = WriteAheadLog::encode(record);
+    auto node = makeNode(record);
+    std::shared_ptr<WriteAheadLog> log;
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const KeySlot* slot = orders_->find(id);
+    if (slot == nullptr || !slot->live) {
+        return false;
+    }
+    const std::uint64_t lsn = write(lock, frame, node, log);
+    lock.unlock();
+    return lsn != 0 && log->commit(lsn);
+}
+
+std::optional<LogRecord> LsmDatabase::lookup(std::uint64_t key) const {
+    auto it = memtable_->records.find(key);
+    if (it != memtable_->records.end()) {
+        return it->second;
+    }
+    if (frozen_ != nullptr) {
+        auto frozen_it = frozen_->records.find(key);
+        if (frozen_it != frozen_->records.end()) {
+            return frozen_it->second;
+        }
+    }
+    for (auto run = runs_.rbegin(); run != runs_.rend(); ++run) {
+        if (!(*run)->mayContain(key)) {
+            bloom_skips_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        run_probes_.fetch_add(1, std::memory_order_relaxed);
+        const std::size_t index = (*run)->lowerBound(key);
+        if (index < (*run)->size() && (*run)->key(index) == key) {
+            return (*run)->record(index);
+        }
+    }
+    return std::nullopt;
+}
+
+template <typename Visitor>
+void LsmDatabase::scan(std::uint32_t kind, Visitor&& visit) const {
+    // Курсоры источников от новых к старым: при равных ключах
+    // побеждает первый
+    struct Cursor {
+        Records::const_iterator it;
+        Records::const_iterator end;
+        const LsmRun* run = nullptr;
+        std::size_t index = 0;
+        std::size_t stop = 0;
+
+        bool done() const { return run != nullptr ? index >= stop : it == end; }
+        std::uint64_t key() const { return run != nullptr ? run->key(index) : it->first; }
+        void next() {
+            if (run != nullptr) {
+                ++index;
+            } else {
+                ++it;
+            }
+        }
+    };
+
+    const std::uint64_t first = makeKey(kind, 0);
+    const std::uint64_t last = std::uint64_t{kind + 1} << 32;
+    std::vector<Cursor> cursors;
+    auto add_memtable = [&](const Records& records) {
+        Cursor cursor;
+        cursor.it = records.lower_bound(first);
+        cursor.end = records.lower_bound(last);
+        cursors.push_back(cursor);
+    };
+    add_memtable(memtable_->records);
+    if (frozen_ != nullptr) {
+        add_memtable(frozen_->records);
+    }
+    for (auto run = runs_.rbegin(); run != runs_.rend(); ++run) {
+        Cursor cursor;
+        cursor.run = run->get();
+        cursor.index = (*run)->lowerBound(first);
+        cursor.stop = (*run)->lowerBound(last);
+        cursors.push_back(cursor);
+    }
+
+    while (true) {
+        Cursor* winner = nullptr;
+        for (Cursor& cursor : cursors) {
+            if (!cursor.done() && (winner == nullptr || cursor.key() < winner->key())) {
+                winner = &cursor;
+            }
+        }
+        if (winner == nullptr) {
+            break;
+        }
+        const std::uint64_t key = winner->key();
+        if (winner->run == nullptr) {
+            if (!isDelete(winner->it->second)) {
+                visit(winner->it->second);
+            }
+        } else if ((winner->run->entry(winner->index).flags & kDeleted) == 0) {
+            visit(winner->run->record(winner->index));
+        }
+        for (Cursor& cursor : cursors) {
+            if (!cursor.done() && cursor.key() == key) {
+                cursor.next();
+            }
+        }
+    }
+}
+
+void LsmDatabase::backgroundLoop() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    while (!stop_) {
+        if (failed_) {
+            idle_cv_.notify_all();
+            work_cv_.wait(lock, [this] { return stop_; });
+            continue;
+        }
+        if (frozen_ != nullptr) {
+            if (!flushFrozen(lock)) {
+                failed_ = true;
+            }
+            idle_cv_.notify_all();
+            continue;
+        }
+        if (pickCompaction().second != 0) {
+            compacting_ = true;
+            if (!compactTier(lock)) {
+                failed_ = true;
+            }
+            compacting_ = false;
+            idle_cv_.notify_all();
+            continue;
+        }
+        work_cv_.wait(lock);
+    }
+}
+
+bool LsmDatabase::flushFrozen(std::unique_lock<std::shared_mutex>& lock) {
+    const std::shared_ptr<const Memtable> memtable = frozen_;
+    const std::uint64_t epoch = epoch_;
+    const std::uint64_t number = next_run_++;
+    const std::string path = runPath(number);
+    lock.unlock();
+
+    LsmRun::Builder builder;
+    for (const auto& [key, record] : memtable->records) {
+        builder.add(record);
+    }
+    auto run = builder.write(path, options_.bloom_bits_per_key) ? LsmRun::open(path, number, 0)
+                                                                : nullptr;
+
+    std::unique_lock<std::mutex> manifest_lock(manifest_mutex_);
+    lock.lock();
+    if (epoch != epoch_) {
+        // clear() уже отбросил эту memtable
+        std::remove(path.c_str());
+        return true;
+    }
+    if (run == nullptr) {
+        return false;
+    }
+    stats_.flushes += 1;
+    stats_.flushed_bytes += run->bytes();
+    runs_.push_back(std::move(run));
+    frozen_.reset();
+    std::shared_ptr<WriteAheadLog> frozen_log = std::move(frozen_log_);
+    const std::uint64_t first_old_log = first_log_;
+    first_log_ = log_generation_;
+    const std::string content = manifest();
+    lock.unlock();
+
+    // Журналы замороженной memtable больше не нужны: она в прогоне
+    frozen_log.reset();
+    const bool ok = writeManifest(content);
+    if (ok) {
+        for (std::uint64_t generation = first_old_log; generation < first_log_; ++generation) {
+            std::remove(logPath(generation).c_str());
+        }
+    }
+    manifest_lock.unlock();
+    lock.lock();
+    return ok;
+}
+
+bool LsmDatabase::compactTier(std::unique_lock<std::shared_mutex>& lock) {
+    const auto [first, last] = pickCompaction();
+    // Прогоны от старых к новым; сброс только дописывает в конец runs_,
+    // а слияния идут в этом же потоке, поэтому [first, last) не сдвинется
+    const std::vector<std::shared_ptr<const LsmRun>> inputs(runs_.begin() + first,
+                                                            runs_.begin() + last);
+    const bool bottom = first == 0;
+    const std::uint64_t epoch = epoch_;
+    const std::uint64_t number = next_run_++;
+    const std::string path = runPath(number);
+    lock.unlock();
+
+    LsmRun::Builder builder;
+    std::vector<std::size_t> positions(inputs.size(), 0);
+    while (true) {
+        // При равных ключах побеждает более новый прогон
+        std::size_t winner = inputs.size();
+        for (std::size_t i = inputs.size(); i-- > 0;) {
+            if (positions[i] < inputs[i]->size() &&
+                (winner == inputs.size() ||
+                 inputs[i]->key(positions[i]) < inputs[winner]->key(positions[winner]))) {
+                winner = i;
+            }
+        }
+        if (winner == inputs.size()) {
+            break;
+        }
+        const std::uint64_t key = inputs[winner]->key(positions[winner]);
+        const Entry& entry = inputs[winner]->entry(positions[winner]);
+        // Удаление нужно, пока под ним могут лежать старые версии
+        if (!bottom || (entry.flags & kDeleted) == 0) {
+            builder.add(entry, inputs[winner]->text());
+        }
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            if (positions[i] < inputs[i]->size() && inputs[i]->key(positions[i]) == key) {
+                ++positions[i];
+            }
+        }
+    }
+    const unsigned tier = inputs.front()->tier() + 1;
+    std::shared_ptr<const LsmRun> run;
+    if (!builder.empty()) {
+        if (builder.write(path, options_.bloom_bits_per_key)) {
+            run = LsmRun::open(path, number, tier);
+        }
+        if (run == nullptr) {
+            std::remove(path.c_str());
+            std::unique_lock<std::mutex> manifest_lock(manifest_mutex_);
+            lock.lock();
+            return epoch != epoch_;
+        }
+    }
+
+    std::unique_lock<std::mutex> manifest_lock(manifest_mutex_);
+    lock.lock();
+    if (epoch != epoch_) {
+        std::remove(path.c_str());
+        return true;
+    }
+    stats_.compactions += 1;
+    auto position = runs_.erase(runs_.begin() + first, runs_.begin() + last);
+    if (run != nullptr) {
+        stats_.compacted_bytes += run->bytes();
+        runs_.insert(position, std::move(run));
+    }
+    const std::string content = manifest();
+    lock.unlock();
+
+    const bool ok = writeManifest(content);
+    if (ok) {
+        // Читатели, начавшие поиск до замены, держат отображения входов
+        for (const auto& input : inputs) {
+            std::remove(input->path().c_str());
+        }
+    }
+    manifest_lock.unlock();
+    lock.lock();
+    return ok;
+}
+
+std::pair<std::size_t, std::size_t> LsmDatabase::pickCompaction() const {
+    // Ярусы не возрастают от старых прогонов к новым; берется самая
+    // новая группа из fanout прогонов одного яруса
+    std::size_t last = runs_.size();
+    while (last > 0) {
+        std::size_t first = last - 1;
+        while (first > 0 && runs_[first - 1]->tier() == runs_[last - 1]->tier()) {
+            --first;
+        }
+        if (last - first >= options_.fanout) {
+            return {last - options_.fanout, last};
+        }
+        last = first;
+    }
+    return {0, 0};
+}
+
+std::string LsmDatabase::manifest() const {
+    std::ostringstream out;
+    out << kManifestMagic << ' ' << kManifestVersion << '\n';
+    out << "log " << first_log_ << '\n';
+    out << "next " << next_run_ << '\n';
+    for (const auto& run : runs_) {
+        out << "run " << run->number() << ' ' << run->tier() << '\n';
+    }
+    return out.str();
+}
+
+bool LsmDatabase::writeManifest(const std::string& content) const {
+    const std::string path = directory_ + "/MANIFEST";
+    const std::string temp = path + ".tmp";
+    const int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = writeFully(fd, content.data(), content.size()) && syncToDisk(fd);
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+void LsmDatabase::clear() {
+    std::unique_lock<std::mutex> manifest_lock(manifest_mutex_);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto next = WriteAheadLog::open(logPath(log_generation_ + 1),
+                                    WriteAheadLog::Options{options_.durability});
+    if (next == nullptr) {
+        failed_ = true;
+        return;
+    }
+    const std::uint64_t first_old_log = first_log_;
+    const std::uint64_t last_old_log = log_generation_;
+    std::vector<std::shared_ptr<const LsmRun>> old_runs = std::move(runs_);
+    std::shared_ptr<WriteAheadLog> old_log = std::move(log_);
+    std::shared_ptr<WriteAheadLog> old_frozen_log = std::move(frozen_log_);
+    std::shared_ptr<Memtable> old_memtable = std::move(memtable_);
+    std::unique_ptr<DenseIdArray<KeySlot>> old_users = std::move(users_);
+    std::unique_ptr<DenseIdArray<KeySlot>> old_orders = std::move(orders_);
+
+    ++epoch_;
+    runs_.clear();
+    log_ = std::move(next);
+    log_generation_ = last_old_log + 1;
+    first_log_ = log_generation_;
+    memtable_ = std::make_shared<Memtable>();
+    frozen_.reset();
+    users_ = std::make_unique<DenseIdArray<KeySlot>>();
+    orders_ = std::make_unique<DenseIdArray<KeySlot>>();
+    user_orders_.clear();
+    user_ids_->reset();
+    order_ids_->reset();
+    const std::string content = manifest();
+    lock.unlock();
+    idle_cv_.notify_all();
+
+    if (!writeManifest(content)) {
+        lock.lock();
+        failed_ = true;
+        return;
+    }
+    old_log.reset();
+    old_frozen_log.reset();
+    for (std::uint64_t generation = first_old_log; generation <= last_old_log; ++generation) {
+        std::remove(logPath(generation).c_str());
+    }
+    for (const auto& run : old_runs) {
+        std::remove(run->path().c_str());
+    }
+}
+
+bool LsmDatabase::flush() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!memtable_->records.empty()) {
+        idle_cv_.wait(lock, [this] { return frozen_ == nullptr || failed_; });
+        if (!failed_ && !memtable_->records.empty()) {
+            freezeMemtable();
+        }
+    }
+    work_cv_.notify_one();
+    idle_cv_.wait(lock, [this] {
+        return failed_ ||
+               (frozen_ == nullptr && !compacting_ && pickCompaction().second == 0);
+    });
+    const bool ok = !failed_;
+    std::shared_ptr<WriteAheadLog> log = log_;
+    lock.unlock();
+    return log->flush() && ok;
+}
+
+LsmDatabase::Stats LsmDatabase::stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    Stats result = stats_;
+    result.runs = runs_.size();
+    result.run_probes = run_probes_.load(std::memory_order_relaxed);
+    result.bloom_skips = bloom_skips_.load(std::memory_order_relaxed);
+    return result;
+}
+
+void LsmDatabase::indexOrder(int user_id, int order_id) {
+    auto& ids = user_orders_[user_id];
+    if (ids.empty() || ids.back() < order_id) {
+        ids.push_back(order_id);
+        return;
+    }
+    ids.insert(std::lower_bound(ids.begin(), ids.end(), order_id), order_id);
+}
+
+void LsmDatabase::unindexOrder(int user_id, int order_id) {
+    auto it = user_orders_.find(user_id);
+    if (it == user_orders_.end()) {
+        return;
+    }
+    auto& ids = it->second;
+    auto pos = std::lower_bound(ids.begin(), ids.end(), order_id);
+    if (pos != ids.end() && *pos == order_id) {
+        ids.erase(pos);
+    }
+    if (ids.empty()) {
+        user_orders_.erase(it);
+    }
+}
+
+std::string LsmDatabase::runPath(std::uint64_t number) const {
+    return directory_ + "/run-" + std::to_string(number) + ".dat";
+}
+
+std::string LsmDatabase::logPath(std::uint64_t generation) const {
+    return directory_ + "/wal-" + std::to_string(generation) + ".log";
+}
+
+} // namespace services
@@ -0,0 +1,518 @@
+#include "services/mapped_database.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace services {
+
+using namespace mapped_format;
+
+namespace {
+
+constexpr std::size_t kInitialSlots = 1024;
+constexpr std::size_t kInitialTextBytes = 64 * 1024;
+
+} // namespace
+
+std::shared_ptr<MappedDatabase> MappedDatabase::open(const std::string& directory) {
+    auto users = MappedFile::open(directory + "/users.dat");
+    auto orders = MappedFile::open(directory + "/orders.dat");
+    auto user_orders = MappedFile::open(directory + "/user_orders.dat");
+    auto strings = MappedFile::open(directory + "/strings.dat");
+    if (!users || !orders || !user_orders || !strings ||
+        !initialize(*users, kUsersMagic, sizeof(UserSlot)) ||
+        !initialize(*orders, kOrdersMagic, sizeof(OrderSlot)) ||
+        !initialize(*user_orders, kUserOrdersMagic, sizeof(UserOrdersSlot)) ||
+        !initialize(*strings, kStringsMagic, 1)) {
+        return nullptr;
+    }
+    std::shared_ptr<MappedDatabase> database(new MappedDatabase(
+        std::move(*users), std::move(*orders), std::move(*user_orders), std::move(*strings)));
+    if (!database->validate()) {
+        return nullptr;
+    }
+    // Падение посреди linkOrder/unlinkOrder оставляет списки
+    // несогласованными; они целиком выводятся из живых слотов
+    if (!database->listsConsistent()) {
+        database->rebuildLists();
+    }
+    return database;
+}
+
+MappedDatabase::MappedDatabase(MappedFile users, MappedFile orders, MappedFile user_orders,
+                               MappedFile strings)
+    : users_(std::move(users)),
+      orders_(std::move(orders)),
+      user_orders_(std::move(user_orders)),
+      strings_(std::move(strings)),
+      user_ids_(std::make_shared<IdAllocator>()),
+      order_ids_(std::make_shared<IdAllocator>()) {
+    user_ids_->advancePast(static_cast<int>(header(users_).used));
+    order_ids_->advancePast(static_cast<int>(header(orders_).used));
+}
+
+bool MappedDatabase::initialize(MappedFile& file, const char (&magic)[8],
+                                std::uint32_t record_size) {
+    const std::size_t initial =
+        record_size == 1 ? kInitialTextBytes : kInitialSlots * record_size;
+    if (file.size() == 0) {
+        if (!file.resize(sizeof(Header) + initial)) {
+            return false;
+        }
+        Header& created = header(file);
+        std::memcpy(created.magic, magic, sizeof(created.magic));
+        created.version = kVersion;
+        created.byte_order = kByteOrderMark;
+        created.record_size = record_size;
+        created.used = 0;
+        return true;
+    }
+    if (file.size() < sizeof(Header)) {
+        return false;
+    }
+    const Header& existing = header(file);
+    const std::size_t capacity = (file.size() - sizeof(Header)) / record_size;
+    // Для слотов used — наибольший ID, его слот должен быть в файле
+    const bool used_fits = record_size == 1 ? existing.used <= capacity
+                                            : existing.used <= INT_MAX &&
+                                                  (existing.used == 0 || existing.used < capacity);
+    return std::memcmp(existing.magic, magic, sizeof(existing.magic)) == 0 &&
+           existing.version == kVersion && existing.byte_order == kByteOrderMark &&
+           existing.record_size == record_size && used_fits;
+}
+
+bool MappedDatabase::validate() const {
+    const std::uint64_t text_used = header(strings_).used;
+    const auto text_fits = [text_used](std::uint64_t offset, std::uint64_t size) {
+        return offset <= text_used && size <= text_used - offset;
+    };
+    const auto last_user = static_cast<int>(header(users_).used);
+    const UserSlot* users = slots<UserSlot>(users_);
+    for (int id = 1; id <= last_user; ++id) {
+        const UserSlot& slot = users[id];
+        if ((slot.flags & kLive) != 0 &&
+            !text_fits(slot.text_offset, std::uint64_t{slot.name_size} + slot.email_size)) {
+            return false;
+        }
+    }
+
+    const auto last_order = static_cast<int>(header(orders_).used);
+    const std::size_t chains = chainCount();
+    const OrderSlot* orders = slots<OrderSlot>(orders_);
+    for (int id = 1; id <= last_order; ++id) {
+        const OrderSlot& slot = orders[id];
+        if ((slot.flags & kLive) != 0 &&
+            (!text_fits(slot.product_offset, slot.product_size) ||
+             slot.status > static_cast<std::uint8_t>(contracts::OrderStatus::CANCELLED) ||
+             slot.user_id < 0 || static_cast<std::size_t>(slot.user_id) >= chains)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MappedDatabase::listsConsistent() const {
+    // Ссылки проверяются и у неживых слотов: прерванная запись могла
+    // оставить заказ в списке пользователя
+    const auto last_order = static_cast<int>(header(orders_).used);
+    const auto order_id_fits = [last_order](int id) { return id >= 0 && id <= last_order; };
+    const OrderSlot* orders = slots<OrderSlot>(orders_);
+    std::size_t live = 0;
+    for (int id = 1; id <= last_order; ++id) {
+        if (!order_id_fits(orders[id].prev) || !order_id_fits(orders[id].next)) {
+            return false;
+        }
+        live += (orders[id].flags & kLive) != 0 ? 1 : 0;
+    }
+
+    // Списки двусвязны, без циклов (всего в них не больше last_order
+    // звеньев) и держат ровно живые заказы своего пользователя
+    const UserOrdersSlot* heads = slots<UserOrdersSlot>(user_orders_);
+    const std::size_t chains = chainCount();
+    std::size_t links = 0;
+    for (std::size_t user_id = 0; user_id < chains; ++user_id) {
+        const UserOrdersSlot& chain = heads[user_id];
+        if (!order_id_fits(chain.first) || !order_id_fits(chain.last)) {
+            return false;
+        }
+        int prev = 0;
+        for (int id = chain.first; id != 0; prev = id, id = orders[id].next) {
+            const OrderSlot& slot = orders[id];
+            if (++links > static_cast<std::size_t>(last_order) || slot.prev != prev ||
+                (slot.flags & kLive) == 0 ||
+                static_cast<std::size_t>(slot.user_id) != user_id) {
+                return false;
+            }
+        }
+        if (prev != chain.last) {
+            return false;
+        }
+    }
+    return links == live;
+}
+
+void MappedDatabase::rebuildLists() {
+    UserOrdersSlot* heads = slots<UserOrdersSlot>(user_orders_);
+    const std::size_t chains = chainCount();
+    for (std::size_t user_id = 0; user_id < chains; ++user_id) {
+        heads[user_id].first = 0;
+        heads[user_id].last = 0;
+    }
+    const auto last_order = static_cast<int>(header(orders_).used);
+    OrderSlot* orders = slots<OrderSlot>(orders_);
+    for (int id = 1; id <= last_order; ++id) {
+        orders[id].prev = 0;
+        orders[id].next = 0;
+    }
+    // По возрастанию ID каждый заказ встает в конец списка;
+    // user_id живых слотов проверен в validate()
+    for (int id = 1; id <= last_order; ++id) {
+        if ((orders[id].flags & kLive) != 0) {
+            linkOrder(orders[id].user_id, id);
+        }
+    }
+}
+
+std::size_t MappedDatabase::chainCount() const {
+    return (user_orders_.size() - sizeof(Header)) / sizeof(UserOrdersSlot);
+}
+
+Header& MappedDatabase::header(const MappedFile& file) {
+    return *reinterpret_cast<Header*>(file.data());
+}
+
+template <typename Slot>
+Slot* MappedDatabase::slots(const MappedFile& file) {
+    return reinterpret_cast<Slot*>(file.data() + sizeof(Header));
+}
+
+template <typename Slot>
+Slot* MappedDatabase::slotAt(const MappedFile& file, int id) {
+    const std::size_t capacity = (file.size() - sizeof(Header)) / sizeof(Slot);
+    if (id < 0 || static_cast<std::size_t>(id) >= capacity) {
+        return nullptr;
+    }
+    return slots<Slot>(file) + id;
+}
+
+template <typename Slot>
+bool MappedDatabase::ensureSlot(MappedFile& file, int id) {
+    const std::size_t capacity = (file.size() - sizeof(Header)) / sizeof(Slot);
+    const auto needed = static_cast<std::size_t>(id) + 1;
+    if (needed <= capacity) {
+        return true;
+    }
+    // Удвоение: переотображений O(log n) за время роста
+    const std::size_t grown = std::max(needed, capacity * 2);
+    return file.resize(sizeof(Header) + grown * sizeof(Slot));
+}
+
+int MappedDatabase::saveUser(const contracts::User& user) {
+    const int id = user_ids_->allocate();
+    if (id < 0) {
+        return -1;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::uint64_t offset = 0;
+    if (!ensureSlot<UserSlot>(users_, id) || !appendText(user.name, user.email, offset)) {
+        return -1;
+    }
+    Header& head = header(users_);
+    head.used = std::max<std::uint64_t>(head.used, static_cast<std::uint64_t>(id));
+    UserSlot& slot = *slotAt<UserSlot>(users_, id);
+    slot.text_offset = offset;
+    slot.name_size = static_cast<std::uint32_t>(user.name.size());
+    slot.email_size = static_cast<std::uint32_t>(user.email.size());
+    slot.is_active = user.is_active ? 1 : 0;
+    slot.flags = kLive;
+    return id;
+}
+
+std::optional<contracts::User> MappedDatabase::findUserById(int id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (const UserSlot* slot = liveUser(id)) {
+        return toUser(id, *slot);
+    }
+    return std::nullopt;
+}
+
+std::vector<contracts::User> MappedDatabase::findAllUsers() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<contracts::User> result;
+    const auto last = static_cast<int>(header(users_).used);
+    const UserSlot* all = slots<UserSlot>(users_);
+    for (int id = 1; id <= last; ++id) {
+        if ((all[id].flags & kLive) != 0) {
+            result.push_back(toUser(id, all[id]));
+        }
+    }
+    return result;
+}
+
+bool MappedDatabase::updateUser(const contracts::User& user) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const UserSlot* current = liveUser(user.id);
+    if (current == nullptr) {
+        return false;
+    }
+    // Обычно меняется только is_active: строки дописываются, только если изменились
+    std::uint64_t offset = current->text_offset;
+    if (text(current->text_offset, current->name_size) != user.name ||
+        text(current->text_offset + current->name_size, current->email_size) != user.email) {
+        if (!appendText(user.name, user.email, offset)) {
+            return false;
+        }
+    }
+    UserSlot& slot = *slotAt<UserSlot>(users_, user.id);
+    slot.text_offset = offset;
+    slot.name_size = static_cast<std::uint32_t>(user.name.size());
+    slot.email_size = static_cast<std::uint32_t>(user.email.size());
+    slot.is_active = user.is_active ? 1 : 0;
+    return true;
+}
+
+bool MappedDatabase::deleteUser(int id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (liveUser(id) == nullptr) {
+        return false;
+    }
+    std::memset(slotAt<UserSlot>(users_, id), 0, sizeof(UserSlot));
+    return true;
+}
+
+int MappedDatabase::saveOrder(const contracts::Order& order) {
+    const int id = order_ids_->allocate();
+    if (order.user_id < 0 || id < 0) {
+        return -1;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::uint64_t offset = 0;
+    if (!acceptsUserId(order.user_id) || !ensureSlot<OrderSlot>(orders_, id) ||
+        !ensureSlot<UserOrdersSlot>(user_orders_, order.user_id) ||
+        !storeProductName(order.product_name, offset)) {
+        return -1;
+    }
+    // ID отмечается выданным до записи слота: после падения посреди
+    // записи он не достанется другому заказу, уже попав в список
+    Header& head = header(orders_);
+    head.used = std::max<std::uint64_t>(head.used, static_cast<std::uint64_t>(id));
+    OrderSlot& slot = *slotAt<OrderSlot>(orders_, id);
+    slot.product_offset = offset;
+    slot.product_size = static_cast<std::uint32_t>(order.product_name.size());
+    slot.amount = order.amount.minorUnits();
+    slot.user_id = order.user_id;
+    slot.status = static_cast<std::uint8_t>(order.status);
+    // Заказ становится видимым, когда уже включен в список пользователя
+    linkOrder(order.user_id, id);
+    slot.flags = kLive;
+    return id;
+}
+
+std::optional<contracts::Order> MappedDatabase::findOrderById(int id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (const OrderSlot* slot = liveOrder(id)) {
+        return toOrder(id, *slot);
+    }
+    return std::nullopt;
+}
+
+std::vector<contracts::Order> MappedDatabase::findOrdersByUserId(int user_id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<contracts::Order> result;
+    const UserOrdersSlot* chain = slotAt<UserOrdersSlot>(user_orders_, user_id);
+    if (chain == nullptr) {
+        return result;
+    }
+    for (int id = chain->first; id != 0;) {
+        // Ссылки списков проверены или перестроены при открытии
+        const OrderSlot* slot = slotAt<OrderSlot>(orders_, id);
+        if (slot == nullptr) {
+            break;
+        }
+        // Заказ, еще не отмеченный живым, в списке только внутри записи
+        if ((slot->flags & kLive) != 0) {
+            result.push_back(toOrder(id, *slot));
+        }
+        id = slot->next;
+    }
+    return result;
+}
+
+std::vector<contracts::Order> MappedDatabase::findAllOrders() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<contracts::Order> result;
+    const auto last = static_cast<int>(header(orders_).used);
+    const OrderSlot* all = slots<OrderSlot>(orders_);
+    for (int id = 1; id <= last; ++id) {
+        if ((all[id].flags & kLive) != 0) {
+            result.push_back(toOrder(id, all[id]));
+        }
+    }
+    return result;
+}
+
+bool MappedDatabase::updateOrder(const contracts::Order& order) {
+    if (order.user_id < 0) {
+        return false;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const OrderSlot* current = liveOrder(order.id);
+    if (current == nullptr) {
+        return false;
+    }
+    std::uint64_t offset = current->product_offset;
+    // Смена статуса — частый случай, название при этом не переписываем
+    if (text(current->product_offset, current->product_size) != order.product_name &&
+        !storeProductName(order.product_name, offset)) {
+        return false;
+    }
+    const int old_user_id = current->user_id;
+    if (old_user_id != order.user_id) {
+        if (!acceptsUserId(order.user_id) ||
+            !ensureSlot<UserOrdersSlot>(user_orders_, order.user_id)) {
+            return false;
+        }
+        unlinkOrder(old_user_id, order.id);
+        linkOrder(order.user_id, order.id);
+    }
+    OrderSlot& slot = *slotAt<OrderSlot>(orders_, order.id);
+    slot.product_offset = offset;
+    slot.product_size = static_cast<std::uint32_t>(order.product_name.size());
+    slot.amount = order.amount.minorUnits();
+    slot.user_id = order.user_id;
+    slot.status = static_cast<std::uint8_t>(order.status);
+    return true;
+}
+
+bool MappedDatabase::deleteOrder(int id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const OrderSlot* current = liveOrder(id);
+    if (current == nullptr) {
+        return false;
+    }
+    const int user_id = current->user_id;
+    OrderSlot& slot = *slotAt<OrderSlot>(orders_, id);
+    slot.flags = 0;
+    unlinkOrder(user_id, id);
+    std::memset(&slot, 0, sizeof(OrderSlot));
+    return true;
+}
+
+void MappedDatabase::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    // Усечение до заголовка обнуляет слоты и кучу, заголовки остаются
+    for (MappedFile* file : {&users_, &orders_, &user_orders_, &strings_}) {
+        const std::size_t initial = header(*file).record_size == 1
+                                        ? kInitialTextBytes
+                                        : kInitialSlots * header(*file).record_size;
+        header(*file).used = 0;
+        if (!file->resize(sizeof(Header)) || !file->resize(sizeof(Header) + initial)) {
+            // Неудачный resize оставил прежнее отображение: слоты за used
+            // не должны ожить, поэтому они обнуляются на месте
+            std::memset(file->data() + sizeof(Header), 0, file->size() - sizeof(Header));
+        }
+    }
+    product_offsets_.clear();
+    user_ids_->reset();
+    order_ids_->reset();
+}
+
+bool MappedDatabase::sync() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return strings_.sync() && users_.sync() && orders_.sync() && user_orders_.sync();
+}
+
+bool MappedDatabase::acceptsUserId(int user_id) const {
+    return user_id >= 0 && static_cast<std::uint64_t>(user_id) <= header(users_).used;
+}
+
+const UserSlot* MappedDatabase::liveUser(int id) const {
+    const UserSlot* slot = slotAt<UserSlot>(users_, id);
+    return slot != nullptr && (slot->flags & kLive) != 0 ? slot : nullptr;
+}
+
+const OrderSlot* MappedDatabase::liveOrder(int id) const {
+    const OrderSlot* slot = slotAt<OrderSlot>(orders_, id);
+    return slot != nullptr && (slot->flags & kLive) != 0 ? slot : nullptr;
+}
+
+contracts::User MappedDatabase::toUser(int id, const UserSlot& slot) const {
+    return contracts::User{id, std::string(text(slot.text_offset, slot.name_size)),
+                           std::string(text(slot.text_offset + slot.name_size,
+                                            slot.email_size)),
+                           slot.is_active != 0};
+}
+
+contracts::Order MappedDatabase::toOrder(int id, const OrderSlot& slot) const {
+    return contracts::Order{id, slot.user_id,
+                            std::string(text(slot.product_offset, slot.product_size)),
+                            contracts::Money::fromMinorUnits(slot.amount),
+                            static_cast<contracts::OrderStatus>(slot.status)};
+}
+
+std::string_view MappedDatabase::text(std::uint64_t offset, std::size_t size) const {
+    return std::string_view(strings_.data() + sizeof(Header) + offset, size);
+}
+
+bool MappedDatabase::appendText(std::string_view first, std::string_view second,
+                                std::uint64_t& offset) {
+    const std::uint64_t used = header(strings_).used;
+    const std::size_t capacity = strings_.size() - sizeof(Header);
+    const std::size_t needed = used + first.size() + second.size();
+    if (needed > capacity &&
+        !strings_.resize(sizeof(Header) + std::max(needed, capacity * 2))) {
+        return false;
+    }
+    char* data = strings_.data() + sizeof(Header) + used;
+    // data() пустой строки может быть nullptr, memcpy он не передается
+    if (!first.empty()) {
+        std::memcpy(data, first.data(), first.size());
+    }
+    if (!second.empty()) {
+        std::memcpy(data + first.size(), second.data(), second.size());
+    }
+    header(strings_).used = needed;
+    offset = used;
+    return true;
+}
+
+bool MappedDatabase::storeProductName(const std::string& name, std::uint64_t& offset) {
+    auto it = product_offsets_.find(name);
+    if (it != product_offsets_.end()) {
+        offset = it->second;
+        return true;
+    }
+    if (!appendText(name, {}, offset)) {
+        return false;
+    }
+    product_offsets_.emplace(name, offset);
+    return true;
+}
+
+void MappedDatabase::linkOrder(int user_id, int order_id) {
+    UserOrdersSlot& chain = slots<UserOrdersSlot>(user_orders_)[user_id];
+    OrderSlot* all = slots<OrderSlot>(orders_);
+    // Обычно ID растут, и заказ встает в конец списка
+    int after = chain.last;
+    while (after != 0 && after > order_id) {
+        after = all[after].prev;
+    }
+    const int before = after != 0 ? all[after].next : chain.first;
+    all[order_id].prev = after;
+    all[order_id].next = before;
+    (after != 0 ? all[after].next : chain.first) = order_id;
+    (before != 0 ? all[before].prev : chain.last) = order_id;
+}
+
+void MappedDatabase::unlinkOrder(int user_id, int order_id) {
+    UserOrdersSlot& chain = slots<UserOrdersSlot>(user_orders_)[user_id];
+    OrderSlot* all = slots<OrderSlot>(orders_);
+    const int prev = all[order_id].prev;
+    const int next = all[order_id].next;
+    (prev != 0 ? all[prev].next : chain.first) = next;
+    (next != 0 ? all[next].prev : chain.last) = prev;
+    all[order_id].prev = 0;
+    all[order_id].next = 0;
+}
+
+} // namespace services
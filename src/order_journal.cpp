@@ -0,0 +1,317 @@
+#include "services/order_journal.hpp"
+#include "services/file_io.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <filesystem>
+#include <map>
+#include <unistd.h>
+
+namespace services {
+
+namespace {
+
+using OrderMap = std::map<int, contracts::Order>;
+
+void fold(OrderMap& orders, const LogRecord& record) {
+    switch (record.type) {
+    case LogRecord::Type::PutOrder:
+        orders[record.order.id] = record.order;
+        break;
+    case LogRecord::Type::SetOrderStatus: {
+        auto it = orders.find(record.id);
+        if (it != orders.end()) {
+            it->second.status = record.order.status;
+        }
+        break;
+    }
+    case LogRecord::Type::DeleteOrder:
+        orders.erase(record.id);
+        break;
+    default:
+        break;
+    }
+}
+
+// Записать базу во временный файл и переименовать; size — байт в ней
+bool writeBase(const std::string& path, const OrderMap& orders, std::uint64_t& size) {
+    std::string data;
+    for (const auto& [id, order] : orders) {
+        data += WriteAheadLog::encode(LogRecord::putOrder(order));
+    }
+    const std::string temp = path + ".tmp";
+    const int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = writeFully(fd, data.data(), data.size()) && syncToDisk(fd);
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    size = data.size();
+    return true;
+}
+
+} // namespace
+
+std::shared_ptr<OrderJournal> OrderJournal::open(const std::string& directory, Options options) {
+    std::shared_ptr<OrderJournal> journal(new OrderJournal(directory, options));
+    if (!journal->recover()) {
+        return nullptr;
+    }
+    OrderJournal* raw = journal.get();
+    journal->worker_ = std::thread([raw] { raw->compactionLoop(); });
+    return journal;
+}
+
+OrderJournal::OrderJournal(std::string directory, Options options)
+    : directory_(std::move(directory)), options_(options) {}
+
+OrderJournal::~OrderJournal() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool OrderJournal::recover() {
+    namespace fs = std::filesystem;
+    std::error_code error;
+    if (!fs::is_directory(directory_, error)) {
+        return false;
+    }
+    std::vector<std::uint64_t> bases;
+    std::vector<std::uint64_t> segments;
+    for (const auto& item : fs::directory_iterator(directory_, error)) {
+        const std::string name = item.path().filename().string();
+        std::uint64_t number = 0;
+        if (parseNumber(name, "base-", ".log", number)) {
+            bases.push_back(number);
+        } else if (parseNumber(name, "segment-", ".log", number)) {
+            segments.push_back(number);
+        } else if (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0) {
+            // Недописанная база прерванной свертки
+            fs::remove(item.path(), error);
+        }
+    }
+
+    // Базы появляются переименованием, поэтому последняя — полная
+    base_number_ = bases.empty() ? 0 : *std::max_element(bases.begin(), bases.end());
+    for (std::uint64_t number : bases) {
+        if (number != base_number_) {
+            fs::remove(basePath(number), error);
+        }
+    }
+    if (base_number_ != 0) {
+        base_bytes_ = fs::file_size(basePath(base_number_), error);
+    }
+    std::sort(segments.begin(), segments.end());
+    for (std::uint64_t number : segments) {
+        if (number < base_number_) {
+            fs::remove(segmentPath(number), error);
+            continue;
+        }
+        // Оборванный хвост в закрытых сегментах отрезается при чтении
+        sealed_.push_back(Segment{number, fs::file_size(segmentPath(number), error), nullptr});
+    }
+
+    // Дозапись всегда идет в новый сегмент
+    active_number_ = std::max(base_number_, segments.empty() ? 0 : segments.back()) + 1;
+    active_ = WriteAheadLog::open(segmentPath(active_number_),
+                                  WriteAheadLog::Options{options_.durability});
+    return active_ != nullptr;
+}
+
+bool OrderJournal::recordOrder(const contracts::Order& order) {
+    return append(LogRecord::putOrder(order));
+}
+
+bool OrderJournal::recordStatus(int id, contracts::OrderStatus status) {
+    return append(LogRecord::setOrderStatus(id, status));
+}
+
+bool OrderJournal::recordDeleted(int id) {
+    return append(LogRecord::deleteOrder(id));
+}
+
+bool OrderJournal::append(const LogRecord& record) {
+    const std::string frame = WriteAheadLog::encode(record);
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (failed_) {
+        return false;
+    }
+    const std::uint64_t lsn = active_->append(frame);
+    if (lsn == 0) {
+        return false;
+    }
+    std::shared_ptr<WriteAheadLog> log = active_;
+    active_bytes_ += frame.size();
+    stats_.appended_bytes += frame.size();
+    stats_.events += 1;
+    if (active_bytes_ >= options_.segment_bytes) {
+        rollSegment();
+    }
+    lock.unlock();
+    return log->commit(lsn);
+}
+
+bool OrderJournal::rollSegment() {
+    auto next = WriteAheadLog::open(segmentPath(active_number_ + 1),
+                                    WriteAheadLog::Options{options_.durability});
+    if (next == nullptr) {
+        failed_ = true;
+        return false;
+    }
+    sealed_.push_back(Segment{active_number_, active_bytes_, std::move(active_)});
+    active_ = std::move(next);
+    active_number_ += 1;
+    active_bytes_ = 0;
+    if (compactionDue()) {
+        work_cv_.notify_one();
+    }
+    return true;
+}
+
+bool OrderJournal::compactionDue() const {
+    std::uint64_t sealed_bytes = 0;
+    for (const Segment& segment : sealed_) {
+        sealed_bytes += segment.bytes;
+    }
+    return !sealed_.empty() &&
+           static_cast<double>(sealed_bytes) >=
+               options_.compaction_ratio * static_cast<double>(base_bytes_);
+}
+
+void OrderJournal::compactionLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        if (!failed_ && !sealed_.empty() && (requested_ || compactionDue())) {
+            requested_ = false;
+            compacting_ = true;
+            if (!compactSealed(lock)) {
+                failed_ = true;
+            }
+            compacting_ = false;
+            idle_cv_.notify_all();
+            continue;
+        }
+        requested_ = false;
+        idle_cv_.notify_all();
+        work_cv_.wait(lock);
+    }
+}
+
+bool OrderJournal::compactSealed(std::unique_lock<std::mutex>& lock) {
+    // Новые сегменты закрываются только в конец sealed_, поэтому
+    // свернутые останутся его началом
+    const std::vector<Segment> segments = sealed_;
+    const std::uint64_t old_base = base_number_;
+    const std::uint64_t new_base = segments.back().number + 1;
+    lock.unlock();
+
+    bool ok = true;
+    for (const Segment& segment : segments) {
+        // Кадры, добавленные до смены сегмента, могут быть еще в буфере
+        if (segment.log != nullptr && !segment.log->flush()) {
+            ok = false;
+        }
+    }
+    OrderMap orders;
+    const auto apply = [&](const LogRecord& record) { fold(orders, record); };
+    if (old_base != 0) {
+        WriteAheadLog::replay(basePath(old_base), apply);
+    }
+    for (const Segment& segment : segments) {
+        WriteAheadLog::replay(segmentPath(segment.number), apply);
+    }
+    std::uint64_t size = 0;
+    ok = ok && writeBase(basePath(new_base), orders, size);
+
+    lock.lock();
+    if (!ok) {
+        return false;
+    }
+    sealed_.erase(sealed_.begin(), sealed_.begin() + segments.size());
+    base_number_ = new_base;
+    base_bytes_ = size;
+    stats_.compacted_bytes += size;
+    stats_.compactions += 1;
+    lock.unlock();
+
+    if (old_base != 0) {
+        std::remove(basePath(old_base).c_str());
+    }
+    for (const Segment& segment : segments) {
+        std::remove(segmentPath(segment.number).c_str());
+    }
+    lock.lock();
+    return true;
+}
+
+std::vector<contracts::Order> OrderJournal::load() const {
+    // Под mutex_ свертка не заменит файлы посреди чтения
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Segment& segment : sealed_) {
+        if (segment.log != nullptr) {
+            segment.log->flush();
+        }
+    }
+    active_->flush();
+
+    OrderMap orders;
+    const auto apply = [&](const LogRecord& record) { fold(orders, record); };
+    if (base_number_ != 0) {
+        WriteAheadLog::replay(basePath(base_number_), apply);
+    }
+    for (const Segment& segment : sealed_) {
+        WriteAheadLog::replay(segmentPath(segment.number), apply);
+    }
+    WriteAheadLog::replay(segmentPath(active_number_), apply);
+
+    std::vector<contracts::Order> result;
+    result.reserve(orders.size());
+    for (auto& [id, order] : orders) {
+        result.push_back(std::move(order));
+    }
+    return result;
+}
+
+bool OrderJournal::compact() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (active_bytes_ > 0 && !failed_) {
+        rollSegment();
+    }
+    if (!sealed_.empty()) {
+        requested_ = true;
+        work_cv_.notify_one();
+    }
+    idle_cv_.wait(lock, [this] { return failed_ || (!requested_ && !compacting_); });
+    return !failed_;
+}
+
+OrderJournal::Stats OrderJournal::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats result = stats_;
+    result.disk_bytes = base_bytes_ + active_bytes_;
+    for (const Segment& segment : sealed_) {
+        result.disk_bytes += segment.bytes;
+    }
+    result.segments = sealed_.size() + 1;
+    return result;
+}
+
+std::string OrderJournal::segmentPath(std::uint64_t number) const {
+    return directory_ + "/segment-" + std::to_string(number) + ".log";
+}
+
+std::string OrderJournal::basePath(std::uint64_t number) const {
+    return directory_ + "/base-" + std::to_string(number) + ".log";
+}
+
+} // namespace services
@@ -1,21 +1,20 @@
 #include "services/order_service.hpp"
-#include <numeric>
+#include <limits>
 
 namespace services {
 
 OrderService::OrderService(std::shared_ptr<contracts::IDatabase> database,
-                           std::shared_ptr<contracts::IUserService> userService)
-    : database_(std::move(database)), userService_(std::move(userService)) {}
-
-int OrderService::createOrder(int user_id, const std::string& product_name, double amount) {
-    // Проверка контракта: пользователь должен существовать
-    auto user = userService_->getUser(user_id);
-    if (!user.has_value()) {
-        return -1;
-    }
-
-    // Проверка контракта: пользователь должен быть активен
-    if (!user->is_active) {
+                           std::shared_ptr<contracts::IUserService> userService,
+                           std::shared_ptr<OrderJournal> journal)
+    : database_(std::move(database)),
+      userService_(std::move(userService)),
+      journal_(std::move(journal)) {}
+
+int OrderService::createOrder(int user_id, const std::string& product_name,
+                              contracts::Money amount) {
+    // Проверка контракта: пользователь должен существовать и быть активен.
+    // Читается только флаг, без копии имени и email
+    if (!userService_->isActive(user_id)) {
         return -1;
     }
 
@@ -31,7 +30,16 @@ int OrderService::createOrder(int user_id, const std::string& product_name, doub
     order.amount = amount;
     order.status = contracts::OrderStatus::PENDING;
 
-    return database_->saveOrder(order);
+    order.id = database_->saveOrder(order);
+    if (order.id > 0 && journal_) {
+        // Заказ уже виден, и смена статуса могла опередить эту запись:
+        // в журнал идет текущее состояние
+        auto lock = lockForJournal(order.id);
+        if (auto current = database_->findOrderById(order.id)) {
+            journaled(journal_->recordOrder(*current));
+        }
+    }
+    return order.id;
 }
 
 std::optional<contracts::Order> OrderService::getOrder(int id) const {
@@ -42,17 +50,36 @@ std::vector<contracts::Order> OrderService::getUserOrders(int user_id) const {
     return database_->findOrdersByUserId(user_id);
 }
 
+std::vector<contracts::Order> OrderService::getUserOrders(
+    int user_id, const contracts::PageRequest& page) const {
+    return database_->findOrdersByUserIdPage(user_id, page);
+}
+
+std::vector<contracts::OrderSummary> OrderService::getUserOrderSummaries(int user_id) const {
+    contracts::OrderQuery query;
+    query.user_id = user_id;
+    return database_->findOrderSummaries(query);
+}
+
 bool OrderService::updateOrderStatus(int id, contracts::OrderStatus status) {
+    auto lock = lockForJournal(id);
     auto order = database_->findOrderById(id);
     if (!order.has_value()) {
         return false;
     }
 
     order->status = status;
-    return database_->updateOrder(*order);
+    if (!database_->updateOrder(*order)) {
+        return false;
+    }
+    if (journal_) {
+        journaled(journal_->recordStatus(id, status));
+    }
+    return true;
 }
 
 bool OrderService::cancelOrder(int id) {
+    auto lock = lockForJournal(id);
     auto order = database_->findOrderById(id);
     if (!order.has_value()) {
         return false;
@@ -64,20 +91,40 @@ bool OrderService::cancelOrder(int id) {
     }
 
     order->status = contracts::OrderStatus::CANCELLED;
-    return database_->updateOrder(*order);
+    if (!database_->updateOrder(*order)) {
+        return false;
+    }
+    if (journal_) {
+        journaled(journal_->recordStatus(id, contracts::OrderStatus::CANCELLED));
+    }
+    return true;
+}
+
+contracts::Money OrderService::getTotal(int user_id) const {
+    // Не учитываем отмененные заказы; сумма считается в хранилище
+    contracts::OrderQuery query;
+    query.user_id = user_id;
+    query.statuses = contracts::StatusSet::allExcept({contracts::OrderStatus::CANCELLED});
+    return database_->aggregateOrders(query).sum;
 }
 
 double OrderService::getTotalAmount(int user_id) const {
-    auto orders = database_->findOrdersByUserId(user_id);
-    
-    return std::accumulate(orders.begin(), orders.end(), 0.0,
-        [](double sum, const contracts::Order& order) {
-            // Не учитываем отмененные заказы
-            if (order.status != contracts::OrderStatus::CANCELLED) {
-                return sum + order.amount;
-            }
-            return sum;
-        });
+    const contracts::Money total = getTotal(user_id);
+    return total.isValid() ? total.toDouble() : std::numeric_limits<double>::quiet_NaN();
+}
+
+std::unique_lock<std::mutex> OrderService::lockForJournal(int id) {
+    if (!journal_) {
+        return {};
+    }
+    return std::unique_lock<std::mutex>(
+        order_locks_[static_cast<unsigned>(id) % kOrderLocks]);
+}
+
+void OrderService::journaled(bool recorded) {
+    if (!recorded) {
+        journal_failed_.store(true);
+    }
 }
 
 bool OrderService::isValidProductName(const std::string& name) const {
@@ -85,9 +132,10 @@ bool OrderService::isValidProductName(const std::string& name) const {
     return !name.empty();
 }
 
-bool OrderService::isValidAmount(double amount) const {
-    // Контракт: сумма должна быть больше 0
-    return amount > 0;
+bool OrderService::isValidAmount(contracts::Money amount) const {
+    // Контракт: сумма должна быть конечной, больше 0 (после округления
+    // до копейки) и не больше kMaxAmount
+    return amount.isValid() && amount > contracts::Money{} && amount <= kMaxAmount;
 }
 
 bool OrderService::canCancel(contracts::OrderStatus status) const {
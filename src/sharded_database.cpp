@@ -0,0 +1,122 @@
+#include "services/sharded_database.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace services {
+
+ShardedDatabase::ShardedDatabase(std::size_t shard_count)
+    : user_ids_(std::make_shared<IdAllocator>()),
+      order_ids_(std::make_shared<IdAllocator>()) {
+    shard_count = std::max<std::size_t>(shard_count, 1);
+    shards_.reserve(shard_count);
+    for (std::size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<InMemoryDatabase>(user_ids_, order_ids_));
+    }
+}
+
+std::size_t ShardedDatabase::shardIndex(int id) const {
+    return static_cast<unsigned int>(id) % shards_.size();
+}
+
+InMemoryDatabase& ShardedDatabase::shardFor(int id) {
+    return *shards_[shardIndex(id)];
+}
+
+const InMemoryDatabase& ShardedDatabase::shardFor(int id) const {
+    return *shards_[shardIndex(id)];
+}
+
+int ShardedDatabase::saveUser(const contracts::User& user) {
+    contracts::User new_user = user;
+    std::shared_lock<std::shared_mutex> lock(clear_mutex_);
+    new_user.id = user_ids_->allocate();
+    if (new_user.id < 0 || !shardFor(new_user.id).insertUser(new_user)) {
+        return -1;
+    }
+    return new_user.id;
+}
+
+std::optional<contracts::User> ShardedDatabase::findUserById(int id) const {
+    return shardFor(id).findUserById(id);
+}
+
+std::vector<contracts::User> ShardedDatabase::findAllUsers() const {
+    std::vector<contracts::User> result;
+    for (const auto& shard : shards_) {
+        auto part = shard->findAllUsers();
+        result.insert(result.end(), part.begin(), part.end());
+    }
+    return result;
+}
+
+bool ShardedDatabase::updateUser(const contracts::User& user) {
+    return shardFor(user.id).updateUser(user);
+}
+
+bool ShardedDatabase::deleteUser(int id) {
+    return shardFor(id).deleteUser(id);
+}
+
+int ShardedDatabase::saveOrder(const contracts::Order& order) {
+    contracts::Order new_order = order;
+    std::shared_lock<std::shared_mutex> lock(clear_mutex_);
+    new_order.id = order_ids_->allocate();
+    if (new_order.id < 0 || !shardFor(new_order.id).insertOrder(new_order)) {
+        return -1;
+    }
+    return new_order.id;
+}
+
+std::optional<contracts::Order> ShardedDatabase::findOrderById(int id) const {
+    return shardFor(id).findOrderById(id);
+}
+
+std::vector<contracts::Order> ShardedDatabase::findOrdersByUserId(int user_id) const {
+    // Заказы шардируются по своему ID, поэтому заказы пользователя
+    // разбросаны по всем шардам
+    std::vector<contracts::Order> result;
+    for (const auto& shard : shards_) {
+        auto part = shard->findOrdersByUserId(user_id);
+        result.insert(result.end(), part.begin(), part.end());
+    }
+    std::sort(result.begin(), result.end(),
+        [](const contracts::Order& a, const contracts::Order& b) { return a.id < b.id; });
+    return result;
+}
+
+std::vector<contracts::Order> ShardedDatabase::findAllOrders() const {
+    std::vector<contracts::Order> result;
+    for (const auto& shard : shards_) {
+        auto part = shard->findAllOrders();
+        result.insert(result.end(), part.begin(), part.end());
+    }
+    return result;
+}
+
+contracts::OrderAggregate ShardedDatabase::aggregateOrders(
+    const contracts::OrderQuery& query) const {
+    contracts::OrderAggregate aggregate;
+    for (const auto& shard : shards_) {
+        aggregate.merge(shard->aggregateOrders(query));
+    }
+    return aggregate;
+}
+
+bool ShardedDatabase::updateOrder(const contracts::Order& order) {
+    return shardFor(order.id).updateOrder(order);
+}
+
+bool ShardedDatabase::deleteOrder(int id) {
+    return shardFor(id).deleteOrder(id);
+}
+
+void ShardedDatabase::clear() {
+    // Каждый шард сбрасывает и общие аллокаторы ID. Пока очищаются шарды,
+    // save* ждут: ID, выданный до сброса, не попадет в уже очищенный шард
+    std::unique_lock<std::shared_mutex> lock(clear_mutex_);
+    for (auto& shard : shards_) {
+        shard->clear();
+    }
+}
+
+} // namespace services
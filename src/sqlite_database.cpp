@@ -0,0 +1,360 @@
+#include "services/sqlite_database.hpp"
+#include <sqlite3.h>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace services {
+
+namespace {
+
+const char* const kSchema =
+    "CREATE TABLE IF NOT EXISTS users ("
+    " id INTEGER PRIMARY KEY, name TEXT NOT NULL, email TEXT NOT NULL,"
+    " is_active INTEGER NOT NULL);"
+    "CREATE TABLE IF NOT EXISTS orders ("
+    " id INTEGER PRIMARY KEY, user_id INTEGER NOT NULL, product_name TEXT NOT NULL,"
+    " amount INTEGER NOT NULL, status INTEGER NOT NULL);"
+    "CREATE INDEX IF NOT EXISTS orders_by_user ON orders (user_id, id);";
+
+// В порядке SqliteDatabase::Statement
+const char* const kStatementSql[] = {
+    "BEGIN",
+    "COMMIT",
+    "INSERT INTO users (id, name, email, is_active) VALUES (?1, ?2, ?3, ?4)",
+    "SELECT id, name, email, is_active FROM users WHERE id = ?1",
+    "SELECT id, name, email, is_active FROM users ORDER BY id",
+    "UPDATE users SET name = ?2, email = ?3, is_active = ?4 WHERE id = ?1",
+    "DELETE FROM users WHERE id = ?1",
+    "INSERT INTO orders (id, user_id, product_name, amount, status)"
+    " VALUES (?1, ?2, ?3, ?4, ?5)",
+    "SELECT id, user_id, product_name, amount, status FROM orders WHERE id = ?1",
+    "SELECT id, user_id, product_name, amount, status FROM orders"
+    " WHERE user_id = ?1 ORDER BY id",
+    "SELECT id, user_id, product_name, amount, status FROM orders ORDER BY id",
+    "UPDATE orders SET user_id = ?2, product_name = ?3, amount = ?4, status = ?5"
+    " WHERE id = ?1",
+    "DELETE FROM orders WHERE id = ?1",
+    "DELETE FROM users",
+    "DELETE FROM orders",
+    "SELECT COALESCE(MAX(id), 0) FROM users",
+    "SELECT COALESCE(MAX(id), 0) FROM orders",
+    // Статус, не входящий в запрос, привязывается как -1 и не совпадает
+    "SELECT COUNT(*), SUM(amount), MIN(amount), MAX(amount) FROM orders"
+    " WHERE status IN (?1, ?2, ?3, ?4, ?5) AND amount BETWEEN ?6 AND ?7",
+    "SELECT COUNT(*), SUM(amount), MIN(amount), MAX(amount) FROM orders"
+    " WHERE user_id = ?8 AND status IN (?1, ?2, ?3, ?4, ?5) AND amount BETWEEN ?6 AND ?7",
+};
+
+constexpr int kStatusCount = static_cast<int>(contracts::OrderStatus::CANCELLED) + 1;
+
+// Сбрасывает запрос после выполнения: прочитанные строки освобождаются,
+// запрос готов к следующему вызову
+class ResetOnExit {
+public:
+    explicit ResetOnExit(sqlite3_stmt* statement) : statement_(statement) {}
+    ResetOnExit(const ResetOnExit&) = delete;
+    ResetOnExit& operator=(const ResetOnExit&) = delete;
+    ~ResetOnExit() { sqlite3_reset(statement_); }
+
+private:
+    sqlite3_stmt* statement_;
+};
+
+// Строки привязываются без копирования: они живут до sqlite3_step
+void bindText(sqlite3_stmt* statement, int index, const std::string& text) {
+    sqlite3_bind_text(statement, index, text.data(), static_cast<int>(text.size()),
+                      SQLITE_STATIC);
+}
+
+std::string columnText(sqlite3_stmt* statement, int column) {
+    const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(statement, column));
+    const auto size = static_cast<std::size_t>(sqlite3_column_bytes(statement, column));
+    return text != nullptr ? std::string(text, size) : std::string();
+}
+
+void bindUser(sqlite3_stmt* statement, const contracts::User& user) {
+    sqlite3_bind_int(statement, 1, user.id);
+    bindText(statement, 2, user.name);
+    bindText(statement, 3, user.email);
+    sqlite3_bind_int(statement, 4, user.is_active ? 1 : 0);
+}
+
+void bindOrder(sqlite3_stmt* statement, const contracts::Order& order) {
+    sqlite3_bind_int(statement, 1, order.id);
+    sqlite3_bind_int(statement, 2, order.user_id);
+    bindText(statement, 3, order.product_name);
+    sqlite3_bind_int64(statement, 4, order.amount.minorUnits());
+    sqlite3_bind_int(statement, 5, static_cast<int>(order.status));
+}
+
+contracts::User readUser(sqlite3_stmt* statement) {
+    return contracts::User{sqlite3_column_int(statement, 0), columnText(statement, 1),
+                           columnText(statement, 2), sqlite3_column_int(statement, 3) != 0};
+}
+
+contracts::Order readOrder(sqlite3_stmt* statement) {
+    const auto amount = contracts::Money::fromMinorUnits(sqlite3_column_int64(statement, 3));
+    const auto status = static_cast<contracts::OrderStatus>(sqlite3_column_int(statement, 4));
+    return contracts::Order{sqlite3_column_int(statement, 0), sqlite3_column_int(statement, 1),
+                            columnText(statement, 2), amount, status};
+}
+
+} // namespace
+
+std::shared_ptr<SqliteDatabase> SqliteDatabase::open(const std::string& path, Options options) {
+    sqlite3* connection = nullptr;
+    // Соединение сериализует сама база, встроенные мьютексы SQLite не нужны
+    if (sqlite3_open_v2(path.c_str(), &connection,
+                        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX,
+                        nullptr) != SQLITE_OK) {
+        sqlite3_close(connection);
+        return nullptr;
+    }
+    std::shared_ptr<SqliteDatabase> database(new SqliteDatabase(connection, options));
+    const std::string setup =
+        std::string("PRAGMA journal_mode=WAL; PRAGMA synchronous=") +
+        (options.durability == Durability::Synced ? "FULL;" : "OFF;") + kSchema;
+    if (sqlite3_exec(connection, setup.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK ||
+        !database->prepareStatements()) {
+        return nullptr;
+    }
+    for (auto [which, ids] : {std::pair{kMaxUserId, database->user_ids_.get()},
+                              std::pair{kMaxOrderId, database->order_ids_.get()}}) {
+        sqlite3_stmt* max_id = database->statement(which);
+        ResetOnExit reset(max_id);
+        if (sqlite3_step(max_id) != SQLITE_ROW) {
+            return nullptr;
+        }
+        ids->advancePast(sqlite3_column_int(max_id, 0));
+    }
+    return database;
+}
+
+SqliteDatabase::SqliteDatabase(sqlite3* connection, Options options)
+    : connection_(connection),
+      options_(options),
+      user_ids_(std::make_shared<IdAllocator>()),
+      order_ids_(std::make_shared<IdAllocator>()) {}
+
+SqliteDatabase::~SqliteDatabase() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (in_batch_) {
+            commitBatch();
+        }
+    }
+    for (sqlite3_stmt* statement : statements_) {
+        sqlite3_finalize(statement);
+    }
+    sqlite3_close(connection_);
+}
+
+bool SqliteDatabase::prepareStatements() {
+    static_assert(sizeof(kStatementSql) / sizeof(kStatementSql[0]) == kStatementCount,
+                  "SQL text for every statement");
+    for (int i = 0; i < kStatementCount; ++i) {
+        if (sqlite3_prepare_v3(connection_, kStatementSql[i], -1, SQLITE_PREPARE_PERSISTENT,
+                               &statements_[i], nullptr) != SQLITE_OK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+sqlite3_stmt* SqliteDatabase::statement(Statement which) const {
+    return statements_[which];
+}
+
+int SqliteDatabase::saveUser(const contracts::User& user) {
+    // Строки привязываются без копирования: запись живет до конца вызова
+    const contracts::User stored{user_ids_->allocate(), user.name, user.email, user.is_active};
+    if (stored.id < 0) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    const bool saved =
+        write(kInsertUser, [&](sqlite3_stmt* insert) { bindUser(insert, stored); });
+    return saved ? stored.id : -1;
+}
+
+std::optional<contracts::User> SqliteDatabase::findUserById(int id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sqlite3_stmt* select = statement(kSelectUser);
+    ResetOnExit reset(select);
+    sqlite3_bind_int(select, 1, id);
+    if (sqlite3_step(select) != SQLITE_ROW) {
+        return std::nullopt;
+    }
+    return readUser(select);
+}
+
+std::vector<contracts::User> SqliteDatabase::findAllUsers() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sqlite3_stmt* select = statement(kSelectAllUsers);
+    ResetOnExit reset(select);
+    std::vector<contracts::User> result;
+    while (sqlite3_step(select) == SQLITE_ROW) {
+        result.push_back(readUser(select));
+    }
+    return result;
+}
+
+bool SqliteDatabase::updateUser(const contracts::User& user) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return write(kUpdateUser, [&](sqlite3_stmt* update) { bindUser(update, user); });
+}
+
+bool SqliteDatabase::deleteUser(int id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return write(kDeleteUser, [&](sqlite3_stmt* erase) { sqlite3_bind_int(erase, 1, id); });
+}
+
+int SqliteDatabase::saveOrder(const contracts::Order& order) {
+    const contracts::Order stored{order_ids_->allocate(), order.user_id, order.product_name,
+                                  order.amount, order.status};
+    if (stored.id < 0) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    const bool saved =
+        write(kInsertOrder, [&](sqlite3_stmt* insert) { bindOrder(insert, stored); });
+    return saved ? stored.id : -1;
+}
+
+std::optional<contracts::Order> SqliteDatabase::findOrderById(int id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sqlite3_stmt* select = statement(kSelectOrder);
+    ResetOnExit reset(select);
+    sqlite3_bind_int(select, 1, id);
+    if (sqlite3_step(select) != SQLITE_ROW) {
+        return std::nullopt;
+    }
+    return readOrder(select);
+}
+
+std::vector<contracts::Order> SqliteDatabase::findOrdersByUserId(int user_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sqlite3_stmt* select = statement(kSelectUserOrders);
+    ResetOnExit reset(select);
+    sqlite3_bind_int(select, 1, user_id);
+    std::vector<contracts::Order> result;
+    while (sqlite3_step(select) == SQLITE_ROW) {
+        result.push_back(readOrder(select));
+    }
+    return result;
+}
+
+std::vector<contracts::Order> SqliteDatabase::findAllOrders() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sqlite3_stmt* select = statement(kSelectAllOrders);
+    ResetOnExit reset(select);
+    std::vector<contracts::Order> result;
+    while (sqlite3_step(select) == SQLITE_ROW) {
+        result.push_back(readOrder(select));
+    }
+    return result;
+}
+
+contracts::OrderAggregate SqliteDatabase::aggregateOrders(
+    const contracts::OrderQuery& query) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sqlite3_stmt* select = statement(query.user_id ? kAggregateUserOrders : kAggregateOrders);
+    ResetOnExit reset(select);
+    for (int status = 0; status < kStatusCount; ++status) {
+        const bool wanted = query.statuses.contains(static_cast<contracts::OrderStatus>(status));
+        sqlite3_bind_int(select, status + 1, wanted ? status : -1);
+    }
+    sqlite3_bind_int64(select, 6,
+                       query.min_amount ? query.min_amount->minorUnits()
+                                        : std::numeric_limits<std::int64_t>::min());
+    sqlite3_bind_int64(select, 7,
+                       query.max_amount ? query.max_amount->minorUnits()
+                                        : std::numeric_limits<std::int64_t>::max());
+    if (query.user_id) {
+        sqlite3_bind_int(select, 8, *query.user_id);
+    }
+    contracts::OrderAggregate aggregate;
+    if (sqlite3_step(select) != SQLITE_ROW) {
+        // SUM отказывает ("integer overflow"), если сумма не помещается в int64
+        aggregate.overflow = true;
+        aggregate.sum = contracts::Money::invalid();
+        return aggregate;
+    }
+    aggregate.count = static_cast<std::size_t>(sqlite3_column_int64(select, 0));
+    aggregate.sum = contracts::Money::fromMinorUnits(sqlite3_column_int64(select, 1));
+    aggregate.min = contracts::Money::fromMinorUnits(sqlite3_column_int64(select, 2));
+    aggregate.max = contracts::Money::fromMinorUnits(sqlite3_column_int64(select, 3));
+    return aggregate;
+}
+
+bool SqliteDatabase::updateOrder(const contracts::Order& order) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return write(kUpdateOrder, [&](sqlite3_stmt* update) { bindOrder(update, order); });
+}
+
+bool SqliteDatabase::deleteOrder(int id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return write(kDeleteOrder, [&](sqlite3_stmt* erase) { sqlite3_bind_int(erase, 1, id); });
+}
+
+void SqliteDatabase::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Пустая таблица не считается ошибкой: результат не проверяется
+    write(kClearOrders, [](sqlite3_stmt*) {});
+    write(kClearUsers, [](sqlite3_stmt*) {});
+    user_ids_->reset();
+    order_ids_->reset();
+}
+
+bool SqliteDatabase::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !failed_ && (!in_batch_ || commitBatch());
+}
+
+template <typename Bind>
+bool SqliteDatabase::write(Statement which, Bind&& bind) {
+    if (failed_ || !beginBatch()) {
+        return false;
+    }
+    sqlite3_stmt* change = statement(which);
+    ResetOnExit reset(change);
+    bind(change);
+    if (sqlite3_step(change) != SQLITE_DONE || sqlite3_changes(connection_) == 0) {
+        return false;
+    }
+    // Written и Synced фиксируют каждое изменение
+    const std::size_t batch =
+        options_.durability == Durability::Buffered ? options_.batch_size : 1;
+    if (++pending_ >= batch) {
+        return commitBatch();
+    }
+    return true;
+}
+
+bool SqliteDatabase::beginBatch() {
+    if (in_batch_) {
+        return true;
+    }
+    sqlite3_stmt* begin = statement(kBegin);
+    ResetOnExit reset(begin);
+    if (sqlite3_step(begin) != SQLITE_DONE) {
+        return false;
+    }
+    in_batch_ = true;
+    return true;
+}
+
+bool SqliteDatabase::commitBatch() {
+    sqlite3_stmt* commit = statement(kCommit);
+    ResetOnExit reset(commit);
+    if (sqlite3_step(commit) != SQLITE_DONE) {
+        failed_ = true;
+        return false;
+    }
+    in_batch_ = false;
+    pending_ = 0;
+    return true;
+}
+
+} // namespace services
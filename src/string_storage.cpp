@@ -0,0 +1,58 @@
+#include "services/string_storage.hpp"
+#include <cstring>
+
+namespace services {
+
+std::string_view StringArena::store(std::string_view text) {
+    if (text.empty()) {
+        return {};
+    }
+    if (text.size() > left_) {
+        // Длинная строка получает собственный блок, текущий блок не бросаем
+        const bool own_block = text.size() > kBlockSize / 4;
+        const std::size_t size = own_block ? text.size() : kBlockSize;
+        blocks_.push_back(std::make_unique<char[]>(size));
+        reserved_ += size;
+        if (own_block) {
+            char* data = blocks_.back().get();
+            std::memcpy(data, text.data(), text.size());
+            used_ += text.size();
+            return std::string_view(data, text.size());
+        }
+        cursor_ = blocks_.back().get();
+        left_ = size;
+    }
+    char* data = cursor_;
+    std::memcpy(data, text.data(), text.size());
+    cursor_ += text.size();
+    left_ -= text.size();
+    used_ += text.size();
+    return std::string_view(data, text.size());
+}
+
+std::string_view StringInterner::intern(std::string_view text) {
+    auto it = strings_.find(text);
+    if (it != strings_.end()) {
+        return *it;
+    }
+    std::string_view stored = arena_.store(text);
+    strings_.insert(stored);
+    return stored;
+}
+
+std::optional<std::string_view> StringInterner::find(std::string_view text) const {
+    auto it = strings_.find(text);
+    if (it == strings_.end()) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+std::size_t StringInterner::memoryBytes() const {
+    // Узел unordered_set: указатель на следующий, значение и кэш хеша
+    const std::size_t node = sizeof(void*) + sizeof(std::string_view) + sizeof(std::size_t);
+    return arena_.bytesReserved() + strings_.size() * node +
+           strings_.bucket_count() * sizeof(void*);
+}
+
+} // namespace services
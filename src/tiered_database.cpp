@@ -0,0 +1,645 @@
+#include "services/tiered_database.hpp"
+#include "services/file_io.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <iterator>
+#include <limits>
+#include <unistd.h>
+
+namespace services {
+
+using cold_format::Record;
+
+namespace {
+
+constexpr char kSegmentPrefix[] = "cold-";
+constexpr char kSegmentSuffix[] = ".seg";
+constexpr char kCompactPrefix[] = "compact-";
+
+// Прочитать size байт с позиции offset, повторяя pread после частичного чтения
+bool readFully(int fd, char* data, std::size_t size, std::uint64_t offset) {
+    while (size > 0) {
+        const ssize_t read = ::pread(fd, data, size, static_cast<off_t>(offset));
+        if (read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read <= 0) {
+            return false;
+        }
+        data += read;
+        size -= static_cast<std::size_t>(read);
+        offset += static_cast<std::uint64_t>(read);
+    }
+    return true;
+}
+
+// Запись в начале data или nullopt, если она обрезана; size — ее длина
+std::optional<contracts::Order> decodeRecord(const char* data, std::size_t available,
+                                            std::size_t& size) {
+    if (available < sizeof(Record)) {
+        return std::nullopt;
+    }
+    Record record;
+    std::memcpy(&record, data, sizeof(record));
+    size = sizeof(Record) + record.name_size;
+    if (available < size) {
+        return std::nullopt;
+    }
+    return contracts::Order{record.id, record.user_id,
+                            std::string(data + sizeof(Record), record.name_size),
+                            contracts::Money::fromMinorUnits(record.amount),
+                            static_cast<contracts::OrderStatus>(record.status)};
+}
+
+bool lessById(const contracts::Order& a, const contracts::Order& b) {
+    return a.id < b.id;
+}
+
+} // namespace
+
+std::shared_ptr<TieredDatabase> TieredDatabase::open(const std::string& directory,
+                                                     Options options) {
+    std::error_code error;
+    if (!std::filesystem::is_directory(directory, error)) {
+        return nullptr;
+    }
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind(kSegmentPrefix, 0) == 0 && name.size() > sizeof(kSegmentSuffix) &&
+            name.compare(name.size() - std::strlen(kSegmentSuffix), std::string::npos,
+                         kSegmentSuffix) == 0) {
+            std::filesystem::remove(entry.path(), error);
+        }
+    }
+    // Смещение записи в ColdSlot — 32 бита
+    options.segment_bytes =
+        std::min<std::size_t>(options.segment_bytes, std::numeric_limits<std::uint32_t>::max());
+    std::shared_ptr<TieredDatabase> database(new TieredDatabase(directory, options));
+    if (!database->openSegment()) {
+        return nullptr;
+    }
+    return database;
+}
+
+TieredDatabase::TieredDatabase(std::string directory, Options options)
+    : directory_(std::move(directory)),
+      options_(options),
+      user_ids_(std::make_shared<IdAllocator>()),
+      order_ids_(std::make_shared<IdAllocator>()),
+      hot_(user_ids_, order_ids_),
+      cold_(std::make_unique<DenseIdArray<ColdSlot>>()) {}
+
+TieredDatabase::~TieredDatabase() {
+    closeSegments();
+}
+
+// --- Пользователи: только горячий ярус ---
+
+int TieredDatabase::saveUser(const contracts::User& user) {
+    return hot_.saveUser(user);
+}
+
+std::optional<contracts::User> TieredDatabase::findUserById(int id) const {
+    return hot_.findUserById(id);
+}
+
+std::vector<contracts::User> TieredDatabase::findAllUsers() const {
+    return hot_.findAllUsers();
+}
+
+bool TieredDatabase::updateUser(const contracts::User& user) {
+    return hot_.updateUser(user);
+}
+
+bool TieredDatabase::deleteUser(int id) {
+    return hot_.deleteUser(id);
+}
+
+void TieredDatabase::scanUsers(const UserVisitor& visit) const {
+    hot_.scanUsers(visit);
+}
+
+std::vector<contracts::User> TieredDatabase::findActiveUsersPage(
+    const contracts::PageRequest& page) const {
+    return hot_.findActiveUsersPage(page);
+}
+
+std::vector<contracts::User> TieredDatabase::findUsers(const contracts::UserQuery& query) const {
+    return hot_.findUsers(query);
+}
+
+std::optional<bool> TieredDatabase::findUserActive(int id) const {
+    return hot_.findUserActive(id);
+}
+
+// --- Заказы ---
+
+int TieredDatabase::saveOrder(const contracts::Order& order) {
+    if (!isCold(order.status)) {
+        // Новый ID ни в одном ярусе еще не встречается
+        return hot_.saveOrder(order);
+    }
+    contracts::Order stored = order;
+    stored.id = order_ids_->allocate();
+    if (stored.id < 0) {
+        return -1;
+    }
+    const std::string record = encode(stored);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    return appendCold(stored.id, stored.user_id, record) ? stored.id : -1;
+}
+
+std::optional<contracts::Order> TieredDatabase::findOrderById(int id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (const ColdSlot* slot = coldSlot(id)) {
+        return readCold(*slot);
+    }
+    return hot_.findOrderById(id);
+}
+
+std::vector<contracts::Order> TieredDatabase::findOrdersByUserId(int user_id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto result = hot_.findOrdersByUserId(user_id);
+    appendColdOrdersOf(user_id, result);
+    lock.unlock();
+    std::sort(result.begin(), result.end(), lessById);
+    return result;
+}
+
+std::vector<contracts::Order> TieredDatabase::findAllOrders() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const auto hot = hot_.findAllOrders();
+    auto cold = scanCold();
+    lock.unlock();
+    std::sort(cold.begin(), cold.end(), lessById);
+    std::vector<contracts::Order> result;
+    result.reserve(hot.size() + cold.size());
+    std::merge(std::make_move_iterator(cold.begin()), std::make_move_iterator(cold.end()),
+               hot.begin(), hot.end(), std::back_inserter(result), lessById);
+    return result;
+}
+
+std::vector<contracts::Order> TieredDatabase::findOrders(
+    const contracts::OrderQuery& query) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const auto hot = hot_.findOrders(query);
+    auto cold = findColdOrders(query);
+    lock.unlock();
+    std::sort(cold.begin(), cold.end(), lessById);
+    std::vector<contracts::Order> result;
+    result.reserve(hot.size() + cold.size());
+    std::merge(std::make_move_iterator(cold.begin()), std::make_move_iterator(cold.end()),
+               hot.begin(), hot.end(), std::back_inserter(result), lessById);
+    return result;
+}
+
+std::vector<contracts::OrderSummary> TieredDatabase::findOrderSummaries(
+    const contracts::OrderQuery& query) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const auto hot = hot_.findOrderSummaries(query);
+    const auto cold_orders = findColdOrders(query);
+    lock.unlock();
+    std::vector<contracts::OrderSummary> cold;
+    cold.reserve(cold_orders.size());
+    for (const auto& order : cold_orders) {
+        cold.push_back(contracts::OrderSummary{order.id, order.user_id, order.amount,
+                                               order.status});
+    }
+    const auto byId = [](const contracts::OrderSummary& a, const contracts::OrderSummary& b) {
+        return a.id < b.id;
+    };
+    std::sort(cold.begin(), cold.end(), byId);
+    std::vector<contracts::OrderSummary> result;
+    result.reserve(hot.size() + cold.size());
+    std::merge(cold.begin(), cold.end(), hot.begin(), hot.end(), std::back_inserter(result),
+               byId);
+    return result;
+}
+
+contracts::OrderAggregate TieredDatabase::aggregateOrders(
+    const contracts::OrderQuery& query) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto aggregate = hot_.aggregateOrders(query);
+    for (const auto& order : findColdOrders(query)) {
+        aggregate.add(order.amount);
+    }
+    return aggregate;
+}
+
+bool TieredDatabase::updateOrder(const contracts::Order& order) {
+    if (!isCold(order.status)) {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            if (coldSlot(order.id) == nullptr) {
+                return hot_.updateOrder(order);
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (coldSlot(order.id) == nullptr) {
+            return hot_.updateOrder(order);
+        }
+        // Заказ снова активен: возвращается в горячий ярус
+        if (!hot_.insertOrder(order)) {
+            return false;
+        }
+        forgetCold(order.id);
+        return true;
+    }
+
+    const std::string record = encode(order);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (coldSlot(order.id) != nullptr) {
+        return appendCold(order.id, order.user_id, record);
+    }
+    // Перенос: холодная запись появляется раньше, чем исчезает горячая,
+    // но читатели не видят промежуточного состояния под mutex_
+    if (!hot_.findOrderById(order.id) || !appendCold(order.id, order.user_id, record)) {
+        return false;
+    }
+    hot_.deleteOrder(order.id);
+    ++migrations_;
+    return true;
+}
+
+bool TieredDatabase::deleteOrder(int id) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (coldSlot(id) == nullptr) {
+            return hot_.deleteOrder(id);
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (coldSlot(id) == nullptr) {
+        return hot_.deleteOrder(id);
+    }
+    forgetCold(id);
+    return true;
+}
+
+void TieredDatabase::clear() {
+    auto fresh = std::make_unique<DenseIdArray<ColdSlot>>();
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    hot_.clear();
+    closeSegments();
+    cold_.swap(fresh);
+    cold_by_user_.clear();
+    buffer_.clear();
+    cold_orders_ = 0;
+    dead_bytes_ = 0;
+    migrations_ = 0;
+    compactions_ = 0;
+    failed_ = !openSegment();
+}
+
+TieredDatabase::Stats TieredDatabase::stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    Stats stats;
+    stats.cold_orders = cold_orders_;
+    stats.cold_index_bytes = cold_->memoryBytes() +
+                             cold_by_user_.bucket_count() * sizeof(void*);
+    for (const auto& [user_id, ids] : cold_by_user_) {
+        // Узел таблицы и массив ID
+        stats.cold_index_bytes += sizeof(void*) + sizeof(std::pair<const int, std::vector<int>>) +
+                                  ids.capacity() * sizeof(int);
+    }
+    for (const auto& segment : segments_) {
+        stats.cold_disk_bytes += segment.file_bytes;
+    }
+    stats.cold_disk_bytes += buffer_.size();
+    stats.cold_dead_bytes = dead_bytes_;
+    stats.migrations = migrations_;
+    stats.compactions = compactions_;
+    stats.segments = segments_.size();
+    return stats;
+}
+
+std::string TieredDatabase::encode(const contracts::Order& order) {
+    Record record{};
+    record.amount = order.amount.minorUnits();
+    record.id = order.id;
+    record.user_id = order.user_id;
+    record.name_size = static_cast<std::uint32_t>(order.product_name.size());
+    record.status = static_cast<std::uint8_t>(order.status);
+    std::string data(sizeof(record) + order.product_name.size(), '\0');
+    std::memcpy(&data[0], &record, sizeof(record));
+    std::memcpy(&data[sizeof(record)], order.product_name.data(), order.product_name.size());
+    return data;
+}
+
+const TieredDatabase::ColdSlot* TieredDatabase::coldSlot(int id) const {
+    const ColdSlot* slot = cold_->find(id);
+    return slot != nullptr && slot->segment != 0 ? slot : nullptr;
+}
+
+std::optional<contracts::Order> TieredDatabase::readCold(const ColdSlot& slot) const {
+    const Segment& segment = segments_[slot.segment - 1];
+    std::size_t size = 0;
+    if (slot.offset >= segment.file_bytes) {
+        // Запись еще в буфере активного сегмента
+        const std::size_t start = slot.offset - segment.file_bytes;
+        return decodeRecord(buffer_.data() + start, buffer_.size() - start, size);
+    }
+    std::string data(slot.size, '\0');
+    if (!readFully(segment.fd, &data[0], data.size(), slot.offset)) {
+        return std::nullopt;
+    }
+    return decodeRecord(data.data(), data.size(), size);
+}
+
+void TieredDatabase::appendColdOrdersOf(int user_id,
+                                        std::vector<contracts::Order>& result) const {
+    const auto it = cold_by_user_.find(user_id);
+    if (it == cold_by_user_.end()) {
+        return;
+    }
+    result.reserve(result.size() + it->second.size());
+    for (int id : it->second) {
+        const ColdSlot* slot = coldSlot(id);
+        auto order = slot != nullptr ? readCold(*slot) : std::nullopt;
+        if (order && order->user_id == user_id) {
+            result.push_back(std::move(*order));
+        }
+    }
+}
+
+std::vector<contracts::Order> TieredDatabase::findColdOrders(
+    const contracts::OrderQuery& query) const {
+    std::vector<contracts::Order> result;
+    // В холодном ярусе только DELIVERED и CANCELLED: без них он не читается
+    if (!query.statuses.contains(contracts::OrderStatus::DELIVERED) &&
+        !query.statuses.contains(contracts::OrderStatus::CANCELLED)) {
+        return result;
+    }
+    if (query.user_id) {
+        appendColdOrdersOf(*query.user_id, result);
+    } else {
+        result = scanCold();
+    }
+    result.erase(std::remove_if(result.begin(), result.end(),
+                                [&query](const contracts::Order& order) {
+                                    return !query.matches(order);
+                                }),
+                 result.end());
+    return result;
+}
+
+std::vector<contracts::Order> TieredDatabase::scanCold() const {
+    std::vector<contracts::Order> result;
+    result.reserve(cold_orders_);
+    std::string data;
+    for (std::size_t i = 0; i < segments_.size(); ++i) {
+        const Segment& segment = segments_[i];
+        data.resize(segment.file_bytes);
+        if (!readFully(segment.fd, &data[0], data.size(), 0)) {
+            continue;
+        }
+        if (i + 1 == segments_.size()) {
+            data += buffer_;
+        }
+        // Жива только запись, на которую указывает индекс
+        std::size_t offset = 0;
+        std::size_t size = 0;
+        while (auto order = decodeRecord(data.data() + offset, data.size() - offset, size)) {
+            const ColdSlot* slot = coldSlot(order->id);
+            if (slot != nullptr && slot->segment == i + 1 && slot->offset == offset) {
+                result.push_back(std::move(*order));
+            }
+            offset += size;
+        }
+    }
+    return result;
+}
+
+bool TieredDatabase::appendCold(int id, int user_id, const std::string& record) {
+    if (failed_) {
+        return false;
+    }
+    const Segment& active = segments_.back();
+    if (active.file_bytes + buffer_.size() > 0 &&
+        active.file_bytes + buffer_.size() + record.size() > options_.segment_bytes) {
+        if (!flushBuffer() || !openSegment()) {
+            failed_ = true;
+            return false;
+        }
+    }
+
+    ColdSlot& slot = cold_->ensure(id);
+    const bool replaced = slot.segment != 0;
+    if (replaced) {
+        // Замена холодной записи; владелец мог смениться
+        const auto previous = readCold(slot);
+        if (!previous || previous->user_id != user_id) {
+            unlinkColdOwner(id, previous ? std::optional<int>(previous->user_id)
+                                         : std::nullopt);
+            cold_by_user_[user_id].push_back(id);
+        }
+        dead_bytes_ += slot.size;
+    } else {
+        cold_by_user_[user_id].push_back(id);
+        ++cold_orders_;
+    }
+    slot.segment = static_cast<std::uint32_t>(segments_.size());
+    slot.offset = static_cast<std::uint32_t>(segments_.back().file_bytes + buffer_.size());
+    slot.size = static_cast<std::uint32_t>(record.size());
+    buffer_ += record;
+    if (buffer_.size() >= options_.write_buffer_bytes) {
+        // При ошибке запись остается в буфере и читается оттуда,
+        // следующие переносы отклоняются
+        flushBuffer();
+    }
+    if (replaced) {
+        compactIfWasteful();
+    }
+    return true;
+}
+
+void TieredDatabase::forgetCold(int id) {
+    ColdSlot* slot = cold_->find(id);
+    if (slot == nullptr || slot->segment == 0) {
+        return;
+    }
+    const auto order = readCold(*slot);
+    unlinkColdOwner(id, order ? std::optional<int>(order->user_id) : std::nullopt);
+    dead_bytes_ += slot->size;
+    --cold_orders_;
+    *slot = ColdSlot{};
+    compactIfWasteful();
+}
+
+void TieredDatabase::unlinkColdOwner(int id, std::optional<int> user_id) {
+    const auto unlink = [this, id](auto it) {
+        auto& ids = it->second;
+        ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+        return ids.empty() ? cold_by_user_.erase(it) : std::next(it);
+    };
+    if (user_id) {
+        const auto it = cold_by_user_.find(*user_id);
+        if (it != cold_by_user_.end()) {
+            unlink(it);
+        }
+        return;
+    }
+    // Запись не прочиталась: владелец неизвестен, ID ищется во всех списках
+    for (auto it = cold_by_user_.begin(); it != cold_by_user_.end();) {
+        it = unlink(it);
+    }
+}
+
+void TieredDatabase::compactIfWasteful() {
+    std::uint64_t disk_bytes = buffer_.size();
+    for (const auto& segment : segments_) {
+        disk_bytes += segment.file_bytes;
+    }
+    const std::uint64_t live_bytes = disk_bytes - dead_bytes_;
+    if (dead_bytes_ >= options_.compact_min_dead_bytes && dead_bytes_ * 2 > live_bytes) {
+        // При ошибке остаются прежние сегменты: сжатие повторится позже
+        compactCold();
+    }
+}
+
+bool TieredDatabase::compactCold() {
+    if (!flushBuffer()) {
+        return false;
+    }
+    std::vector<Segment> compacted;
+    std::vector<std::pair<int, ColdSlot>> moved;
+    moved.reserve(cold_orders_);
+    std::string data;
+    std::string out;    // Хвост последнего нового сегмента
+    const auto openOut = [this, &compacted] {
+        const auto number = static_cast<std::uint32_t>(compacted.size() + 1);
+        const int fd = ::open(compactPath(number).c_str(),
+                              O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        compacted.push_back(Segment{fd, 0});
+        return true;
+    };
+    const auto writeOut = [&compacted, &out] {
+        if (!writeFully(compacted.back().fd, out.data(), out.size())) {
+            return false;
+        }
+        compacted.back().file_bytes += out.size();
+        out.clear();
+        return true;
+    };
+
+    // Живые записи переписываются по порядку в новые сегменты
+    bool ok = openOut();
+    for (std::size_t i = 0; ok && i < segments_.size(); ++i) {
+        const Segment& segment = segments_[i];
+        data.resize(segment.file_bytes);
+        if (!readFully(segment.fd, &data[0], data.size(), 0)) {
+            ok = false;
+            break;
+        }
+        std::size_t offset = 0;
+        std::size_t size = 0;
+        while (auto order = decodeRecord(data.data() + offset, data.size() - offset, size)) {
+            const ColdSlot* slot = coldSlot(order->id);
+            if (slot != nullptr && slot->segment == i + 1 && slot->offset == offset) {
+                if (compacted.back().file_bytes + out.size() > 0 &&
+                    compacted.back().file_bytes + out.size() + size > options_.segment_bytes &&
+                    !(writeOut() && openOut())) {
+                    ok = false;
+                    break;
+                }
+                ColdSlot target;
+                target.segment = static_cast<std::uint32_t>(compacted.size());
+                target.offset = static_cast<std::uint32_t>(compacted.back().file_bytes +
+                                                           out.size());
+                target.size = static_cast<std::uint32_t>(size);
+                moved.emplace_back(order->id, target);
+                out.append(data, offset, size);
+                if (out.size() >= options_.write_buffer_bytes && !writeOut()) {
+                    ok = false;
+                    break;
+                }
+            }
+            offset += size;
+        }
+    }
+    ok = ok && writeOut();
+
+    // Новые сегменты занимают имена прежних; прежние файлы читаются
+    // по открытым дескрипторам, пока индекс не переключен
+    std::size_t renamed = 0;
+    while (ok && renamed < compacted.size()) {
+        const auto number = static_cast<std::uint32_t>(renamed + 1);
+        ok = std::rename(compactPath(number).c_str(), segmentPath(number).c_str()) == 0;
+        renamed += ok ? 1 : 0;
+    }
+    if (!ok) {
+        for (std::size_t i = 0; i < compacted.size(); ++i) {
+            ::close(compacted[i].fd);
+            if (i >= renamed) {
+                std::remove(compactPath(static_cast<std::uint32_t>(i + 1)).c_str());
+            }
+        }
+        return false;
+    }
+
+    for (std::size_t i = 0; i < segments_.size(); ++i) {
+        ::close(segments_[i].fd);
+        if (i >= compacted.size()) {
+            std::remove(segmentPath(static_cast<std::uint32_t>(i + 1)).c_str());
+        }
+    }
+    segments_ = std::move(compacted);
+    for (const auto& [id, target] : moved) {
+        cold_->ensure(id) = target;
+    }
+    dead_bytes_ = 0;
+    ++compactions_;
+    return true;
+}
+
+bool TieredDatabase::flushBuffer() {
+    if (buffer_.empty()) {
+        return true;
+    }
+    Segment& active = segments_.back();
+    if (!writeFully(active.fd, buffer_.data(), buffer_.size())) {
+        failed_ = true;
+        return false;
+    }
+    active.file_bytes += buffer_.size();
+    buffer_.clear();
+    return true;
+}
+
+bool TieredDatabase::openSegment() {
+    const auto number = static_cast<std::uint32_t>(segments_.size() + 1);
+    const std::string path = segmentPath(number);
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    segments_.push_back(Segment{fd, 0});
+    return true;
+}
+
+void TieredDatabase::closeSegments() {
+    for (std::size_t i = 0; i < segments_.size(); ++i) {
+        ::close(segments_[i].fd);
+        std::remove(segmentPath(static_cast<std::uint32_t>(i + 1)).c_str());
+    }
+    segments_.clear();
+}
+
+std::string TieredDatabase::segmentPath(std::uint32_t number) const {
+    return directory_ + "/" + kSegmentPrefix + std::to_string(number) + kSegmentSuffix;
+}
+
+std::string TieredDatabase::compactPath(std::uint32_t number) const {
+    // Имя вида cold-*.seg: недописанный файл удалит следующий open()
+    return directory_ + "/" + kSegmentPrefix + kCompactPrefix + std::to_string(number) +
+           kSegmentSuffix;
+}
+
+} // namespace services
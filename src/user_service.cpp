@@ -1,5 +1,4 @@
 #include "services/user_service.hpp"
-#include <algorithm>
 
 namespace services {
 
@@ -26,14 +25,15 @@ std::optional<contracts::User> UserService::getUser(int id) const {
 }
 
 std::vector<contracts::User> UserService::getActiveUsers() const {
-    auto all_users = database_->findAllUsers();
-    std::vector<contracts::User> active_users;
-    
-    std::copy_if(all_users.begin(), all_users.end(), 
-                 std::back_inserter(active_users),
-                 [](const contracts::User& u) { return u.is_active; });
-    
-    return active_users;
+    // Фильтр проверяется в хранилище: копируются только активные пользователи
+    contracts::UserQuery query;
+    query.is_active = true;
+    return database_->findUsers(query);
+}
+
+std::vector<contracts::User> UserService::getActiveUsers(
+    const contracts::PageRequest& page) const {
+    return database_->findActiveUsersPage(page);
 }
 
 bool UserService::deactivateUser(int id) {
@@ -47,7 +47,12 @@ bool UserService::deactivateUser(int id) {
 }
 
 bool UserService::userExists(int id) const {
-    return database_->findUserById(id).has_value();
+    return database_->findUserActive(id).has_value();
+}
+
+bool UserService::isActive(int id) const {
+    // Имя и email не копируются: читается только флаг
+    return database_->findUserActive(id).value_or(false);
 }
 
 bool UserService::isValidName(const std::string& name) const {
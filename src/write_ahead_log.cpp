@@ -0,0 +1,359 @@
+#include "services/write_ahead_log.hpp"
+#include "services/file_io.hpp"
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+
+namespace services {
+
+namespace {
+
+constexpr std::size_t kHeaderSize = 8;  // Длина и CRC32 кадра
+
+// Числа пишутся побайтно little-endian независимо от платформы
+template <typename T>
+void putInt(std::string& out, T value) {
+    auto bits = static_cast<std::uint64_t>(value);
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+    }
+}
+
+template <typename T>
+void putIntAt(std::string& out, std::size_t pos, T value) {
+    auto bits = static_cast<std::uint64_t>(value);
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        out[pos + i] = static_cast<char>((bits >> (8 * i)) & 0xFF);
+    }
+}
+
+void putString(std::string& out, const std::string& value) {
+    putInt<std::uint32_t>(out, static_cast<std::uint32_t>(value.size()));
+    out.append(value);
+}
+
+class Reader {
+public:
+    Reader(const char* data, std::size_t size) : pos_(data), end_(data + size) {}
+
+    template <typename T>
+    bool readInt(T& value) {
+        if (static_cast<std::size_t>(end_ - pos_) < sizeof(T)) {
+            return false;
+        }
+        std::uint64_t bits = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            bits |= static_cast<std::uint64_t>(static_cast<unsigned char>(pos_[i])) << (8 * i);
+        }
+        value = static_cast<T>(bits);
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool readString(std::string& value) {
+        std::uint32_t size = 0;
+        if (!readInt(size) || static_cast<std::size_t>(end_ - pos_) < size) {
+            return false;
+        }
+        value.assign(pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    bool atEnd() const { return pos_ == end_; }
+
+private:
+    const char* pos_;
+    const char* end_;
+};
+
+bool decode(const char* data, std::size_t size, LogRecord& record) {
+    Reader in(data, size);
+    std::uint8_t type = 0;
+    if (!in.readInt(type)) {
+        return false;
+    }
+    record = LogRecord{};
+    record.type = static_cast<LogRecord::Type>(type);
+    bool ok = false;
+    switch (record.type) {
+    case LogRecord::Type::PutUser: {
+        std::uint8_t active = 0;
+        ok = in.readInt(record.user.id) && in.readInt(active) &&
+             in.readString(record.user.name) && in.readString(record.user.email);
+        record.user.is_active = active != 0;
+        record.id = record.user.id;
+        break;
+    }
+    case LogRecord::Type::PutOrder: {
+        std::int64_t minor = 0;
+        std::uint8_t status = 0;
+        ok = in.readInt(record.order.id) && in.readInt(record.order.user_id) &&
+             in.readInt(minor) && in.readInt(status) &&
+             in.readString(record.order.product_name);
+        record.order.amount = contracts::Money::fromMinorUnits(minor);
+        record.order.status = static_cast<contracts::OrderStatus>(status);
+        record.id = record.order.id;
+        break;
+    }
+    case LogRecord::Type::DeleteUser:
+    case LogRecord::Type::DeleteOrder:
+        ok = in.readInt(record.id);
+        break;
+    case LogRecord::Type::Clear:
+        ok = true;
+        break;
+    case LogRecord::Type::SetOrderStatus: {
+        std::uint8_t status = 0;
+        ok = in.readInt(record.id) && in.readInt(status);
+        record.order.id = record.id;
+        record.order.status = static_cast<contracts::OrderStatus>(status);
+        break;
+    }
+    }
+    return ok && in.atEnd();
+}
+
+// Передать apply целые кадры из начала data; возвращает их длину
+std::size_t readFrames(const std::string& data,
+                       const std::function<void(const LogRecord&)>& apply) {
+    std::size_t pos = 0;
+    LogRecord record;
+    while (data.size() - pos >= kHeaderSize) {
+        Reader header(data.data() + pos, kHeaderSize);
+        std::uint32_t size = 0;
+        std::uint32_t checksum = 0;
+        header.readInt(size);
+        header.readInt(checksum);
+        const char* payload = data.data() + pos + kHeaderSize;
+        if (data.size() - pos - kHeaderSize < size || crc32(payload, size) != checksum ||
+            !decode(payload, size, record)) {
+            break;
+        }
+        apply(record);
+        pos += kHeaderSize + size;
+    }
+    return pos;
+}
+
+std::optional<std::string> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+LogRecord LogRecord::putUser(const contracts::User& user) {
+    LogRecord record;
+    record.type = Type::PutUser;
+    record.id = user.id;
+    record.user = user;
+    return record;
+}
+
+LogRecord LogRecord::deleteUser(int id) {
+    LogRecord record;
+    record.type = Type::DeleteUser;
+    record.id = id;
+    return record;
+}
+
+LogRecord LogRecord::putOrder(const contracts::Order& order) {
+    LogRecord record;
+    record.type = Type::PutOrder;
+    record.id = order.id;
+    record.order = order;
+    return record;
+}
+
+LogRecord LogRecord::deleteOrder(int id) {
+    LogRecord record;
+    record.type = Type::DeleteOrder;
+    record.id = id;
+    return record;
+}
+
+LogRecord LogRecord::setOrderStatus(int id, contracts::OrderStatus status) {
+    LogRecord record;
+    record.type = Type::SetOrderStatus;
+    record.id = id;
+    record.order.id = id;
+    record.order.status = status;
+    return record;
+}
+
+LogRecord LogRecord::clear() {
+    return LogRecord{};
+}
+
+std::shared_ptr<WriteAheadLog> WriteAheadLog::open(const std::string& path, Options options) {
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return nullptr;
+    }
+    return std::shared_ptr<WriteAheadLog>(new WriteAheadLog(fd, options));
+}
+
+std::size_t WriteAheadLog::replay(const std::string& path,
+                                  const std::function<void(const LogRecord&)>& apply) {
+    const auto data = readFile(path);
+    if (!data) {
+        return 0;
+    }
+    std::size_t applied = 0;
+    const std::size_t pos = readFrames(*data, [&](const LogRecord& record) {
+        apply(record);
+        ++applied;
+    });
+    if (pos < data->size()) {
+        // Хвост от прерванной записи: следующий кадр должен начаться с границы
+        ::truncate(path.c_str(), static_cast<off_t>(pos));
+    }
+    return applied;
+}
+
+std::optional<std::vector<LogRecord>> WriteAheadLog::readAll(const std::string& path) {
+    const auto data = readFile(path);
+    if (!data) {
+        return std::nullopt;
+    }
+    std::vector<LogRecord> records;
+    if (readFrames(*data, [&records](const LogRecord& record) { records.push_back(record); }) !=
+        data->size()) {
+        return std::nullopt;
+    }
+    return records;
+}
+
+std::string WriteAheadLog::encode(const LogRecord& record) {
+    std::string frame(kHeaderSize, '\0');
+    putInt<std::uint8_t>(frame, static_cast<std::uint8_t>(record.type));
+    switch (record.type) {
+    case LogRecord::Type::PutUser:
+        putInt<std::int32_t>(frame, record.user.id);
+        putInt<std::uint8_t>(frame, record.user.is_active ? 1 : 0);
+        putString(frame, record.user.name);
+        putString(frame, record.user.email);
+        break;
+    case LogRecord::Type::PutOrder:
+        putInt<std::int32_t>(frame, record.order.id);
+        putInt<std::int32_t>(frame, record.order.user_id);
+        putInt<std::int64_t>(frame, record.order.amount.minorUnits());
+        putInt<std::uint8_t>(frame, static_cast<std::uint8_t>(record.order.status));
+        putString(frame, record.order.product_name);
+        break;
+    case LogRecord::Type::DeleteUser:
+    case LogRecord::Type::DeleteOrder:
+        putInt<std::int32_t>(frame, record.id);
+        break;
+    case LogRecord::Type::Clear:
+        break;
+    case LogRecord::Type::SetOrderStatus:
+        putInt<std::int32_t>(frame, record.id);
+        putInt<std::uint8_t>(frame, static_cast<std::uint8_t>(record.order.status));
+        break;
+    }
+    const std::size_t size = frame.size() - kHeaderSize;
+    putIntAt<std::uint32_t>(frame, 0, static_cast<std::uint32_t>(size));
+    putIntAt<std::uint32_t>(frame, 4, crc32(frame.data() + kHeaderSize, size));
+    return frame;
+}
+
+WriteAheadLog::WriteAheadLog(int fd, Options options) : fd_(fd), options_(options) {}
+
+WriteAheadLog::~WriteAheadLog() {
+    flush();
+    ::close(fd_);
+}
+
+std::uint64_t WriteAheadLog::append(const std::string& frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (failed_) {
+        return 0;
+    }
+    pending_.append(frame);
+    ++stats_.records;
+    return ++appended_;
+}
+
+bool WriteAheadLog::commit(std::uint64_t lsn) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (options_.durability == Durability::Buffered) {
+        if (pending_.size() >= options_.buffer_bytes && !writing_) {
+            writeGroup(lock, appended_, false);
+        }
+        return !failed_;
+    }
+    const bool sync = options_.durability == Durability::Synced;
+    const std::uint64_t& done = sync ? synced_ : written_;
+    while (done < lsn && !failed_) {
+        if (writing_) {
+            // Группу пишет другой поток; если она не покроет lsn,
+            // следующим лидером станет один из ожидающих
+            written_cv_.wait(lock);
+        } else {
+            writeGroup(lock, appended_, sync);
+        }
+    }
+    return done >= lsn;
+}
+
+bool WriteAheadLog::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (synced_ < appended_ && !failed_) {
+        if (writing_) {
+            written_cv_.wait(lock);
+        } else {
+            writeGroup(lock, appended_, true);
+        }
+    }
+    return !failed_;
+}
+
+bool WriteAheadLog::failed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_;
+}
+
+WriteAheadLog::Stats WriteAheadLog::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void WriteAheadLog::writeGroup(std::unique_lock<std::mutex>& lock, std::uint64_t target,
+                               bool sync) {
+    writing_ = true;
+    // batch_ и pending_ меняются местами, сохраняя емкость: в установившемся
+    // режиме буферы не перевыделяются
+    batch_.swap(pending_);
+    lock.unlock();
+
+    bool ok = batch_.empty() || writeFully(fd_, batch_.data(), batch_.size());
+    if (ok && sync) {
+        ok = syncToDisk(fd_);
+    }
+
+    lock.lock();
+    if (ok) {
+        if (!batch_.empty()) {
+            ++stats_.writes;
+            stats_.bytes += batch_.size();
+        }
+        stats_.syncs += sync ? 1 : 0;
+        written_ = target;
+        if (sync) {
+            synced_ = target;
+        }
+    } else {
+        failed_ = true;
+    }
+    batch_.clear();
+    writing_ = false;
+    written_cv_.notify_all();
+}
+
+} // namespace services
@@ -0,0 +1,602 @@
+/**
+ * @file database_contract_test.cpp
+ * @brief Контрактные тесты для IDatabase
+ *
+ * Одни и те же тесты прогоняются для каждой реализации IDatabase.
+ * Любое новое хранилище должно быть добавлено в DatabaseImplementations
+ * и проходить этот набор без изменений.
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "contracts/database_contract.hpp"
+#include "services/columnar_database.hpp"
+#include "services/database.hpp"
+#include "services/lsm_database.hpp"
+#include "services/mapped_database.hpp"
+#include "services/sharded_database.hpp"
+#include "services/tiered_database.hpp"
+#ifdef SERVICES_WITH_SQLITE
+#include "services/sqlite_database.hpp"
+#endif
+#include "services/user_service.hpp"
+#include "services/order_service.hpp"
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <set>
+#include <unistd.h>
+
+using namespace services;
+using namespace contracts;
+
+/**
+ * Фабрика тестируемых хранилищ. Специализируется для реализаций,
+ * которым нужны параметры конструктора или внешние ресурсы.
+ */
+template <typename Db>
+struct DatabaseFactory {
+    static std::shared_ptr<IDatabase> create() {
+        return std::make_shared<Db>();
+    }
+};
+
+/**
+ * Открыть хранилище в собственном пустом каталоге prefix_<pid>_<n>:
+ * open(путь каталога) возвращает базу или nullptr. Каталог удаляется
+ * вместе с базой; неудачное открытие отмечается ошибкой теста.
+ */
+template <typename Open>
+std::shared_ptr<IDatabase> openInTempDirectory(const std::string& prefix, Open open) {
+    static std::atomic<int> counter{0};
+    const auto directory = std::filesystem::temp_directory_path() /
+                           (prefix + "_" + std::to_string(::getpid()) + "_" +
+                            std::to_string(counter.fetch_add(1)));
+    std::filesystem::create_directories(directory);
+    std::shared_ptr<IDatabase> database = open(directory);
+    if (database == nullptr) {
+        ADD_FAILURE() << "cannot open " << prefix << " database in " << directory;
+        std::filesystem::remove_all(directory);
+        return nullptr;
+    }
+    IDatabase* raw = database.get();
+    return std::shared_ptr<IDatabase>(raw, [database, directory](IDatabase*) mutable {
+        database.reset();
+        std::filesystem::remove_all(directory);
+    });
+}
+
+template <>
+struct DatabaseFactory<MappedDatabase> {
+    static std::shared_ptr<IDatabase> create() {
+        return openInTempDirectory("mapped_contract", [](const std::filesystem::path& directory) {
+            return MappedDatabase::open(directory.string());
+        });
+    }
+};
+
+/**
+ * LsmDatabase с маленькой memtable, чтобы тесты проходили через сбросы
+ * в прогоны и слияния, а не только через memtable.
+ */
+template <>
+struct DatabaseFactory<LsmDatabase> {
+    static std::shared_ptr<IDatabase> create() {
+        return openInTempDirectory("lsm_contract", [](const std::filesystem::path& directory) {
+            LsmDatabase::Options options;
+            options.memtable_bytes = 4096;
+            options.fanout = 2;
+            return LsmDatabase::open(directory.string(), options);
+        });
+    }
+};
+
+/**
+ * TieredDatabase с маленькими сегментами и буфером, чтобы холодные
+ * заказы читались и из буфера, и из файлов нескольких сегментов.
+ */
+template <>
+struct DatabaseFactory<TieredDatabase> {
+    static std::shared_ptr<IDatabase> create() {
+        return openInTempDirectory("tiered_contract", [](const std::filesystem::path& directory) {
+            TieredDatabase::Options options;
+            options.segment_bytes = 256;
+            options.write_buffer_bytes = 64;
+            return TieredDatabase::open(directory.string(), options);
+        });
+    }
+};
+
+#ifdef SERVICES_WITH_SQLITE
+/**
+ * SqliteDatabase с маленьким пакетом, чтобы тесты проходили и через
+ * зафиксированные транзакции, и через открытый пакет.
+ */
+template <>
+struct DatabaseFactory<SqliteDatabase> {
+    static std::shared_ptr<IDatabase> create() {
+        return openInTempDirectory("sqlite_contract", [](const std::filesystem::path& directory) {
+            SqliteDatabase::Options options;
+            options.batch_size = 8;
+            return SqliteDatabase::open((directory / "db.sqlite").string(), options);
+        });
+    }
+};
+#endif
+
+template <typename Db>
+class DatabaseContractTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        database_ = DatabaseFactory<Db>::create();
+        ASSERT_NE(database_, nullptr);
+    }
+
+    static User makeUser(const std::string& name, bool is_active = true) {
+        return User{0, name, name + "@test.com", is_active};
+    }
+
+    static Order makeOrder(int user_id, const std::string& product, double amount,
+                           OrderStatus status = OrderStatus::PENDING) {
+        return Order{0, user_id, product, amount, status};
+    }
+
+    std::shared_ptr<IDatabase> database_;  // Используем интерфейс!
+};
+
+#ifdef SERVICES_WITH_SQLITE
+using DatabaseImplementations =
+    ::testing::Types<InMemoryDatabase, ShardedDatabase, ColumnarDatabase, MappedDatabase,
+                     LsmDatabase, TieredDatabase, SqliteDatabase>;
+#else
+using DatabaseImplementations =
+    ::testing::Types<InMemoryDatabase, ShardedDatabase, ColumnarDatabase, MappedDatabase,
+                     LsmDatabase, TieredDatabase>;
+#endif
+TYPED_TEST_SUITE(DatabaseContractTest, DatabaseImplementations);
+
+// ============================================================================
+// КОНТРАКТ: saveUser / findUserById
+// Постусловие: положительный уникальный ID, запись читается без искажений
+// ============================================================================
+
+TYPED_TEST(DatabaseContractTest, SaveUser_Contract_ReturnsUniquePositiveIds) {
+    std::set<int> ids;
+    for (int i = 0; i < 100; ++i) {
+        int id = this->database_->saveUser(this->makeUser("User" + std::to_string(i)));
+        EXPECT_GT(id, 0) << "CONTRACT VIOLATION: saveUser must return positive ID";
+        ids.insert(id);
+    }
+    EXPECT_EQ(ids.size(), 100) << "CONTRACT VIOLATION: user IDs must be unique";
+}
+
+TYPED_TEST(DatabaseContractTest, FindUserById_Contract_DataIntegrity) {
+    int id = this->database_->saveUser(this->makeUser("John"));
+
+    auto user = this->database_->findUserById(id);
+
+    ASSERT_TRUE(user.has_value())
+        << "CONTRACT VIOLATION: saved user must be found by ID";
+    EXPECT_EQ(user->id, id);
+    EXPECT_EQ(user->name, "John");
+    EXPECT_EQ(user->email, "John@test.com");
+    EXPECT_TRUE(user->is_active);
+}
+
+TYPED_TEST(DatabaseContractTest, FindUserById_Contract_NonExisting_ReturnsNullopt) {
+    EXPECT_FALSE(this->database_->findUserById(99999).has_value());
+    EXPECT_FALSE(this->database_->findUserById(0).has_value());
+    EXPECT_FALSE(this->database_->findUserById(-1).has_value());
+}
+
+// ============================================================================
+// КОНТРАКТ: updateUser / deleteUser
+// Постусловие: true и изменение видно, если запись существовала; иначе false
+// ============================================================================
+
+TYPED_TEST(DatabaseContractTest, UpdateUser_Contract_ExistingUser) {
+    int id = this->database_->saveUser(this->makeUser("John"));
+    User changed{id, "Johnny", "johnny@test.com", false};
+
+    EXPECT_TRUE(this->database_->updateUser(changed));
+
+    auto user = this->database_->findUserById(id);
+    ASSERT_TRUE(user.has_value());
+    EXPECT_EQ(*user, changed) << "CONTRACT VIOLATION: update must be visible";
+}
+
+TYPED_TEST(DatabaseContractTest, UpdateUser_Contract_NonExisting_ReturnsFalse) {
+    EXPECT_FALSE(this->database_->updateUser(User{99999, "X", "x@test.com", true}));
+    EXPECT_FALSE(this->database_->findUserById(99999).has_value())
+        << "CONTRACT VIOLATION: updateUser must not create records";
+}
+
+TYPED_TEST(DatabaseContractTest, DeleteUser_Contract) {
+    int id = this->database_->saveUser(this->makeUser("John"));
+
+    EXPECT_TRUE(this->database_->deleteUser(id));
+    EXPECT_FALSE(this->database_->findUserById(id).has_value());
+    EXPECT_FALSE(this->database_->deleteUser(id))
+        << "CONTRACT VIOLATION: second delete must return false";
+}
+
+TYPED_TEST(DatabaseContractTest, FindAllUsers_Contract_ReturnsEveryUser) {
+    std::set<int> expected;
+    for (int i = 0; i < 20; ++i) {
+        expected.insert(this->database_->saveUser(this->makeUser("U" + std::to_string(i))));
+    }
+    this->database_->deleteUser(*expected.begin());
+    expected.erase(expected.begin());
+
+    std::set<int> actual;
+    for (const auto& user : this->database_->findAllUsers()) {
+        actual.insert(user.id);
+    }
+    EXPECT_EQ(actual, expected);
+}
+
+// ============================================================================
+// КОНТРАКТ: saveOrder / findOrderById / findOrdersByUserId
+// ============================================================================
+
+TYPED_TEST(DatabaseContractTest, SaveOrder_Contract_DataIntegrity) {
+    int user_id = this->database_->saveUser(this->makeUser("John"));
+    int id = this->database_->saveOrder(this->makeOrder(user_id, "Laptop", 1500.5));
+
+    ASSERT_GT(id, 0) << "CONTRACT VIOLATION: saveOrder must return positive ID";
+    auto order = this->database_->findOrderById(id);
+
+    ASSERT_TRUE(order.has_value());
+    EXPECT_EQ(order->id, id);
+    EXPECT_EQ(order->user_id, user_id);
+    EXPECT_EQ(order->product_name, "Laptop");
+    EXPECT_EQ(order->amount, Money(1500.5));
+    EXPECT_EQ(order->status, OrderStatus::PENDING);
+}
+
+TYPED_TEST(DatabaseContractTest, FindOrderById_Contract_NonExisting_ReturnsNullopt) {
+    EXPECT_FALSE(this->database_->findOrderById(99999).has_value());
+}
+
+TYPED_TEST(DatabaseContractTest, FindOrdersByUserId_Contract_ReturnsOnlyUserOrders) {
+    int user1 = this->database_->saveUser(this->makeUser("U1"));
+    int user2 = this->database_->saveUser(this->makeUser("U2"));
+    for (int i = 0; i < 10; ++i) {
+        this->database_->saveOrder(this->makeOrder(user1, "A", 10.0));
+        this->database_->saveOrder(this->makeOrder(user2, "B", 20.0));
+    }
+
+    auto orders = this->database_->findOrdersByUserId(user1);
+
+    EXPECT_EQ(orders.size(), 10);
+    for (const auto& order : orders) {
+        EXPECT_EQ(order.user_id, user1)
+            << "CONTRACT VIOLATION: findOrdersByUserId must filter by user";
+    }
+    EXPECT_TRUE(this->database_->findOrdersByUserId(99999).empty());
+}
+
+TYPED_TEST(DatabaseContractTest, FindOrdersByUserId_Contract_OrderedById) {
+    int user1 = this->database_->saveUser(this->makeUser("U1"));
+    int user2 = this->database_->saveUser(this->makeUser("U2"));
+    std::vector<int> expected;
+    for (int i = 0; i < 30; ++i) {
+        expected.push_back(this->database_->saveOrder(this->makeOrder(user1, "A", 1.0)));
+        this->database_->saveOrder(this->makeOrder(user2, "B", 1.0));
+    }
+    this->database_->deleteOrder(expected[10]);
+    expected.erase(expected.begin() + 10);
+
+    std::vector<int> actual;
+    for (const auto& order : this->database_->findOrdersByUserId(user1)) {
+        actual.push_back(order.id);
+    }
+    EXPECT_EQ(actual, expected)
+        << "CONTRACT VIOLATION: user orders must be returned in ID order";
+}
+
+TYPED_TEST(DatabaseContractTest, ScanUsers_Contract_MatchesFindAllAndStopsEarly) {
+    for (int i = 0; i < 20; ++i) {
+        this->database_->saveUser(this->makeUser("User" + std::to_string(i), i % 2 == 0));
+    }
+
+    std::vector<User> scanned;
+    this->database_->scanUsers([&scanned](const User& user) {
+        scanned.push_back(user);
+        return true;
+    });
+    EXPECT_EQ(scanned, this->database_->findAllUsers())
+        << "CONTRACT VIOLATION: scanUsers must visit the same users as findAllUsers";
+
+    int visited = 0;
+    this->database_->scanUsers([&visited](const User&) { return ++visited < 5; });
+    EXPECT_EQ(visited, 5) << "CONTRACT VIOLATION: scanUsers must stop when visit returns false";
+}
+
+TYPED_TEST(DatabaseContractTest, ScanOrders_Contract_MatchesFindAllAndStopsEarly) {
+    int user_id = this->database_->saveUser(this->makeUser("John"));
+    for (int i = 0; i < 20; ++i) {
+        this->database_->saveOrder(this->makeOrder(user_id, "Product" + std::to_string(i), i));
+    }
+
+    std::vector<Order> scanned;
+    this->database_->scanOrders([&scanned](const Order& order) {
+        scanned.push_back(order);
+        return true;
+    });
+    EXPECT_EQ(scanned, this->database_->findAllOrders())
+        << "CONTRACT VIOLATION: scanOrders must visit the same orders as findAllOrders";
+
+    int visited = 0;
+    this->database_->scanOrders([&visited](const Order&) { return ++visited < 3; });
+    EXPECT_EQ(visited, 3) << "CONTRACT VIOLATION: scanOrders must stop when visit returns false";
+}
+
+TYPED_TEST(DatabaseContractTest, FindOrdersByUserIdPage_Contract_WalksAllPagesInIdOrder) {
+    int user1 = this->database_->saveUser(this->makeUser("U1"));
+    int user2 = this->database_->saveUser(this->makeUser("U2"));
+    std::vector<int> expected;
+    for (int i = 0; i < 25; ++i) {
+        expected.push_back(this->database_->saveOrder(this->makeOrder(user1, "A", 1.0)));
+        this->database_->saveOrder(this->makeOrder(user2, "B", 1.0));
+    }
+
+    std::vector<int> actual;
+    PageRequest page{0, 10};
+    for (;;) {
+        auto orders = this->database_->findOrdersByUserIdPage(user1, page);
+        ASSERT_LE(orders.size(), page.limit);
+        if (orders.empty()) {
+            break;
+        }
+        for (const auto& order : orders) {
+            EXPECT_EQ(order.user_id, user1);
+            actual.push_back(order.id);
+        }
+        page.after_id = orders.back().id;
+        if (actual.size() == 10) {
+            // Вставка между страницами не сдвигает следующие
+            expected.push_back(this->database_->saveOrder(this->makeOrder(user1, "C", 1.0)));
+        }
+    }
+    EXPECT_EQ(actual, expected)
+        << "CONTRACT VIOLATION: pages must cover user orders once, in ID order";
+    EXPECT_TRUE(this->database_->findOrdersByUserIdPage(user1, PageRequest{0, 0}).empty());
+}
+
+TYPED_TEST(DatabaseContractTest, FindActiveUsersPage_Contract_SkipsInactiveUsers) {
+    std::vector<int> active;
+    for (int i = 0; i < 30; ++i) {
+        int id = this->database_->saveUser(this->makeUser("U" + std::to_string(i), i % 3 != 0));
+        if (i % 3 != 0) {
+            active.push_back(id);
+        }
+    }
+
+    std::vector<int> actual;
+    PageRequest page{0, 7};
+    for (auto users = this->database_->findActiveUsersPage(page); !users.empty();
+         users = this->database_->findActiveUsersPage(page)) {
+        ASSERT_LE(users.size(), page.limit);
+        for (const auto& user : users) {
+            EXPECT_TRUE(user.is_active);
+            actual.push_back(user.id);
+        }
+        page.after_id = users.back().id;
+    }
+    EXPECT_EQ(actual, active)
+        << "CONTRACT VIOLATION: pages must cover active users once, in ID order";
+}
+
+TYPED_TEST(DatabaseContractTest, FindOrders_Contract_MatchesFilteredFindResults) {
+    int user1 = this->database_->saveUser(this->makeUser("U1"));
+    int user2 = this->database_->saveUser(this->makeUser("U2"));
+    for (int i = 0; i < 30; ++i) {
+        const auto status = static_cast<OrderStatus>(i % 5);
+        this->database_->saveOrder(this->makeOrder(i % 3 == 0 ? user2 : user1,
+                                                   "P" + std::to_string(i), 1.0 + i, status));
+    }
+
+    OrderQuery by_user;
+    by_user.user_id = user1;
+    OrderQuery by_status;
+    by_status.statuses = StatusSet::of({OrderStatus::DELIVERED, OrderStatus::CANCELLED});
+    OrderQuery combined;
+    combined.user_id = user1;
+    combined.statuses = StatusSet::allExcept({OrderStatus::CANCELLED});
+    combined.min_amount = Money(5.0);
+    combined.max_amount = Money(20.0);
+    OrderQuery nothing;
+    nothing.statuses = StatusSet::none();
+
+    for (const auto& query : {OrderQuery{}, by_user, by_status, combined, nothing}) {
+        auto expected = query.user_id ? this->database_->findOrdersByUserId(*query.user_id)
+                                      : this->database_->findAllOrders();
+        expected.erase(std::remove_if(expected.begin(), expected.end(),
+                                      [&query](const Order& order) {
+                                          return !query.matches(order);
+                                      }),
+                       expected.end());
+        EXPECT_EQ(this->database_->findOrders(query), expected)
+            << "CONTRACT VIOLATION: findOrders must return exactly the matching orders";
+    }
+    // Границы суммы включительны: 5.0 ... 20.0 без отмененных
+    for (const auto& order : this->database_->findOrders(combined)) {
+        EXPECT_EQ(order.user_id, user1);
+        EXPECT_NE(order.status, OrderStatus::CANCELLED);
+        EXPECT_GE(order.amount, Money(5.0));
+        EXPECT_LE(order.amount, Money(20.0));
+    }
+    EXPECT_EQ(this->database_->findOrders(combined).size(), 8);
+    EXPECT_TRUE(this->database_->findOrders(nothing).empty());
+}
+
+TYPED_TEST(DatabaseContractTest, FindOrderSummaries_Contract_ProjectFindOrders) {
+    int user_id = this->database_->saveUser(this->makeUser("John"));
+    for (int i = 0; i < 10; ++i) {
+        this->database_->saveOrder(this->makeOrder(user_id, "P" + std::to_string(i), 1.0 + i,
+                                                   static_cast<OrderStatus>(i % 5)));
+    }
+    this->database_->saveOrder(this->makeOrder(user_id + 1, "Other", 5.0));
+
+    OrderQuery by_user;
+    by_user.user_id = user_id;
+    OrderQuery terminal;
+    terminal.statuses = StatusSet::of({OrderStatus::DELIVERED, OrderStatus::CANCELLED});
+    for (const auto& query : {OrderQuery{}, by_user, terminal}) {
+        std::vector<OrderSummary> expected;
+        for (const auto& order : this->database_->findOrders(query)) {
+            expected.push_back(OrderSummary{order.id, order.user_id, order.amount, order.status});
+        }
+        EXPECT_EQ(this->database_->findOrderSummaries(query), expected)
+            << "CONTRACT VIOLATION: summaries must project findOrders";
+    }
+}
+
+TYPED_TEST(DatabaseContractTest, AggregateOrders_Contract_MatchesFindOrders) {
+    int user1 = this->database_->saveUser(this->makeUser("U1"));
+    int user2 = this->database_->saveUser(this->makeUser("U2"));
+    for (int i = 0; i < 40; ++i) {
+        this->database_->saveOrder(this->makeOrder(i % 4 == 0 ? user2 : user1, "P", 0.5 + i,
+                                                   static_cast<OrderStatus>(i % 5)));
+    }
+
+    OrderQuery not_cancelled;
+    not_cancelled.user_id = user1;
+    not_cancelled.statuses = StatusSet::allExcept({OrderStatus::CANCELLED});
+    OrderQuery delivered;
+    delivered.statuses = StatusSet::of({OrderStatus::DELIVERED});
+    OrderQuery missing;
+    missing.user_id = 99999;
+    for (const auto& query : {OrderQuery{}, not_cancelled, delivered, missing}) {
+        OrderAggregate expected;
+        for (const auto& order : this->database_->findOrders(query)) {
+            expected.add(order.amount);
+        }
+        const auto actual = this->database_->aggregateOrders(query);
+        EXPECT_EQ(actual.count, expected.count)
+            << "CONTRACT VIOLATION: aggregate must count the orders findOrders returns";
+        EXPECT_EQ(actual.sum, expected.sum);
+        if (expected.count > 0) {
+            EXPECT_EQ(actual.min, expected.min);
+            EXPECT_EQ(actual.max, expected.max);
+        }
+    }
+    const auto all = this->database_->aggregateOrders(OrderQuery{});
+    EXPECT_EQ(all.count, 40);
+    EXPECT_EQ(all.min, Money(0.5));
+    EXPECT_EQ(all.max, Money(39.5));
+    EXPECT_EQ(this->database_->aggregateOrders(missing).count, 0);
+}
+
+TYPED_TEST(DatabaseContractTest, FindUserActive_Contract_ReflectsUpdates) {
+    int id = this->database_->saveUser(this->makeUser("John"));
+    EXPECT_EQ(this->database_->findUserActive(id), std::optional<bool>(true));
+
+    this->database_->updateUser(User{id, "John", "John@test.com", false});
+    EXPECT_EQ(this->database_->findUserActive(id), std::optional<bool>(false));
+
+    this->database_->deleteUser(id);
+    EXPECT_FALSE(this->database_->findUserActive(id).has_value())
+        << "CONTRACT VIOLATION: deleted user must have no active flag";
+}
+
+TYPED_TEST(DatabaseContractTest, FindUsers_Contract_FiltersByActiveFlag) {
+    for (int i = 0; i < 12; ++i) {
+        this->database_->saveUser(this->makeUser("U" + std::to_string(i), i % 4 != 0));
+    }
+
+    UserQuery active;
+    active.is_active = true;
+    UserQuery inactive;
+    inactive.is_active = false;
+
+    EXPECT_EQ(this->database_->findUsers(UserQuery{}), this->database_->findAllUsers());
+    EXPECT_EQ(this->database_->findUsers(active).size(), 9);
+    EXPECT_EQ(this->database_->findUsers(inactive).size(), 3);
+    for (const auto& user : this->database_->findUsers(inactive)) {
+        EXPECT_FALSE(user.is_active) << "CONTRACT VIOLATION: findUsers must apply the filter";
+    }
+}
+
+TYPED_TEST(DatabaseContractTest, UpdateOrder_Contract_ChangeOwner_MovesOrder) {
+    int user1 = this->database_->saveUser(this->makeUser("U1"));
+    int user2 = this->database_->saveUser(this->makeUser("U2"));
+    int id = this->database_->saveOrder(this->makeOrder(user1, "A", 1.0));
+
+    EXPECT_TRUE(this->database_->updateOrder(Order{id, user2, "A", 1.0, OrderStatus::PENDING}));
+
+    EXPECT_TRUE(this->database_->findOrdersByUserId(user1).empty());
+    ASSERT_EQ(this->database_->findOrdersByUserId(user2).size(), 1);
+    EXPECT_EQ(this->database_->findOrdersByUserId(user2)[0].id, id);
+}
+
+TYPED_TEST(DatabaseContractTest, UpdateOrder_Contract) {
+    int user_id = this->database_->saveUser(this->makeUser("John"));
+    int id = this->database_->saveOrder(this->makeOrder(user_id, "Laptop", 100.0));
+    Order changed{id, user_id, "Laptop", 100.0, OrderStatus::SHIPPED};
+
+    EXPECT_TRUE(this->database_->updateOrder(changed));
+    EXPECT_EQ(*this->database_->findOrderById(id), changed);
+    EXPECT_FALSE(this->database_->updateOrder(Order{99999, user_id, "X", 1.0,
+                                                    OrderStatus::PENDING}));
+}
+
+TYPED_TEST(DatabaseContractTest, DeleteOrder_Contract) {
+    int user_id = this->database_->saveUser(this->makeUser("John"));
+    int id = this->database_->saveOrder(this->makeOrder(user_id, "Laptop", 100.0));
+
+    EXPECT_TRUE(this->database_->deleteOrder(id));
+    EXPECT_FALSE(this->database_->findOrderById(id).has_value());
+    EXPECT_TRUE(this->database_->findOrdersByUserId(user_id).empty());
+    EXPECT_FALSE(this->database_->deleteOrder(id));
+}
+
+TYPED_TEST(DatabaseContractTest, FindAllOrders_Contract_ReturnsEveryOrder) {
+    int user_id = this->database_->saveUser(this->makeUser("John"));
+    for (int i = 0; i < 25; ++i) {
+        this->database_->saveOrder(this->makeOrder(user_id, "P", 1.0 + i));
+    }
+    EXPECT_EQ(this->database_->findAllOrders().size(), 25);
+}
+
+// ============================================================================
+// КОНТРАКТ: clear
+// Постусловие: база пуста и снова принимает записи
+// ============================================================================
+
+TYPED_TEST(DatabaseContractTest, Clear_Contract_EmptiesDatabase) {
+    int user_id = this->database_->saveUser(this->makeUser("John"));
+    this->database_->saveOrder(this->makeOrder(user_id, "Laptop", 100.0));
+
+    this->database_->clear();
+
+    EXPECT_TRUE(this->database_->findAllUsers().empty());
+    EXPECT_TRUE(this->database_->findAllOrders().empty());
+    EXPECT_FALSE(this->database_->findUserById(user_id).has_value());
+    EXPECT_GT(this->database_->saveUser(this->makeUser("Again")), 0);
+}
+
+// ============================================================================
+// Сервисы поверх хранилища: контракт IDatabase достаточен для них
+// ============================================================================
+
+TYPED_TEST(DatabaseContractTest, Services_Contract_WorkOnTopOfDatabase) {
+    auto userService = std::make_shared<UserService>(this->database_);
+    OrderService orderService(this->database_, userService);
+
+    int user_id = userService->createUser("Ivan", "ivan@test.com");
+    int order1 = orderService.createOrder(user_id, "Laptop", 75000.0);
+    int order2 = orderService.createOrder(user_id, "Mouse", 2500.0);
+    ASSERT_GT(order1, 0);
+    ASSERT_GT(order2, 0);
+
+    EXPECT_TRUE(orderService.cancelOrder(order2));
+    EXPECT_TRUE(orderService.updateOrderStatus(order1, OrderStatus::SHIPPED));
+    EXPECT_DOUBLE_EQ(orderService.getTotalAmount(user_id), 75000.0);
+    EXPECT_EQ(orderService.getUserOrders(user_id).size(), 2);
+
+    EXPECT_TRUE(userService->deactivateUser(user_id));
+    EXPECT_TRUE(userService->getActiveUsers().empty());
+    EXPECT_EQ(orderService.createOrder(user_id, "Keyboard", 10.0), -1);
+}
@@ -131,7 +131,7 @@ TEST_F(OrderContractTest, GetOrder_Contract_DataIntegrity) {
         << "CONTRACT VIOLATION: order user_id must be preserved";
     EXPECT_EQ(order->product_name, product) 
         << "CONTRACT VIOLATION: order product_name must be preserved";
-    EXPECT_DOUBLE_EQ(order->amount, amount) 
+    EXPECT_EQ(order->amount, Money(amount)) 
         << "CONTRACT VIOLATION: order amount must be preserved";
 }
 
@@ -159,6 +159,40 @@ TEST_F(OrderContractTest, GetUserOrders_Contract_ReturnsOnlyUserOrders) {
     EXPECT_EQ(orders.size(), 2);
 }
 
+TEST_F(OrderContractTest, GetUserOrders_Contract_PageContinuesAfterCursor) {
+    std::vector<int> ids;
+    for (int i = 0; i < 5; ++i) {
+        ids.push_back(orderService_->createOrder(active_user_id_, "Product", 10.0 + i));
+    }
+
+    auto first = orderService_->getUserOrders(active_user_id_, PageRequest{0, 3});
+    auto second = orderService_->getUserOrders(active_user_id_, PageRequest{first.back().id, 3});
+
+    ASSERT_EQ(first.size(), 3);
+    ASSERT_EQ(second.size(), 2)
+        << "CONTRACT VIOLATION: page must contain only orders after the cursor";
+    EXPECT_EQ(first[0].id, ids[0]);
+    EXPECT_EQ(second[0].id, ids[3]);
+    EXPECT_EQ(second[1].id, ids[4]);
+}
+
+TEST_F(OrderContractTest, GetUserOrderSummaries_Contract_MatchGetUserOrders) {
+    orderService_->createOrder(active_user_id_, "Laptop", 100.0);
+    int cancelled = orderService_->createOrder(active_user_id_, "Phone", 50.0);
+    orderService_->cancelOrder(cancelled);
+
+    auto orders = orderService_->getUserOrders(active_user_id_);
+    auto summaries = orderService_->getUserOrderSummaries(active_user_id_);
+
+    ASSERT_EQ(summaries.size(), orders.size())
+        << "CONTRACT VIOLATION: summaries must cover the same orders";
+    for (std::size_t i = 0; i < orders.size(); ++i) {
+        EXPECT_EQ(summaries[i], (OrderSummary{orders[i].id, orders[i].user_id, orders[i].amount,
+                                              orders[i].status}));
+    }
+    EXPECT_TRUE(orderService_->getUserOrderSummaries(99999).empty());
+}
+
 // ============================================================================
 // КОНТРАКТ: cancelOrder
 // Предусловие: заказ существует
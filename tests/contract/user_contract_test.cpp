@@ -163,6 +163,27 @@ TEST_F(UserContractTest, GetActiveUsers_Contract_ReturnsOnlyActive) {
         << "CONTRACT VIOLATION: deactivated user must not be in active users list";
 }
 
+TEST_F(UserContractTest, GetActiveUsers_Contract_PageContinuesAfterCursor) {
+    // Arrange
+    int id1 = service_->createUser("User1", "user1@test.com");
+    int id2 = service_->createUser("User2", "user2@test.com");
+    int id3 = service_->createUser("User3", "user3@test.com");
+    int id4 = service_->createUser("User4", "user4@test.com");
+    service_->deactivateUser(id2);
+
+    // Act
+    auto first = service_->getActiveUsers(PageRequest{0, 2});
+    auto second = service_->getActiveUsers(PageRequest{first.back().id, 2});
+
+    // Assert: постусловие - страницы по возрастанию ID без неактивных
+    ASSERT_EQ(first.size(), 2);
+    EXPECT_EQ(first[0].id, id1);
+    EXPECT_EQ(first[1].id, id3);
+    ASSERT_EQ(second.size(), 1)
+        << "CONTRACT VIOLATION: page must contain only users after the cursor";
+    EXPECT_EQ(second[0].id, id4);
+}
+
 // ============================================================================
 // КОНТРАКТ: deactivateUser
 // Предусловие: нет
@@ -222,3 +243,20 @@ TEST_F(UserContractTest, UserExists_Contract_ConsistentWithGetUser) {
     EXPECT_FALSE(service_->getUser(99999).has_value());
 }
 
+// ============================================================================
+// КОНТРАКТ: isActive
+// Предусловие: нет
+// Постусловие: true только для существующего активного пользователя
+// ============================================================================
+
+TEST_F(UserContractTest, IsActive_Contract_ConsistentWithGetUser) {
+    int id = service_->createUser("John", "john@test.com");
+    EXPECT_TRUE(service_->isActive(id));
+
+    service_->deactivateUser(id);
+    EXPECT_FALSE(service_->isActive(id))
+        << "CONTRACT VIOLATION: deactivated user must not be active";
+    EXPECT_TRUE(service_->userExists(id));
+    EXPECT_FALSE(service_->isActive(99999));
+}
+
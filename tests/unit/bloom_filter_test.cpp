@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+#include "services/bloom_filter.hpp"
+
+using namespace services;
+
+TEST(BloomFilterUnitTest, AddedKeys_AlwaysMayBeContained) {
+    BloomFilter filter(1000, 10);
+    for (std::uint64_t key = 1; key <= 1000; ++key) {
+        filter.add(key * 7);
+    }
+
+    for (std::uint64_t key = 1; key <= 1000; ++key) {
+        EXPECT_TRUE(filter.mayContain(key * 7));
+    }
+    EXPECT_TRUE(BloomFilter::mayContain(filter.bytes().data(), filter.bytes().size(),
+                                        filter.hashes(), 7));
+}
+
+TEST(BloomFilterUnitTest, FalsePositiveRate_MatchesBitsPerKey) {
+    constexpr std::uint64_t kKeys = 10000;
+    BloomFilter filter(kKeys, 10);
+    for (std::uint64_t key = 0; key < kKeys; ++key) {
+        filter.add(key);
+    }
+
+    std::size_t false_positives = 0;
+    for (std::uint64_t key = kKeys; key < 11 * kKeys; ++key) {
+        false_positives += filter.mayContain(key) ? 1 : 0;
+    }
+
+    // Теоретически около 0.8% при 10 битах и 7 хешах
+    EXPECT_LT(false_positives, kKeys * 10 / 50);
+}
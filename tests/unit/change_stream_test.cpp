@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "services/change_stream.hpp"
+#include "services/database.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace services;
+using namespace contracts;
+
+TEST(ChangeStreamTest, Database_PublishesEveryMutationInOrder) {
+    auto stream = std::make_shared<ChangeStream>();
+    InMemoryDatabase database;
+    database.attachChangeStream(stream);
+
+    const int user_id = database.saveUser(User{0, "John", "john@test.com", true});
+    const int order_id =
+        database.saveOrder(Order{0, user_id, "Laptop", 999.99, OrderStatus::PENDING});
+    ASSERT_TRUE(database.updateOrder(Order{order_id, user_id, "Laptop", 999.99,
+                                           OrderStatus::SHIPPED}));
+    ASSERT_TRUE(database.deleteOrder(order_id));
+    ASSERT_TRUE(database.deleteUser(user_id));
+    // Неудачное изменение ничего не публикует
+    EXPECT_FALSE(database.deleteUser(user_id));
+    database.clear();
+
+    std::vector<ChangeEvent::Type> types;
+    std::uint64_t next = 1;
+    ASSERT_TRUE(stream->poll(next, [&](const ChangeEvent& event) {
+        EXPECT_EQ(event.sequence, types.size() + 1);
+        types.push_back(event.type);
+        if (event.sequence == 1) {
+            EXPECT_EQ(event.id, user_id);
+            EXPECT_EQ(event.name, "John");
+            EXPECT_EQ(event.email, "john@test.com");
+            EXPECT_TRUE(event.is_active);
+        } else if (event.sequence == 3) {
+            EXPECT_EQ(event.id, order_id);
+            EXPECT_EQ(event.user_id, user_id);
+            EXPECT_EQ(event.product_name, "Laptop");
+            EXPECT_EQ(event.amount, Money(999.99));
+            EXPECT_EQ(event.status, OrderStatus::SHIPPED);
+        }
+    }));
+
+    using Type = ChangeEvent::Type;
+    EXPECT_EQ(types, (std::vector<Type>{Type::PutUser, Type::PutOrder, Type::PutOrder,
+                                        Type::DeleteOrder, Type::DeleteUser, Type::Clear}));
+    EXPECT_EQ(next, stream->nextSequence());
+}
+
+TEST(ChangeStreamTest, Poll_ResumesFromSequenceAndReportsOverrun) {
+    ChangeStream stream(4096);
+    for (int i = 1; i <= 10; ++i) {
+        stream.publishDelete(ChangeEvent::Type::DeleteOrder, i);
+    }
+
+    // Продолжение с произвольного номера, порциями
+    std::uint64_t next = 4;
+    std::vector<int> ids;
+    const auto collect = [&ids](const ChangeEvent& event) { ids.push_back(event.id); };
+    ASSERT_TRUE(stream.poll(next, collect, 3));
+    EXPECT_EQ(next, 7);
+    ASSERT_TRUE(stream.poll(next, collect));
+    EXPECT_EQ(ids, (std::vector<int>{4, 5, 6, 7, 8, 9, 10}));
+
+    // Писатель обгоняет читателя на целое кольцо
+    for (int i = 11; i <= 1000; ++i) {
+        stream.publishUser(i, "User " + std::to_string(i), "user@test.com", true);
+    }
+    std::uint64_t lagging = 1;
+    EXPECT_FALSE(stream.poll(lagging, collect));
+    EXPECT_EQ(lagging, 1);
+    EXPECT_GT(stream.oldestSequence(), 1);
+
+    lagging = stream.oldestSequence();
+    std::uint64_t expected = lagging;
+    ASSERT_TRUE(stream.poll(lagging, [&expected](const ChangeEvent& event) {
+        EXPECT_EQ(event.sequence, expected++);
+        EXPECT_EQ(event.name, "User " + std::to_string(event.id));
+    }));
+    EXPECT_EQ(lagging, stream.nextSequence());
+
+    // Слишком длинная запись публикуется без строк
+    stream.publishUser(1001, std::string(4096, 'x'), "user@test.com", true);
+    ASSERT_TRUE(stream.poll(lagging, [](const ChangeEvent& event) {
+        EXPECT_TRUE(event.truncated);
+        EXPECT_TRUE(event.name.empty());
+    }));
+}
+
+TEST(ChangeStreamTest, Poll_ConcurrentReadersSeeConsistentEvents) {
+    auto stream = std::make_shared<ChangeStream>(16 << 10);
+    InMemoryDatabase database;
+    database.attachChangeStream(stream);
+    const int user_id = database.saveUser(User{0, "Owner", "owner@test.com", true});
+    constexpr int kOrders = 20000;
+
+    std::atomic<bool> done{false};
+    std::atomic<int> corrupted{0};
+    const auto reader = [&] {
+        std::uint64_t next = stream->oldestSequence();
+        while (!done.load() || next < stream->nextSequence()) {
+            int mismatches = 0;
+            const bool ok = stream->poll(next, [&](const ChangeEvent& event) {
+                // Название заказа выводится из его ID: рваное чтение его нарушит
+                if (event.type == ChangeEvent::Type::PutOrder && !event.product_name.empty() &&
+                    event.product_name != "Product " + std::to_string(event.id)) {
+                    ++mismatches;
+                }
+            });
+            // visit получает только проверенные копии, даже если порция прервана
+            corrupted += mismatches;
+            if (!ok) {
+                // Отставший читатель отбрасывает порцию и продолжает с самого старого
+                next = stream->oldestSequence();
+            }
+        }
+    };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; ++i) {
+        readers.emplace_back(reader);
+    }
+    for (int i = 0; i < kOrders; ++i) {
+        const int id = database.saveOrder(Order{0, user_id, "", 1.0, OrderStatus::PENDING});
+        database.updateOrder(
+            Order{id, user_id, "Product " + std::to_string(id), 1.0, OrderStatus::CONFIRMED});
+    }
+    done = true;
+    for (auto& thread : readers) {
+        thread.join();
+    }
+
+    EXPECT_EQ(corrupted.load(), 0);
+    EXPECT_EQ(stream->nextSequence(), 2 + 2 * static_cast<std::uint64_t>(kOrders));
+}
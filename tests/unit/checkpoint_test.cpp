@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include "temp_directory_test.hpp"
+#include "services/checkpoint.hpp"
+#include "services/database.hpp"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <thread>
+
+using namespace services;
+using namespace contracts;
+
+class CheckpointUnitTest : public TempDirectoryTest {
+protected:
+    void SetUp() override {
+        TempDirectoryTest::SetUp();
+        path_ = directory_ + "/checkpoint.bin";
+    }
+
+    std::string path_;
+};
+
+TEST_F(CheckpointUnitTest, WriterReader_RoundTripAndSharedProductNames) {
+    CheckpointWriter writer;
+    writer.addUser(1, "John", "john@test.com", true);
+    writer.addUser(2, "", "", false);
+    writer.addOrder(10, 1, "Laptop", Money(999.99), OrderStatus::SHIPPED);
+    writer.addOrder(11, 2, "Mouse", Money(25.0), OrderStatus::PENDING);
+    writer.addOrder(12, 1, "Laptop", Money(1.0), OrderStatus::CANCELLED);
+    ASSERT_TRUE(writer.write(path_));
+
+    auto reader = CheckpointReader::open(path_);
+
+    ASSERT_TRUE(reader.has_value());
+    ASSERT_EQ(reader->userCount(), 2);
+    EXPECT_EQ(reader->user(0).name, "John");
+    EXPECT_EQ(reader->user(0).email, "john@test.com");
+    EXPECT_TRUE(reader->user(0).is_active);
+    EXPECT_TRUE(reader->user(1).name.empty());
+    EXPECT_FALSE(reader->user(1).is_active);
+    ASSERT_EQ(reader->orderCount(), 3);
+    EXPECT_EQ(reader->productCount(), 2);
+    EXPECT_EQ(reader->order(0).product, reader->order(2).product);
+    EXPECT_EQ(reader->product(reader->order(1).product), "Mouse");
+    EXPECT_EQ(reader->order(0).amount, Money(999.99));
+    EXPECT_EQ(reader->order(2).status, OrderStatus::CANCELLED);
+}
+
+TEST_F(CheckpointUnitTest, Open_RejectsMissingTruncatedAndCorruptedFiles) {
+    EXPECT_FALSE(CheckpointReader::open(path_).has_value());
+
+    CheckpointWriter writer;
+    writer.addUser(1, "John", "john@test.com", true);
+    writer.addOrder(10, 1, "Laptop", Money(1.0), OrderStatus::PENDING);
+    ASSERT_TRUE(writer.write(path_));
+    const auto size = std::filesystem::file_size(path_);
+    {
+        std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-1, std::ios::end);
+        file.put('X');
+    }
+    EXPECT_FALSE(CheckpointReader::open(path_).has_value());
+
+    ASSERT_TRUE(writer.write(path_));
+    std::filesystem::resize_file(path_, size - 1);
+    EXPECT_FALSE(CheckpointReader::open(path_).has_value());
+}
+
+TEST_F(CheckpointUnitTest, Database_SaveLoad_RestoresTablesIndexAndIds) {
+    InMemoryDatabase source;
+    int john = source.saveUser(User{0, "John", "john@test.com", true});
+    int jane = source.saveUser(User{0, "Jane", "jane@test.com", false});
+    int first = source.saveOrder(Order{0, john, "Laptop", 999.99, OrderStatus::PENDING});
+    int deleted = source.saveOrder(Order{0, jane, "Mouse", 25.0, OrderStatus::PENDING});
+    int last = source.saveOrder(Order{0, john, "Laptop", 10.0, OrderStatus::SHIPPED});
+    source.deleteOrder(deleted);
+    ASSERT_TRUE(source.saveCheckpoint(path_));
+
+    InMemoryDatabase loaded;
+    loaded.saveUser(User{0, "Stale", "stale@test.com", true});
+    ASSERT_TRUE(loaded.loadCheckpoint(path_));
+
+    ASSERT_EQ(loaded.findAllUsers().size(), 2);
+    EXPECT_EQ(loaded.findUserById(jane)->email, "jane@test.com");
+    EXPECT_FALSE(loaded.findUserById(jane)->is_active);
+    EXPECT_FALSE(loaded.findOrderById(deleted).has_value());
+    EXPECT_TRUE(loaded.findOrdersByUserId(jane).empty());
+    auto orders = loaded.findOrdersByUserId(john);
+    ASSERT_EQ(orders.size(), 2);
+    EXPECT_EQ(orders[0].id, first);
+    EXPECT_EQ(orders[1].id, last);
+    EXPECT_EQ(orders[1].amount, Money(10.0));
+    EXPECT_EQ(orders[1].status, OrderStatus::SHIPPED);
+    // Одинаковые названия после загрузки снова интернированы
+    EXPECT_EQ(loaded.textMemory().product_names, 1);
+    EXPECT_GT(loaded.saveOrder(Order{0, john, "P", 1.0, OrderStatus::PENDING}), last);
+}
+
+TEST_F(CheckpointUnitTest, Database_LoadCorrupted_KeepsContents) {
+    {
+        std::ofstream out(path_, std::ios::binary);
+        out << "not a checkpoint file at all, but long enough for a header check";
+    }
+    InMemoryDatabase database;
+    int id = database.saveUser(User{0, "John", "john@test.com", true});
+
+    EXPECT_FALSE(database.loadCheckpoint(path_));
+    EXPECT_TRUE(database.findUserById(id).has_value());
+}
+
+TEST_F(CheckpointUnitTest, Database_SaveDuringWrites_IsConsistentAcrossTables) {
+    constexpr int kPairs = 5000;
+    InMemoryDatabase database;
+    std::atomic<bool> done{false};
+
+    // Заказ создается только после своего пользователя: в согласованной
+    // контрольной точке у каждого заказа есть пользователь
+    std::thread writer([&] {
+        for (int i = 0; i < kPairs; ++i) {
+            int user_id = database.saveUser(User{0, "U", "u@test.com", true});
+            database.saveOrder(Order{0, user_id, "P", 1.0, OrderStatus::PENDING});
+        }
+        done.store(true);
+    });
+    do {
+        EXPECT_TRUE(database.saveCheckpoint(path_));
+        auto reader = CheckpointReader::open(path_);
+        if (!reader) {
+            ADD_FAILURE() << "checkpoint did not open";
+            break;
+        }
+        std::set<int> users;
+        for (std::size_t i = 0; i < reader->userCount(); ++i) {
+            users.insert(reader->user(i).id);
+        }
+        for (std::size_t i = 0; i < reader->orderCount(); ++i) {
+            EXPECT_EQ(users.count(reader->order(i).user_id), 1);
+        }
+    } while (!done.load());
+    writer.join();
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "services/columnar_database.hpp"
+#include <map>
+
+using namespace services;
+using namespace contracts;
+
+class ColumnarDatabaseUnitTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        user_id_ = database_.saveUser(User{0, "John", "john@test.com", true});
+    }
+
+    int addOrder(Money amount, OrderStatus status, const std::string& product = "P") {
+        return database_.saveOrder(Order{0, user_id_, product, amount, status});
+    }
+
+    ColumnarDatabase database_;
+    int user_id_ = 0;
+};
+
+TEST_F(ColumnarDatabaseUnitTest, StatusAggregates) {
+    double pending = 0;
+    for (int i = 1; i <= 37; ++i) {
+        OrderStatus status = i % 3 == 0 ? OrderStatus::SHIPPED : OrderStatus::PENDING;
+        addOrder(i, status);
+        if (status == OrderStatus::PENDING) {
+            pending += i;
+        }
+    }
+
+    EXPECT_EQ(database_.countOrdersByStatus(OrderStatus::SHIPPED), 12);
+    EXPECT_EQ(database_.countOrdersByStatus(OrderStatus::PENDING), 25);
+    EXPECT_EQ(database_.countOrdersByStatus(OrderStatus::CANCELLED), 0);
+    EXPECT_EQ(database_.sumAmountByStatus(OrderStatus::PENDING), Money(pending));
+    EXPECT_EQ(database_.sumAmountByStatus(OrderStatus::DELIVERED), Money(0.0));
+}
+
+TEST_F(ColumnarDatabaseUnitTest, TotalAmountByUser_SkipsCancelled) {
+    addOrder(100.0, OrderStatus::PENDING);
+    addOrder(50.0, OrderStatus::CANCELLED);
+    addOrder(25.0, OrderStatus::DELIVERED);
+    int other = database_.saveUser(User{0, "Jane", "jane@test.com", true});
+    database_.saveOrder(Order{0, other, "P", 1000.0, OrderStatus::PENDING});
+
+    EXPECT_EQ(database_.totalAmountByUser(user_id_), Money(125.0));
+    EXPECT_EQ(database_.totalAmountByUser(other), Money(1000.0));
+    EXPECT_EQ(database_.totalAmountByUser(999), Money(0.0));
+}
+
+TEST_F(ColumnarDatabaseUnitTest, DeleteOrder_MovesLastRowAndKeepsLookups) {
+    int first = addOrder(1.0, OrderStatus::PENDING, "First");
+    int second = addOrder(2.0, OrderStatus::PENDING, "Second");
+    int third = addOrder(3.0, OrderStatus::SHIPPED, "Third");
+
+    EXPECT_TRUE(database_.deleteOrder(first));
+
+    EXPECT_FALSE(database_.findOrderById(first).has_value());
+    ASSERT_TRUE(database_.findOrderById(third).has_value());
+    EXPECT_EQ(database_.findOrderById(third)->product_name, "Third");
+    EXPECT_EQ(database_.findOrderById(third)->status, OrderStatus::SHIPPED);
+    EXPECT_EQ(database_.findOrderById(second)->product_name, "Second");
+    EXPECT_EQ(database_.sumAmountByStatus(OrderStatus::PENDING), Money(2.0));
+
+    auto orders = database_.findOrdersByUserId(user_id_);
+    ASSERT_EQ(orders.size(), 2);
+    EXPECT_EQ(orders[0].id, second);
+    EXPECT_EQ(orders[1].id, third);
+}
+
+TEST_F(ColumnarDatabaseUnitTest, UpdateOrder_StatusOnly_DoesNotRewriteName) {
+    int id = addOrder(1.0, OrderStatus::PENDING, "Laptop");
+    Order order = *database_.findOrderById(id);
+
+    order.status = OrderStatus::CONFIRMED;
+    ASSERT_TRUE(database_.updateOrder(order));
+    EXPECT_EQ(database_.productHeapGarbage(), 0);
+
+    order.product_name = "Notebook";
+    ASSERT_TRUE(database_.updateOrder(order));
+    EXPECT_EQ(database_.findOrderById(id)->product_name, "Notebook");
+    EXPECT_EQ(database_.findOrderById(id)->status, OrderStatus::CONFIRMED);
+}
+
+TEST_F(ColumnarDatabaseUnitTest, ProductHeap_CompactsAndKeepsNames) {
+    std::map<int, std::string> expected;
+    for (int i = 0; i < 200; ++i) {
+        std::string name = "Product-" + std::to_string(i);
+        expected[addOrder(1.0, OrderStatus::PENDING, name)] = name;
+    }
+    // Переименования и удаления оставляют мусор в куче до сжатия
+    int round = 0;
+    for (auto it = expected.begin(); it != expected.end();) {
+        if (++round % 2 == 0) {
+            EXPECT_TRUE(database_.deleteOrder(it->first));
+            it = expected.erase(it);
+            continue;
+        }
+        it->second += "-renamed";
+        Order order = *database_.findOrderById(it->first);
+        order.product_name = it->second;
+        EXPECT_TRUE(database_.updateOrder(order));
+        ++it;
+    }
+
+    for (const auto& [id, name] : expected) {
+        auto order = database_.findOrderById(id);
+        ASSERT_TRUE(order.has_value());
+        EXPECT_EQ(order->product_name, name);
+    }
+    EXPECT_EQ(database_.findAllOrders().size(), expected.size());
+    // Сжатие не дает мусору превысить половину кучи
+    std::size_t live = 0;
+    for (const auto& entry : expected) {
+        live += entry.second.size();
+    }
+    EXPECT_LE(database_.productHeapGarbage(), live);
+}
@@ -0,0 +1,364 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "services/database.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace services;
+using namespace contracts;
+
+class InMemoryDatabaseUnitTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        database_ = std::make_unique<InMemoryDatabase>();
+        user_id_ = database_->saveUser(User{0, "John", "john@test.com", true});
+    }
+
+    int addOrder(int user_id) {
+        return database_->saveOrder(Order{0, user_id, "P", 1.0, OrderStatus::PENDING});
+    }
+
+    std::unique_ptr<InMemoryDatabase> database_;
+    int user_id_;
+};
+
+TEST_F(InMemoryDatabaseUnitTest, InsertOrder_OutOfOrderIds_IndexStaysSorted) {
+    database_->insertOrder(Order{30, user_id_, "P", 1.0, OrderStatus::PENDING});
+    database_->insertOrder(Order{10, user_id_, "P", 1.0, OrderStatus::PENDING});
+    database_->insertOrder(Order{20, user_id_, "P", 1.0, OrderStatus::PENDING});
+
+    auto orders = database_->findOrdersByUserId(user_id_);
+
+    ASSERT_EQ(orders.size(), 3);
+    EXPECT_EQ(orders[0].id, 10);
+    EXPECT_EQ(orders[1].id, 20);
+    EXPECT_EQ(orders[2].id, 30);
+}
+
+TEST_F(InMemoryDatabaseUnitTest, InsertOrder_DuplicateOrInvalidId_ReturnsFalse) {
+    EXPECT_TRUE(database_->insertOrder(Order{5, user_id_, "P", 1.0, OrderStatus::PENDING}));
+    EXPECT_FALSE(database_->insertOrder(Order{5, user_id_, "Q", 2.0, OrderStatus::PENDING}));
+    EXPECT_FALSE(database_->insertOrder(Order{0, user_id_, "P", 1.0, OrderStatus::PENDING}));
+
+    EXPECT_EQ(database_->findOrdersByUserId(user_id_).size(), 1);
+    // Следующий выданный ID не пересекается со вставленным
+    EXPECT_GT(addOrder(user_id_), 5);
+}
+
+TEST_F(InMemoryDatabaseUnitTest, InsertInsideLeasedBlock_SaveSkipsTakenIds) {
+    InMemoryDatabase database;
+    ASSERT_EQ(database.saveUser(User{0, "A", "a@test.com", true}), 1);
+    // ID 2 уже в блоке, арендованном этим потоком
+    ASSERT_TRUE(database.insertUser(User{2, "B", "b@test.com", true}));
+
+    const int id = database.saveUser(User{0, "C", "c@test.com", true});
+
+    EXPECT_NE(id, 2);
+    ASSERT_TRUE(database.findUserById(id).has_value());
+    EXPECT_EQ(database.findUserById(id)->name, "C");
+    EXPECT_EQ(database.findUserById(2)->name, "B");
+    EXPECT_EQ(database.findAllUsers().size(), 3);
+
+    ASSERT_EQ(database.saveOrder(Order{0, 1, "P", 1.0, OrderStatus::PENDING}), 1);
+    ASSERT_TRUE(database.insertOrder(Order{2, 2, "Q", 2.0, OrderStatus::PENDING}));
+    const int order_id = database.saveOrder(Order{0, 1, "R", 3.0, OrderStatus::PENDING});
+    EXPECT_NE(order_id, 2);
+    EXPECT_EQ(database.findOrderById(order_id)->product_name, "R");
+    EXPECT_EQ(database.findOrderById(2)->product_name, "Q");
+    EXPECT_EQ(database.findOrdersByUserId(1).size(), 2);
+    EXPECT_EQ(database.findOrdersByUserId(2).size(), 1);
+}
+
+TEST_F(InMemoryDatabaseUnitTest, UpdateOrder_SameOwner_KeepsIndex) {
+    int id = addOrder(user_id_);
+
+    EXPECT_TRUE(database_->updateOrder(Order{id, user_id_, "P", 1.0, OrderStatus::SHIPPED}));
+
+    auto orders = database_->findOrdersByUserId(user_id_);
+    ASSERT_EQ(orders.size(), 1);
+    EXPECT_EQ(orders[0].status, OrderStatus::SHIPPED);
+}
+
+TEST_F(InMemoryDatabaseUnitTest, Clear_DropsIndex) {
+    addOrder(user_id_);
+    database_->clear();
+
+    EXPECT_TRUE(database_->findOrdersByUserId(user_id_).empty());
+
+    int user_id = database_->saveUser(User{0, "Jane", "jane@test.com", true});
+    addOrder(user_id);
+    EXPECT_EQ(database_->findOrdersByUserId(user_id).size(), 1);
+}
+
+TEST_F(InMemoryDatabaseUnitTest, ConcurrentReadersAndWriter_SeeConsistentRecords) {
+    constexpr int kReaders = 4;
+    constexpr int kWrites = 2000;
+
+    int order_id = addOrder(user_id_);
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < kReaders; ++t) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                auto user = database_->findUserById(user_id_);
+                auto order = database_->findOrderById(order_id);
+                ASSERT_TRUE(user.has_value());
+                ASSERT_TRUE(order.has_value());
+                EXPECT_EQ(order->product_name, "P");
+            }
+        });
+    }
+    for (int i = 0; i < kWrites; ++i) {
+        OrderStatus status = i % 2 ? OrderStatus::CONFIRMED : OrderStatus::PENDING;
+        database_->updateOrder(Order{order_id, user_id_, "P", 1.0, status});
+        addOrder(user_id_);
+    }
+    done.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(database_->findOrdersByUserId(user_id_).size(), kWrites + 1);
+}
+
+TEST_F(InMemoryDatabaseUnitTest, FindAllOrders_DuringConcurrentWrites_ReturnsValidSnapshots) {
+    constexpr int kWrites = 3000;
+    std::atomic<bool> done{false};
+
+    std::thread scanner([&] {
+        std::size_t previous = 0;
+        while (!done.load()) {
+            auto orders = database_->findAllOrders();
+            EXPECT_GE(orders.size(), previous);
+            previous = orders.size();
+            for (const auto& order : orders) {
+                EXPECT_EQ(order.user_id, user_id_);
+            }
+        }
+    });
+    for (int i = 0; i < kWrites; ++i) {
+        int id = addOrder(user_id_);
+        database_->updateOrder(Order{id, user_id_, "P", 2.0, OrderStatus::CONFIRMED});
+    }
+    done.store(true);
+    scanner.join();
+
+    EXPECT_EQ(database_->findAllOrders().size(), kWrites);
+}
+
+TEST_F(InMemoryDatabaseUnitTest, ProductNames_AreInterned) {
+    for (int i = 0; i < 300; ++i) {
+        database_->saveOrder(Order{0, user_id_, "Product-" + std::to_string(i % 3), 1.0,
+                                   OrderStatus::PENDING});
+    }
+
+    EXPECT_EQ(database_->textMemory().product_names, 3);
+    auto orders = database_->findOrdersByUserId(user_id_);
+    ASSERT_EQ(orders.size(), 300);
+    EXPECT_EQ(orders[4].product_name, "Product-1");
+}
+
+TEST_F(InMemoryDatabaseUnitTest, UpdateUser_UnchangedText_DoesNotGrowArena) {
+    const std::size_t before = database_->textMemory().user_text_bytes;
+
+    EXPECT_TRUE(database_->updateUser(User{user_id_, "John", "john@test.com", false}));
+    EXPECT_EQ(database_->textMemory().user_text_bytes, before);
+
+    EXPECT_TRUE(database_->updateUser(User{user_id_, "Johnny", "john@test.com", false}));
+    auto user = database_->findUserById(user_id_);
+    ASSERT_TRUE(user.has_value());
+    EXPECT_EQ(user->name, "Johnny");
+    EXPECT_EQ(user->email, "john@test.com");
+    EXPECT_FALSE(user->is_active);
+}
+
+TEST_F(InMemoryDatabaseUnitTest, UpdateChurn_CompactsUserText) {
+    constexpr int kUpdates = 20000;
+    const std::string padding(100, 'x');
+    std::atomic<bool> done{false};
+    ASSERT_TRUE(database_->updateUser(User{user_id_, "John", "John@test.com", true}));
+
+    std::thread scanner([&] {
+        while (!done.load()) {
+            for (const auto& user : database_->findAllUsers()) {
+                EXPECT_EQ(user.email, user.name + "@test.com");
+            }
+        }
+    });
+    for (int i = 0; i < kUpdates; ++i) {
+        const std::string name = padding + std::to_string(i);
+        EXPECT_TRUE(database_->updateUser(User{user_id_, name, name + "@test.com", true}));
+    }
+    done.store(true);
+    scanner.join();
+
+    // Без сжатия арена хранила бы все kUpdates версий (~4 МБ)
+    EXPECT_LT(database_->textMemory().user_text_bytes, 512u * 1024);
+    auto user = database_->findUserById(user_id_);
+    ASSERT_TRUE(user.has_value());
+    EXPECT_EQ(user->name, padding + std::to_string(kUpdates - 1));
+}
+
+TEST_F(InMemoryDatabaseUnitTest, SaveDeleteChurn_CompactsUserText) {
+    const std::string name(200, 'y');
+    for (int i = 0; i < 5000; ++i) {
+        const int id = database_->saveUser(User{0, name, name + "@test.com", true});
+        ASSERT_GT(id, 0);
+        EXPECT_TRUE(database_->deleteUser(id));
+    }
+
+    EXPECT_LT(database_->textMemory().user_text_bytes, 512u * 1024);
+    auto user = database_->findUserById(user_id_);
+    ASSERT_TRUE(user.has_value());
+    EXPECT_EQ(user->name, "John");
+}
+
+TEST_F(InMemoryDatabaseUnitTest, ClearDuringScans_OldStringsStayReadable) {
+    constexpr int kRounds = 200;
+    std::atomic<bool> done{false};
+    database_->clear();
+
+    std::thread scanner([&] {
+        while (!done.load()) {
+            for (const auto& user : database_->findAllUsers()) {
+                EXPECT_EQ(user.email, user.name + "@test.com");
+            }
+        }
+    });
+    for (int round = 0; round < kRounds; ++round) {
+        for (int i = 0; i < 20; ++i) {
+            std::string name = "User-" + std::to_string(round) + "-" + std::to_string(i);
+            database_->saveUser(User{0, name, name + "@test.com", true});
+        }
+        database_->clear();
+    }
+    done.store(true);
+    scanner.join();
+
+    EXPECT_TRUE(database_->findAllUsers().empty());
+}
+
+TEST_F(InMemoryDatabaseUnitTest, ConcurrentWritesAndClear_KeepRecordsIntact) {
+    constexpr int kWriters = 4;
+    constexpr int kRounds = 2000;
+    std::atomic<bool> done{false};
+
+    // Строки копируются до блокировки; clear() между копированием
+    // и вставкой не должен оставить запись со строками прежнего хранилища
+    std::vector<std::thread> writers;
+    for (int w = 0; w < kWriters; ++w) {
+        writers.emplace_back([&, w] {
+            for (int i = 0; i < kRounds; ++i) {
+                std::string name = "Writer-" + std::to_string(w) + "-" + std::to_string(i);
+                int user_id = database_->saveUser(User{0, name, name + "@test.com", true});
+                int order_id = database_->saveOrder(
+                    Order{0, user_id, name, 1.0, OrderStatus::PENDING});
+                database_->updateUser(User{user_id, name, name + "@test.com", false});
+                if (auto user = database_->findUserById(user_id)) {
+                    EXPECT_EQ(user->email, user->name + "@test.com");
+                }
+                if (auto order = database_->findOrderById(order_id)) {
+                    EXPECT_EQ(order->product_name.rfind("Writer-", 0), 0u);
+                }
+                if (i % 2 == 0) {
+                    database_->deleteOrder(order_id);
+                }
+            }
+        });
+    }
+    std::thread clearer([&] {
+        while (!done.load()) {
+            database_->clear();
+            std::this_thread::yield();
+        }
+    });
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    done.store(true);
+    clearer.join();
+
+    for (const auto& user : database_->findAllUsers()) {
+        EXPECT_EQ(user.email, user.name + "@test.com");
+        for (const auto& order : database_->findOrdersByUserId(user.id)) {
+            EXPECT_EQ(order.user_id, user.id);
+        }
+    }
+}
+
+TEST_F(InMemoryDatabaseUnitTest, BulkLoad_BuildsTablesIndexAndIds) {
+    constexpr int kUsers = 3000;
+    constexpr int kOrders = 20000;
+    std::vector<User> users;
+    for (int i = 1; i <= kUsers; ++i) {
+        // ID с пропусками покрывают несколько частей загрузки
+        const std::string name = "User-" + std::to_string(i * 7);
+        users.push_back(User{i * 7, name, name + "@test.com", i % 2 == 0});
+    }
+    std::vector<Order> orders;
+    for (int i = kOrders; i >= 1; --i) {
+        orders.push_back(Order{i, (i % kUsers + 1) * 7, "P-" + std::to_string(i % 10), 1.5,
+                               OrderStatus::SHIPPED});
+    }
+
+    ASSERT_TRUE(database_->bulkLoad(users, orders, 4));
+
+    EXPECT_FALSE(database_->findUserById(user_id_).has_value());
+    EXPECT_EQ(database_->findAllUsers().size(), kUsers);
+    EXPECT_EQ(database_->findAllOrders().size(), kOrders);
+    auto user = database_->findUserById(14);
+    ASSERT_TRUE(user.has_value());
+    EXPECT_EQ(user->email, "User-14@test.com");
+    EXPECT_TRUE(user->is_active);
+    auto owned = database_->findOrdersByUserId(14);
+    ASSERT_EQ(owned.size(), kOrders / kUsers + 1);
+    for (std::size_t i = 1; i < owned.size(); ++i) {
+        EXPECT_LT(owned[i - 1].id, owned[i].id);
+    }
+    EXPECT_EQ(database_->textMemory().product_names, 10);
+    EXPECT_GT(database_->textMemory().user_text_bytes, 0);
+    EXPECT_GT(database_->saveUser(User{0, "New", "new@test.com", true}), kUsers * 7);
+    EXPECT_GT(addOrder(14), kOrders);
+}
+
+TEST_F(InMemoryDatabaseUnitTest, BulkLoad_InvalidOrDuplicateIds_KeepsContents) {
+    std::vector<User> users{User{1, "A", "a@test.com", true}, User{2, "B", "b@test.com", true}};
+    std::vector<Order> duplicate{Order{5, 1, "P", 1.0, OrderStatus::PENDING},
+                                 Order{5, 2, "P", 1.0, OrderStatus::PENDING}};
+    std::vector<Order> invalid{Order{0, 1, "P", 1.0, OrderStatus::PENDING}};
+
+    EXPECT_FALSE(database_->bulkLoad(users, duplicate, 2));
+    EXPECT_FALSE(database_->bulkLoad(users, invalid, 2));
+    users.push_back(User{2, "C", "c@test.com", true});
+    EXPECT_FALSE(database_->bulkLoad(users, {}, 2));
+
+    ASSERT_EQ(database_->findAllUsers().size(), 1);
+    EXPECT_EQ(database_->findUserById(user_id_)->name, "John");
+}
+
+TEST_F(InMemoryDatabaseUnitTest, BulkLoad_ReadersSeeOldOrNewContents) {
+    constexpr int kUsers = 5000;
+    constexpr int kRounds = 20;
+    std::vector<User> users;
+    for (int i = 1; i <= kUsers; ++i) {
+        users.push_back(User{i, "Bulk", "bulk@test.com", true});
+    }
+    std::atomic<bool> done{false};
+
+    std::thread reader([&] {
+        while (!done.load()) {
+            const auto seen = database_->findAllUsers();
+            EXPECT_TRUE(seen.size() == 1 || seen.size() == kUsers) << seen.size();
+            for (const auto& user : seen) {
+                EXPECT_TRUE(user.email == "bulk@test.com" || user.email == "john@test.com");
+            }
+        }
+    });
+    for (int round = 0; round < kRounds; ++round) {
+        EXPECT_TRUE(database_->bulkLoad(users, {}, 2));
+    }
+    done.store(true);
+    reader.join();
+}
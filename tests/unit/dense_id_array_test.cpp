@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "services/dense_id_array.hpp"
+#include <atomic>
+#include <climits>
+#include <thread>
+#include <vector>
+
+using namespace services;
+
+namespace {
+
+struct Cell {
+    std::atomic<int> value{0};
+};
+
+} // namespace
+
+class DenseIdArrayUnitTest : public ::testing::Test {
+protected:
+    DenseIdArray<Cell> array_;
+};
+
+TEST_F(DenseIdArrayUnitTest, Find_ReturnsNullUntilLeafAllocated) {
+    EXPECT_EQ(array_.find(1), nullptr);
+    EXPECT_EQ(array_.find(-1), nullptr);
+
+    array_.ensure(5).value.store(42);
+
+    ASSERT_NE(array_.find(5), nullptr);
+    EXPECT_EQ(array_.find(5)->value.load(), 42);
+    // Соседние слоты того же листа уже доступны и пусты
+    ASSERT_NE(array_.find(6), nullptr);
+    EXPECT_EQ(array_.find(6)->value.load(), 0);
+    EXPECT_EQ(array_.find(5000), nullptr);
+}
+
+TEST_F(DenseIdArrayUnitTest, Ensure_ReturnsStableSlot) {
+    Cell* first = &array_.ensure(10);
+    for (int id = 0; id < 100000; id += 7) {
+        array_.ensure(id);
+    }
+    EXPECT_EQ(&array_.ensure(10), first);
+    EXPECT_EQ(array_.find(10), first);
+}
+
+TEST_F(DenseIdArrayUnitTest, BoundaryIds) {
+    array_.ensure(0).value.store(1);
+    array_.ensure(INT_MAX).value.store(2);
+
+    EXPECT_EQ(array_.find(0)->value.load(), 1);
+    EXPECT_EQ(array_.find(INT_MAX)->value.load(), 2);
+    EXPECT_EQ(array_.find(INT_MIN), nullptr);
+}
+
+TEST_F(DenseIdArrayUnitTest, ForEach_VisitsAllocatedSlotsInIdOrder) {
+    array_.ensure(3000000).value.store(3);
+    array_.ensure(2000).value.store(2);
+    array_.ensure(1).value.store(1);
+
+    std::vector<int> ids;
+    std::vector<int> values;
+    int previous = -1;
+    bool ordered = true;
+    array_.forEach([&](int id, const Cell& cell) {
+        ordered = ordered && id > previous;
+        previous = id;
+        if (cell.value.load() != 0) {
+            ids.push_back(id);
+            values.push_back(cell.value.load());
+        }
+    });
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(ids, (std::vector<int>{1, 2000, 3000000}));
+    EXPECT_EQ(values, (std::vector<int>{1, 2, 3}));
+}
+
+TEST_F(DenseIdArrayUnitTest, ForEachWhile_StartsAtFirstIdAndStops) {
+    array_.ensure(3000000).value.store(3);
+    array_.ensure(2000).value.store(2);
+    array_.ensure(1).value.store(1);
+
+    std::vector<int> ids;
+    const bool finished = array_.forEachWhile(
+        [&](int id, const Cell& cell) {
+            if (cell.value.load() != 0) {
+                ids.push_back(id);
+            }
+            return true;
+        },
+        2000);
+    EXPECT_TRUE(finished);
+    EXPECT_EQ(ids, (std::vector<int>{2000, 3000000}));
+
+    int visited = -1;
+    EXPECT_FALSE(array_.forEachWhile(
+        [&](int id, const Cell&) {
+            visited = id;
+            return false;
+        },
+        2001));
+    EXPECT_EQ(visited, 2001);
+}
+
+TEST_F(DenseIdArrayUnitTest, MemoryBytes_GrowsPerLeaf) {
+    const std::size_t empty = array_.memoryBytes();
+    array_.ensure(1);
+    const std::size_t one_leaf = array_.memoryBytes();
+    array_.ensure(2);
+    EXPECT_EQ(array_.memoryBytes(), one_leaf);
+    array_.ensure(100000);
+    EXPECT_GT(one_leaf, empty);
+    EXPECT_GT(array_.memoryBytes(), one_leaf);
+}
+
+TEST_F(DenseIdArrayUnitTest, ConcurrentEnsure_AllThreadsShareSlots) {
+    constexpr int kThreads = 4;
+    constexpr int kIds = 50000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([this] {
+            for (int id = 0; id < kIds; ++id) {
+                array_.ensure(id).value.fetch_add(1);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int id = 0; id < kIds; ++id) {
+        ASSERT_EQ(array_.find(id)->value.load(), kThreads) << "id " << id;
+    }
+}
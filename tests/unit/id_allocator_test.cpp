@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "services/id_allocator.hpp"
+#include <algorithm>
+#include <climits>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace services;
+
+TEST(IdAllocatorUnitTest, SingleThread_IssuesSequentialIdsFromOne) {
+    IdAllocator allocator(4);
+
+    for (int expected = 1; expected <= 10; ++expected) {
+        EXPECT_EQ(allocator.allocate(), expected);
+    }
+}
+
+TEST(IdAllocatorUnitTest, BlockSizeOne_UsesSharedCounterOnly) {
+    IdAllocator allocator(1);
+
+    EXPECT_EQ(allocator.allocate(), 1);
+    EXPECT_EQ(allocator.allocate(), 2);
+    EXPECT_EQ(allocator.watermark(), 3);
+}
+
+TEST(IdAllocatorUnitTest, NonPositiveBlockSize_ClampedToOne) {
+    IdAllocator allocator(0);
+    EXPECT_EQ(allocator.blockSize(), 1);
+}
+
+TEST(IdAllocatorUnitTest, Reset_RestartsFromOneAndDropsLeases) {
+    IdAllocator allocator(16);
+    allocator.allocate();
+    allocator.allocate();
+
+    allocator.reset();
+
+    EXPECT_EQ(allocator.allocate(), 1);
+    EXPECT_EQ(allocator.allocate(), 2);
+}
+
+TEST(IdAllocatorUnitTest, AdvancePast_SkipsInsertedIds) {
+    IdAllocator allocator(8);
+
+    allocator.advancePast(100);
+    EXPECT_EQ(allocator.allocate(), 101);
+
+    // ID ниже водяного знака водяной знак не сдвигают
+    allocator.advancePast(50);
+    EXPECT_EQ(allocator.allocate(), 102);
+}
+
+TEST(IdAllocatorUnitTest, AdvancePastMaxId_ExhaustsIds) {
+    IdAllocator leased(64);
+    IdAllocator single(1);
+
+    leased.advancePast(INT_MAX);
+    single.advancePast(INT_MAX);
+
+    EXPECT_EQ(leased.allocate(), -1);
+    EXPECT_EQ(single.allocate(), -1);
+    EXPECT_EQ(single.allocate(), -1);
+    EXPECT_EQ(leased.watermark(), std::int64_t{INT_MAX} + 1 + 64);
+}
+
+TEST(IdAllocatorUnitTest, LastBlock_EndsAtMaxIdWithoutWrapping) {
+    IdAllocator allocator(64);
+    allocator.advancePast(INT_MAX - 3);
+
+    EXPECT_EQ(allocator.allocate(), INT_MAX - 2);
+    EXPECT_EQ(allocator.allocate(), INT_MAX - 1);
+    EXPECT_EQ(allocator.allocate(), INT_MAX);
+    EXPECT_EQ(allocator.allocate(), -1);
+    EXPECT_EQ(allocator.allocate(), -1);
+}
+
+TEST(IdAllocatorUnitTest, IndependentAllocators_DoNotShareLeases) {
+    IdAllocator first(8);
+    IdAllocator second(8);
+
+    EXPECT_EQ(first.allocate(), 1);
+    EXPECT_EQ(second.allocate(), 1);
+    EXPECT_EQ(first.allocate(), 2);
+    EXPECT_EQ(second.allocate(), 2);
+}
+
+TEST(IdAllocatorUnitTest, ManyAllocatorsPerThread_EvictedLeasesStayUnique) {
+    constexpr int kAllocators = 20;
+    std::vector<std::unique_ptr<IdAllocator>> allocators;
+    std::vector<std::set<int>> issued(kAllocators);
+    for (int i = 0; i < kAllocators; ++i) {
+        allocators.push_back(std::make_unique<IdAllocator>(4));
+    }
+
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < kAllocators; ++i) {
+            int id = allocators[i]->allocate();
+            EXPECT_GT(id, 0);
+            EXPECT_TRUE(issued[i].insert(id).second) << "duplicate ID " << id;
+        }
+    }
+}
+
+TEST(IdAllocatorUnitTest, ConcurrentThreads_IdsUniqueAndIncreasingPerThread) {
+    constexpr int kThreads = 8;
+    constexpr int kPerThread = 5000;
+    IdAllocator allocator;
+
+    std::vector<std::vector<int>> ids(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                ids[t].push_back(allocator.allocate());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::set<int> all;
+    for (const auto& per_thread : ids) {
+        EXPECT_TRUE(std::is_sorted(per_thread.begin(), per_thread.end()));
+        for (int id : per_thread) {
+            EXPECT_GT(id, 0);
+            all.insert(id);
+        }
+    }
+    EXPECT_EQ(all.size(), kThreads * kPerThread);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include "temp_directory_test.hpp"
+#include "services/database.hpp"
+#include "services/incremental_backup.hpp"
+#include <filesystem>
+
+using namespace services;
+using namespace contracts;
+
+class IncrementalBackupUnitTest : public TempDirectoryTest {
+protected:
+    static void fill(InMemoryDatabase& database, int users, int orders) {
+        for (int i = 0; i < users; ++i) {
+            database.saveUser(User{0, "User " + std::to_string(i), "user@test.com", true});
+        }
+        for (int i = 0; i < orders; ++i) {
+            database.saveOrder(Order{0, i % users + 1, "Product", 10.0, OrderStatus::PENDING});
+        }
+    }
+};
+
+TEST_F(IncrementalBackupUnitTest, SaveDelta_WritesOnlyChangedRecords) {
+    InMemoryDatabase database;
+    fill(database, 10, 100);
+    const std::string delta = directory_ + "/delta.log";
+    // Без контрольной точки отсчитывать не от чего
+    EXPECT_FALSE(database.saveDelta(delta));
+    ASSERT_TRUE(database.saveCheckpoint(directory_ + "/base.ckpt"));
+
+    auto order = *database.findOrderById(5);
+    order.status = OrderStatus::SHIPPED;
+    ASSERT_TRUE(database.updateOrder(order));
+    ASSERT_TRUE(database.updateOrder(order));
+    ASSERT_TRUE(database.deleteOrder(7));
+    ASSERT_TRUE(database.deleteUser(3));
+    ASSERT_TRUE(database.saveDelta(delta));
+
+    std::vector<LogRecord> records;
+    WriteAheadLog::replay(delta, [&records](const LogRecord& record) {
+        records.push_back(record);
+    });
+    ASSERT_EQ(records.size(), 3);
+    EXPECT_EQ(records[0].type, LogRecord::Type::DeleteUser);
+    EXPECT_EQ(records[0].id, 3);
+    EXPECT_EQ(records[1].type, LogRecord::Type::PutOrder);
+    EXPECT_EQ(records[1].order.id, 5);
+    EXPECT_EQ(records[1].order.status, OrderStatus::SHIPPED);
+    EXPECT_EQ(records[2].type, LogRecord::Type::DeleteOrder);
+    EXPECT_EQ(records[2].id, 7);
+
+    // Следующая дельта отсчитывается от этой
+    ASSERT_TRUE(database.saveDelta(delta));
+    EXPECT_EQ(WriteAheadLog::replay(delta, [](const LogRecord&) {}), 0);
+
+    database.clear();
+    EXPECT_FALSE(database.saveDelta(delta));
+}
+
+TEST_F(IncrementalBackupUnitTest, BackupMergeRestore_ReproducesDatabase) {
+    InMemoryDatabase database;
+    fill(database, 20, 500);
+    IncrementalBackup backup(directory_);
+    ASSERT_TRUE(backup.backup(database));
+    EXPECT_EQ(backup.stats().deltas, 0);
+
+    for (int round = 0; round < 3; ++round) {
+        for (int id = round + 1; id <= 500; id += 50) {
+            auto order = *database.findOrderById(id);
+            order.status = OrderStatus::CONFIRMED;
+            database.updateOrder(order);
+        }
+        database.deleteOrder(400 + round);
+        database.saveOrder(Order{0, 1, "New product", 5.0, OrderStatus::PENDING});
+        ASSERT_TRUE(backup.backup(database));
+    }
+    auto stats = backup.stats();
+    EXPECT_EQ(stats.deltas, 3);
+    // Дельты хранят по десятку записей, а не всю базу
+    EXPECT_LT(stats.delta_bytes, stats.base_bytes);
+
+    InMemoryDatabase restored;
+    ASSERT_TRUE(backup.restore(restored));
+    EXPECT_EQ(restored.findAllOrders(), database.findAllOrders());
+    EXPECT_EQ(restored.findAllUsers(), database.findAllUsers());
+
+    ASSERT_TRUE(backup.merge());
+    EXPECT_EQ(backup.stats().deltas, 0);
+    InMemoryDatabase merged;
+    ASSERT_TRUE(backup.restore(merged));
+    EXPECT_EQ(merged.findAllOrders(), database.findAllOrders());
+
+    // После свертки дельты продолжают отсчет от последней копии
+    database.deleteOrder(1);
+    ASSERT_TRUE(backup.backup(database));
+    EXPECT_EQ(backup.stats().deltas, 1);
+    ASSERT_TRUE(backup.restore(merged));
+    EXPECT_FALSE(merged.findOrderById(1).has_value());
+    EXPECT_EQ(merged.findAllOrders().size(), database.findAllOrders().size());
+}
+
+TEST_F(IncrementalBackupUnitTest, Backup_AfterClear_WritesNewBase) {
+    InMemoryDatabase database;
+    fill(database, 5, 50);
+    IncrementalBackup backup(directory_);
+    ASSERT_TRUE(backup.backup(database));
+    database.deleteOrder(1);
+    ASSERT_TRUE(backup.backup(database));
+    EXPECT_EQ(backup.stats().deltas, 1);
+
+    database.clear();
+    database.saveUser(User{0, "Only", "only@test.com", true});
+    ASSERT_TRUE(backup.backup(database));
+
+    EXPECT_EQ(backup.stats().deltas, 0);
+    InMemoryDatabase restored;
+    ASSERT_TRUE(backup.restore(restored));
+    EXPECT_EQ(restored.findAllUsers().size(), 1);
+    EXPECT_TRUE(restored.findAllOrders().empty());
+}
+
+TEST_F(IncrementalBackupUnitTest, RestoreAndMerge_DamagedDelta_FailWithoutChanges) {
+    InMemoryDatabase database;
+    fill(database, 5, 50);
+    IncrementalBackup backup(directory_);
+    ASSERT_TRUE(backup.backup(database));
+    database.deleteOrder(1);
+    database.deleteOrder(2);
+    ASSERT_TRUE(backup.backup(database));
+    ASSERT_EQ(backup.stats().deltas, 1);
+
+    // Оборвать последний кадр дельты
+    std::filesystem::path delta;
+    for (const auto& item : std::filesystem::directory_iterator(directory_)) {
+        if (item.path().extension() == ".log") {
+            delta = item.path();
+        }
+    }
+    ASSERT_FALSE(delta.empty());
+    const auto size = std::filesystem::file_size(delta) - 1;
+    std::filesystem::resize_file(delta, size);
+
+    InMemoryDatabase restored;
+    const int marker = restored.saveUser(User{0, "Marker", "marker@test.com", true});
+    EXPECT_FALSE(backup.restore(restored));
+    ASSERT_EQ(restored.findAllUsers().size(), 1);
+    EXPECT_EQ(restored.findAllUsers()[0].id, marker);
+    EXPECT_TRUE(restored.findAllOrders().empty());
+
+    EXPECT_FALSE(backup.merge());
+    EXPECT_EQ(backup.stats().deltas, 1);
+    EXPECT_EQ(std::filesystem::file_size(delta), size);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include "temp_directory_test.hpp"
+#include "services/lsm_database.hpp"
+#include <filesystem>
+#include <fstream>
+
+using namespace services;
+using namespace contracts;
+
+class LsmDatabaseUnitTest : public TempDirectoryTest {
+protected:
+    // Маленькая memtable: несколько десятков записей на прогон
+    static LsmDatabase::Options smallOptions() {
+        LsmDatabase::Options options;
+        options.memtable_bytes = 8192;
+        options.fanout = 3;
+        return options;
+    }
+};
+
+TEST_F(LsmDatabaseUnitTest, Reopen_RestoresRunsAndLoggedChanges) {
+    constexpr int kOrders = 500;
+    int user_id = 0;
+    int deleted = 0;
+    int updated = 0;
+    {
+        auto database = LsmDatabase::open(directory_, smallOptions());
+        ASSERT_NE(database, nullptr);
+        user_id = database->saveUser(User{0, "John", "john@test.com", true});
+        for (int i = 0; i < kOrders; ++i) {
+            ASSERT_GT(database->saveOrder(Order{0, user_id, "Product " + std::to_string(i),
+                                                1.0, OrderStatus::PENDING}),
+                      0);
+        }
+        ASSERT_TRUE(database->flush());
+        EXPECT_GT(database->stats().flushes, 0);
+        // Эти изменения остаются только в memtable и журнале
+        deleted = 1;
+        updated = 2;
+        EXPECT_TRUE(database->deleteOrder(deleted));
+        EXPECT_TRUE(database->updateOrder(
+            Order{updated, user_id, "Product 1", 5.0, OrderStatus::SHIPPED}));
+        EXPECT_TRUE(database->updateUser(User{user_id, "John", "john@test.com", false}));
+    }
+
+    auto reopened = LsmDatabase::open(directory_, smallOptions());
+
+    ASSERT_NE(reopened, nullptr);
+    EXPECT_FALSE(reopened->findUserById(user_id)->is_active);
+    EXPECT_FALSE(reopened->findOrderById(deleted).has_value());
+    EXPECT_EQ(reopened->findOrderById(updated)->status, OrderStatus::SHIPPED);
+    EXPECT_EQ(reopened->findOrderById(kOrders)->product_name,
+              "Product " + std::to_string(kOrders - 1));
+    auto orders = reopened->findOrdersByUserId(user_id);
+    ASSERT_EQ(orders.size(), kOrders - 1);
+    EXPECT_EQ(orders.front().id, updated);
+    EXPECT_EQ(reopened->findAllOrders().size(), kOrders - 1);
+    EXPECT_GT(reopened->saveOrder(Order{0, user_id, "P", 1.0, OrderStatus::PENDING}), kOrders);
+}
+
+TEST_F(LsmDatabaseUnitTest, Compaction_KeepsLatestVersionsAndDropsDeletes) {
+    constexpr int kOrders = 2000;
+    auto database = LsmDatabase::open(directory_, smallOptions());
+    ASSERT_NE(database, nullptr);
+    for (int i = 0; i < kOrders; ++i) {
+        database->saveOrder(Order{0, i % 10, "Product", 1.0, OrderStatus::PENDING});
+    }
+    // Перезапись половины заказов и удаление каждого десятого
+    for (int id = 1; id <= kOrders; id += 2) {
+        database->updateOrder(Order{id, (id - 1) % 10, "Product", 2.0, OrderStatus::DELIVERED});
+    }
+    for (int id = 10; id <= kOrders; id += 10) {
+        database->deleteOrder(id);
+    }
+    ASSERT_TRUE(database->flush());
+
+    auto stats = database->stats();
+    EXPECT_GT(stats.compactions, 0);
+    EXPECT_LT(stats.runs, stats.flushes);
+    EXPECT_GT(stats.writeAmplification(), 1.0);
+    auto orders = database->findAllOrders();
+    ASSERT_EQ(orders.size(), kOrders - kOrders / 10);
+    for (const auto& order : orders) {
+        EXPECT_NE(order.id % 10, 0);
+        EXPECT_EQ(order.status,
+                  order.id % 2 == 1 ? OrderStatus::DELIVERED : OrderStatus::PENDING);
+    }
+    EXPECT_EQ(database->findOrdersByUserId(3).size(), kOrders / 10);
+}
+
+TEST_F(LsmDatabaseUnitTest, PointLookup_BloomFilterSkipsRunsWithoutKey) {
+    auto database = LsmDatabase::open(directory_, smallOptions());
+    ASSERT_NE(database, nullptr);
+    int first = database->saveOrder(Order{0, 1, "Oldest", 1.0, OrderStatus::PENDING});
+    for (int i = 0; i < 300; ++i) {
+        database->saveOrder(Order{0, 1, "Product", 1.0, OrderStatus::PENDING});
+    }
+    ASSERT_TRUE(database->flush());
+    ASSERT_GT(database->stats().runs, 1);
+
+    const auto before = database->stats();
+    EXPECT_EQ(database->findOrderById(first)->product_name, "Oldest");
+    const auto after = database->stats();
+
+    // Ключ есть только в самом старом прогоне
+    EXPECT_EQ(after.run_probes - before.run_probes, 1);
+    EXPECT_GE(after.bloom_skips - before.bloom_skips, 1);
+}
+
+TEST_F(LsmDatabaseUnitTest, UpdateOrder_ChangedOwner_MovesBetweenUsers) {
+    auto database = LsmDatabase::open(directory_, smallOptions());
+    ASSERT_NE(database, nullptr);
+    int first = database->saveOrder(Order{0, 1, "P", 1.0, OrderStatus::PENDING});
+    int second = database->saveOrder(Order{0, 1, "P", 1.0, OrderStatus::PENDING});
+    ASSERT_TRUE(database->flush());
+
+    EXPECT_TRUE(database->updateOrder(Order{first, 2, "P", 1.0, OrderStatus::PENDING}));
+    EXPECT_FALSE(database->updateOrder(Order{999, 2, "P", 1.0, OrderStatus::PENDING}));
+
+    ASSERT_EQ(database->findOrdersByUserId(1).size(), 1);
+    EXPECT_EQ(database->findOrdersByUserId(1)[0].id, second);
+    ASSERT_EQ(database->findOrdersByUserId(2).size(), 1);
+    EXPECT_EQ(database->findOrdersByUserId(2)[0].id, first);
+}
+
+TEST_F(LsmDatabaseUnitTest, Clear_RemovesRunsAndSurvivesReopen) {
+    {
+        auto database = LsmDatabase::open(directory_, smallOptions());
+        ASSERT_NE(database, nullptr);
+        for (int i = 0; i < 300; ++i) {
+            database->saveOrder(Order{0, 1, "Product", 1.0, OrderStatus::PENDING});
+        }
+        ASSERT_TRUE(database->flush());
+
+        database->clear();
+
+        EXPECT_TRUE(database->findAllOrders().empty());
+        EXPECT_EQ(database->stats().runs, 0);
+        EXPECT_EQ(database->saveUser(User{0, "Jane", "jane@test.com", true}), 1);
+    }
+    // Мусор прерванного сброса удаляется при открытии
+    std::ofstream(directory_ + "/run-999.dat") << "partial";
+
+    auto reopened = LsmDatabase::open(directory_, smallOptions());
+
+    ASSERT_NE(reopened, nullptr);
+    EXPECT_TRUE(reopened->findAllOrders().empty());
+    ASSERT_EQ(reopened->findAllUsers().size(), 1);
+    EXPECT_EQ(reopened->findUserById(1)->name, "Jane");
+    EXPECT_FALSE(std::filesystem::exists(directory_ + "/run-999.dat"));
+    EXPECT_EQ(LsmDatabase::open(directory_ + "/missing"), nullptr);
+}
@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+#include "temp_directory_test.hpp"
+#include "services/mapped_database.hpp"
+#include <climits>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace services;
+using namespace contracts;
+
+class MappedDatabaseUnitTest : public TempDirectoryTest {
+protected:
+    // Изменить слот id в файле; возвращает прежнее содержимое слота
+    template <typename Slot, typename Change>
+    Slot changeSlot(const std::string& name, int id, Change change) {
+        Slot original{};
+        {
+            std::ifstream in(directory_ + "/" + name, std::ios::binary);
+            in.seekg(slotOffset<Slot>(id));
+            in.read(reinterpret_cast<char*>(&original), sizeof(Slot));
+            EXPECT_TRUE(in.good()) << name << " slot " << id;
+        }
+        Slot changed = original;
+        change(changed);
+        writeSlot(name, id, changed);
+        return original;
+    }
+
+    // Изменить слот id в файле, убедиться, что open() отвергает базу,
+    // и вернуть слот обратно
+    template <typename Slot, typename Change>
+    void expectRejected(const std::string& name, int id, Change change) {
+        const Slot original = changeSlot<Slot>(name, id, change);
+        EXPECT_EQ(MappedDatabase::open(directory_), nullptr) << name << " slot " << id;
+        writeSlot(name, id, original);
+        EXPECT_NE(MappedDatabase::open(directory_), nullptr);
+    }
+
+    template <typename Slot>
+    static std::streamoff slotOffset(int id) {
+        return static_cast<std::streamoff>(sizeof(mapped_format::Header) +
+                                           sizeof(Slot) * static_cast<std::size_t>(id));
+    }
+
+    template <typename Slot>
+    void writeSlot(const std::string& name, int id, const Slot& slot) {
+        std::fstream out(directory_ + "/" + name, std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(slotOffset<Slot>(id));
+        out.write(reinterpret_cast<const char*>(&slot), sizeof(Slot));
+    }
+};
+
+TEST_F(MappedDatabaseUnitTest, Reopen_RestoresRecordsIndexAndIds) {
+    int john = 0;
+    int jane = 0;
+    int first = 0;
+    int last = 0;
+    {
+        auto database = MappedDatabase::open(directory_);
+        ASSERT_NE(database, nullptr);
+        john = database->saveUser(User{0, "John", "john@test.com", true});
+        jane = database->saveUser(User{0, "Jane", "jane@test.com", true});
+        first = database->saveOrder(Order{0, john, "Laptop", 999.99, OrderStatus::PENDING});
+        int deleted = database->saveOrder(Order{0, john, "Mouse", 25.0, OrderStatus::PENDING});
+        last = database->saveOrder(Order{0, john, "Laptop", 10.0, OrderStatus::PENDING});
+        database->deleteOrder(deleted);
+        database->updateUser(User{jane, "Jane", "jane@test.com", false});
+        database->updateOrder(Order{last, john, "Laptop", 10.0, OrderStatus::SHIPPED});
+        EXPECT_TRUE(database->sync());
+    }
+
+    auto reopened = MappedDatabase::open(directory_);
+
+    ASSERT_NE(reopened, nullptr);
+    ASSERT_EQ(reopened->findAllUsers().size(), 2);
+    EXPECT_FALSE(reopened->findUserById(jane)->is_active);
+    auto orders = reopened->findOrdersByUserId(john);
+    ASSERT_EQ(orders.size(), 2);
+    EXPECT_EQ(orders[0].id, first);
+    EXPECT_EQ(orders[0].amount, Money(999.99));
+    EXPECT_EQ(orders[1].id, last);
+    EXPECT_EQ(orders[1].status, OrderStatus::SHIPPED);
+    EXPECT_GT(reopened->saveUser(User{0, "New", "new@test.com", true}), jane);
+    EXPECT_GT(reopened->saveOrder(Order{0, jane, "P", 1.0, OrderStatus::PENDING}), last);
+}
+
+TEST_F(MappedDatabaseUnitTest, GrowthBeyondInitialFiles_KeepsRecords) {
+    constexpr int kOrders = 5000;
+    auto database = MappedDatabase::open(directory_);
+    ASSERT_NE(database, nullptr);
+    int user_id = database->saveUser(User{0, "John", "john@test.com", true});
+    const std::string long_name(300, 'x');
+    for (int i = 0; i < kOrders; ++i) {
+        // Уникальные длинные названия заставляют расти кучу строк
+        ASSERT_GT(database->saveOrder(Order{0, user_id, long_name + std::to_string(i), 1.0,
+                                            OrderStatus::PENDING}),
+                  0);
+    }
+    int far_user = 0;
+    for (int i = 0; i < 5000; ++i) {
+        far_user = database->saveUser(User{0, "U", "u@test.com", true});
+    }
+    ASSERT_GT(database->saveOrder(Order{0, far_user, "Far user", 1.0, OrderStatus::PENDING}), 0);
+
+    auto orders = database->findOrdersByUserId(user_id);
+    ASSERT_EQ(orders.size(), kOrders);
+    EXPECT_EQ(orders.back().product_name, long_name + std::to_string(kOrders - 1));
+    EXPECT_EQ(database->findOrdersByUserId(far_user).size(), 1);
+}
+
+TEST_F(MappedDatabaseUnitTest, SaveOrder_UnissuedUserId_Rejected) {
+    auto database = MappedDatabase::open(directory_);
+    ASSERT_NE(database, nullptr);
+    const int user_id = database->saveUser(User{0, "John", "john@test.com", true});
+    const int order = database->saveOrder(Order{0, user_id, "P", 1.0, OrderStatus::PENDING});
+
+    EXPECT_EQ(database->saveOrder(Order{0, INT_MAX - 1, "P", 1.0, OrderStatus::PENDING}), -1);
+    EXPECT_EQ(database->saveOrder(Order{0, user_id + 1, "P", 1.0, OrderStatus::PENDING}), -1);
+    EXPECT_FALSE(database->updateOrder(Order{order, INT_MAX - 1, "P", 1.0, OrderStatus::PENDING}));
+    // Файл списков не вырос до слота INT_MAX - 1
+    EXPECT_LT(std::filesystem::file_size(directory_ + "/user_orders.dat"), 1u << 20);
+    EXPECT_EQ(database->findOrdersByUserId(user_id).size(), 1);
+}
+
+TEST_F(MappedDatabaseUnitTest, UpdateOrder_ChangedOwner_MovesBetweenLists) {
+    auto database = MappedDatabase::open(directory_);
+    ASSERT_NE(database, nullptr);
+    ASSERT_EQ(database->saveUser(User{0, "John", "john@test.com", true}), 1);
+    ASSERT_EQ(database->saveUser(User{0, "Jane", "jane@test.com", true}), 2);
+    int first = database->saveOrder(Order{0, 1, "P", 1.0, OrderStatus::PENDING});
+    int second = database->saveOrder(Order{0, 1, "P", 1.0, OrderStatus::PENDING});
+    int third = database->saveOrder(Order{0, 2, "P", 1.0, OrderStatus::PENDING});
+
+    EXPECT_TRUE(database->updateOrder(Order{first, 2, "P", 1.0, OrderStatus::PENDING}));
+
+    auto moved = database->findOrdersByUserId(2);
+    ASSERT_EQ(moved.size(), 2);
+    EXPECT_EQ(moved[0].id, first);
+    EXPECT_EQ(moved[1].id, third);
+    ASSERT_EQ(database->findOrdersByUserId(1).size(), 1);
+    EXPECT_EQ(database->findOrdersByUserId(1)[0].id, second);
+    EXPECT_EQ(database->saveOrder(Order{0, -1, "P", 1.0, OrderStatus::PENDING}), -1);
+}
+
+TEST_F(MappedDatabaseUnitTest, Open_RejectsForeignFiles) {
+    {
+        std::ofstream out(directory_ + "/orders.dat", std::ios::binary);
+        out << "not a mapped database file, but longer than its header";
+    }
+
+    EXPECT_EQ(MappedDatabase::open(directory_), nullptr);
+    EXPECT_EQ(MappedDatabase::open(directory_ + "/missing"), nullptr);
+}
+
+TEST_F(MappedDatabaseUnitTest, Open_RejectsSlotsPointingOutsideFiles) {
+    int john = 0;
+    int first = 0;
+    int second = 0;
+    {
+        auto database = MappedDatabase::open(directory_);
+        ASSERT_NE(database, nullptr);
+        john = database->saveUser(User{0, "John", "john@test.com", true});
+        first = database->saveOrder(Order{0, john, "Laptop", 1.0, OrderStatus::PENDING});
+        second = database->saveOrder(Order{0, john, "Mouse", 1.0, OrderStatus::PENDING});
+    }
+    ASSERT_NE(MappedDatabase::open(directory_), nullptr);
+
+    expectRejected<mapped_format::UserSlot>("users.dat", john,
+                                            [](auto& slot) { slot.email_size = 1u << 30; });
+    expectRejected<mapped_format::OrderSlot>("orders.dat", first,
+                                             [](auto& slot) { slot.product_offset = 1u << 30; });
+    expectRejected<mapped_format::OrderSlot>("orders.dat", second,
+                                             [](auto& slot) { slot.status = 200; });
+    expectRejected<mapped_format::OrderSlot>("orders.dat", first,
+                                             [](auto& slot) { slot.user_id = INT_MAX; });
+}
+
+TEST_F(MappedDatabaseUnitTest, Open_RebuildsInconsistentOrderLists) {
+    int john = 0;
+    int jane = 0;
+    int first = 0;
+    int second = 0;
+    int third = 0;
+    {
+        auto database = MappedDatabase::open(directory_);
+        ASSERT_NE(database, nullptr);
+        john = database->saveUser(User{0, "John", "john@test.com", true});
+        jane = database->saveUser(User{0, "Jane", "jane@test.com", true});
+        first = database->saveOrder(Order{0, john, "Laptop", 1.0, OrderStatus::PENDING});
+        second = database->saveOrder(Order{0, john, "Mouse", 1.0, OrderStatus::PENDING});
+        third = database->saveOrder(Order{0, jane, "Desk", 1.0, OrderStatus::PENDING});
+    }
+    const auto orderIds = [](const MappedDatabase& database, int user_id) {
+        std::vector<int> ids;
+        for (const auto& order : database.findOrdersByUserId(user_id)) {
+            ids.push_back(order.id);
+        }
+        return ids;
+    };
+    // Открытие перестраивает списки; повторное открытие видит их целыми
+    const auto expectRebuilt = [&](const char* what) {
+        for (int pass = 0; pass < 2; ++pass) {
+            auto database = MappedDatabase::open(directory_);
+            ASSERT_NE(database, nullptr) << what;
+            EXPECT_EQ(orderIds(*database, john), (std::vector<int>{first, second})) << what;
+            EXPECT_EQ(orderIds(*database, jane), std::vector<int>{third}) << what;
+            EXPECT_EQ(database->findAllOrders().size(), 3u) << what;
+        }
+    };
+
+    changeSlot<mapped_format::OrderSlot>("orders.dat", first,
+                                         [](auto& slot) { slot.next = 1000000; });
+    expectRebuilt("link past issued ids");
+    // Цикл: второй заказ снова ссылается на первый
+    changeSlot<mapped_format::OrderSlot>("orders.dat", second,
+                                         [first](auto& slot) { slot.next = first; });
+    expectRebuilt("cycle");
+    changeSlot<mapped_format::UserOrdersSlot>("user_orders.dat", john,
+                                              [](auto& slot) { slot.first = 1000000; });
+    expectRebuilt("head past issued ids");
+    // Падение между unlinkOrder и linkOrder: заказ выпал из всех списков
+    changeSlot<mapped_format::UserOrdersSlot>("user_orders.dat", jane, [](auto& slot) {
+        slot.first = 0;
+        slot.last = 0;
+    });
+    expectRebuilt("live order outside lists");
+    // Заказ Jane дописан в список John
+    changeSlot<mapped_format::OrderSlot>("orders.dat", second,
+                                         [third](auto& slot) { slot.next = third; });
+    changeSlot<mapped_format::OrderSlot>("orders.dat", third,
+                                         [second](auto& slot) { slot.prev = second; });
+    changeSlot<mapped_format::UserOrdersSlot>("user_orders.dat", john,
+                                              [third](auto& slot) { slot.last = third; });
+    changeSlot<mapped_format::UserOrdersSlot>("user_orders.dat", jane, [](auto& slot) {
+        slot.first = 0;
+        slot.last = 0;
+    });
+    expectRebuilt("order in another user's list");
+}
+
+TEST_F(MappedDatabaseUnitTest, Clear_EmptiesFilesAndRestartsIds) {
+    auto database = MappedDatabase::open(directory_);
+    ASSERT_NE(database, nullptr);
+    int user_id = database->saveUser(User{0, "John", "john@test.com", true});
+    database->saveOrder(Order{0, user_id, "Laptop", 1.0, OrderStatus::PENDING});
+
+    database->clear();
+
+    EXPECT_TRUE(database->findAllUsers().empty());
+    EXPECT_TRUE(database->findOrdersByUserId(user_id).empty());
+    EXPECT_EQ(database->saveUser(User{0, "Jane", "jane@test.com", true}), 1);
+    database.reset();
+    auto reopened = MappedDatabase::open(directory_);
+    ASSERT_NE(reopened, nullptr);
+    ASSERT_EQ(reopened->findAllUsers().size(), 1);
+    EXPECT_EQ(reopened->findUserById(1)->name, "Jane");
+}
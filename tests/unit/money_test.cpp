@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "contracts/money.hpp"
+#include "contracts/query.hpp"
+#include <limits>
+#include <sstream>
+
+using namespace contracts;
+
+TEST(MoneyUnitTest, FromDouble_RoundsToNearestMinorUnit) {
+    EXPECT_EQ(Money(150.5).minorUnits(), 15050);
+    EXPECT_EQ(Money(0.1 + 0.2).minorUnits(), 30);
+    EXPECT_EQ(Money(1.005).minorUnits(), 100);  // 1.005 в double чуть меньше
+    EXPECT_EQ(Money(-2.499).minorUnits(), -250);
+    EXPECT_DOUBLE_EQ(Money(75000.25).toDouble(), 75000.25);
+}
+
+TEST(MoneyUnitTest, FromDouble_RejectsNonFiniteAndOutOfRange) {
+    const double inf = std::numeric_limits<double>::infinity();
+    for (double amount : {std::numeric_limits<double>::quiet_NaN(), inf, -inf, 1e17, -1e17,
+                          std::numeric_limits<double>::max()}) {
+        EXPECT_FALSE(Money::fromDouble(amount).has_value()) << amount;
+        EXPECT_FALSE(Money(amount).isValid()) << amount;
+        EXPECT_LT(Money(amount), Money(-1e15));
+    }
+}
+
+TEST(MoneyUnitTest, FromDouble_AcceptsRangeLimits) {
+    ASSERT_TRUE(Money::fromDouble(9e16).has_value());
+    EXPECT_EQ(Money::fromDouble(9e16)->minorUnits(), 9000000000000000000);
+    EXPECT_EQ(Money::fromDouble(-9e16)->minorUnits(), -9000000000000000000);
+    EXPECT_EQ(Money::fromDouble(150.5), Money(150.5));
+    EXPECT_TRUE(Money(0.0).isValid());
+    EXPECT_TRUE(Money{}.isValid());
+}
+
+TEST(MoneyUnitTest, Sum_IsExact) {
+    Money total;
+    double naive = 0.0;
+    for (int i = 0; i < 1000000; ++i) {
+        total += 0.1;
+        naive += 0.1;
+    }
+
+    EXPECT_EQ(total, Money::fromMinorUnits(10000000));
+    EXPECT_NE(naive, 100000.0);  // А double накопил ошибку
+}
+
+TEST(MoneyUnitTest, ComparisonAndArithmetic) {
+    EXPECT_LT(Money(1.0), Money(1.01));
+    EXPECT_GT(Money(0.01), Money{});
+    EXPECT_EQ(Money(5.0) - Money(7.5), Money(-2.5));
+    EXPECT_EQ(Money(0.004), Money{});
+}
+
+TEST(MoneyUnitTest, Overflow_GivesInvalidInsteadOfWrapping) {
+    const Money top = Money::fromMinorUnits(std::numeric_limits<std::int64_t>::max());
+    const Money bottom = Money::fromMinorUnits(std::numeric_limits<std::int64_t>::min() + 1);
+
+    EXPECT_FALSE((top + Money::fromMinorUnits(1)).isValid());
+    EXPECT_FALSE((bottom - Money::fromMinorUnits(1)).isValid());
+    EXPECT_FALSE((Money::invalid() + Money(1.0)).isValid());
+    EXPECT_FALSE((Money(1.0) - Money::invalid()).isValid());
+    EXPECT_EQ(top - Money::fromMinorUnits(1) + Money::fromMinorUnits(1), top);
+}
+
+TEST(MoneyUnitTest, Aggregate_ReportsOverflow) {
+    const Money top = Money::fromMinorUnits(std::numeric_limits<std::int64_t>::max());
+    OrderAggregate aggregate;
+    aggregate.add(top);
+    EXPECT_FALSE(aggregate.overflow);
+
+    aggregate.add(Money(0.01));
+    aggregate.add(Money(-5.0));
+
+    EXPECT_TRUE(aggregate.overflow);
+    EXPECT_FALSE(aggregate.sum.isValid());
+    EXPECT_EQ(aggregate.count, 3u);
+    EXPECT_EQ(aggregate.max, top);
+
+    OrderAggregate merged;
+    merged.add(Money(1.0));
+    merged.merge(aggregate);
+    EXPECT_TRUE(merged.overflow);
+    EXPECT_FALSE(merged.sum.isValid());
+}
+
+TEST(MoneyUnitTest, Print) {
+    std::ostringstream out;
+    out << Money(12.5) << ' ' << Money(-0.07) << ' ' << Money(-3.2);
+    EXPECT_EQ(out.str(), "12.50 -0.07 -3.20");
+}
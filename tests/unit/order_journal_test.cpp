@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include "temp_directory_test.hpp"
+#include "services/database.hpp"
+#include "services/order_journal.hpp"
+#include "services/order_service.hpp"
+#include "services/user_service.hpp"
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+using namespace services;
+using namespace contracts;
+
+class OrderJournalUnitTest : public TempDirectoryTest {
+protected:
+    // Маленькие сегменты: свертки идут уже на сотнях событий
+    static OrderJournal::Options smallOptions() {
+        OrderJournal::Options options;
+        options.segment_bytes = 1024;
+        return options;
+    }
+};
+
+TEST_F(OrderJournalUnitTest, Load_FoldsEventsIntoLatestState) {
+    auto journal = OrderJournal::open(directory_);
+    ASSERT_NE(journal, nullptr);
+    EXPECT_TRUE(journal->recordOrder(Order{1, 7, "Laptop", 999.99, OrderStatus::PENDING}));
+    EXPECT_TRUE(journal->recordOrder(Order{2, 7, "Mouse", 25.0, OrderStatus::PENDING}));
+    EXPECT_TRUE(journal->recordOrder(Order{3, 8, "Desk", 300.0, OrderStatus::PENDING}));
+    EXPECT_TRUE(journal->recordStatus(1, OrderStatus::CONFIRMED));
+    EXPECT_TRUE(journal->recordStatus(1, OrderStatus::SHIPPED));
+    EXPECT_TRUE(journal->recordDeleted(2));
+    // Событие для неизвестного заказа не создает запись
+    EXPECT_TRUE(journal->recordStatus(42, OrderStatus::SHIPPED));
+
+    auto orders = journal->load();
+
+    ASSERT_EQ(orders.size(), 2);
+    EXPECT_EQ(orders[0].id, 1);
+    EXPECT_EQ(orders[0].product_name, "Laptop");
+    EXPECT_EQ(orders[0].amount, Money(999.99));
+    EXPECT_EQ(orders[0].status, OrderStatus::SHIPPED);
+    EXPECT_EQ(orders[1].id, 3);
+    EXPECT_EQ(orders[1].status, OrderStatus::PENDING);
+}
+
+TEST_F(OrderJournalUnitTest, Compact_ReplacesSegmentsWithBaseAndSurvivesReopen) {
+    constexpr int kOrders = 200;
+    const OrderStatus transitions[] = {OrderStatus::CONFIRMED, OrderStatus::SHIPPED,
+                                       OrderStatus::DELIVERED};
+    {
+        auto journal = OrderJournal::open(directory_, smallOptions());
+        ASSERT_NE(journal, nullptr);
+        for (int id = 1; id <= kOrders; ++id) {
+            journal->recordOrder(Order{id, id % 10, "Product", 10.0, OrderStatus::PENDING});
+        }
+        for (OrderStatus status : transitions) {
+            for (int id = 1; id <= kOrders; ++id) {
+                journal->recordStatus(id, status);
+            }
+        }
+        ASSERT_TRUE(journal->compact());
+
+        auto stats = journal->stats();
+        EXPECT_GT(stats.compactions, 0);
+        EXPECT_EQ(stats.segments, 1);
+        EXPECT_EQ(stats.events, kOrders * 4);
+        // После свертки на диске только база: по записи на заказ
+        EXPECT_LT(stats.disk_bytes, stats.appended_bytes);
+        EXPECT_GT(stats.writeAmplification(), 1.0);
+        journal->recordStatus(1, OrderStatus::CANCELLED);
+    }
+
+    auto reopened = OrderJournal::open(directory_, smallOptions());
+
+    ASSERT_NE(reopened, nullptr);
+    auto orders = reopened->load();
+    ASSERT_EQ(orders.size(), kOrders);
+    EXPECT_EQ(orders[0].status, OrderStatus::CANCELLED);
+    for (int i = 1; i < kOrders; ++i) {
+        EXPECT_EQ(orders[i].status, OrderStatus::DELIVERED);
+    }
+}
+
+TEST_F(OrderJournalUnitTest, ConcurrentAppends_DuringBackgroundCompaction_AreKept) {
+    constexpr int kThreads = 4;
+    constexpr int kOrdersPerThread = 300;
+    auto journal = OrderJournal::open(directory_, smallOptions());
+    ASSERT_NE(journal, nullptr);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < kOrdersPerThread; ++i) {
+                const int id = t * kOrdersPerThread + i + 1;
+                journal->recordOrder(Order{id, t, "Product", 1.0, OrderStatus::PENDING});
+                journal->recordStatus(id, OrderStatus::CONFIRMED);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto orders = journal->load();
+    ASSERT_EQ(orders.size(), kThreads * kOrdersPerThread);
+    for (const auto& order : orders) {
+        EXPECT_EQ(order.status, OrderStatus::CONFIRMED);
+    }
+    ASSERT_TRUE(journal->compact());
+    EXPECT_GT(journal->stats().compactions, 0);
+    EXPECT_EQ(journal->load().size(), kThreads * kOrdersPerThread);
+}
+
+TEST_F(OrderJournalUnitTest, OrderService_WithJournal_RecordsCreationAndTransitions) {
+    auto database = std::make_shared<InMemoryDatabase>();
+    auto users = std::make_shared<UserService>(database);
+    auto journal = OrderJournal::open(directory_);
+    ASSERT_NE(journal, nullptr);
+    OrderService orders(database, users, journal);
+    int user_id = users->createUser("John", "john@test.com");
+
+    int shipped = orders.createOrder(user_id, "Laptop", 999.99);
+    int cancelled = orders.createOrder(user_id, "Mouse", 25.0);
+    EXPECT_TRUE(orders.updateOrderStatus(shipped, OrderStatus::CONFIRMED));
+    EXPECT_TRUE(orders.updateOrderStatus(shipped, OrderStatus::SHIPPED));
+    EXPECT_TRUE(orders.cancelOrder(cancelled));
+
+    auto journaled = journal->load();
+    ASSERT_EQ(journaled.size(), 2);
+    EXPECT_EQ(journaled[0].id, shipped);
+    EXPECT_EQ(journaled[0].status, OrderStatus::SHIPPED);
+    EXPECT_EQ(journaled[1].status, OrderStatus::CANCELLED);
+    // Две полные записи и три коротких события
+    EXPECT_EQ(journal->stats().events, 5);
+}
+
+TEST_F(OrderJournalUnitTest, OrderService_ConcurrentTransitions_JournalMatchesDatabase) {
+    constexpr int kOrders = 200;
+    constexpr int kThreads = 4;
+    auto database = std::make_shared<InMemoryDatabase>();
+    auto users = std::make_shared<UserService>(database);
+    auto journal = OrderJournal::open(directory_, smallOptions());
+    ASSERT_NE(journal, nullptr);
+    OrderService orders(database, users, journal);
+    const int user_id = users->createUser("John", "john@test.com");
+
+    // Создание идет параллельно со сменами статуса уже видимых заказов:
+    // событие статуса может опередить запись о создании
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            const OrderStatus status = static_cast<OrderStatus>(1 + t % 3);
+            while (!done.load()) {
+                for (const auto& order : orders.getUserOrders(user_id)) {
+                    orders.updateOrderStatus(order.id, status);
+                }
+            }
+        });
+    }
+    for (int i = 0; i < kOrders; ++i) {
+        EXPECT_GT(orders.createOrder(user_id, "P", 1.0), 0);
+    }
+    done.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto expected = database->findAllOrders();
+    auto journaled = journal->load();
+    ASSERT_EQ(journaled.size(), expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(journaled[i].id, expected[i].id);
+        EXPECT_EQ(journaled[i].status, expected[i].status) << "order " << expected[i].id;
+    }
+    EXPECT_FALSE(orders.journalFailed());
+}
+
+TEST_F(OrderJournalUnitTest, OrderService_JournalFailure_KeepsCommittedOrders) {
+    auto database = std::make_shared<InMemoryDatabase>();
+    auto users = std::make_shared<UserService>(database);
+    auto journal = OrderJournal::open(directory_, smallOptions());
+    ASSERT_NE(journal, nullptr);
+    OrderService orders(database, users, journal);
+    const int user_id = users->createUser("John", "john@test.com");
+
+    // Без каталога журнал не откроет следующий сегмент и перейдет в сбой
+    std::filesystem::remove_all(directory_);
+    std::vector<int> ids;
+    for (int i = 0; i < 100; ++i) {
+        const int id = orders.createOrder(user_id, "Product", 1.0);
+        ASSERT_GT(id, 0) << "a saved order must not be reported as failed";
+        EXPECT_TRUE(orders.updateOrderStatus(id, OrderStatus::CONFIRMED));
+        ids.push_back(id);
+    }
+
+    EXPECT_TRUE(orders.journalFailed());
+    EXPECT_EQ(database->findOrdersByUserId(user_id).size(), ids.size());
+}
@@ -3,6 +3,8 @@
 #include "services/order_service.hpp"
 #include "services/user_service.hpp"
 #include "services/database.hpp"
+#include <cmath>
+#include <limits>
 
 using namespace services;
 using namespace contracts;
@@ -55,6 +57,23 @@ TEST_F(OrderServiceUnitTest, CreateOrder_NegativeAmount_ReturnsMinusOne) {
     EXPECT_EQ(id, -1);
 }
 
+TEST_F(OrderServiceUnitTest, CreateOrder_NonFiniteOrHugeAmount_ReturnsMinusOne) {
+    EXPECT_EQ(orderService_->createOrder(test_user_id_, "Product A",
+                                         std::numeric_limits<double>::quiet_NaN()), -1);
+    EXPECT_EQ(orderService_->createOrder(test_user_id_, "Product A",
+                                         std::numeric_limits<double>::infinity()), -1);
+    EXPECT_EQ(orderService_->createOrder(test_user_id_, "Product A", 1e300), -1);
+    EXPECT_TRUE(orderService_->getUserOrders(test_user_id_).empty());
+}
+
+TEST_F(OrderServiceUnitTest, CreateOrder_AboveMaxAmount_ReturnsMinusOne) {
+    const Money above = OrderService::kMaxAmount + Money::fromMinorUnits(1);
+
+    EXPECT_EQ(orderService_->createOrder(test_user_id_, "Product A", above), -1);
+    EXPECT_GT(orderService_->createOrder(test_user_id_, "Product A", OrderService::kMaxAmount),
+              0);
+}
+
 TEST_F(OrderServiceUnitTest, GetOrder_ExistingOrder_ReturnsOrder) {
     int id = orderService_->createOrder(test_user_id_, "Product A", 100.0);
     auto order = orderService_->getOrder(id);
@@ -113,3 +132,26 @@ TEST_F(OrderServiceUnitTest, GetTotalAmount_ExcludesCancelledOrders) {
     EXPECT_DOUBLE_EQ(total, 100.0);
 }
 
+
+TEST_F(OrderServiceUnitTest, GetTotal_ManySmallOrders_IsExact) {
+    for (int i = 0; i < 1000; ++i) {
+        orderService_->createOrder(test_user_id_, "Gum", 0.1);
+    }
+
+    EXPECT_EQ(orderService_->getTotal(test_user_id_), Money(100.0));
+    EXPECT_EQ(orderService_->getTotalAmount(test_user_id_), 100.0);
+}
+
+TEST_F(OrderServiceUnitTest, CreateOrder_AmountRoundsToZero_ReturnsMinusOne) {
+    EXPECT_EQ(orderService_->createOrder(test_user_id_, "Product A", 0.004), -1);
+}
+
+TEST_F(OrderServiceUnitTest, GetTotal_SumOverflowsInt64_ReturnsInvalid) {
+    // Хранилище суммы не проверяет: заказы в обход сервиса
+    const Money huge = Money::fromMinorUnits(std::numeric_limits<std::int64_t>::max() / 2 + 1);
+    ASSERT_TRUE(database_->insertOrder(Order{1, test_user_id_, "A", huge, OrderStatus::PENDING}));
+    ASSERT_TRUE(database_->insertOrder(Order{2, test_user_id_, "B", huge, OrderStatus::PENDING}));
+
+    EXPECT_FALSE(orderService_->getTotal(test_user_id_).isValid());
+    EXPECT_TRUE(std::isnan(orderService_->getTotalAmount(test_user_id_)));
+}
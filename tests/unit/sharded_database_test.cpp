@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "services/sharded_database.hpp"
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace services;
+using namespace contracts;
+
+class ShardedDatabaseUnitTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        database_ = std::make_unique<ShardedDatabase>(4);
+    }
+
+    std::unique_ptr<ShardedDatabase> database_;
+};
+
+TEST_F(ShardedDatabaseUnitTest, ZeroShardCount_FallsBackToSingleShard) {
+    ShardedDatabase db(0);
+    EXPECT_EQ(db.shardCount(), 1);
+
+    int id = db.saveUser(User{0, "John", "john@test.com", true});
+    EXPECT_TRUE(db.findUserById(id).has_value());
+}
+
+TEST_F(ShardedDatabaseUnitTest, ShardIndex_DistributesConsecutiveIds) {
+    EXPECT_EQ(database_->shardCount(), 4);
+
+    std::set<std::size_t> used;
+    for (int id = 1; id <= 4; ++id) {
+        used.insert(database_->shardIndex(id));
+    }
+    EXPECT_EQ(used.size(), 4);
+    EXPECT_EQ(database_->shardIndex(1), database_->shardIndex(5));
+}
+
+TEST_F(ShardedDatabaseUnitTest, FindOrdersByUserId_MergesShardsInIdOrder) {
+    int user_id = database_->saveUser(User{0, "John", "john@test.com", true});
+    for (int i = 0; i < 10; ++i) {
+        database_->saveOrder(Order{0, user_id, "P", 1.0, OrderStatus::PENDING});
+    }
+
+    auto orders = database_->findOrdersByUserId(user_id);
+
+    ASSERT_EQ(orders.size(), 10);
+    for (std::size_t i = 1; i < orders.size(); ++i) {
+        EXPECT_LT(orders[i - 1].id, orders[i].id);
+    }
+}
+
+TEST_F(ShardedDatabaseUnitTest, Clear_ResetsIdSequence) {
+    database_->saveUser(User{0, "John", "john@test.com", true});
+    database_->clear();
+
+    EXPECT_EQ(database_->saveUser(User{0, "Jane", "jane@test.com", true}), 1);
+}
+
+TEST_F(ShardedDatabaseUnitTest, ConcurrentWriters_AllRecordsVisibleWithUniqueIds) {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 500;
+
+    std::vector<std::vector<int>> order_ids(kThreads);
+    std::vector<int> user_ids(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            user_ids[t] = database_->saveUser(
+                User{0, "User" + std::to_string(t), "u@test.com", true});
+            for (int i = 0; i < kPerThread; ++i) {
+                int id = database_->saveOrder(
+                    Order{0, user_ids[t], "P", 1.0, OrderStatus::PENDING});
+                order_ids[t].push_back(id);
+                // Читатели работают параллельно с писателями
+                EXPECT_TRUE(database_->findOrderById(id).has_value());
+                EXPECT_TRUE(database_->findUserById(user_ids[t]).has_value());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::set<int> unique;
+    for (int t = 0; t < kThreads; ++t) {
+        unique.insert(order_ids[t].begin(), order_ids[t].end());
+        EXPECT_EQ(database_->findOrdersByUserId(user_ids[t]).size(), kPerThread);
+    }
+    EXPECT_EQ(unique.size(), kThreads * kPerThread);
+    EXPECT_EQ(database_->findAllOrders().size(), kThreads * kPerThread);
+    EXPECT_EQ(database_->findAllUsers().size(), kThreads);
+}
+
+TEST_F(ShardedDatabaseUnitTest, ConcurrentClear_NeverReusesIdsOfSurvivingRecords) {
+    constexpr int kThreads = 3;
+    constexpr int kPerThread = 2000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < kPerThread; ++i) {
+                // ID, выданный до сброса аллокаторов, не попадает в очищенный шард,
+                // поэтому вставка не наталкивается на занятый ID
+                EXPECT_GT(database_->saveOrder(Order{0, 1, "P", 1.0, OrderStatus::PENDING}),
+                          0);
+            }
+        });
+    }
+    for (int i = 0; i < 20; ++i) {
+        database_->clear();
+        std::this_thread::yield();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::set<int> unique;
+    for (const auto& order : database_->findAllOrders()) {
+        EXPECT_TRUE(unique.insert(order.id).second) << order.id;
+    }
+    const int next = database_->saveOrder(Order{0, 1, "P", 1.0, OrderStatus::PENDING});
+    EXPECT_EQ(unique.count(next), 0);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include "temp_directory_test.hpp"
+#include "services/sqlite_database.hpp"
+#include <filesystem>
+#include <limits>
+
+using namespace services;
+using namespace contracts;
+
+class SqliteDatabaseUnitTest : public TempDirectoryTest {
+protected:
+    void SetUp() override {
+        TempDirectoryTest::SetUp();
+        path_ = directory_ + "/db.sqlite";
+    }
+
+    std::string path_;
+};
+
+TEST_F(SqliteDatabaseUnitTest, Reopen_KeepsCommittedBatchesAndContinuesIds) {
+    SqliteDatabase::Options options;
+    options.batch_size = 16;
+    int user_id = 0;
+    int last_order = 0;
+    {
+        auto database = SqliteDatabase::open(path_, options);
+        ASSERT_NE(database, nullptr);
+        user_id = database->saveUser(User{0, "John", "john@test.com", true});
+        for (int i = 0; i < 40; ++i) {
+            last_order = database->saveOrder(
+                Order{0, user_id, "Product " + std::to_string(i), 1.5, OrderStatus::PENDING});
+        }
+        // Незафиксированный пакет виден в том же соединении
+        EXPECT_EQ(database->findOrdersByUserId(user_id).size(), 40);
+        EXPECT_TRUE(database->deleteOrder(last_order));
+        // Остаток пакета фиксируется при закрытии
+    }
+
+    auto reopened = SqliteDatabase::open(path_, options);
+
+    ASSERT_NE(reopened, nullptr);
+    EXPECT_EQ(reopened->findUserById(user_id)->name, "John");
+    auto orders = reopened->findAllOrders();
+    ASSERT_EQ(orders.size(), 39);
+    EXPECT_EQ(orders[0].amount, Money(1.5));
+    EXPECT_EQ(orders[38].product_name, "Product 38");
+    // ID продолжаются после наибольшего сохраненного
+    EXPECT_GT(reopened->saveOrder(Order{0, user_id, "Next", 1.0, OrderStatus::PENDING}),
+              orders.back().id);
+}
+
+TEST_F(SqliteDatabaseUnitTest, Synced_CommitsEveryChange) {
+    SqliteDatabase::Options options;
+    options.durability = Durability::Synced;
+    auto database = SqliteDatabase::open(path_, options);
+    ASSERT_NE(database, nullptr);
+    const int id = database->saveUser(User{0, "Ann", "ann@test.com", true});
+    ASSERT_GT(id, 0);
+
+    // Второе соединение видит только зафиксированные изменения
+    auto reader = SqliteDatabase::open(path_, options);
+    ASSERT_NE(reader, nullptr);
+    EXPECT_TRUE(reader->findUserById(id).has_value());
+    EXPECT_TRUE(database->flush());
+}
+
+TEST_F(SqliteDatabaseUnitTest, Open_FailsForUnreachablePath) {
+    EXPECT_EQ(SqliteDatabase::open(directory_ + "/missing/db.sqlite"), nullptr);
+}
+
+TEST_F(SqliteDatabaseUnitTest, AggregateOrders_SumOverflow_ReportsOverflow) {
+    auto database = SqliteDatabase::open(path_);
+    ASSERT_NE(database, nullptr);
+    const Money huge = Money::fromMinorUnits(std::numeric_limits<std::int64_t>::max() / 2 + 1);
+    ASSERT_GT(database->saveOrder(Order{0, 1, "A", huge, OrderStatus::PENDING}), 0);
+    ASSERT_GT(database->saveOrder(Order{0, 1, "B", huge, OrderStatus::PENDING}), 0);
+    ASSERT_GT(database->saveOrder(Order{0, 2, "C", Money(5.0), OrderStatus::PENDING}), 0);
+
+    OrderQuery query;
+    query.user_id = 1;
+    const auto aggregate = database->aggregateOrders(query);
+    EXPECT_TRUE(aggregate.overflow);
+    EXPECT_FALSE(aggregate.sum.isValid());
+
+    // Запрос после отказа SUM снова выполняется
+    query.user_id = 2;
+    EXPECT_FALSE(database->aggregateOrders(query).overflow);
+    EXPECT_EQ(database->aggregateOrders(query).sum, Money(5.0));
+}
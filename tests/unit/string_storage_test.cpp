@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "services/string_storage.hpp"
+#include <string>
+#include <vector>
+
+using namespace services;
+
+TEST(StringArenaUnitTest, Store_CopiesAndKeepsAddressesStable) {
+    StringArena arena;
+    std::vector<std::string_view> views;
+    for (int i = 0; i < 5000; ++i) {
+        std::string text = "user-" + std::to_string(i) + "@test.com";
+        views.push_back(arena.store(text));
+    }
+
+    for (int i = 0; i < 5000; ++i) {
+        ASSERT_EQ(views[i], "user-" + std::to_string(i) + "@test.com");
+    }
+    EXPECT_GE(arena.bytesReserved(), arena.bytesUsed());
+    // Строки идут подряд блоками, а не отдельным выделением на каждую
+    EXPECT_LT(arena.bytesReserved(), arena.bytesUsed() + 2 * StringArena::kBlockSize);
+}
+
+TEST(StringArenaUnitTest, EmptyAndLongStrings) {
+    StringArena arena;
+    EXPECT_TRUE(arena.store("").empty());
+    EXPECT_EQ(arena.bytesReserved(), 0);
+
+    std::string_view small = arena.store("small");
+    std::string long_text(StringArena::kBlockSize * 2, 'x');
+    std::string_view big = arena.store(long_text);
+    std::string_view after = arena.store("after");
+
+    EXPECT_EQ(big, long_text);
+    EXPECT_EQ(small, "small");
+    // Длинная строка не заставляет бросить начатый блок
+    EXPECT_EQ(after.data(), small.data() + small.size());
+}
+
+TEST(StringInternerUnitTest, Intern_EqualStringsShareStorage) {
+    StringInterner interner;
+    std::string first = "Laptop";
+    std::string second = "Laptop";
+
+    std::string_view a = interner.intern(first);
+    std::string_view b = interner.intern(second);
+    std::string_view c = interner.intern("Mouse");
+
+    EXPECT_EQ(a.data(), b.data());
+    EXPECT_NE(a.data(), first.data());
+    EXPECT_EQ(c, "Mouse");
+    EXPECT_EQ(interner.size(), 2);
+    EXPECT_GT(interner.memoryBytes(), 0);
+}
+
+TEST(StringInternerUnitTest, Find_ReturnsInternedViewOnly) {
+    StringInterner interner;
+    std::string_view stored = interner.intern("Laptop");
+
+    auto found = interner.find(std::string("Laptop"));
+
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ(found->data(), stored.data());
+    EXPECT_FALSE(interner.find("Mouse").has_value());
+    EXPECT_EQ(interner.size(), 1);
+}
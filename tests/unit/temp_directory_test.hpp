@@ -0,0 +1,27 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <string>
+
+/**
+ * @brief Базовая фикстура тестов, которым нужен свой каталог на диске
+ *
+ * Перед каждым тестом создает пустой каталог directory_
+ * (<temp>/<набор>_<тест>), после теста удаляет его вместе с содержимым.
+ */
+class TempDirectoryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const auto* test = ::testing::UnitTest::GetInstance()->current_test_info();
+        directory_ = (std::filesystem::temp_directory_path() /
+                      (std::string(test->test_suite_name()) + "_" + test->name()))
+                         .string();
+        std::filesystem::remove_all(directory_);
+        std::filesystem::create_directories(directory_);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(directory_); }
+
+    std::string directory_;
+};
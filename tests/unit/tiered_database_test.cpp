@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "temp_directory_test.hpp"
+#include "services/tiered_database.hpp"
+#include <filesystem>
+#include <fstream>
+
+using namespace services;
+using namespace contracts;
+
+class TieredDatabaseUnitTest : public TempDirectoryTest {
+protected:
+    std::size_t segmentFiles() const {
+        std::size_t count = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(directory_)) {
+            count += entry.path().extension() == ".seg" ? 1 : 0;
+        }
+        return count;
+    }
+};
+
+TEST_F(TieredDatabaseUnitTest, TerminalOrders_MoveBetweenTiersTransparently) {
+    auto database = TieredDatabase::open(directory_);
+    ASSERT_NE(database, nullptr);
+    const int user_id = database->saveUser(User{0, "John", "john@test.com", true});
+    const int active = database->saveOrder(Order{0, user_id, "Phone", 10.0,
+                                                 OrderStatus::PENDING});
+    const int delivered = database->saveOrder(Order{0, user_id, "Laptop", 20.0,
+                                                    OrderStatus::PENDING});
+    const int cancelled = database->saveOrder(Order{0, user_id, "Tablet", 30.0,
+                                                    OrderStatus::CANCELLED});
+    ASSERT_TRUE(database->updateOrder(Order{delivered, user_id, "Laptop", 20.0,
+                                            OrderStatus::DELIVERED}));
+
+    auto stats = database->stats();
+    EXPECT_EQ(stats.cold_orders, 2);
+    EXPECT_EQ(stats.migrations, 1);
+    auto order = database->findOrderById(delivered);
+    ASSERT_TRUE(order.has_value());
+    EXPECT_EQ(order->product_name, "Laptop");
+    EXPECT_EQ(order->amount, Money(20.0));
+    EXPECT_EQ(order->status, OrderStatus::DELIVERED);
+    auto orders = database->findOrdersByUserId(user_id);
+    ASSERT_EQ(orders.size(), 3);
+    EXPECT_EQ(orders[0].id, active);
+    EXPECT_EQ(orders[1].id, delivered);
+    EXPECT_EQ(orders[2].id, cancelled);
+    EXPECT_EQ(database->findAllOrders().size(), 3);
+
+    // Возврат в активный статус переносит заказ обратно в горячий ярус
+    ASSERT_TRUE(database->updateOrder(Order{cancelled, user_id, "Tablet", 30.0,
+                                            OrderStatus::CONFIRMED}));
+    EXPECT_EQ(database->stats().cold_orders, 1);
+    EXPECT_EQ(database->findOrderById(cancelled)->status, OrderStatus::CONFIRMED);
+
+    EXPECT_TRUE(database->deleteOrder(delivered));
+    EXPECT_FALSE(database->findOrderById(delivered).has_value());
+    EXPECT_FALSE(database->deleteOrder(delivered));
+    EXPECT_FALSE(database->updateOrder(Order{9999, user_id, "Missing", 1.0,
+                                             OrderStatus::DELIVERED}));
+    EXPECT_EQ(database->findOrdersByUserId(user_id).size(), 2);
+    EXPECT_EQ(database->stats().cold_orders, 0);
+}
+
+TEST_F(TieredDatabaseUnitTest, ColdRecords_ReadFromBufferAndSealedSegments) {
+    TieredDatabase::Options options;
+    options.segment_bytes = 1024;
+    options.write_buffer_bytes = 128;
+    auto database = TieredDatabase::open(directory_, options);
+    ASSERT_NE(database, nullptr);
+    std::vector<int> ids;
+    for (int i = 0; i < 200; ++i) {
+        ids.push_back(database->saveOrder(Order{0, 1 + i % 3, "Product " + std::to_string(i),
+                                                1.0 + i, OrderStatus::DELIVERED}));
+    }
+    // Замена холодной записи со сменой владельца
+    ASSERT_TRUE(database->updateOrder(Order{ids[0], 3, "Replaced", 5.0,
+                                            OrderStatus::CANCELLED}));
+
+    auto stats = database->stats();
+    EXPECT_EQ(stats.cold_orders, 200);
+    EXPECT_GT(stats.segments, 3);
+    EXPECT_EQ(segmentFiles(), stats.segments);
+    EXPECT_GT(stats.cold_dead_bytes, 0);
+    for (int i = 1; i < 200; ++i) {
+        auto order = database->findOrderById(ids[i]);
+        ASSERT_TRUE(order.has_value()) << i;
+        EXPECT_EQ(order->product_name, "Product " + std::to_string(i));
+    }
+    EXPECT_EQ(database->findOrderById(ids[0])->product_name, "Replaced");
+    const auto all = database->findAllOrders();
+    ASSERT_EQ(all.size(), 200);
+    EXPECT_TRUE(std::is_sorted(all.begin(), all.end(),
+                               [](const Order& a, const Order& b) { return a.id < b.id; }));
+    EXPECT_EQ(database->findOrdersByUserId(1).size(), 66);
+    EXPECT_EQ(database->findOrdersByUserId(3).size(), 67);
+
+    database->clear();
+    EXPECT_TRUE(database->findAllOrders().empty());
+    EXPECT_EQ(database->stats().cold_disk_bytes, 0);
+    EXPECT_EQ(segmentFiles(), 1);
+}
+
+TEST_F(TieredDatabaseUnitTest, Open_RemovesStaleSegmentsAndClosesWithoutFiles) {
+    std::ofstream(directory_ + "/cold-7.seg") << "stale";
+    {
+        auto database = TieredDatabase::open(directory_);
+        ASSERT_NE(database, nullptr);
+        EXPECT_EQ(segmentFiles(), 1);
+        EXPECT_GT(database->saveOrder(Order{0, 1, "Book", 1.0, OrderStatus::DELIVERED}), 0);
+    }
+    EXPECT_EQ(segmentFiles(), 0);
+    EXPECT_EQ(TieredDatabase::open(directory_ + "/missing"), nullptr);
+}
+
+TEST_F(TieredDatabaseUnitTest, DeadRecords_CompactSegmentsKeepingLiveOrders) {
+    TieredDatabase::Options options;
+    options.segment_bytes = 1024;
+    options.write_buffer_bytes = 128;
+    options.compact_min_dead_bytes = 512;
+    auto database = TieredDatabase::open(directory_, options);
+    ASSERT_NE(database, nullptr);
+    std::vector<int> ids;
+    for (int i = 0; i < 100; ++i) {
+        ids.push_back(database->saveOrder(Order{0, 1 + i % 2, "Product " + std::to_string(i),
+                                                1.0 + i, OrderStatus::DELIVERED}));
+    }
+    const auto before = database->stats();
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 50; ++i) {
+            ASSERT_TRUE(database->updateOrder(Order{ids[i], 2, "Round " + std::to_string(round),
+                                                    2.0, OrderStatus::CANCELLED}));
+        }
+    }
+    for (int i = 90; i < 100; ++i) {
+        ASSERT_TRUE(database->deleteOrder(ids[i]));
+    }
+
+    const auto after = database->stats();
+    EXPECT_GT(after.compactions, 0);
+    EXPECT_EQ(after.cold_orders, 90);
+    EXPECT_LE(after.cold_disk_bytes, before.cold_disk_bytes);
+    EXPECT_LE(after.cold_dead_bytes * 2, after.cold_disk_bytes - after.cold_dead_bytes);
+    EXPECT_EQ(segmentFiles(), after.segments);
+    for (int i = 0; i < 90; ++i) {
+        auto order = database->findOrderById(ids[i]);
+        ASSERT_TRUE(order.has_value()) << i;
+        EXPECT_EQ(order->product_name, i < 50 ? "Round 2" : "Product " + std::to_string(i));
+    }
+    EXPECT_FALSE(database->findOrderById(ids[95]).has_value());
+    EXPECT_EQ(database->findAllOrders().size(), 90);
+    EXPECT_EQ(database->findOrdersByUserId(1).size(), 20);
+    EXPECT_EQ(database->findOrdersByUserId(2).size(), 70);
+
+    // После сжатия база принимает новые холодные записи
+    const int id = database->saveOrder(Order{0, 1, "After", 3.0, OrderStatus::DELIVERED});
+    EXPECT_EQ(database->findOrderById(id)->product_name, "After");
+}
@@ -0,0 +1,279 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "services/versioned_table.hpp"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace services;
+
+namespace {
+
+struct Item {
+    int id = 0;
+    long value = 0;
+    long doubled = 0;  // Инвариант: doubled == 2 * value
+    std::string payload;
+};
+
+Item makeItem(int id, long value) {
+    return Item{id, value, value * 2, "payload-" + std::to_string(value)};
+}
+
+// Запись, по счетчику ссылок которой видно, живы ли ее версии
+struct Tracked {
+    std::shared_ptr<int> token;
+};
+
+std::map<int, long> collect(const VersionedTable<Item>::Snapshot& snapshot) {
+    std::map<int, long> result;
+    snapshot.forEach([&result](const Item& item) { result[item.id] = item.value; });
+    return result;
+}
+
+} // namespace
+
+class VersionedTableUnitTest : public ::testing::Test {
+protected:
+    VersionedTable<Item> table_;
+};
+
+TEST_F(VersionedTableUnitTest, PointOperations) {
+    EXPECT_TRUE(table_.insert(1, makeItem(1, 10)));
+    EXPECT_FALSE(table_.insert(1, makeItem(1, 20)));
+    ASSERT_NE(table_.find(1), nullptr);
+    EXPECT_EQ(table_.find(1)->value, 10);
+
+    EXPECT_TRUE(table_.update(1, makeItem(1, 30)));
+    EXPECT_EQ(table_.find(1)->value, 30);
+    EXPECT_FALSE(table_.update(2, makeItem(2, 0)));
+
+    EXPECT_TRUE(table_.erase(1));
+    EXPECT_EQ(table_.find(1), nullptr);
+    EXPECT_FALSE(table_.erase(1));
+    EXPECT_EQ(table_.size(), 0);
+
+    // ID можно использовать повторно после удаления
+    EXPECT_TRUE(table_.insert(1, makeItem(1, 40)));
+    EXPECT_EQ(table_.find(1)->value, 40);
+}
+
+TEST_F(VersionedTableUnitTest, Snapshot_IgnoresLaterWrites) {
+    for (int id = 1; id <= 600; ++id) {
+        table_.insert(id, makeItem(id, id));
+    }
+    auto snapshot = table_.snapshot();
+
+    table_.update(1, makeItem(1, -1));
+    table_.erase(2);
+    table_.insert(1000, makeItem(1000, 1000));
+    table_.erase(3);
+    table_.insert(3, makeItem(3, -3));
+
+    auto seen = collect(snapshot);
+    EXPECT_EQ(seen.size(), 600);
+    EXPECT_EQ(seen[1], 1);
+    EXPECT_EQ(seen[2], 2);
+    EXPECT_EQ(seen[3], 3);
+    EXPECT_EQ(seen.count(1000), 0);
+
+    auto current = collect(table_.snapshot());
+    EXPECT_EQ(current.size(), 600);
+    EXPECT_EQ(current[1], -1);
+    EXPECT_EQ(current.count(2), 0);
+    EXPECT_EQ(current[3], -3);
+    EXPECT_EQ(current[1000], 1000);
+}
+
+TEST_F(VersionedTableUnitTest, WithoutSnapshots_OldVersionsFreedImmediately) {
+    table_.insert(1, makeItem(1, 0));
+    for (int i = 1; i <= 100; ++i) {
+        table_.update(1, makeItem(1, i));
+    }
+    table_.insert(2, makeItem(2, 0));
+    table_.erase(2);
+
+    EXPECT_EQ(table_.pendingReclaim(), 0);
+}
+
+TEST_F(VersionedTableUnitTest, OpenSnapshot_DefersReclamationUntilClosed) {
+    table_.insert(1, makeItem(1, 0));
+    table_.insert(2, makeItem(2, 0));
+    {
+        auto snapshot = table_.snapshot();
+        for (int i = 1; i <= 10; ++i) {
+            table_.update(1, makeItem(1, i));
+        }
+        table_.erase(2);
+
+        EXPECT_GT(table_.pendingReclaim(), 0);
+        auto seen = collect(snapshot);
+        EXPECT_EQ(seen[1], 0);
+        EXPECT_EQ(seen[2], 0);
+    }
+
+    // Освобождение происходит при следующей записи
+    table_.update(1, makeItem(1, 11));
+    EXPECT_EQ(table_.pendingReclaim(), 0);
+    EXPECT_EQ(collect(table_.snapshot()).size(), 1);
+}
+
+TEST_F(VersionedTableUnitTest, ReinsertOverTombstone_ReusesSlotAndReclaims) {
+    table_.insert(1, makeItem(1, 1));
+    {
+        auto snapshot = table_.snapshot();
+        table_.erase(1);
+        table_.insert(1, makeItem(1, 2));
+        table_.erase(1);
+        table_.insert(1, makeItem(1, 3));
+
+        EXPECT_EQ(collect(snapshot)[1], 1);
+        EXPECT_EQ(table_.find(1)->value, 3);
+        EXPECT_EQ(table_.size(), 1);
+    }
+
+    table_.update(1, makeItem(1, 4));
+    EXPECT_EQ(table_.pendingReclaim(), 0);
+    auto seen = collect(table_.snapshot());
+    ASSERT_EQ(seen.size(), 1);
+    EXPECT_EQ(seen[1], 4);
+}
+
+TEST_F(VersionedTableUnitTest, Clear_OpenSnapshotKeepsOldState) {
+    table_.insert(1, makeItem(1, 1));
+    auto snapshot = table_.snapshot();
+
+    table_.clear();
+    table_.insert(2, makeItem(2, 2));
+
+    auto seen = collect(snapshot);
+    ASSERT_EQ(seen.size(), 1);
+    EXPECT_EQ(seen.begin()->first, 1);
+    EXPECT_EQ(table_.find(1), nullptr);
+    EXPECT_EQ(collect(table_.snapshot()).size(), 1);
+}
+
+TEST(VersionedTablePreparedTest, Insert_TakesNodeOnlyOnSuccess) {
+    VersionedTable<Item> table;
+    table.reserve(7);
+    auto first = VersionedTable<Item>::prepare(makeItem(7, 1));
+    auto second = VersionedTable<Item>::prepare(makeItem(7, 2));
+
+    EXPECT_TRUE(table.insert(7, first));
+    EXPECT_FALSE(table.insert(7, second));
+
+    EXPECT_TRUE(first.empty());
+    ASSERT_FALSE(second.empty());
+    EXPECT_EQ(second.record().value, 2);
+    EXPECT_EQ(table.find(7)->value, 1);
+}
+
+TEST(VersionedTablePreparedTest, ReplacedVersions_FreedWithGarbage) {
+    VersionedTable<Tracked> table;
+    auto token = std::make_shared<int>(0);
+    auto original = VersionedTable<Tracked>::prepare(Tracked{token});
+    table.insert(1, original);
+    auto replacement = VersionedTable<Tracked>::prepare(Tracked{});
+    table.update(1, replacement);
+    {
+        auto garbage = table.takeGarbage();
+        // Прежняя версия уже не в таблице, но удаляется только с garbage
+        EXPECT_EQ(table.pendingReclaim(), 0);
+        EXPECT_EQ(token.use_count(), 2);
+    }
+    EXPECT_EQ(token.use_count(), 1);
+}
+
+TEST(VersionedTablePreparedTest, Clear_ReturnsOldStateToFree) {
+    VersionedTable<Tracked> table;
+    auto token = std::make_shared<int>(0);
+    table.insert(1, Tracked{token});
+    {
+        auto garbage = table.clear();
+        EXPECT_EQ(table.find(1), nullptr);
+        EXPECT_EQ(token.use_count(), 2);
+    }
+    EXPECT_EQ(token.use_count(), 1);
+}
+
+TEST(VersionedTableBulkTest, Install_ReplacesContentsFromParallelBuilders) {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 5000;
+    VersionedTable<Item> table;
+    table.insert(1, makeItem(1, 1));
+    auto snapshot = table.snapshot();
+    VersionedTable<Item>::Bulk bulk;
+
+    std::vector<std::thread> builders;
+    for (int t = 0; t < kThreads; ++t) {
+        builders.emplace_back([&bulk, t] {
+            // ID потоков чередуются и попадают в общие листья
+            for (int i = 0; i < kPerThread; ++i) {
+                const int id = 1 + i * kThreads + t;
+                EXPECT_TRUE(bulk.add(id, makeItem(id, id)));
+            }
+        });
+    }
+    for (auto& builder : builders) {
+        builder.join();
+    }
+    EXPECT_FALSE(bulk.add(5, makeItem(5, 0)));
+    EXPECT_FALSE(bulk.add(-1, makeItem(-1, 0)));
+    table.install(std::move(bulk), kThreads * kPerThread);
+
+    EXPECT_EQ(table.size(), kThreads * kPerThread);
+    EXPECT_EQ(table.find(5)->value, 5);
+    EXPECT_EQ(collect(table.snapshot()).size(), kThreads * kPerThread);
+    EXPECT_EQ(collect(snapshot).size(), 1);
+    // Загруженная запись меняется как обычная
+    EXPECT_TRUE(table.update(5, makeItem(5, 50)));
+    EXPECT_EQ(table.find(5)->value, 50);
+}
+
+TEST_F(VersionedTableUnitTest, ConcurrentScansDuringWrites_SeeIntactRecords) {
+    // Писатель один (как под эксклюзивной блокировкой владельца),
+    // читатели обходят снимки без блокировки
+    constexpr int kReaders = 3;
+    constexpr int kRecords = 2000;
+    std::atomic<bool> done{false};
+    std::atomic<long> scans{0};
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < kReaders; ++t) {
+        readers.emplace_back([&] {
+            std::size_t previous = 0;
+            while (!done.load()) {
+                std::size_t count = 0;
+                table_.scan([&count](const Item& item) {
+                    ++count;
+                    EXPECT_EQ(item.doubled, item.value * 2);
+                    EXPECT_EQ(item.payload, "payload-" + std::to_string(item.value));
+                });
+                // Записи только добавляются и обновляются
+                EXPECT_GE(count, previous);
+                previous = count;
+                scans.fetch_add(1);
+            }
+        });
+    }
+
+    for (int id = 1; id <= kRecords; ++id) {
+        table_.insert(id, makeItem(id, id));
+        table_.update(id / 2 + 1, makeItem(id / 2 + 1, id));
+    }
+    while (scans.load() < kReaders) {
+        std::this_thread::yield();
+    }
+    done.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_GT(scans.load(), 0);
+    EXPECT_EQ(table_.size(), kRecords);
+    table_.update(1, makeItem(1, 0));
+    EXPECT_EQ(table_.pendingReclaim(), 0);
+}
@@ -0,0 +1,268 @@
+#include <gtest/gtest.h>
+#include "temp_directory_test.hpp"
+#include "services/database.hpp"
+#include "services/write_ahead_log.hpp"
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+using namespace services;
+using namespace contracts;
+
+class WriteAheadLogUnitTest : public TempDirectoryTest {
+protected:
+    void SetUp() override {
+        TempDirectoryTest::SetUp();
+        path_ = directory_ + "/wal.log";
+    }
+
+    std::vector<LogRecord> readAll() {
+        std::vector<LogRecord> records;
+        WriteAheadLog::replay(path_, [&](const LogRecord& record) { records.push_back(record); });
+        return records;
+    }
+
+    std::string path_;
+};
+
+TEST_F(WriteAheadLogUnitTest, AppendCommitReplay_RoundTrip) {
+    {
+        auto log = WriteAheadLog::open(path_);
+        ASSERT_NE(log, nullptr);
+        log->append(WriteAheadLog::encode(LogRecord::putUser(User{7, "John", "john@test.com", true})));
+        log->append(WriteAheadLog::encode(
+            LogRecord::putOrder(Order{3, 7, "Laptop", Money(999.99), OrderStatus::SHIPPED})));
+        log->append(WriteAheadLog::encode(LogRecord::deleteOrder(3)));
+        log->append(WriteAheadLog::encode(LogRecord::clear()));
+        std::uint64_t lsn = log->append(
+            WriteAheadLog::encode(LogRecord::setOrderStatus(5, OrderStatus::DELIVERED)));
+        EXPECT_TRUE(log->commit(lsn));
+    }
+
+    auto records = readAll();
+
+    ASSERT_EQ(records.size(), 5);
+    EXPECT_EQ(records[0].type, LogRecord::Type::PutUser);
+    EXPECT_EQ(records[0].user.name, "John");
+    EXPECT_EQ(records[0].user.email, "john@test.com");
+    EXPECT_TRUE(records[0].user.is_active);
+    EXPECT_EQ(records[1].order.id, 3);
+    EXPECT_EQ(records[1].order.amount, Money(999.99));
+    EXPECT_EQ(records[1].order.status, OrderStatus::SHIPPED);
+    EXPECT_EQ(records[2].type, LogRecord::Type::DeleteOrder);
+    EXPECT_EQ(records[2].id, 3);
+    EXPECT_EQ(records[3].type, LogRecord::Type::Clear);
+    EXPECT_EQ(records[4].type, LogRecord::Type::SetOrderStatus);
+    EXPECT_EQ(records[4].id, 5);
+    EXPECT_EQ(records[4].order.status, OrderStatus::DELIVERED);
+}
+
+TEST_F(WriteAheadLogUnitTest, Commit_WritesAllPendingRecordsAsOneGroup) {
+    auto log = WriteAheadLog::open(path_, {Durability::Synced});
+    std::uint64_t lsn = 0;
+    for (int i = 1; i <= 10; ++i) {
+        lsn = log->append(WriteAheadLog::encode(LogRecord::deleteUser(i)));
+    }
+
+    EXPECT_TRUE(log->commit(lsn));
+    // Более ранние записи уже сохранены той же группой
+    EXPECT_TRUE(log->commit(1));
+
+    auto stats = log->stats();
+    EXPECT_EQ(stats.records, 10);
+    EXPECT_EQ(stats.writes, 1);
+    EXPECT_EQ(stats.syncs, 1);
+}
+
+TEST_F(WriteAheadLogUnitTest, Buffered_WritesOnlyWhenBufferFills) {
+    auto log = WriteAheadLog::open(path_, {Durability::Buffered, 64});
+    std::uint64_t lsn = log->append(WriteAheadLog::encode(LogRecord::deleteUser(1)));
+    EXPECT_TRUE(log->commit(lsn));
+    EXPECT_EQ(log->stats().writes, 0);
+
+    while (log->stats().writes == 0) {
+        lsn = log->append(WriteAheadLog::encode(
+            LogRecord::putUser(User{2, "Long enough name", "name@test.com", true})));
+        log->commit(lsn);
+    }
+    EXPECT_EQ(log->stats().syncs, 0);
+    EXPECT_TRUE(log->flush());
+    EXPECT_EQ(readAll().size(), log->stats().records);
+}
+
+TEST_F(WriteAheadLogUnitTest, Replay_TornTail_IsDroppedAndTruncated) {
+    {
+        auto log = WriteAheadLog::open(path_);
+        log->append(WriteAheadLog::encode(LogRecord::deleteUser(1)));
+        log->flush();
+    }
+    const auto intact_size = std::filesystem::file_size(path_);
+    {
+        // Кадр, оборванный посреди записи
+        std::string frame = WriteAheadLog::encode(LogRecord::deleteUser(2));
+        std::ofstream out(path_, std::ios::binary | std::ios::app);
+        out.write(frame.data(), static_cast<std::streamsize>(frame.size() - 2));
+    }
+
+    EXPECT_EQ(readAll().size(), 1);
+    EXPECT_EQ(std::filesystem::file_size(path_), intact_size);
+
+    // Дозапись продолжается с границы кадра
+    {
+        auto log = WriteAheadLog::open(path_);
+        log->commit(log->append(WriteAheadLog::encode(LogRecord::deleteUser(3))));
+    }
+    auto records = readAll();
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records[1].id, 3);
+}
+
+TEST_F(WriteAheadLogUnitTest, Replay_CorruptedFrame_StopsBeforeIt) {
+    {
+        auto log = WriteAheadLog::open(path_);
+        log->append(WriteAheadLog::encode(LogRecord::deleteUser(1)));
+        log->append(WriteAheadLog::encode(LogRecord::deleteUser(2)));
+        log->flush();
+    }
+    {
+        std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-1, std::ios::end);
+        file.put('\x7f');
+    }
+
+    auto records = readAll();
+    ASSERT_EQ(records.size(), 1);
+    EXPECT_EQ(records[0].id, 1);
+}
+
+TEST_F(WriteAheadLogUnitTest, ReadAll_DamagedFrame_FailsWithoutTruncating) {
+    {
+        auto log = WriteAheadLog::open(path_);
+        log->append(WriteAheadLog::encode(LogRecord::deleteUser(1)));
+        log->append(WriteAheadLog::encode(LogRecord::deleteUser(2)));
+        log->flush();
+    }
+    auto intact = WriteAheadLog::readAll(path_);
+    ASSERT_TRUE(intact.has_value());
+    ASSERT_EQ(intact->size(), 2);
+    EXPECT_EQ((*intact)[1].id, 2);
+
+    const auto size = std::filesystem::file_size(path_);
+    std::filesystem::resize_file(path_, size - 1);
+    EXPECT_FALSE(WriteAheadLog::readAll(path_).has_value());
+    EXPECT_EQ(std::filesystem::file_size(path_), size - 1);
+    EXPECT_FALSE(WriteAheadLog::readAll(path_ + "_missing").has_value());
+}
+
+TEST_F(WriteAheadLogUnitTest, Open_MissingDirectory_ReturnsNull) {
+    EXPECT_EQ(WriteAheadLog::open(path_ + "_missing_dir/log"), nullptr);
+}
+
+TEST_F(WriteAheadLogUnitTest, InMemoryDatabase_RecoversFromLog) {
+    int john = 0;
+    int kept_order = 0;
+    {
+        InMemoryDatabase database;
+        database.attachLog(WriteAheadLog::open(path_, {Durability::Written}));
+        database.saveUser(User{0, "Temp", "temp@test.com", true});
+        database.clear();
+        john = database.saveUser(User{0, "John", "john@test.com", true});
+        int jane = database.saveUser(User{0, "Jane", "jane@test.com", true});
+        kept_order = database.saveOrder(Order{0, john, "Laptop", 999.99, OrderStatus::PENDING});
+        int dropped_order = database.saveOrder(Order{0, jane, "Mouse", 25.0, OrderStatus::PENDING});
+        EXPECT_TRUE(database.updateOrder(
+            Order{kept_order, john, "Laptop", 899.99, OrderStatus::SHIPPED}));
+        EXPECT_TRUE(database.updateUser(User{john, "John", "john@test.com", false}));
+        EXPECT_TRUE(database.deleteOrder(dropped_order));
+        EXPECT_TRUE(database.deleteUser(jane));
+    }
+
+    InMemoryDatabase recovered;
+    WriteAheadLog::replay(path_, [&](const LogRecord& record) {
+        recovered.applyLogRecord(record);
+    });
+
+    auto users = recovered.findAllUsers();
+    ASSERT_EQ(users.size(), 1);
+    EXPECT_EQ(users[0].id, john);
+    EXPECT_FALSE(users[0].is_active);
+    auto orders = recovered.findOrdersByUserId(john);
+    ASSERT_EQ(orders.size(), 1);
+    EXPECT_EQ(orders[0].id, kept_order);
+    EXPECT_EQ(orders[0].amount, Money(899.99));
+    EXPECT_EQ(orders[0].status, OrderStatus::SHIPPED);
+    EXPECT_EQ(recovered.findAllOrders().size(), 1);
+    // Новые ID не пересекаются с восстановленными
+    EXPECT_GT(recovered.saveUser(User{0, "Next", "next@test.com", true}), john);
+}
+
+TEST_F(WriteAheadLogUnitTest, ConcurrentWriters_AllChangesDurable) {
+    constexpr int kThreads = 4;
+    constexpr int kOrdersPerThread = 100;
+    auto log = WriteAheadLog::open(path_, {Durability::Synced});
+    {
+        InMemoryDatabase database;
+        database.attachLog(log);
+        const int user_id = database.saveUser(User{0, "John", "john@test.com", true});
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < kOrdersPerThread; ++i) {
+                    EXPECT_GT(database.saveOrder(Order{0, user_id, "P", 1.0, OrderStatus::PENDING}),
+                              0);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    auto stats = log->stats();
+    EXPECT_EQ(stats.records, 1 + kThreads * kOrdersPerThread);
+    EXPECT_LE(stats.syncs, stats.records);
+
+    InMemoryDatabase recovered;
+    WriteAheadLog::replay(path_, [&](const LogRecord& record) {
+        recovered.applyLogRecord(record);
+    });
+    EXPECT_EQ(recovered.findAllOrders().size(), kThreads * kOrdersPerThread);
+}
+
+TEST_F(WriteAheadLogUnitTest, InMemoryDatabase_FailedCommit_StopsAcceptingWrites) {
+    // Запись в /dev/full всегда завершается ENOSPC
+    auto log = WriteAheadLog::open("/dev/full", {Durability::Written});
+    if (log == nullptr) {
+        GTEST_SKIP() << "/dev/full is not available";
+    }
+    InMemoryDatabase database;
+    const int john = database.saveUser(User{0, "John", "john@test.com", true});
+    const int order = database.saveOrder(Order{0, john, "Laptop", 10.0, OrderStatus::PENDING});
+    database.attachLog(log);
+
+    // Сбой при записи группы: изменение уже видно, состояние опережает журнал
+    EXPECT_FALSE(database.updateUser(User{john, "John", "john@test.com", false}));
+    EXPECT_TRUE(database.logFailed());
+    ASSERT_TRUE(database.findUserById(john).has_value());
+    EXPECT_FALSE(database.findUserById(john)->is_active);
+
+    // Журнал в состоянии failed(): последующие изменения не применяются
+    EXPECT_EQ(database.saveUser(User{0, "Jane", "jane@test.com", true}), -1);
+    EXPECT_FALSE(database.insertUser(User{100, "Jane", "jane@test.com", true}));
+    EXPECT_FALSE(database.updateUser(User{john, "Johnny", "john@test.com", true}));
+    EXPECT_FALSE(database.deleteUser(john));
+    EXPECT_EQ(database.saveOrder(Order{0, john, "Mouse", 1.0, OrderStatus::PENDING}), -1);
+    EXPECT_FALSE(database.insertOrder(Order{100, john, "Mouse", 1.0, OrderStatus::PENDING}));
+    EXPECT_FALSE(
+        database.updateOrder(Order{order, john, "Laptop", 10.0, OrderStatus::SHIPPED}));
+    EXPECT_FALSE(database.deleteOrder(order));
+    database.clear();
+
+    auto users = database.findAllUsers();
+    ASSERT_EQ(users.size(), 1);
+    EXPECT_EQ(users[0].name, "John");
+    EXPECT_FALSE(users[0].is_active);
+    auto orders = database.findAllOrders();
+    ASSERT_EQ(orders.size(), 1);
+    EXPECT_EQ(orders[0].status, OrderStatus::PENDING);
+}